@@ -0,0 +1,473 @@
+/* Microbenchmarks of the core functions.
+ *
+ * Every function is timed over three date distributions: one day repeated,
+ * consecutive days from 2000-01-01, and uniformly random days in years
+ * 1-4000 (about 2000 years either side of the present). Each benchmark is
+ * calibrated to BENCH_TARGET_NS per repetition and repeated BENCH_REPETITIONS
+ * times; the results go to a JSON file so runs can be diffed between commits,
+ * or compared as they run against an earlier file with --baseline.
+ *
+ * Allocations are counted by wrapping malloc, calloc, realloc and strdup at
+ * link time (see the bench target in the Makefile); GLib allocations made by
+ * the GUI model are not included. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include "../include/lunar_calendar.h"
+#include "../include/lunar_renderer.h"
+#ifdef LUNAR_BENCH_GUI
+#include <gtk/gtk.h>
+#include "../include/gui/calendar_adapter.h"
+#include "../include/gui/calendar_events.h"
+#endif
+
+// --- Constants ---
+#define BENCH_DATES 4096              /* Inputs per distribution; a power of two */
+#define BENCH_REPETITIONS 7
+#define BENCH_TARGET_NS 50000000.0    /* Time per repetition */
+#define BENCH_CALIBRATE_NS 5000000.0
+#define BENCH_SEQUENTIAL_START 2451545 /* 2000-01-01 */
+#define BENCH_RANDOM_FIRST_YEAR 1
+#define BENCH_RANDOM_LAST_YEAR 4000
+#define BENCH_MAX_BASELINE 64
+
+// --- Allocation Counting ---
+
+static long g_allocations = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+char *__real_strdup(const char *text);
+
+void *__wrap_malloc(size_t size) {
+    g_allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    g_allocations++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    g_allocations++;
+    return __real_realloc(pointer, size);
+}
+
+char *__wrap_strdup(const char *text) {
+    g_allocations++;
+    return __real_strdup(text);
+}
+
+// --- Inputs ---
+
+typedef enum {
+    DIST_SINGLE,
+    DIST_SEQUENTIAL,
+    DIST_RANDOM,
+    DIST_COUNT
+} Distribution;
+
+static const char *DISTRIBUTION_NAMES[DIST_COUNT] = { "single_day", "sequential", "random" };
+
+/* Inputs of one distribution, all derived from the same day numbers */
+typedef struct {
+    int year[BENCH_DATES], month[BENCH_DATES], day[BENCH_DATES];
+    double noon_jd[BENCH_DATES];
+    int lunar_year[BENCH_DATES], lunar_month[BENCH_DATES], lunar_day[BENCH_DATES];
+} BenchInputs;
+
+static BenchInputs g_inputs[DIST_COUNT];
+
+/* Keeps results alive so the calls are not optimized away */
+static volatile double g_sink;
+
+static uint64_t next_random(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void prepare_inputs(void) {
+    int random_first = (int)floor(gregorian_to_julian_day(BENCH_RANDOM_FIRST_YEAR, 1, 1, 12.0));
+    int random_last = (int)floor(gregorian_to_julian_day(BENCH_RANDOM_LAST_YEAR, 12, 31, 12.0));
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    LunarCache cache;
+
+    lunar_cache_init(&cache);
+    for (int d = 0; d < DIST_COUNT; d++) {
+        BenchInputs *in = &g_inputs[d];
+        for (int i = 0; i < BENCH_DATES; i++) {
+            int day_number;
+            switch ((Distribution)d) {
+                case DIST_SINGLE:     day_number = BENCH_SEQUENTIAL_START; break;
+                case DIST_SEQUENTIAL: day_number = BENCH_SEQUENTIAL_START + i; break;
+                default:
+                    day_number = random_first + (int)(next_random(&state) % (uint64_t)(random_last - random_first + 1));
+                    break;
+            }
+            day_number_to_gregorian(day_number, &in->year[i], &in->month[i], &in->day[i]);
+            in->noon_jd[i] = day_number;
+
+            LunarDay lunar = gregorian_to_lunar_cached(&cache, in->year[i], in->month[i], in->day[i]);
+            in->lunar_year[i] = lunar.lunar_year;
+            in->lunar_month[i] = lunar.lunar_month;
+            in->lunar_day[i] = lunar.lunar_day;
+
+            /* The two conversions bound a month differently, so lunar_to_gregorian
+             * can reject the last day of a month; time only the success path */
+            int year, month, day;
+            if (!lunar_to_gregorian_cached(&cache, lunar.lunar_year, lunar.lunar_month, lunar.lunar_day,
+                                           &year, &month, &day)) {
+                in->lunar_day[i] = lunar.lunar_day - 1;
+            }
+        }
+    }
+}
+
+// --- Benchmark Bodies ---
+
+/* Run `iterations` operations over the inputs, starting at index 0 */
+typedef void (*BenchBody)(const BenchInputs *in, long iterations);
+
+static void bench_gregorian_to_lunar(const BenchInputs *in, long iterations) {
+    for (long n = 0; n < iterations; n++) {
+        long i = n & (BENCH_DATES - 1);
+        g_sink = gregorian_to_lunar(in->year[i], in->month[i], in->day[i]).lunar_day;
+    }
+}
+
+static void bench_gregorian_to_lunar_cached(const BenchInputs *in, long iterations) {
+    LunarCache cache;
+    lunar_cache_init(&cache);
+    for (long n = 0; n < iterations; n++) {
+        long i = n & (BENCH_DATES - 1);
+        g_sink = gregorian_to_lunar_cached(&cache, in->year[i], in->month[i], in->day[i]).lunar_day;
+    }
+}
+
+static void bench_lunar_to_gregorian(const BenchInputs *in, long iterations) {
+    int year, month, day;
+    for (long n = 0; n < iterations; n++) {
+        long i = n & (BENCH_DATES - 1);
+        lunar_to_gregorian(in->lunar_year[i], in->lunar_month[i], in->lunar_day[i], &year, &month, &day);
+        g_sink = day;
+    }
+}
+
+static void bench_moon_phase_from_jd(const BenchInputs *in, long iterations) {
+    for (long n = 0; n < iterations; n++) {
+        g_sink = calculate_moon_phase_from_jd(in->noon_jd[n & (BENCH_DATES - 1)]);
+    }
+}
+
+static void bench_find_next_phase_jd(const BenchInputs *in, long iterations) {
+    for (long n = 0; n < iterations; n++) {
+        g_sink = find_next_phase_jd(in->noon_jd[n & (BENCH_DATES - 1)], (int)(n & 3));
+    }
+}
+
+static void bench_lunar_new_year_jd(const BenchInputs *in, long iterations) {
+    for (long n = 0; n < iterations; n++) {
+        g_sink = calculate_lunar_new_year_jd(in->year[n & (BENCH_DATES - 1)]);
+    }
+}
+
+static void bench_lunar_months_in_year(const BenchInputs *in, long iterations) {
+    for (long n = 0; n < iterations; n++) {
+        g_sink = get_lunar_months_in_year(in->lunar_year[n & (BENCH_DATES - 1)]);
+    }
+}
+
+static void bench_render_month(const BenchInputs *in, long iterations) {
+    RenderOptions options = default_render_options();
+    RenderSink sink;
+
+    options.highlight_today = false;
+    render_sink_init_buffer(&sink);
+    for (long n = 0; n < iterations; n++) {
+        long i = n & (BENCH_DATES - 1);
+        render_sink_reset(&sink);
+        render_lunar_month_to(&sink, in->lunar_year[i], in->lunar_month[i], options);
+        g_sink = (double)sink.length;
+    }
+    render_sink_free(&sink);
+}
+
+static void bench_render_year(const BenchInputs *in, long iterations) {
+    RenderOptions options = default_render_options();
+    RenderSink sink;
+
+    options.highlight_today = false;
+    render_sink_init_buffer(&sink);
+    for (long n = 0; n < iterations; n++) {
+        render_sink_reset(&sink);
+        render_lunar_year_to(&sink, in->lunar_year[n & (BENCH_DATES - 1)], options);
+        g_sink = (double)sink.length;
+    }
+    render_sink_free(&sink);
+}
+
+#ifdef LUNAR_BENCH_GUI
+static void bench_month_model(const BenchInputs *in, long iterations) {
+    for (long n = 0; n < iterations; n++) {
+        long i = n & (BENCH_DATES - 1);
+        CalendarGridModel *model = calendar_adapter_create_month_model(in->year[i], in->month[i]);
+        g_sink = model != NULL ? model->days_in_month : 0;
+        calendar_adapter_free_model(model);
+    }
+}
+#endif
+
+static const struct {
+    const char *name;
+    BenchBody body;
+} BENCHMARKS[] = {
+    { "gregorian_to_lunar", bench_gregorian_to_lunar },
+    { "gregorian_to_lunar_cached", bench_gregorian_to_lunar_cached },
+    { "lunar_to_gregorian", bench_lunar_to_gregorian },
+    { "calculate_moon_phase_from_jd", bench_moon_phase_from_jd },
+    { "find_next_phase_jd", bench_find_next_phase_jd },
+    { "calculate_lunar_new_year_jd", bench_lunar_new_year_jd },
+    { "get_lunar_months_in_year", bench_lunar_months_in_year },
+    { "render_lunar_month_to", bench_render_month },
+    { "render_lunar_year_to", bench_render_year },
+#ifdef LUNAR_BENCH_GUI
+    { "calendar_adapter_create_month_model", bench_month_model },
+#endif
+};
+
+// --- Measurement ---
+
+typedef struct {
+    long iterations;           /* Operations per repetition */
+    double ns_per_op[BENCH_REPETITIONS];
+    double median_ns, mean_ns, min_ns, max_ns, stddev_ns;
+    double allocations_per_op;
+} BenchResult;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double left = *(const double *)a;
+    double right = *(const double *)b;
+    return (left > right) - (left < right);
+}
+
+static void run_benchmark(BenchBody body, const BenchInputs *in, BenchResult *result) {
+    /* Grow the batch until it takes long enough to time, then size it to the target */
+    long iterations = 1;
+    double elapsed;
+    for (;;) {
+        double start = now_ns();
+        body(in, iterations);
+        elapsed = now_ns() - start;
+        if (elapsed >= BENCH_CALIBRATE_NS || iterations >= (1L << 30)) break;
+        iterations *= 2;
+    }
+    iterations = (long)ceil(iterations * BENCH_TARGET_NS / (elapsed > 0 ? elapsed : 1));
+    if (iterations < 1) iterations = 1;
+
+    long allocations = 0;
+    for (int r = 0; r < BENCH_REPETITIONS; r++) {
+        long allocations_before = g_allocations;
+        double start = now_ns();
+        body(in, iterations);
+        result->ns_per_op[r] = (now_ns() - start) / (double)iterations;
+        allocations += g_allocations - allocations_before;
+    }
+
+    double sorted[BENCH_REPETITIONS], sum = 0, squares = 0;
+    memcpy(sorted, result->ns_per_op, sizeof(sorted));
+    qsort(sorted, BENCH_REPETITIONS, sizeof(double), compare_doubles);
+    for (int r = 0; r < BENCH_REPETITIONS; r++) {
+        sum += sorted[r];
+    }
+    result->mean_ns = sum / BENCH_REPETITIONS;
+    for (int r = 0; r < BENCH_REPETITIONS; r++) {
+        squares += (sorted[r] - result->mean_ns) * (sorted[r] - result->mean_ns);
+    }
+    result->iterations = iterations;
+    result->median_ns = sorted[BENCH_REPETITIONS / 2];
+    result->min_ns = sorted[0];
+    result->max_ns = sorted[BENCH_REPETITIONS - 1];
+    result->stddev_ns = sqrt(squares / (BENCH_REPETITIONS - 1));
+    result->allocations_per_op = (double)allocations / ((double)iterations * BENCH_REPETITIONS);
+}
+
+static void write_result(FILE *out, const char *name, const char *distribution, const BenchResult *r, bool first) {
+    fprintf(out, "%s    {\"name\": \"%s\", \"distribution\": \"%s\", \"iterations\": %ld, \"repetitions\": %d,\n"
+                 "     \"ns_per_op\": %.3f, \"ns_per_op_mean\": %.3f, \"ns_per_op_min\": %.3f, \"ns_per_op_max\": %.3f,\n"
+                 "     \"ns_per_op_stddev\": %.3f, \"ns_per_op_variance\": %.3f, \"ops_per_sec\": %.1f,\n"
+                 "     \"allocations_per_op\": %.4f, \"samples_ns_per_op\": [",
+            first ? "" : ",\n", name, distribution, r->iterations, BENCH_REPETITIONS,
+            r->median_ns, r->mean_ns, r->min_ns, r->max_ns,
+            r->stddev_ns, r->stddev_ns * r->stddev_ns, r->median_ns > 0 ? 1e9 / r->median_ns : 0,
+            r->allocations_per_op);
+    for (int i = 0; i < BENCH_REPETITIONS; i++) {
+        fprintf(out, "%s%.3f", i > 0 ? ", " : "", r->ns_per_op[i]);
+    }
+    fprintf(out, "]}");
+}
+
+// --- Baseline ---
+
+typedef struct {
+    char name[64];
+    char distribution[16];
+    double ns_per_op;
+} BaselineResult;
+
+static BaselineResult g_baseline[BENCH_MAX_BASELINE];
+static int g_baseline_count = 0;
+
+/* Read the median ns/op of each result from a file this program wrote */
+static bool load_baseline(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+    char line[512];
+    BaselineResult *pending = NULL;
+    while (fgets(line, sizeof(line), file) != NULL && g_baseline_count < BENCH_MAX_BASELINE) {
+        const char *ns = strstr(line, "\"ns_per_op\": ");
+        if (pending == NULL) {
+            BaselineResult *result = &g_baseline[g_baseline_count];
+            if (sscanf(line, " {\"name\": \"%63[^\"]\", \"distribution\": \"%15[^\"]\"",
+                       result->name, result->distribution) == 2) {
+                pending = result;
+            }
+        } else if (ns != NULL && sscanf(ns, "\"ns_per_op\": %lf", &pending->ns_per_op) == 1) {
+            g_baseline_count++;
+            pending = NULL;
+        }
+    }
+    fclose(file);
+    return g_baseline_count > 0;
+}
+
+static double baseline_ns_per_op(const char *name, const char *distribution) {
+    for (int i = 0; i < g_baseline_count; i++) {
+        if (strcmp(g_baseline[i].name, name) == 0 && strcmp(g_baseline[i].distribution, distribution) == 0) {
+            return g_baseline[i].ns_per_op;
+        }
+    }
+    return 0;
+}
+
+/* A comma-separated filter selects the benchmarks whose name contains any of its parts */
+static bool filter_matches(const char *filter, const char *name) {
+    if (filter == NULL) {
+        return true;
+    }
+    while (*filter != '\0') {
+        size_t length = strcspn(filter, ",");
+        for (const char *p = name; strlen(p) >= length; p++) {
+            if (strncmp(p, filter, length) == 0) {
+                return true;
+            }
+        }
+        filter += length;
+        if (*filter == ',') filter++;
+    }
+    return false;
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [--output FILE] [--label TEXT] [--filter NAME[,NAME...]] [--baseline FILE]\n", program);
+}
+
+int main(int argc, char *argv[]) {
+    const char *output_path = "bench_results.json";
+    const char *label = "";
+    const char *filter = NULL;
+    const char *baseline_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--label") == 0 && i + 1 < argc) {
+            label = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (baseline_path != NULL && !load_baseline(baseline_path)) {
+        fprintf(stderr, "Error: Could not read results from '%s'\n", baseline_path);
+        return 2;
+    }
+
+    FILE *out = fopen(output_path, "w");
+    if (out == NULL) {
+        fprintf(stderr, "Error: Could not create '%s'\n", output_path);
+        return 2;
+    }
+
+#ifdef LUNAR_BENCH_GUI
+    /* The month model looks up events; start with an empty list */
+    events_init(NULL);
+#endif
+    prepare_inputs();
+
+    time_t now = time(NULL);
+    char timestamp[32];
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    fprintf(out, "{\n  \"schema\": 1,\n  \"label\": \"%s\",\n  \"timestamp\": \"%s\",\n  \"results\": [\n",
+            label, timestamp);
+
+    printf("%-36s %-11s %12s %14s %9s %10s", "benchmark", "dates", "ns/op", "ops/s", "stddev%", "allocs/op");
+    printf(g_baseline_count > 0 ? " %12s %8s\n" : "\n", "base ns/op", "speedup");
+    bool first = true;
+    double log_speedup_sum = 0;
+    int compared = 0;
+    for (size_t b = 0; b < sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]); b++) {
+        if (!filter_matches(filter, BENCHMARKS[b].name)) {
+            continue;
+        }
+        for (int d = 0; d < DIST_COUNT; d++) {
+            BenchResult result;
+            run_benchmark(BENCHMARKS[b].body, &g_inputs[d], &result);
+            write_result(out, BENCHMARKS[b].name, DISTRIBUTION_NAMES[d], &result, first);
+            first = false;
+            printf("%-36s %-11s %12.1f %14.0f %8.1f%% %10.2f", BENCHMARKS[b].name, DISTRIBUTION_NAMES[d],
+                   result.median_ns, 1e9 / result.median_ns,
+                   result.median_ns > 0 ? 100.0 * result.stddev_ns / result.mean_ns : 0,
+                   result.allocations_per_op);
+            double base_ns = baseline_ns_per_op(BENCHMARKS[b].name, DISTRIBUTION_NAMES[d]);
+            if (base_ns > 0 && result.median_ns > 0) {
+                printf(" %12.1f %7.2fx", base_ns, base_ns / result.median_ns);
+                log_speedup_sum += log(base_ns / result.median_ns);
+                compared++;
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    if (fclose(out) != 0) {
+        fprintf(stderr, "Error: Could not write '%s'\n", output_path);
+        return 1;
+    }
+    if (compared > 0) {
+        printf("Geometric mean speedup over %s: %.2fx (%d results)\n", baseline_path,
+               exp(log_speedup_sum / compared), compared);
+    }
+    printf("Results written to %s\n", output_path);
+    return 0;
+}
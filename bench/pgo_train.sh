@@ -0,0 +1,40 @@
+#!/bin/sh
+# Training run for the profile-guided build (make pgo), using the
+# instrumented programs in BIN_DIR: conversions in both directions over
+# random dates, a range export, an iCalendar export and rendered years
+# through the command-line tool, then a scripted walk through the GUI's
+# months when there is a display (or xvfb-run) to show it on.
+#
+# Usage: bench/pgo_train.sh BIN_DIR
+set -e
+
+bin=${1:?usage: $0 BIN_DIR}
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# Keep the GUI's config, events, cache and log out of the user's home
+export HOME="$work" XDG_CONFIG_HOME="$work/config" XDG_CACHE_HOME="$work/cache" XDG_DATA_HOME="$work/data"
+
+# The same random days as Gregorian and as lunar dates, years 1-4000
+awk 'BEGIN {
+    srand(1)
+    for (i = 0; i < 20000; i++)
+        printf "%d-%02d-%02d\n", 1 + int(rand() * 4000), 1 + int(rand() * 12), 1 + int(rand() * 28)
+}' > "$work/dates.txt"
+
+"$bin/lunar_calendar" --batch "$work/dates.txt" --format csv > /dev/null
+"$bin/lunar_calendar" --batch "$work/dates.txt" --l2g --format jsonl > /dev/null
+"$bin/lunar_calendar" export --from 1800-01-01 --to 2200-12-31 --format binary --output "$work/export.bin"
+"$bin/lunar_calendar" export --from 1990-01-01 --to 2030-12-31 --format csv --output "$work/export.csv"
+"$bin/lunar_calendar" ics --from 1900 --to 2100 --output "$work/lunar.ics"
+"$bin/lunar_calendar" render_years 2000 2040 > /dev/null
+
+if [ -x "$bin/lunar_calendar_gui" ]; then
+    if [ -n "$DISPLAY$WAYLAND_DISPLAY" ]; then
+        "$bin/lunar_calendar_gui" --navigate 60
+    elif command -v xvfb-run > /dev/null; then
+        xvfb-run -a "$bin/lunar_calendar_gui" --navigate 60
+    else
+        echo "pgo_train: no display, the GUI is not part of the profile" >&2
+    fi
+fi
@@ -71,6 +71,9 @@ const char* calendar_adapter_get_moon_phase_name(MoonPhase phase);
 // Get an icon for a moon phase (returns a GtkImage widget)
 GtkWidget* calendar_adapter_get_moon_phase_icon(MoonPhase phase);
 
+// Resolve the moon phase icons against the icon theme ahead of first use
+void calendar_adapter_preload_icons(void);
+
 // Get the color for a special day type
 void calendar_adapter_get_special_day_color(SpecialDayType type, GdkRGBA* color);
 
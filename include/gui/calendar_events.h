@@ -3,9 +3,28 @@
 
 #include <gtk/gtk.h>
 #include <stdbool.h>
+#include <stdint.h>
+
+// Recurrence rules. A recurring event is stored once and expanded on demand;
+// its date is the first day the rule applies from.
+typedef enum {
+    EVENT_RECUR_NONE,               // Single occurrence on year/month/day
+    EVENT_RECUR_YEARLY_GREGORIAN,   // Every year on the Gregorian month/day
+    EVENT_RECUR_LUNAR_MONTH_START,  // Every full-moon day 1 of lunar month recur_month
+    EVENT_RECUR_WINTER_SOLSTICE     // Every winter solstice
+} EventRecurrence;
+
+// Calendar an event is keyed by. Lunar-keyed events keep the Gregorian date of
+// their (first) occurrence in year/month/day for display.
+typedef enum {
+    EVENT_KEY_GREGORIAN,    // Gregorian year/month/day
+    EVENT_KEY_LUNAR,        // Fixed lunar_year/lunar_month/lunar_day
+    EVENT_KEY_LUNAR_YEARLY  // lunar_month/lunar_day every lunar year from lunar_year on
+} EventKey;
 
 // Calendar event structure
 typedef struct {
+    uint64_t id;        // Stable event ID (never reused within a store, 0 is invalid)
     int year;           // Gregorian year
     int month;          // Gregorian month
     int day;            // Gregorian day
@@ -13,6 +32,12 @@ typedef struct {
     char* description;  // Event description
     bool has_custom_color;  // Whether the event has a custom color
     GdkRGBA color;      // Custom color for the event
+    EventRecurrence recurrence;  // Recurrence rule (EVENT_RECUR_NONE for one-off events)
+    int recur_month;    // Lunar month for EVENT_RECUR_LUNAR_MONTH_START
+    EventKey key;       // Calendar the event is keyed by
+    int lunar_year;     // Lunar key (EVENT_KEY_LUNAR and EVENT_KEY_LUNAR_YEARLY only)
+    int lunar_month;
+    int lunar_day;
 } CalendarEvent;
 
 // Structure to hold a list of events
@@ -34,15 +59,52 @@ bool events_save(const char* events_file_path);
 // Add an event
 bool event_add(int year, int month, int day, const char* title, const char* description, GdkRGBA* color);
 
-// Update an event
-bool event_update(int year, int month, int day, int event_index, const char* title, const char* description, GdkRGBA* color);
+// Add a recurring event starting from the given Gregorian date
+bool event_add_recurring(int year, int month, int day, EventRecurrence recurrence, int recur_month,
+                         const char* title, const char* description, GdkRGBA* color);
+
+// Add an event keyed by a lunar date; with yearly set it repeats on that lunar
+// month and day every lunar year starting from lunar_year
+bool event_add_lunar(int lunar_year, int lunar_month, int lunar_day, bool yearly,
+                     const char* title, const char* description, GdkRGBA* color);
 
-// Delete an event
-bool event_delete(int year, int month, int day, int event_index);
+// Update an event's title, description and color by ID
+bool event_update(uint64_t event_id, const char* title, const char* description, GdkRGBA* color);
+
+// Delete an event by ID
+bool event_delete(uint64_t event_id);
+
+// Get an event by ID (NULL if there is none)
+CalendarEvent* event_get_by_id(uint64_t event_id);
 
 // Get events for a specific date
 EventList* event_get_for_date(int year, int month, int day);
 
+// Get events for a lunar date (NULL if the date does not exist or has no events)
+EventList* event_get_for_lunar_date(int lunar_year, int lunar_month, int lunar_day);
+
+// Convert a Gregorian date to the lunar date of its calendar grid cell, using
+// the cached month boundaries (month 1 day 1 is the day containing the full moon)
+bool events_gregorian_to_lunar(int year, int month, int day,
+                               int* lunar_year, int* lunar_month, int* lunar_day);
+
+// Callback for each stored event
+typedef void (*EventFunc)(CalendarEvent* event, void* user_data);
+
+// Visit every stored event once (recurring events are not expanded)
+void event_foreach(EventFunc func, void* user_data);
+
+// Callback for event occurrences within a date range
+typedef void (*EventOccurrenceFunc)(CalendarEvent* event, int year, int month, int day, void* user_data);
+
+// Visit every event occurrence (including expanded recurrences) in an inclusive date range
+void event_foreach_in_range(int start_year, int start_month, int start_day,
+                            int end_year, int end_month, int end_day,
+                            EventOccurrenceFunc func, void* user_data);
+
+// Get a short description of an event's recurrence rule (NULL for one-off events)
+const char* event_recurrence_describe(const CalendarEvent* event);
+
 // Check if a date has any events
 bool event_date_has_events(int year, int month, int day);
 
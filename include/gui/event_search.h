@@ -0,0 +1,27 @@
+#ifndef EVENT_SEARCH_H
+#define EVENT_SEARCH_H
+
+#include <stdbool.h>
+#include "calendar_events.h"
+
+// Full-text search over event titles and descriptions.
+//
+// The inverted index maps lowercased alphanumeric tokens to posting lists of
+// event IDs. It is built on the first query and then kept up to date by the
+// event store, which calls event_search_index_add/remove on every change.
+
+// Find events whose text contains every query word as a token prefix, sorted
+// by date. At most max_results events are returned (0 for no limit); NULL if
+// nothing matches. Free the result with event_list_free.
+EventList* event_search(const char* query, int max_results);
+
+// Index an event's current title and description
+void event_search_index_add(CalendarEvent* event);
+
+// Remove an event from the index (call before its strings change or it is freed)
+void event_search_index_remove(CalendarEvent* event);
+
+// Drop the whole index; it is rebuilt on the next query
+void event_search_index_reset(void);
+
+#endif /* EVENT_SEARCH_H */
@@ -4,8 +4,23 @@
 #include <gtk/gtk.h>
 #include "../lunar_calendar.h"
 #include "../lunar_renderer.h"
+#include "../lunar_logger.h"
 #include "config.h"
 
+// Stages of startup, timed and logged when debug logging is on. The window
+// is shown with the current month first; the stages after STARTUP_FIRST_FRAME
+// run from idle callbacks once it has been drawn.
+typedef enum {
+    STARTUP_INIT,           // Config, logger and computation cache
+    STARTUP_APPLICATION,    // Registering the application until it activates
+    STARTUP_BUILD_UI,       // Widgets and the current month
+    STARTUP_FIRST_FRAME,    // Until the window is first drawn
+    STARTUP_ICONS,          // Icon theme lookups
+    STARTUP_EVENTS,         // Loading the events file
+    STARTUP_NEIGHBORS,      // Precomputing the months before and after
+    STARTUP_STAGE_COUNT
+} StartupStage;
+
 // GUI application structure
 typedef struct {
     GtkApplication *app;
@@ -44,6 +59,14 @@ typedef struct {
     char *events_file_path;
     LunarCalendarConfig *config;
     
+    // Context of the calculations, active on the main thread; its year
+    // table is saved to the cache directory on exit
+    LunarContext *lunar_ctx;
+    
+    // Logger writing to config->log_file_path (installed as the default)
+    LunarLogger *logger;
+    char *logger_path;
+    
     // Today's date (for highlighting)
     int today_year;
     int today_month;
@@ -60,6 +83,32 @@ typedef struct {
     GtkWidget *event_title_entry;
     GtkWidget *event_desc_text;
     GtkWidget *event_color_button;
+    GtkWidget *event_repeat_combo;
+    
+    // Event search widgets
+    GtkWidget *search_entry;
+    GtkWidget *search_popover;
+    GtkWidget *search_results;
+    
+    // Hot-path counters over the calendar, shown when debug logging is on
+    GtkWidget *stats_overlay;
+    
+    // Start of the frame phase being traced (--trace), 0 when none
+    guint64 trace_layout_start;
+    guint64 trace_paint_start;
+    
+    // Scripted navigation (--navigate N): months to step each way, steps taken
+    int navigate_steps;
+    int navigate_done;
+    
+    // Startup pipeline: time spent in each stage, the end of the last one,
+    // the next deferred stage and its idle source (0 once all have run)
+    guint64 startup_ns[STARTUP_STAGE_COUNT];
+    guint64 startup_mark;
+    StartupStage startup_stage;
+    guint startup_source;
+    GPtrArray *deferred_icon_buttons;   // Buttons whose icon is set in STARTUP_ICONS
+    gboolean events_loaded;
 } LunarCalendarApp;
 
 // Initialize the GUI application
@@ -71,6 +120,9 @@ int gui_app_run(LunarCalendarApp* app);
 // Clean up resources
 void gui_app_cleanup(LunarCalendarApp* app);
 
+// Forget the saved year boundaries and phase instants (Clear cache)
+void gui_app_clear_cache(LunarCalendarApp* app);
+
 // Update calendar view to show a specific month
 void gui_app_show_month(LunarCalendarApp* app, int year, int month);
 
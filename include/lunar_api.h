@@ -0,0 +1,18 @@
+#ifndef LUNAR_API_H
+#define LUNAR_API_H
+
+/* Marks the functions liblunarcore exports. The library is compiled with
+ * -fvisibility=hidden, so anything not marked stays private to it, and the
+ * exported names are bound to a symbol version by src/lunarcore.map. */
+#if defined(__GNUC__)
+#define LUNAR_API __attribute__((visibility("default")))
+#else
+#define LUNAR_API
+#endif
+
+/* Version of the exported API. The major number is the shared library's
+ * soname version and changes only when an existing function changes. */
+#define LUNARCORE_VERSION_MAJOR 1
+#define LUNARCORE_VERSION_MINOR 2
+
+#endif /* LUNAR_API_H */
@@ -0,0 +1,40 @@
+#ifndef LUNAR_BATCH_H
+#define LUNAR_BATCH_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "lunar_api.h"
+
+/* Output formats for batch conversion */
+typedef enum {
+    BATCH_FORMAT_TSV,
+    BATCH_FORMAT_CSV,
+    BATCH_FORMAT_JSONL
+} BatchFormat;
+
+/* Conversion direction: input lines are Gregorian or lunar dates */
+typedef enum {
+    BATCH_GREGORIAN_TO_LUNAR,
+    BATCH_LUNAR_TO_GREGORIAN
+} BatchDirection;
+
+/* Batch conversion options */
+typedef struct {
+    BatchFormat format;
+    BatchDirection direction;
+    bool header;               /* Write a column header (TSV/CSV only) */
+} BatchOptions;
+
+/* Default batch options (TSV, Gregorian to lunar, with header) */
+LUNAR_API BatchOptions default_batch_options(void);
+
+/* Parse a format name ("tsv", "csv" or "jsonl") */
+LUNAR_API bool parse_batch_format(const char *name, BatchFormat *format);
+
+/* Convert one date per input line and write one result row per line.
+ * Dates are YYYY-MM-DD (also accepted: YYYY MM DD, YYYY/MM/DD); blank lines
+ * and lines starting with '#' are skipped. Rows that fail carry the reason in
+ * the error column. Returns the number of failed rows, or -1 on a write error. */
+LUNAR_API long run_batch(FILE *in, FILE *out, const BatchOptions *options);
+
+#endif /* LUNAR_BATCH_H */
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <time.h>
+#include "lunar_api.h"
 
 /* Metonic cycle constants */
 #define YEARS_PER_METONIC_CYCLE 19
@@ -11,9 +12,14 @@
 /* Astronomical constants */
 #define LUNAR_MONTH_AVERAGE_DAYS 29.53058868  /* Average synodic month length */
 #define SOLAR_YEAR_DAYS 365.242189  /* Average solar year in days */
+#define MOON_PHASE_TOLERANCE_DAYS 0.75  /* Days around an instant named after the phase */
 #define WINTER_SOLSTICE_MONTH 12
 #define DEFAULT_WINTER_SOLSTICE_DAY 21
 
+/* Version of the calculations; raised whenever a change alters their results,
+ * so that cache files of earlier results are no longer used */
+#define LUNAR_ALGORITHM_VERSION 1
+
 /* Moon phase enumeration */
 typedef enum {
     NEW_MOON,
@@ -88,6 +94,44 @@ typedef struct {
     int germanic_start_greg_day;
 } LunarYear;
 
+/* Month boundaries of a lunar year, computed once from the full moon instants */
+typedef struct {
+    int lunar_year;          /* Lunar year identifier (Gregorian year it starts in) */
+    int months_count;        /* 12 or 13 */
+    double month_start_jd[14]; /* Start JD (UT) of each month; [months_count] is the next year's start */
+} LunarYearBoundaries;
+
+/* Phase instants (JD, UT) of one lunation, as used to name the moon phase of a day */
+typedef struct {
+    double k_base;           /* Lunation number the instants were computed for */
+    double new_moon;
+    double first_quarter;
+    double full_moon;
+    double last_quarter;
+    double next_new_moon;
+    bool valid;              /* False if the instants could not be put in order */
+    bool computed;
+} LunationPhases;
+
+/* Number of lunar years kept by a LunarCache */
+#define LUNAR_CACHE_YEARS 4
+
+/* Lunar year boundaries and phase instants shared between threads; see lunar_year_table_new */
+typedef struct LunarYearTable LunarYearTable;
+
+/* Caller-owned memo for bulk conversions. Holds the month boundaries of the
+ * most recently used lunar years and the phase instants of the last lunation,
+ * so runs of nearby dates skip the phase searches. Not shared between callers;
+ * give each thread its own. */
+typedef struct {
+    LunarYearBoundaries years[LUNAR_CACHE_YEARS];
+    int years_used;
+    int next_slot;           /* Round-robin replacement */
+    LunationPhases lunation;          /* Lunation containing the last date */
+    LunationPhases previous_lunation; /* Used for dates just before lunation.new_moon */
+    LunarYearTable *table;   /* Consulted on a year miss before computing, or NULL */
+} LunarCache;
+
 /* Structure to represent a complete Metonic cycle (19 years) */
 typedef struct {
     int cycle_number;  /* Which Metonic cycle this is */
@@ -101,85 +145,228 @@ typedef struct {
 /* Function prototypes for date conversions and calculations */
 
 /* Convert a Gregorian date to a lunar date */
-LunarDay gregorian_to_lunar(int year, int month, int day);
+LUNAR_API LunarDay gregorian_to_lunar(int year, int month, int day);
+
+/* Convert a lunar date to a Gregorian date; the inverse of gregorian_to_lunar */
+LUNAR_API bool lunar_to_gregorian(int lunar_year, int lunar_month, int lunar_day, 
+                                  int *greg_year, int *greg_month, int *greg_day);
+
+/* Reset a conversion cache */
+LUNAR_API void lunar_cache_init(LunarCache *cache);
+
+/* Back a cache with a shared year table, so threads reuse each other's years */
+LUNAR_API void lunar_cache_use_table(LunarCache *cache, LunarYearTable *table);
+
+/* Create a table memoizing the boundaries of lunar years first_year..last_year
+ * for the life of the process. Each year is computed once, by whichever thread
+ * needs it first; lookups of computed years take no lock. Years outside the
+ * window are computed on every lookup. A shared context's table also keeps
+ * the moon phase instants of the window, which every phase search and moon
+ * phase made with the context reuses. */
+LUNAR_API LunarYearTable *lunar_year_table_new(int first_year, int last_year);
+LUNAR_API void lunar_year_table_free(LunarYearTable *table);
+
+/* Copy the boundaries of a lunar year out of the table, computing them on first use */
+LUNAR_API bool lunar_year_table_get(LunarYearTable *table, int lunar_year, LunarYearBoundaries *bounds);
 
-/* Convert a lunar date to a Gregorian date */
-bool lunar_to_gregorian(int lunar_year, int lunar_month, int lunar_day, 
-                        int *greg_year, int *greg_month, int *greg_day);
+/* Forget everything computed; only while no other thread uses the table */
+LUNAR_API void lunar_year_table_clear(LunarYearTable *table);
+
+/* Persist what a table has computed across runs. Save writes the computed
+ * years and phase instants to a compact binary file (replacing it
+ * atomically); load publishes those of a file into the table. Files carry
+ * LUNAR_ALGORITHM_VERSION and a checksum: a file from another version, or a
+ * damaged one, is not loaded. Both return false if nothing was saved/loaded. */
+LUNAR_API bool lunar_year_table_save(LunarYearTable *table, const char *path);
+LUNAR_API bool lunar_year_table_load(LunarYearTable *table, const char *path);
+
+/* Same as gregorian_to_lunar, memoizing year boundaries and lunation phases in cache */
+LUNAR_API LunarDay gregorian_to_lunar_cached(LunarCache *cache, int year, int month, int day);
+
+/* Same as lunar_to_gregorian using cached year boundaries; invalid dates fail without logging */
+LUNAR_API bool lunar_to_gregorian_cached(LunarCache *cache, int lunar_year, int lunar_month, int lunar_day,
+                                         int *greg_year, int *greg_month, int *greg_day);
 
 /* Calculate the Germanic Eld year from a Gregorian year */
-int calculate_eld_year(int gregorian_year);
+LUNAR_API int calculate_eld_year(int gregorian_year);
 
 /* Calculate the phase of the moon for a given date */
-MoonPhase calculate_moon_phase(int year, int month, int day);
+LUNAR_API MoonPhase calculate_moon_phase(int year, int month, int day);
 
 /* Calculate the exact time of the full moon for a given month/year */
-bool calculate_full_moon(int year, int month, int *full_moon_day, double *full_moon_hour);
+LUNAR_API bool calculate_full_moon(int year, int month, int *full_moon_day, double *full_moon_hour);
 
 /* Calculate the exact time of the new moon for a given month/year */
-bool calculate_new_moon(int year, int month, int *new_moon_day, double *new_moon_hour);
+LUNAR_API bool calculate_new_moon(int year, int month, int *new_moon_day, double *new_moon_hour);
 
 /* Calculate the winter solstice date for a given year */
-bool calculate_winter_solstice(int year, int *month, int *day);
+LUNAR_API bool calculate_winter_solstice(int year, int *month, int *day);
 
 /* Calculate equinoxes and solstices for a given year */
-bool calculate_spring_equinox(int year, int *month, int *day);
-bool calculate_summer_solstice(int year, int *month, int *day);
-bool calculate_fall_equinox(int year, int *month, int *day);
+LUNAR_API bool calculate_spring_equinox(int year, int *month, int *day);
+LUNAR_API bool calculate_summer_solstice(int year, int *month, int *day);
+LUNAR_API bool calculate_fall_equinox(int year, int *month, int *day);
 
 /* Helper functions for astronomical calculations */
-double calculate_solstice_equinox_jde(int year, int season);
-double periodic_terms_for_solstice_equinox(double T, int season);
+LUNAR_API double calculate_solstice_equinox_jde(int year, int season);
 
 /* Calculate the Germanic new year date for a given Gregorian year */
-int calculate_germanic_new_year(int year, int *month, int *day);
-
-/* Count the number of lunar months in a given year */
-int count_lunar_months_in_year(int year);
+LUNAR_API int calculate_germanic_new_year(int year, int *month, int *day);
 
 /* Calculate the weekday for a given date */
-Weekday calculate_weekday(int year, int month, int day);
+LUNAR_API Weekday calculate_weekday(int year, int month, int day);
 
 /* Get the lunar date for today */
-LunarDay get_today_lunar_date(void);
+LUNAR_API LunarDay get_today_lunar_date(void);
 
 /* Get the position of a *Lunar Year* (identified by its Gregorian start year) within the conceptual Metonic cycle */
-void get_metonic_position(int lunar_year_identifier, int *metonic_year_pos, int *metonic_cycle_num);
+LUNAR_API void get_metonic_position(int lunar_year_identifier, int *metonic_year_pos, int *metonic_cycle_num);
+
+/* Calculate the months and every day of one lunar year */
+LUNAR_API bool calculate_lunar_year(int lunar_year, LunarYear *year);
 
 /* Initialize a Metonic cycle starting from a given Gregorian year */
-MetonicCycle initialize_metonic_cycle(int start_year);
+LUNAR_API MetonicCycle initialize_metonic_cycle(int start_year);
 
 /* Calculate if a given lunar month has 29 or 30 days */
-int calculate_lunar_month_length(int year, int month);
+LUNAR_API int calculate_lunar_month_length(int year, int month);
 
 /* Calculate if a given lunar year is a leap year (13 months) */
-bool is_lunar_leap_year(int year);
+LUNAR_API bool is_lunar_leap_year(int year);
 
 /* Helper function to check if a given Gregorian year is a leap year */
-bool is_gregorian_leap_year(int year);
+LUNAR_API bool is_gregorian_leap_year(int year);
+
+/* Check that a Gregorian date exists */
+LUNAR_API bool is_valid_gregorian_date(int year, int month, int day);
 
 /* Convert Julian day to Gregorian date */
-void julian_day_to_gregorian(double julian_day, int *year, int *month, int *day, double *hour);
+LUNAR_API void julian_day_to_gregorian(double julian_day, int *year, int *month, int *day, double *hour);
+
+/* Convert a day number (JDN) to a proleptic Gregorian date */
+LUNAR_API void day_number_to_gregorian(int day_number, int *year, int *month, int *day);
 
 /* Convert Gregorian date to Julian day */
-double gregorian_to_julian_day(int year, int month, int day, double hour);
+LUNAR_API double gregorian_to_julian_day(int year, int month, int day, double hour);
 
 /* Calculate the Julian Day (UT) of the start of the specified lunar year. */
-double calculate_lunar_new_year_jd(int gregorian_year);
+LUNAR_API double calculate_lunar_new_year_jd(int gregorian_year);
+
+/* Calculate the start of every month of a lunar year in a single pass. */
+LUNAR_API bool calculate_lunar_year_boundaries(int lunar_year, LunarYearBoundaries *bounds);
+
+/* Day number (JDN) of the first day of a month (1..months_count + 1) of a lunar year. */
+LUNAR_API int lunar_month_start_day(const LunarYearBoundaries *bounds, int month);
 
 /* Calculate the number of lunar months (12 or 13) in a given lunar year. */
-int get_lunar_months_in_year(int lunar_year);
+LUNAR_API int get_lunar_months_in_year(int lunar_year);
 
 /* Calculate if a given lunar year (defined by our rules) has 13 months. */
-bool is_lunar_leap_year(int lunar_year);
+LUNAR_API bool is_lunar_leap_year(int lunar_year);
 
 /* Find the Julian Day (UT) of the next specified phase after a given JD. */
-double find_next_phase_jd(double start_jd, int phase_type); // 0=NM, 1=FQ, 2=FM, 3=LQ
+LUNAR_API double find_next_phase_jd(double start_jd, int phase_type); // 0=NM, 1=FQ, 2=FM, 3=LQ
 
 /* Calculate moon phase directly from Julian Day (UT) */
-MoonPhase calculate_moon_phase_from_jd(double jd);
+LUNAR_API MoonPhase calculate_moon_phase_from_jd(double jd);
 
 /* Calculate the Eld Year based on the *Gregorian* year */
-int calculate_eld_year_from_gregorian(int gregorian_year);
+LUNAR_API int calculate_eld_year_from_gregorian(int gregorian_year);
+
+/* Display names for moon phases and weekdays */
+LUNAR_API const char* get_moon_phase_name(MoonPhase phase);
+LUNAR_API const char* get_weekday_name(Weekday weekday);
+
+/* Parse exactly `count` integers separated by '-', '/', ',' or whitespace
+ * (e.g. "2024-03-15" or "2024 3 15"); only the first may be signed.
+ * Surrounding whitespace is allowed. Returns false on anything else. */
+LUNAR_API bool parse_int_fields(const char *text, int *values, int count);
+
+/* --- Contexts ---
+ *
+ * A LunarContext carries the conversion cache, the phase tolerance, the
+ * definition of "today" and where diagnostics go. The lunar_ctx_* functions
+ * take one explicitly; the plain functions use the context activated on the
+ * calling thread (lunar_ctx_activate), or the defaults: local time, the default
+ * logger, MOON_PHASE_TOLERANCE_DAYS and no cache between calls. Passing a NULL
+ * context to a lunar_ctx_* function means the same.
+ *
+ * Every function here that converts, finds moon phases, logs or reads the
+ * clock has a lunar_ctx_* variant (get_today_lunar_date's is lunar_ctx_today).
+ * The *_cached conversions take their cache as an argument and the rest of
+ * their settings from the active context. The others (weekday, Gregorian leap
+ * year and Julian day arithmetic, the solstice and equinox dates, Eld year and
+ * Metonic position, names, parsing) depend on nothing but their arguments. */
+
+/* Diagnostic levels, most severe first; LUNAR_LOG_NONE silences a context */
+typedef enum {
+    LUNAR_LOG_NONE,
+    LUNAR_LOG_ERROR,
+    LUNAR_LOG_WARNING,
+    LUNAR_LOG_INFO,
+    LUNAR_LOG_DEBUG
+} LunarLogLevel;
+
+/* Receives one diagnostic line, without a level prefix or trailing newline */
+typedef void (*LunarLogCallback)(LunarLogLevel level, const char *message, void *user_data);
+
+typedef struct LunarContext LunarContext;
+
+/* lunar_ctx_new flags */
+#define LUNAR_CTX_SHARED 0x1  /* Usable by several threads at once (see lunar_ctx_new) */
+
+/* Create a context with the default settings. Without LUNAR_CTX_SHARED the
+ * context keeps a private LunarCache and must be used by one thread at a
+ * time; give each thread its own. A shared context memoizes years in a
+ * lock-free table instead, so any number of threads may convert with it
+ * concurrently. Change settings only while no other thread uses the context. */
+LUNAR_API LunarContext *lunar_ctx_new(unsigned flags);
+LUNAR_API void lunar_ctx_free(LunarContext *ctx);
+
+/* The table of a shared context (e.g. to save or load it), NULL for a private one */
+LUNAR_API LunarYearTable *lunar_ctx_year_table(LunarContext *ctx);
+
+/* Send diagnostics up to max_level to callback; a NULL callback hands them to
+ * the default logger (lunar_logger.h), or stderr if none is installed */
+LUNAR_API void lunar_ctx_set_log(LunarContext *ctx, LunarLogCallback callback, void *user_data,
+                                 LunarLogLevel max_level);
+
+/* Define today in a fixed offset from UTC instead of the local time zone */
+LUNAR_API void lunar_ctx_set_utc_offset(LunarContext *ctx, int minutes);
+LUNAR_API void lunar_ctx_use_local_time(LunarContext *ctx);
+
+/* Pin today to a Gregorian date (e.g. for reproducible output); false if invalid */
+LUNAR_API bool lunar_ctx_set_today(LunarContext *ctx, int year, int month, int day);
+LUNAR_API void lunar_ctx_clear_today(LunarContext *ctx);
+
+/* Days around a phase instant named after the phase (0 < days <= 3); false if out of range */
+LUNAR_API bool lunar_ctx_set_phase_tolerance(LunarContext *ctx, double days);
+LUNAR_API double lunar_ctx_phase_tolerance(const LunarContext *ctx);
+
+/* Make ctx the calling thread's context for the plain functions; returns the
+ * previously active one so it can be restored. NULL restores the defaults. */
+LUNAR_API LunarContext *lunar_ctx_activate(LunarContext *ctx);
+
+/* Context variants of the conversions and calculations above */
+LUNAR_API LunarDay lunar_ctx_gregorian_to_lunar(LunarContext *ctx, int year, int month, int day);
+LUNAR_API bool lunar_ctx_lunar_to_gregorian(LunarContext *ctx, int lunar_year, int lunar_month, int lunar_day,
+                                            int *greg_year, int *greg_month, int *greg_day);
+LUNAR_API MoonPhase lunar_ctx_moon_phase(LunarContext *ctx, int year, int month, int day);
+LUNAR_API bool lunar_ctx_year_boundaries(LunarContext *ctx, int lunar_year, LunarYearBoundaries *bounds);
+LUNAR_API bool lunar_ctx_lunar_year(LunarContext *ctx, int lunar_year, LunarYear *year);
+LUNAR_API double lunar_ctx_next_phase_jd(LunarContext *ctx, double start_jd, int phase_type);
+LUNAR_API bool lunar_ctx_new_moon(LunarContext *ctx, int year, int month, int *new_moon_day, double *new_moon_hour);
+LUNAR_API bool lunar_ctx_full_moon(LunarContext *ctx, int year, int month, int *full_moon_day, double *full_moon_hour);
+LUNAR_API double lunar_ctx_solstice_equinox_jde(LunarContext *ctx, int year, int season);
+LUNAR_API double lunar_ctx_lunar_new_year_jd(LunarContext *ctx, int gregorian_year);
+LUNAR_API int lunar_ctx_germanic_new_year(LunarContext *ctx, int year, int *month, int *day);
+LUNAR_API int lunar_ctx_months_in_year(LunarContext *ctx, int lunar_year);
+LUNAR_API bool lunar_ctx_is_leap_year(LunarContext *ctx, int lunar_year);
+LUNAR_API int lunar_ctx_month_length(LunarContext *ctx, int lunar_year, int month);
+LUNAR_API MetonicCycle lunar_ctx_metonic_cycle(LunarContext *ctx, int start_year);
+
+/* Today as a day number (JDN) and as a lunar date (get_today_lunar_date) */
+LUNAR_API int lunar_ctx_today_day_number(const LunarContext *ctx);
+LUNAR_API LunarDay lunar_ctx_today(LunarContext *ctx);
 
 #endif /* LUNAR_CALENDAR_H */ 
\ No newline at end of file
@@ -0,0 +1,158 @@
+#ifndef LUNAR_CLIENT_H
+#define LUNAR_CLIENT_H
+
+/* Header-only client for the query daemon's Unix domain socket
+ * (see lunar_wire.h). Needs nothing but libc:
+ *
+ *     LunarClient client;
+ *     if (lunar_client_connect(&client, "/tmp/lunar.sock")) {
+ *         lunar_client_g2l(&client, dates, count, days);
+ *         lunar_client_close(&client);
+ *     }
+ *
+ * Large batches are split into frames of LUNAR_CLIENT_BATCH records, and up
+ * to LUNAR_CLIENT_PIPELINE frames are in flight at once. A LunarClient is
+ * not thread-safe; give each thread its own connection. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "lunar_wire.h"
+
+#define LUNAR_CLIENT_BATCH 1024
+#define LUNAR_CLIENT_PIPELINE 4
+
+typedef struct {
+    int fd;
+    uint32_t next_id;
+} LunarClient;
+
+/* Connect to the daemon's socket; false if it is not listening */
+static inline bool lunar_client_connect(LunarClient *client, const char *path) {
+    struct sockaddr_un address;
+
+    client->fd = -1;
+    client->next_id = 1;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        return false;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
+        close(fd);
+        return false;
+    }
+    client->fd = fd;
+    return true;
+}
+
+static inline void lunar_client_close(LunarClient *client) {
+    if (client->fd >= 0) {
+        close(client->fd);
+        client->fd = -1;
+    }
+}
+
+static inline bool lunar_client_write_all(int fd, const void *data, size_t length) {
+    const char *p = (const char *)data;
+    while (length > 0) {
+        ssize_t sent = send(fd, p, length, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += sent;
+        length -= (size_t)sent;
+    }
+    return true;
+}
+
+static inline bool lunar_client_read_all(int fd, void *data, size_t length) {
+    char *p = (char *)data;
+    while (length > 0) {
+        ssize_t received = recv(fd, p, length, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) {
+            return false;
+        }
+        p += received;
+        length -= (size_t)received;
+    }
+    return true;
+}
+
+/* Send one frame of count request records */
+static inline bool lunar_client_send_frame(LunarClient *client, uint16_t op, uint32_t id,
+                                           const void *records, size_t record_size, size_t count) {
+    LunarWireHeader header = { LUNAR_WIRE_MAGIC, op, LUNAR_WIRE_OK, id, (uint32_t)count };
+    return lunar_client_write_all(client->fd, &header, sizeof(header)) &&
+           lunar_client_write_all(client->fd, records, record_size * count);
+}
+
+/* Receive the reply to a frame of count records */
+static inline bool lunar_client_receive_frame(LunarClient *client, uint16_t op, uint32_t id,
+                                              void *records, size_t record_size, size_t count) {
+    LunarWireHeader header;
+    if (!lunar_client_read_all(client->fd, &header, sizeof(header)) ||
+        header.magic != LUNAR_WIRE_MAGIC || header.op != op || header.id != id ||
+        header.status != LUNAR_WIRE_OK || header.count != count) {
+        return false;
+    }
+    return lunar_client_read_all(client->fd, records, record_size * count);
+}
+
+/* Convert count records with op, pipelining frames; false on any protocol or
+ * connection error, after which the client should be closed */
+static inline bool lunar_client_run(LunarClient *client, uint16_t op,
+                                    const void *requests, size_t request_size,
+                                    void *replies, size_t reply_size, size_t count) {
+    size_t frames = (count + LUNAR_CLIENT_BATCH - 1) / LUNAR_CLIENT_BATCH;
+    size_t sent = 0, received = 0;
+    uint32_t first_id = client->next_id;
+
+    client->next_id += (uint32_t)frames;
+    while (received < frames) {
+        while (sent < frames && sent - received < LUNAR_CLIENT_PIPELINE) {
+            size_t offset = sent * LUNAR_CLIENT_BATCH;
+            size_t n = count - offset < LUNAR_CLIENT_BATCH ? count - offset : LUNAR_CLIENT_BATCH;
+            if (!lunar_client_send_frame(client, op, first_id + (uint32_t)sent,
+                                         (const char *)requests + offset * request_size, request_size, n)) {
+                return false;
+            }
+            sent++;
+        }
+        size_t offset = received * LUNAR_CLIENT_BATCH;
+        size_t n = count - offset < LUNAR_CLIENT_BATCH ? count - offset : LUNAR_CLIENT_BATCH;
+        if (!lunar_client_receive_frame(client, op, first_id + (uint32_t)received,
+                                        (char *)replies + offset * reply_size, reply_size, n)) {
+            return false;
+        }
+        received++;
+    }
+    return true;
+}
+
+/* Lunar dates of count Gregorian dates */
+static inline bool lunar_client_g2l(LunarClient *client, const LunarWireDate *dates, size_t count,
+                                    LunarWireDay *days) {
+    return lunar_client_run(client, LUNAR_OP_G2L, dates, sizeof(*dates), days, sizeof(*days), count);
+}
+
+/* Gregorian dates of count lunar dates */
+static inline bool lunar_client_l2g(LunarClient *client, const LunarWireDate *lunar_dates, size_t count,
+                                    LunarWireDate *dates) {
+    return lunar_client_run(client, LUNAR_OP_L2G, lunar_dates, sizeof(*lunar_dates),
+                            dates, sizeof(*dates), count);
+}
+
+#endif /* LUNAR_CLIENT_H */
@@ -0,0 +1,49 @@
+#ifndef LUNAR_EXPORT_H
+#define LUNAR_EXPORT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "lunar_api.h"
+
+/* Output formats for range export */
+typedef enum {
+    EXPORT_FORMAT_CSV,
+    EXPORT_FORMAT_JSONL,
+    EXPORT_FORMAT_BINARY       /* Columnar row groups, see below */
+} ExportFormat;
+
+/* Binary export layout (native byte order, marked by EXPORT_BINARY_BYTE_ORDER):
+ *   header:    char magic[8] = "LUNARCOL", uint32 version, uint32 byte_order,
+ *              uint32 column_count, then per column: uint8 name_length, name
+ *   row group: uint32 row_count (> 0), then row_count int32 values per column
+ *   footer:    uint32 0, uint64 total_rows
+ * Every column is int32; moon_phase, weekday and special_day hold the enum
+ * values. One row group is written per lunar year. Version 2 added special_day. */
+#define EXPORT_BINARY_MAGIC "LUNARCOL"
+#define EXPORT_BINARY_VERSION 2
+#define EXPORT_BINARY_BYTE_ORDER 0x01020304u
+
+/* Most worker threads an export uses */
+#define EXPORT_MAX_THREADS 256
+
+/* Range export options */
+typedef struct {
+    int from_year, from_month, from_day;   /* First Gregorian date (inclusive) */
+    int to_year, to_month, to_day;         /* Last Gregorian date (inclusive) */
+    ExportFormat format;
+    bool header;                           /* Column header row (CSV only) */
+    int threads;                           /* Worker threads; 0 = one per online CPU */
+} ExportOptions;
+
+/* Default export options (CSV with header, all CPUs); the range must be set */
+LUNAR_API ExportOptions default_export_options(void);
+
+/* Parse a format name ("csv", "jsonl", "binary" or "parquet-like-binary") */
+LUNAR_API bool parse_export_format(const char *name, ExportFormat *format);
+
+/* Write one row per day of the range, every LunarDay field per row.
+ * Lunar years are converted in parallel and written in date order.
+ * Returns the number of rows written, or -1 on an invalid range or write error. */
+LUNAR_API long long run_export(FILE *out, const ExportOptions *options);
+
+#endif /* LUNAR_EXPORT_H */
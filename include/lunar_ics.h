@@ -0,0 +1,64 @@
+#ifndef LUNAR_ICS_H
+#define LUNAR_ICS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "lunar_api.h"
+
+/* Output is staged in this fixed buffer and flushed to the stream when full,
+ * so memory use does not grow with the exported range */
+#define ICS_BUFFER_SIZE 16384
+
+/* Domain part of generated UIDs */
+#define ICS_UID_DOMAIN "lunar-calendar.mani"
+
+/* Streaming iCalendar (RFC 5545) writer */
+typedef struct {
+    FILE *stream;
+    char buffer[ICS_BUFFER_SIZE];
+    size_t length;
+    char dtstamp[17];      /* Creation time, YYYYMMDDTHHMMSSZ */
+    long events;           /* VEVENTs written so far */
+    bool failed;           /* A write failed; later writes are skipped */
+} IcsWriter;
+
+/* An all-day event; description and categories may be NULL */
+typedef struct {
+    const char *uid;       /* Globally unique and stable across exports */
+    int year, month, day;  /* Gregorian date */
+    const char *summary;
+    const char *description;
+    const char *categories;
+} IcsEvent;
+
+/* iCalendar export options; Gregorian years, inclusive (1-9999) */
+typedef struct {
+    int from_year;
+    int to_year;
+    bool month_starts;     /* All-day events for lunar month starts and new years */
+    bool moon_phases;      /* Timed events for new and full moons */
+    bool seasons;          /* Timed events for solstices and equinoxes */
+} IcsOptions;
+
+/* Called after each Gregorian year's astronomical events so the caller can add
+ * its own (e.g. user events) with ics_write_event; return false to abort */
+typedef bool (*IcsYearCallback)(IcsWriter *writer, int year, void *user_data);
+
+/* Default options: every event kind; the year range must be set */
+LUNAR_API IcsOptions default_ics_options(void);
+
+/* Start a calendar on a stream: writes the VCALENDAR header */
+LUNAR_API void ics_writer_begin(IcsWriter *writer, FILE *stream);
+
+/* Write one all-day VEVENT; returns false once the writer has failed */
+LUNAR_API bool ics_write_event(IcsWriter *writer, const IcsEvent *event);
+
+/* Close the calendar and flush the buffer; returns false if any write failed */
+LUNAR_API bool ics_writer_end(IcsWriter *writer);
+
+/* Write a complete calendar of the year range in one streaming pass.
+ * Each year's full moons are walked once; extra_events may be NULL.
+ * Returns the number of VEVENTs written, or -1 on an invalid range or write error. */
+LUNAR_API long run_ics_export(FILE *out, const IcsOptions *options, IcsYearCallback extra_events, void *user_data);
+
+#endif /* LUNAR_ICS_H */
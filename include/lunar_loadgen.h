@@ -0,0 +1,42 @@
+#ifndef LUNAR_LOADGEN_H
+#define LUNAR_LOADGEN_H
+
+#include <stdbool.h>
+
+/* Load generator options for the query daemon */
+typedef struct {
+    const char *host;          /* IPv4 address of the daemon */
+    int port;
+    int connections;           /* Concurrent keep-alive connections */
+    long requests;             /* Total requests to send */
+    const char *path;          /* Request target, or NULL for a mix of every endpoint */
+    const char *socket_path;   /* Use the binary protocol on this Unix socket instead of HTTP */
+} LoadgenOptions;
+
+/* Results of a load run; latencies are per request, in milliseconds. Over the
+ * Unix socket, requests count converted dates and each latency covers one
+ * batch of LOADGEN_SOCKET_BATCH dates. */
+typedef struct {
+    long completed;            /* Responses received, any status */
+    long errors;               /* Non-200 responses and broken connections */
+    double seconds;
+    double qps;
+    double p50_ms;
+    double p90_ms;
+    double p99_ms;
+    double max_ms;
+} LoadgenReport;
+
+/* Dates per client call in socket mode */
+#define LOADGEN_SOCKET_BATCH 4096
+
+/* Default options: 127.0.0.1:SERVER_DEFAULT_PORT, 8 connections, 100000 mixed requests */
+LoadgenOptions default_loadgen_options(void);
+
+/* Send the requests over closed-loop keep-alive connections, one outstanding
+ * request per connection, from a single epoll thread. In socket mode each
+ * connection gets its own thread, which converts batches of dates.
+ * Returns false if no connection could be established or the daemon stalled. */
+bool run_loadgen(const LoadgenOptions *options, LoadgenReport *report);
+
+#endif /* LUNAR_LOADGEN_H */
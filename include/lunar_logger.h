@@ -0,0 +1,58 @@
+#ifndef LUNAR_LOGGER_H
+#define LUNAR_LOGGER_H
+
+#include <stdbool.h>
+#include "lunar_api.h"
+#include "lunar_calendar.h"
+
+/* Asynchronous leveled logger. Logging formats the line into a slot of a
+ * lock-free queue and returns; a background thread writes the queue to the
+ * log file. Nothing that logs ever waits for the disk:
+ *
+ *   - a line above the logger's level is dropped before it is formatted;
+ *   - past LUNAR_LOGGER_RATE_LIMIT lines a second, further lines are dropped;
+ *   - when the queue is full, the line is dropped.
+ *
+ * Dropped lines are counted, and the writer notes how many it missed. Lines
+ * are written as "2024-03-15 12:00:00.123 WARNING message".
+ *
+ * A logger can take the diagnostics of the calculations by installing it as
+ * the default (lunar_logger_set_default) or as a context's log callback:
+ *
+ *     lunar_ctx_set_log(ctx, lunar_logger_callback, logger, LUNAR_LOG_DEBUG); */
+
+#define LUNAR_LOGGER_RATE_LIMIT 200   /* Lines per second */
+
+typedef struct LunarLogger LunarLogger;
+
+/* Start a logger appending to path (NULL or "": stderr) that keeps lines up
+ * to max_level; NULL if the file cannot be opened or the writer not started */
+LUNAR_API LunarLogger *lunar_logger_new(const char *path, LunarLogLevel max_level);
+
+/* Write out what is queued, stop the writer and close the file */
+LUNAR_API void lunar_logger_free(LunarLogger *logger);
+
+LUNAR_API void lunar_logger_set_level(LunarLogger *logger, LunarLogLevel max_level);
+
+/* Whether a line at level would be kept (NULL: the default logger) */
+LUNAR_API bool lunar_logger_enabled(const LunarLogger *logger, LunarLogLevel level);
+
+/* Queue one line, without a trailing newline. A NULL logger means the
+ * default logger, or stderr (synchronously, warnings and errors only) if
+ * there is none. */
+LUNAR_API void lunar_logger_log(LunarLogger *logger, LunarLogLevel level, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/* LunarLogCallback forwarding to the logger passed as user_data */
+LUNAR_API void lunar_logger_callback(LunarLogLevel level, const char *message, void *user_data);
+
+/* Logger used by lunar_logger_log(NULL, ...) and, for threads whose context
+ * has no log callback, by the calculations' own diagnostics. Uninstall it
+ * before freeing it, once no other thread can still be logging. */
+LUNAR_API void lunar_logger_set_default(LunarLogger *logger);
+LUNAR_API LunarLogger *lunar_logger_get_default(void);
+
+/* Lines dropped so far by the level-independent limits (rate and queue) */
+LUNAR_API unsigned long lunar_logger_dropped(const LunarLogger *logger);
+
+#endif /* LUNAR_LOGGER_H */
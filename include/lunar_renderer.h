@@ -1,6 +1,8 @@
 #ifndef LUNAR_RENDERER_H
 #define LUNAR_RENDERER_H
 
+#include <stdio.h>
+#include <stdint.h>
 #include "lunar_calendar.h"
 
 /* Text color definitions */
@@ -28,6 +30,21 @@ typedef enum {
     FESTIVAL_DAY
 } SpecialDayType;
 
+#define SPECIAL_DAY_TYPE_COUNT (FESTIVAL_DAY + 1)
+
+/* Longest range a SpecialDaySet covers: a lunar or Gregorian year with margin */
+#define SPECIAL_DAY_SET_MAX_DAYS 448
+#define SPECIAL_DAY_SET_WORDS ((SPECIAL_DAY_SET_MAX_DAYS + 63) / 64)
+
+/* Special days of a contiguous range of day numbers (JDN), one bitset per
+ * type. Built once per displayed year or month, so classifying a day is a
+ * handful of bit tests instead of new-year and season calculations. */
+typedef struct {
+    int first_day;         /* Day number of the first day covered */
+    int day_count;         /* Days covered, at most SPECIAL_DAY_SET_MAX_DAYS */
+    uint64_t bits[SPECIAL_DAY_TYPE_COUNT][SPECIAL_DAY_SET_WORDS];
+} SpecialDaySet;
+
 /* Structure to store cell rendering options */
 typedef struct {
     bool show_gregorian_date;  /* Show gregorian date in cell */
@@ -36,6 +53,7 @@ typedef struct {
     bool use_colors;           /* Use ANSI colors in output */
     bool highlight_today;      /* Highlight the current day */
     bool highlight_special_days; /* Highlight special days (full moon, new moon, etc.) */
+    int months_per_row;        /* Month blocks side by side in year views */
 } RenderOptions;
 
 /* Structure to represent a rendered month layout */
@@ -55,30 +73,96 @@ typedef struct {
     int months_per_row;    /* Number of months per row in the layout */
 } RenderedYear;
 
+/* Output sink for the renderers: text is either collected in a growable
+ * buffer or written straight to a stream. Appending is amortized O(1). */
+typedef struct {
+    FILE *stream;          /* Write target, or NULL to collect into buffer */
+    char *buffer;          /* Collected text (NUL-terminated), buffer sinks only */
+    size_t length;
+    size_t capacity;
+    bool failed;           /* An allocation or write failed */
+} RenderSink;
+
+/* Initialize a sink that collects text in memory */
+LUNAR_API void render_sink_init_buffer(RenderSink *sink);
+
+/* Initialize a sink that writes to a stream */
+LUNAR_API void render_sink_init_stream(RenderSink *sink, FILE *stream);
+
+/* Append text to a sink */
+LUNAR_API void render_sink_append(RenderSink *sink, const char *text, size_t length);
+LUNAR_API void render_sink_puts(RenderSink *sink, const char *text);
+LUNAR_API void render_sink_printf(RenderSink *sink, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/* Discard a buffer sink's text, keeping its allocation for reuse */
+LUNAR_API void render_sink_reset(RenderSink *sink);
+
+/* Release a buffer sink's text */
+LUNAR_API void render_sink_free(RenderSink *sink);
+
 /* Default render options */
-RenderOptions default_render_options(void);
+LUNAR_API RenderOptions default_render_options(void);
 
 /* Formatting utilities */
-char *format_month_header(int year, int month, int width);
-char *format_day_cell(LunarDay day, RenderOptions options);
-char *format_special_day(SpecialDayType type, RenderOptions options, const char *text);
-SpecialDayType get_special_day_type(LunarDay day);
+LUNAR_API char *format_month_header(int year, int month, int width);
+LUNAR_API char *format_day_cell(LunarDay day, RenderOptions options);
+LUNAR_API char *format_special_day(SpecialDayType type, RenderOptions options, const char *text);
+LUNAR_API SpecialDayType get_special_day_type(LunarDay day);
+LUNAR_API const char *get_special_day_name(SpecialDayType type);
+
+/* Build the special days of [first_day, first_day + day_count): lunar new
+ * years, solstices and equinoxes, new and full moons, and optionally today.
+ * Returns false if the range is empty or too long. */
+LUNAR_API bool special_day_set_build(SpecialDaySet *set, int first_day, int day_count, bool mark_today);
+
+/* Add a day of the given type, e.g. a festival; days outside the set are ignored */
+LUNAR_API void special_day_set_mark(SpecialDaySet *set, int day_number, SpecialDayType type);
+
+/* Test a single type, or classify a day by priority: today, new year,
+ * solstices and equinoxes, new moon, full moon, festival */
+LUNAR_API bool special_day_set_has(const SpecialDaySet *set, int day_number, SpecialDayType type);
+LUNAR_API SpecialDayType special_day_set_classify(const SpecialDaySet *set, int day_number);
+
+/* Context variants: phase tolerance, today and diagnostics come from ctx */
+LUNAR_API SpecialDayType lunar_ctx_special_day_type(LunarContext *ctx, LunarDay day);
+LUNAR_API bool lunar_ctx_special_day_set_build(LunarContext *ctx, SpecialDaySet *set, int first_day,
+                                               int day_count, bool mark_today);
 
 /* Rendering functions */
-RenderedMonth render_lunar_month(int year, int month, RenderOptions options);
-RenderedYear render_lunar_year(int year, RenderOptions options);
-char *render_metonic_cycle_position(int year, RenderOptions options);
+LUNAR_API RenderedMonth render_lunar_month(int year, int month, RenderOptions options);
+LUNAR_API RenderedYear render_lunar_year(int year, RenderOptions options);
+LUNAR_API char *render_metonic_cycle_position(int year, RenderOptions options);
+
+/* Streaming rendering functions; return false if the sink failed */
+LUNAR_API bool render_lunar_month_to(RenderSink *sink, int year, int month, RenderOptions options);
+LUNAR_API bool render_lunar_year_to(RenderSink *sink, int year, RenderOptions options);
+LUNAR_API bool render_lunar_years_to(RenderSink *sink, int first_year, int last_year, RenderOptions options);
+LUNAR_API bool render_metonic_cycle_position_to(RenderSink *sink, int year, RenderOptions options);
+
+/* Context variants: today, phase tolerance and diagnostics come from ctx */
+LUNAR_API RenderedMonth lunar_ctx_render_lunar_month(LunarContext *ctx, int year, int month, RenderOptions options);
+LUNAR_API RenderedYear lunar_ctx_render_lunar_year(LunarContext *ctx, int year, RenderOptions options);
+LUNAR_API char *lunar_ctx_render_metonic_cycle_position(LunarContext *ctx, int year, RenderOptions options);
+LUNAR_API bool lunar_ctx_render_lunar_month_to(LunarContext *ctx, RenderSink *sink, int year, int month,
+                                               RenderOptions options);
+LUNAR_API bool lunar_ctx_render_lunar_year_to(LunarContext *ctx, RenderSink *sink, int year, RenderOptions options);
+LUNAR_API bool lunar_ctx_render_lunar_years_to(LunarContext *ctx, RenderSink *sink, int first_year, int last_year,
+                                               RenderOptions options);
+LUNAR_API bool lunar_ctx_render_metonic_cycle_position_to(LunarContext *ctx, RenderSink *sink, int year,
+                                                          RenderOptions options);
+LUNAR_API char *lunar_ctx_format_day_cell(LunarContext *ctx, LunarDay day, RenderOptions options);
 
 /* Free memory allocated for rendered output */
-void free_rendered_month(RenderedMonth *month);
-void free_rendered_year(RenderedYear *year);
+LUNAR_API void free_rendered_month(RenderedMonth *month);
+LUNAR_API void free_rendered_year(RenderedYear *year);
 
 /* Display rendered output */
-void display_rendered_month(RenderedMonth month);
-void display_rendered_year(RenderedYear year);
-void display_metonic_cycle_position(const char *position_text);
+LUNAR_API void display_rendered_month(RenderedMonth month);
+LUNAR_API void display_rendered_year(RenderedYear year);
+LUNAR_API void display_metonic_cycle_position(const char *position_text);
 
 /* Helper function to calculate cell width based on options */
-int calculate_cell_width(RenderOptions options);
+LUNAR_API int calculate_cell_width(RenderOptions options);
 
 #endif /* LUNAR_RENDERER_H */ 
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef LUNAR_SERVER_H
+#define LUNAR_SERVER_H
+
+#include <stdbool.h>
+
+/* HTTP/JSON query daemon.
+ *
+ * Endpoints (GET, JSON responses, HTTP/1.1 keep-alive):
+ *   /g2l?date=YYYY-MM-DD            lunar date of a Gregorian date
+ *   /l2g?year=Y&month=M&day=D       Gregorian date of a lunar date
+ *   /phase?date=YYYY-MM-DD          moon phase and the next new and full moons (UTC)
+ *   /year?year=Y                    months of a lunar year
+ *   /range?from=YYYY-MM-DD&to=YYYY-MM-DD
+ *                                   one lunar date per day, at most SERVER_RANGE_MAX_DAYS
+ * Errors are {"error": "..."} with a 4xx status.
+ *
+ * With a socket path, the daemon also answers the binary protocol of
+ * lunar_wire.h on a Unix domain socket (client: lunar_client.h), for
+ * batched, pipelined lookups from processes on the same machine. */
+
+#define SERVER_DEFAULT_PORT 8080
+#define SERVER_MAX_WORKERS 64
+#define SERVER_REQUEST_MAX 8192       /* Request line and headers */
+#define SERVER_RANGE_MAX_DAYS 3660
+#define SERVER_TABLE_FIRST_YEAR -1000 /* Lunar years kept in memory once computed */
+#define SERVER_TABLE_LAST_YEAR 4000
+
+/* Daemon options */
+typedef struct {
+    const char *bind_address;  /* IPv4 address to listen on */
+    int port;
+    int workers;               /* Request worker threads; 0 = one per online CPU, at most 8 */
+    int max_connections;       /* Further connections are refused until one closes */
+    const char *socket_path;   /* Unix domain socket for the binary protocol, or NULL */
+} ServerOptions;
+
+/* Default options: 127.0.0.1:SERVER_DEFAULT_PORT, no Unix socket */
+ServerOptions default_server_options(void);
+
+/* Serve until SIGINT or SIGTERM. One thread runs the epoll loop for all
+ * connections; complete requests are handed to the worker pool, whose threads
+ * each keep a LunarCache backed by one shared year table.
+ * Returns 0 after a clean shutdown, -1 if the server could not start. */
+int run_server(const ServerOptions *options);
+
+#endif /* LUNAR_SERVER_H */
@@ -0,0 +1,74 @@
+#ifndef LUNAR_STATS_H
+#define LUNAR_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "lunar_api.h"
+
+/* Hot-path instrumentation: how often the expensive functions run and how
+ * long they take. Each thread counts into its own block and the blocks are
+ * summed on request, so counting costs no locks.
+ *
+ * The probes are compiled in only when LUNAR_STATS is defined (make
+ * STATS=1); otherwise the LUNAR_STATS_* macros expand to nothing and
+ * lunar_stats_enabled() is false. Times are inclusive: a lunar new year
+ * includes the phase searches it makes, which include their series
+ * evaluations. */
+
+typedef enum {
+    LUNAR_STAT_TRUE_PHASE,          /* calculate_true_phase_jd: one series evaluation */
+    LUNAR_STAT_NEXT_PHASE,          /* find_next_phase_jd */
+    LUNAR_STAT_NEW_YEAR,            /* calculate_lunar_new_year_jd */
+    LUNAR_STAT_YEAR_BOUNDARIES,     /* calculate_lunar_year_boundaries */
+    LUNAR_STAT_CACHE_YEAR_MISS,     /* LunarCache year lookups that were not cached (count only) */
+    LUNAR_STAT_CACHE_LUNATION_MISS, /* LunarCache lunations recomputed (count only) */
+    LUNAR_STAT_MONTH_MODEL,         /* GUI: calendar_adapter_create_month_model */
+    LUNAR_STAT_GRID_REBUILD,        /* GUI: rebuilding the calendar grid */
+    LUNAR_STAT_COUNT
+} LunarStat;
+
+typedef struct {
+    uint64_t calls;
+    uint64_t ticks;                 /* Time spent, in lunar_stats_ticks() units */
+} LunarStatValue;
+
+/* Totals over all threads since the last reset */
+typedef struct {
+    LunarStatValue values[LUNAR_STAT_COUNT];
+    double ns_per_tick;
+} LunarStats;
+
+/* Whether the library was built with the probes */
+LUNAR_API bool lunar_stats_enabled(void);
+
+/* Short name of a counter, e.g. "find_next_phase_jd" */
+LUNAR_API const char *lunar_stat_name(LunarStat stat);
+
+/* Sum the counters of all threads (all zero if not enabled) */
+LUNAR_API void lunar_stats_snapshot(LunarStats *stats);
+
+/* Start counting from zero again, for all threads */
+LUNAR_API void lunar_stats_reset(void);
+
+/* Write a snapshot as a text table, one counter per line; returns the
+ * length it needed, as snprintf does */
+LUNAR_API size_t lunar_stats_format(const LunarStats *stats, char *buffer, size_t size);
+
+/* Timestamp counter (the CPU's cycle counter where there is one) */
+LUNAR_API uint64_t lunar_stats_ticks(void);
+
+/* Count one call of stat that took ticks (0 for pure counters) */
+LUNAR_API void lunar_stats_record(LunarStat stat, uint64_t ticks);
+
+#ifdef LUNAR_STATS
+#define LUNAR_STATS_TIMER_START(timer) uint64_t timer = lunar_stats_ticks()
+#define LUNAR_STATS_TIMER_STOP(stat, timer) lunar_stats_record((stat), lunar_stats_ticks() - (timer))
+#define LUNAR_STATS_EVENT(stat) lunar_stats_record((stat), 0)
+#else
+#define LUNAR_STATS_TIMER_START(timer) ((void)0)
+#define LUNAR_STATS_TIMER_STOP(stat, timer) ((void)0)
+#define LUNAR_STATS_EVENT(stat) ((void)0)
+#endif
+
+#endif /* LUNAR_STATS_H */
@@ -0,0 +1,47 @@
+#ifndef LUNAR_TRACE_H
+#define LUNAR_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "lunar_api.h"
+
+/* Span tracer writing the Chrome trace-event format, for looking at where
+ * the time of one interaction goes in a trace viewer (chrome://tracing,
+ * Perfetto). Recording is off until lunar_trace_enable(true); while it is off
+ * a span costs one flag test. Spans are kept in memory until written.
+ *
+ * Names and categories are stored as pointers, so they must be string
+ * literals (or otherwise outlive the trace):
+ *
+ *     LUNAR_TRACE_BEGIN(span);
+ *     rebuild_calendar_grid(app);
+ *     LUNAR_TRACE_END(span, "gui", "rebuild_calendar_grid");
+ */
+
+#define LUNAR_TRACE_MAX_EVENTS (1u << 20)   /* Later spans are dropped */
+
+LUNAR_API void lunar_trace_enable(bool enabled);
+LUNAR_API bool lunar_trace_enabled(void);
+
+/* Monotonic clock in nanoseconds; never 0 */
+LUNAR_API uint64_t lunar_trace_now(void);
+
+/* Record one finished span on the calling thread */
+LUNAR_API void lunar_trace_record(const char *category, const char *name, uint64_t start_ns, uint64_t end_ns);
+
+/* Spans recorded (and dropped for lack of room) since the last clear */
+LUNAR_API size_t lunar_trace_event_count(void);
+LUNAR_API size_t lunar_trace_dropped(void);
+
+/* Write the spans as a trace-event JSON file; false if it cannot be written */
+LUNAR_API bool lunar_trace_write(const char *path);
+
+LUNAR_API void lunar_trace_clear(void);
+
+#define LUNAR_TRACE_BEGIN(span) uint64_t span = lunar_trace_enabled() ? lunar_trace_now() : 0
+#define LUNAR_TRACE_END(span, category, name) do { \
+        if ((span) != 0) lunar_trace_record((category), (name), (span), lunar_trace_now()); \
+    } while (0)
+
+#endif /* LUNAR_TRACE_H */
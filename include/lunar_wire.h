@@ -0,0 +1,73 @@
+#ifndef LUNAR_WIRE_H
+#define LUNAR_WIRE_H
+
+#include <stdint.h>
+
+/* Binary lookup protocol of the query daemon's Unix domain socket.
+ *
+ * A client sends frames, each a LunarWireHeader followed by count request
+ * records, and may send further frames before the replies arrive. Every
+ * frame is answered in order by one reply frame with the same op and id,
+ * the status, and one reply record per request record. All fields are in
+ * host byte order: both ends run on the same machine.
+ *
+ *   op            request record   reply record
+ *   LUNAR_OP_G2L  LunarWireDate    LunarWireDay   (Gregorian to lunar)
+ *   LUNAR_OP_L2G  LunarWireDate    LunarWireDate  (lunar to Gregorian)
+ *
+ * A record that cannot be converted is answered with day 0. A frame with a
+ * bad magic, op or count is answered with LUNAR_WIRE_BAD_FRAME and no
+ * records, and the daemon then closes the connection. */
+
+#define LUNAR_WIRE_MAGIC 0x31524E4Cu    /* "LNR1" on little-endian hosts */
+#define LUNAR_WIRE_MAX_RECORDS 4096     /* Records per frame */
+
+/* Frame operations */
+enum {
+    LUNAR_OP_G2L = 1,
+    LUNAR_OP_L2G = 2
+};
+
+/* Reply statuses */
+enum {
+    LUNAR_WIRE_OK = 0,
+    LUNAR_WIRE_BAD_FRAME = 1
+};
+
+typedef struct {
+    uint32_t magic;            /* LUNAR_WIRE_MAGIC */
+    uint16_t op;
+    uint16_t status;           /* LUNAR_WIRE_OK in requests */
+    uint32_t id;               /* Chosen by the client, echoed in the reply */
+    uint32_t count;            /* Records following the header */
+} LunarWireHeader;
+
+/* A Gregorian or lunar date */
+typedef struct {
+    int32_t year;
+    uint8_t month;
+    uint8_t day;               /* 0 in a reply: no such date */
+    uint16_t reserved;
+} LunarWireDate;
+
+/* The lunar date of a Gregorian day */
+typedef struct {
+    int32_t lunar_year;
+    uint8_t lunar_month;
+    uint8_t lunar_day;         /* 0: the date could not be converted */
+    uint8_t moon_phase;        /* MoonPhase */
+    uint8_t weekday;           /* Weekday */
+    int32_t eld_year;
+    int16_t metonic_cycle;
+    uint8_t metonic_year;
+    uint8_t reserved;
+} LunarWireDay;
+
+_Static_assert(sizeof(LunarWireHeader) == 16, "LunarWireHeader layout");
+_Static_assert(sizeof(LunarWireDate) == 8, "LunarWireDate layout");
+_Static_assert(sizeof(LunarWireDay) == 16, "LunarWireDay layout");
+
+/* Largest frame either side sends */
+#define LUNAR_WIRE_FRAME_MAX (sizeof(LunarWireHeader) + LUNAR_WIRE_MAX_RECORDS * sizeof(LunarWireDay))
+
+#endif /* LUNAR_WIRE_H */
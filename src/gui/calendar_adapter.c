@@ -7,6 +7,9 @@
 #include "../../include/gui/calendar_adapter.h"
 #include "../../include/lunar_calendar.h"
 #include "../../include/lunar_renderer.h"
+#include "../../include/lunar_stats.h"
+#include "../../include/lunar_logger.h"
+#include "../../include/lunar_trace.h"
 #include "../../include/gui/gui_app.h"
 #include "../../include/gui/calendar_events.h"
 
@@ -51,12 +54,12 @@ static const char* default_month_names[] = {
     "Month 7", "Month 8", "Month 9", "Month 10", "Month 11", "Month 12", "Month 13"
 };
 
-// Get all necessary display information for a specific Gregorian date cell.
-// This relies entirely on the backend gregorian_to_lunar function.
-CalendarDayCell* calendar_adapter_get_day_info(int year, int month, int day) {
+// Build a day cell; special days come from the month's SpecialDaySet when
+// one is given, otherwise they are computed for this day alone.
+static CalendarDayCell* create_day_cell(int year, int month, int day, const SpecialDaySet* special_days) {
     CalendarDayCell* cell = g_malloc0(sizeof(CalendarDayCell));
     if (!cell) {
-        perror("Failed to allocate CalendarDayCell");
+        lunar_logger_log(NULL, LUNAR_LOG_ERROR, "Failed to allocate CalendarDayCell");
         return NULL;
     }
     
@@ -78,9 +81,13 @@ CalendarDayCell* calendar_adapter_get_day_info(int year, int month, int day) {
     cell->moon_phase = lunar_day_info.moon_phase;
     cell->weekday = lunar_day_info.weekday;
     
-    // Check for special days using the function from lunar_renderer
-    // (which should now use correct backend checks)
-    cell->special_day_type = get_special_day_type(lunar_day_info); 
+    // Check for special days: a bit test against the month's set
+    if (special_days) {
+        int day_number = (int)floor(gregorian_to_julian_day(year, month, day, 12.0));
+        cell->special_day_type = special_day_set_classify(special_days, day_number);
+    } else {
+        cell->special_day_type = get_special_day_type(lunar_day_info);
+    }
     cell->is_special_day = (cell->special_day_type != NORMAL_DAY);
 
     // Check for events associated with this Gregorian date (unused here, checked in GUI)
@@ -96,6 +103,12 @@ CalendarDayCell* calendar_adapter_get_day_info(int year, int month, int day) {
     return cell;
 }
 
+// Get all necessary display information for a specific Gregorian date cell.
+// This relies entirely on the backend gregorian_to_lunar function.
+CalendarDayCell* calendar_adapter_get_day_info(int year, int month, int day) {
+    return create_day_cell(year, month, day, NULL);
+}
+
 // Get the name for a moon phase
 const char* calendar_adapter_get_moon_phase_name(MoonPhase phase) {
     switch (phase) {
@@ -111,20 +124,38 @@ const char* calendar_adapter_get_moon_phase_name(MoonPhase phase) {
     }
 }
 
+// Icon name resolved for each moon phase against the icon theme, NULL until
+// looked up; MISSING_ICON when neither the themed nor the fallback icon exists
+static const char* g_moon_phase_icon_names[WANING_CRESCENT + 1];
+static const char MISSING_ICON[] = "image-missing-symbolic";
+
+static const char* moon_phase_icon_name(MoonPhase phase) {
+    if (g_moon_phase_icon_names[phase] == NULL) {
+        GtkIconTheme* icon_theme = gtk_icon_theme_get_default();
+        if (gtk_icon_theme_has_icon(icon_theme, MOON_PHASE_ICONS[phase])) {
+            g_moon_phase_icon_names[phase] = MOON_PHASE_ICONS[phase];
+        } else if (gtk_icon_theme_has_icon(icon_theme, FALLBACK_MOON_PHASE_ICONS[phase])) {
+            g_moon_phase_icon_names[phase] = FALLBACK_MOON_PHASE_ICONS[phase];
+        } else {
+            g_moon_phase_icon_names[phase] = MISSING_ICON;
+            lunar_logger_log(NULL, LUNAR_LOG_WARNING, "Missing moon phase icon: %s and fallback %s",
+                    MOON_PHASE_ICONS[phase], FALLBACK_MOON_PHASE_ICONS[phase]);
+        }
+    }
+    return g_moon_phase_icon_names[phase];
+}
+
+// Look up the moon phase icons now, loading the icon theme, rather than on first use
+void calendar_adapter_preload_icons(void) {
+    for (int phase = NEW_MOON; phase <= WANING_CRESCENT; phase++) {
+        moon_phase_icon_name((MoonPhase)phase);
+    }
+}
+
 // Get the icon name for a moon phase
 GtkWidget* calendar_adapter_get_moon_phase_icon(MoonPhase phase) {
     if (phase < NEW_MOON || phase > WANING_CRESCENT) phase = NEW_MOON;
-    GtkIconTheme* icon_theme = gtk_icon_theme_get_default();
-    GtkWidget* image = NULL;
-    if (gtk_icon_theme_has_icon(icon_theme, MOON_PHASE_ICONS[phase])) {
-        image = gtk_image_new_from_icon_name(MOON_PHASE_ICONS[phase], GTK_ICON_SIZE_BUTTON);
-    } else if (gtk_icon_theme_has_icon(icon_theme, FALLBACK_MOON_PHASE_ICONS[phase])) {
-        image = gtk_image_new_from_icon_name(FALLBACK_MOON_PHASE_ICONS[phase], GTK_ICON_SIZE_BUTTON);
-    } else {
-        image = gtk_image_new_from_icon_name("image-missing-symbolic", GTK_ICON_SIZE_BUTTON);
-        fprintf(stderr, "Warning: Missing moon phase icon: %s and fallback %s\n", 
-                MOON_PHASE_ICONS[phase], FALLBACK_MOON_PHASE_ICONS[phase]);
-    }
+    GtkWidget* image = gtk_image_new_from_icon_name(moon_phase_icon_name(phase), GTK_ICON_SIZE_BUTTON);
     if (image) gtk_widget_set_tooltip_text(image, calendar_adapter_get_moon_phase_name(phase));
     return image;
 }
@@ -140,21 +171,16 @@ GdkPixbuf* create_moon_phase_icon(MoonPhase phase, int size) {
     GError* error = NULL;
     GdkPixbuf* pixbuf = NULL;
 
-    // Try themed icon first
-    if (gtk_icon_theme_has_icon(icon_theme, MOON_PHASE_ICONS[phase])) {
-        pixbuf = gtk_icon_theme_load_icon(icon_theme, MOON_PHASE_ICONS[phase], size, GTK_ICON_LOOKUP_USE_BUILTIN, &error);
-    } 
-    
-    // Try fallback icon if themed failed or doesn't exist
-    if (!pixbuf && gtk_icon_theme_has_icon(icon_theme, FALLBACK_MOON_PHASE_ICONS[phase])) {
-        g_clear_error(&error);
-        pixbuf = gtk_icon_theme_load_icon(icon_theme, FALLBACK_MOON_PHASE_ICONS[phase], size, GTK_ICON_LOOKUP_USE_BUILTIN, &error);
+    // Themed icon, or the fallback when the theme lacks it
+    const char* icon_name = moon_phase_icon_name(phase);
+    if (icon_name != MISSING_ICON) {
+        pixbuf = gtk_icon_theme_load_icon(icon_theme, icon_name, size, GTK_ICON_LOOKUP_USE_BUILTIN, &error);
     }
     
     // If all else fails, use a placeholder
     if (!pixbuf) {
         g_clear_error(&error);
-        pixbuf = gtk_icon_theme_load_icon(icon_theme, "image-missing-symbolic", size, GTK_ICON_LOOKUP_USE_BUILTIN, &error);
+        pixbuf = gtk_icon_theme_load_icon(icon_theme, MISSING_ICON, size, GTK_ICON_LOOKUP_USE_BUILTIN, &error);
         g_warning("Missing moon phase icon: %s and fallback %s. Using placeholder.", 
                   MOON_PHASE_ICONS[phase], FALLBACK_MOON_PHASE_ICONS[phase]);
     }
@@ -255,10 +281,11 @@ char* calendar_adapter_get_tooltip_for_day(CalendarDayCell* cell) {
 // Check if a given date is today
 gboolean calendar_adapter_is_today(int year, int month, int day) {
     time_t now = time(NULL);
-    struct tm* tm_now = localtime(&now);
-    return (year == tm_now->tm_year + 1900 &&
-            month == tm_now->tm_mon + 1 &&
-            day == tm_now->tm_mday);
+    struct tm tm_now;
+    localtime_r(&now, &tm_now);
+    return (year == tm_now.tm_year + 1900 &&
+            month == tm_now.tm_mon + 1 &&
+            day == tm_now.tm_mday);
 }
 
 // Check if a lunar year is a leap year
@@ -297,11 +324,11 @@ static const char* get_display_month_name(int month_num) {
          return default_month_names[month_num - 1]; // Use static default for now
 }
 
-// Create the data model for a specific lunar month
-CalendarGridModel* calendar_adapter_create_month_model(int year_identifier, int lunar_month) {
+// Build the data model for a specific lunar month
+static CalendarGridModel* build_month_model(int year_identifier, int lunar_month) {
     CalendarGridModel* model = g_malloc0(sizeof(CalendarGridModel));
     if (!model) {
-        perror("Failed to allocate CalendarGridModel");
+        lunar_logger_log(NULL, LUNAR_LOG_ERROR, "Failed to allocate CalendarGridModel");
         return NULL;
     }
     
@@ -316,18 +343,21 @@ CalendarGridModel* calendar_adapter_create_month_model(int year_identifier, int
     model->year_str = NULL;
 
     // --- Calculate Month Boundaries and Length ---
-    double year_start_jd = calculate_lunar_new_year_jd(year_identifier);
-    if (year_start_jd == 0) goto model_error;
+    // The year's boundaries come from the shared year table when it has them
+    LunarYearBoundaries bounds;
+    if (!lunar_ctx_year_boundaries(NULL, year_identifier, &bounds) || lunar_month < 1) goto model_error;
     
-    double month_start_jd = year_start_jd;
-    for (int m = 1; m < lunar_month; m++) {
-        month_start_jd = find_next_phase_jd(month_start_jd, 2); // Find start of month m+1
-        if (month_start_jd == 0) goto model_error;
+    double month_start_jd, next_month_start_jd;
+    if (lunar_month <= bounds.months_count) {
+        month_start_jd = bounds.month_start_jd[lunar_month - 1];
+        next_month_start_jd = bounds.month_start_jd[lunar_month];
+    } else {
+        // A 13th month asked of a 12-month year runs on into the next year
+        month_start_jd = bounds.month_start_jd[bounds.months_count];
+        next_month_start_jd = find_next_phase_jd(month_start_jd, 2);
+        if (next_month_start_jd == 0) goto model_error;
     }
     
-    double next_month_start_jd = find_next_phase_jd(month_start_jd, 2);
-    if (next_month_start_jd == 0) goto model_error;
-    
     // Calculate exact length and clamp
     model->days_in_month = (int)floor(next_month_start_jd - month_start_jd + 0.5); // Round to nearest day
     if (model->days_in_month < 29) model->days_in_month = 29;
@@ -341,6 +371,13 @@ CalendarGridModel* calendar_adapter_create_month_model(int year_identifier, int
     julian_day_to_gregorian(month_start_jd, &greg_y, &greg_m, &greg_d, &hour_unused);
     model->first_day_weekday = calculate_weekday(greg_y, greg_m, greg_d);
 
+    // --- Special Days of the Whole Month, Built Once ---
+    SpecialDaySet special_days;
+    int first_day_number = (int)floor(gregorian_to_julian_day(greg_y, greg_m, greg_d, 12.0));
+    LUNAR_TRACE_BEGIN(special_span);
+    bool have_special_days = special_day_set_build(&special_days, first_day_number, model->days_in_month, true);
+    LUNAR_TRACE_END(special_span, "adapter", "special days");
+
     // --- Set Month and Year Strings ---
     model->month_name = g_strdup(get_display_month_name(lunar_month));
     model->year_str = g_strdup_printf("%d", year_identifier); // Use the identifier as the year string
@@ -348,7 +385,7 @@ CalendarGridModel* calendar_adapter_create_month_model(int year_identifier, int
     // --- Allocate and Populate Day Cells --- 
     model->cells = g_malloc0(sizeof(CalendarDayCell*) * model->rows * model->cols);
     if (!model->cells) {
-        perror("Failed to allocate cells array in model");
+        lunar_logger_log(NULL, LUNAR_LOG_ERROR, "Failed to allocate cells array in model");
         goto model_error;
     }
     // Initialize all cells to NULL
@@ -360,22 +397,24 @@ CalendarGridModel* calendar_adapter_create_month_model(int year_identifier, int
     int cell_row = 0;
     int cell_col = model->first_day_weekday;
     
+    LUNAR_TRACE_BEGIN(cells_span);
     for (int i = 0; i < model->days_in_month; i++) {
         int index = cell_row * model->cols + cell_col;
         if (index < 0 || index >= model->rows * model->cols) {
-             fprintf(stderr, "Error: Cell index out of bounds (%d) for day %d\n", index, i + 1);
+             lunar_logger_log(NULL, LUNAR_LOG_ERROR, "Cell index out of bounds (%d) for day %d", index, i + 1);
              continue; // Skip this day if index is bad
         }
 
         // Get info for the current Gregorian date
-        model->cells[index] = calendar_adapter_get_day_info(current_greg_y, current_greg_m, current_greg_d);
+        model->cells[index] = create_day_cell(current_greg_y, current_greg_m, current_greg_d,
+                                              have_special_days ? &special_days : NULL);
         if (!model->cells[index]) {
-            fprintf(stderr, "Error getting day info for %d-%d-%d (Lunar %d/%d/%d)\n", 
+            lunar_logger_log(NULL, LUNAR_LOG_ERROR, "Error getting day info for %d-%d-%d (Lunar %d/%d/%d)",
                     current_greg_y, current_greg_m, current_greg_d, 
                     year_identifier, lunar_month, i + 1);
             // Create a placeholder? For now, leave NULL which GUI should handle
         } else if (model->cells[index]->lunar_day == 0) {
-             fprintf(stderr, "Warning: Backend indicated error for %d-%d-%d (Lunar %d/%d/%d)\n", 
+             lunar_logger_log(NULL, LUNAR_LOG_WARNING, "Backend indicated error for %d-%d-%d (Lunar %d/%d/%d)",
                     current_greg_y, current_greg_m, current_greg_d, 
                     year_identifier, lunar_month, i + 1);
              // Mark cell as invalid? The struct doesn't have is_valid.
@@ -394,11 +433,12 @@ CalendarGridModel* calendar_adapter_create_month_model(int year_identifier, int
             cell_row++;
         }
     }
+    LUNAR_TRACE_END(cells_span, "adapter", "day cells");
     
     return model;
 
 model_error:
-    fprintf(stderr, "Error creating calendar model for %d/%d\n", lunar_month, year_identifier);
+    lunar_logger_log(NULL, LUNAR_LOG_ERROR, "Error creating calendar model for %d/%d", lunar_month, year_identifier);
     // Clean up partially created model
     if (model) {
         if (model->cells) { // No need to free individual cells if allocation failed
@@ -411,6 +451,16 @@ model_error:
     return NULL;
 }
 
+// Create the data model for a specific lunar month
+CalendarGridModel* calendar_adapter_create_month_model(int year_identifier, int lunar_month) {
+    LUNAR_TRACE_BEGIN(span);
+    LUNAR_STATS_TIMER_START(timer);
+    CalendarGridModel* model = build_month_model(year_identifier, lunar_month);
+    LUNAR_STATS_TIMER_STOP(LUNAR_STAT_MONTH_MODEL, timer);
+    LUNAR_TRACE_END(span, "adapter", "calendar_adapter_create_month_model");
+    return model;
+}
+
 // Free the memory used by the grid model
 void calendar_adapter_free_model(CalendarGridModel* model) {
     if (model) {
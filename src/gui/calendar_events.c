@@ -3,17 +3,123 @@
 #include <string.h>
 #include <gtk/gtk.h>
 #include "../../include/gui/calendar_events.h"
+#include "../../include/gui/event_search.h"
 #include <time.h>
+#include <math.h>
+#include <stdint.h>
+#include <sys/stat.h>
 #include <json-glib/json-glib.h>
+#include <glib/gstdio.h>
+#include "../../include/lunar_calendar.h"
 
 // Default event capacity
 #define DEFAULT_CAPACITY 10
-#define EVENTS_FILE_VERSION 1
+#define EVENTS_FILE_VERSION 2
+
+// Binary snapshot format (written next to the JSON file, see events_snapshot_path)
+#define EVENTS_SNAPSHOT_MAGIC "MANIEVTS"
+#define EVENTS_SNAPSHOT_VERSION 6
+#define EVENTS_SNAPSHOT_BYTE_ORDER 0x01020304u
+#define EVENTS_SNAPSHOT_FLAG_CUSTOM_COLOR 0x1u
+
+// Snapshot header. All offsets are relative to the start of the file.
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t header_size;
+    uint32_t record_size;
+    uint32_t record_count;
+    uint32_t reserved;
+    uint64_t records_offset;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+    int64_t source_mtime;   // mtime of the JSON file the snapshot was written with
+    int64_t source_mtime_nsec;  // nanoseconds of that mtime
+    int64_t source_size;    // size of that JSON file
+    uint64_t next_event_id; // ID high-water mark, so IDs of deleted events stay retired
+} EventSnapshotHeader;
+
+// Fixed-width record, sorted by day_number. Strings live in the blob and are
+// NUL-terminated, so they can be used in place from the mapping.
+typedef struct {
+    int32_t day_number;     // Julian day number of the Gregorian date
+    int32_t year;
+    int32_t month;
+    int32_t day;
+    uint32_t flags;
+    uint32_t title_offset;  // Offsets into the string blob
+    uint32_t description_offset;
+    int32_t recurrence;     // EventRecurrence
+    int32_t recur_month;
+    int32_t key;            // EventKey
+    int32_t lunar_year;
+    int32_t lunar_month;
+    int32_t lunar_day;
+    uint32_t reserved;
+    uint64_t id;
+    double color[4];        // red, green, blue, alpha
+} EventSnapshotRecord;
 
 // Global event storage
 static EventList* g_all_events = NULL;
 static char* g_events_file_path = NULL;
 
+// Event ID -> slot in g_all_events. Keys point at the events' own id fields.
+static GHashTable* g_event_slots = NULL;
+static uint64_t g_next_event_id = 1;
+
+// Snapshot mapping backing events loaded from the binary snapshot.
+// Events and strings inside these ranges are not individually allocated.
+static GMappedFile* g_snapshot_file = NULL;
+static const char* g_snapshot_strings = NULL;
+static gsize g_snapshot_strings_size = 0;
+static CalendarEvent* g_snapshot_slab = NULL;
+static int g_snapshot_slab_count = 0;
+
+// An expanded occurrence of a recurring event
+typedef struct {
+    int32_t day_number;
+    CalendarEvent* event;
+} EventOccurrence;
+
+// Cached month boundaries of one lunar year, plus the memoized expansion of
+// the recurring events within it
+typedef struct {
+    LunarYearBoundaries bounds;
+    int32_t month_start_day[14];  // Day numbers of day 1 of each month; [months_count] is the next year's
+    GArray* occurrences;          // EventOccurrence sorted by day; NULL until expanded
+} LunarYearEntry;
+
+// Sort key to event mapping used by the lookup indexes
+typedef struct {
+    int64_t key;
+    CalendarEvent* event;
+} EventIndexEntry;
+
+// Lunar years are cached on first use. Expansions are dropped when a recurring
+// event changes; the month boundaries never change and are kept.
+static GHashTable* g_lunar_years = NULL;  // lunar year -> LunarYearEntry*
+static int g_recurring_count = 0;
+
+// Lookup indexes, built on the first lookup after loading and then kept up
+// to date by add and delete. Events on the same key stay in insertion order.
+static GArray* g_day_index = NULL;           // Gregorian-keyed one-off events by day number
+static GArray* g_lunar_index = NULL;         // EVENT_KEY_LUNAR events by lunar_key()
+static GArray* g_lunar_yearly_index = NULL;  // EVENT_KEY_LUNAR_YEARLY events by lunar_key(0, month, day)
+static bool g_indexes_dirty = true;
+
+static bool events_load_json(const char* events_file_path);
+static bool event_append(const CalendarEvent* fields, const char* title, const char* description,
+                         GdkRGBA* color);
+static bool events_load_snapshot(const char* snapshot_path, const struct stat* json_stat);
+static bool events_write_snapshot(const char* snapshot_path, const char* json_path);
+
+// Julian day number of a Gregorian date (snapshot sort key)
+static int32_t event_day_number(int year, int month, int day) {
+    return (int32_t)floor(gregorian_to_julian_day(year, month, day, 12.0));
+}
+
 // Helper function to compare events by date
 static int compare_events_by_date(const void* a, const void* b) {
     CalendarEvent* event_a = *(CalendarEvent**)a;
@@ -33,6 +139,453 @@ static int compare_events_by_date(const void* a, const void* b) {
     return event_a->day - event_b->day;
 }
 
+// Check whether a string points into the mapped snapshot blob
+static bool snapshot_owns_string(const char* str) {
+    return g_snapshot_strings != NULL && str >= g_snapshot_strings &&
+           str < g_snapshot_strings + g_snapshot_strings_size;
+}
+
+// Check whether an event lives in the snapshot slab
+static bool snapshot_owns_event(const CalendarEvent* event) {
+    return g_snapshot_slab != NULL && event >= g_snapshot_slab &&
+           event < g_snapshot_slab + g_snapshot_slab_count;
+}
+
+// Free an event's strings, leaving snapshot-backed strings alone
+static void event_free_strings(CalendarEvent* event) {
+    if (!snapshot_owns_string(event->title)) {
+        free(event->title);
+    }
+    if (!snapshot_owns_string(event->description)) {
+        free(event->description);
+    }
+    event->title = NULL;
+    event->description = NULL;
+}
+
+// Free an event and its strings
+static void event_free(CalendarEvent* event) {
+    event_free_strings(event);
+    if (!snapshot_owns_event(event)) {
+        free(event);
+    }
+}
+
+// Convert a day number back to a Gregorian date
+static void event_day_to_gregorian(int32_t day_number, int* year, int* month, int* day) {
+    double hour_unused;
+    julian_day_to_gregorian((double)day_number, year, month, day, &hour_unused);
+}
+
+// Pack a lunar date into an index key
+static int64_t lunar_key(int lunar_year, int lunar_month, int lunar_day) {
+    return ((int64_t)lunar_year << 16) | ((int64_t)lunar_month << 8) | (int64_t)lunar_day;
+}
+
+// Free a cached lunar year
+static void lunar_year_entry_free(gpointer data) {
+    LunarYearEntry* entry = (LunarYearEntry*)data;
+    if (entry->occurrences != NULL) {
+        g_array_free(entry->occurrences, TRUE);
+    }
+    g_free(entry);
+}
+
+// Get the cached month boundaries for a lunar year, computing them on first use
+static LunarYearEntry* lunar_year_entry_get(int lunar_year) {
+    if (g_lunar_years == NULL) {
+        g_lunar_years = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, lunar_year_entry_free);
+    }
+    
+    LunarYearEntry* entry = g_hash_table_lookup(g_lunar_years, GINT_TO_POINTER(lunar_year));
+    if (entry == NULL) {
+        entry = g_new0(LunarYearEntry, 1);
+        if (!lunar_ctx_year_boundaries(NULL, lunar_year, &entry->bounds)) {
+            g_free(entry);
+            return NULL;
+        }
+        // Same first day as gregorian_to_lunar and lunar_to_gregorian
+        for (int i = 0; i <= entry->bounds.months_count; i++) {
+            entry->month_start_day[i] = lunar_month_start_day(&entry->bounds, i + 1);
+        }
+        g_hash_table_insert(g_lunar_years, GINT_TO_POINTER(lunar_year), entry);
+    }
+    return entry;
+}
+
+// Get the cached lunar year containing a day (greg_year is the day's Gregorian year)
+static LunarYearEntry* lunar_year_entry_for_day(int32_t day_number, int greg_year) {
+    LunarYearEntry* entry = lunar_year_entry_get(greg_year);
+    if (entry != NULL && day_number < entry->month_start_day[0]) {
+        entry = lunar_year_entry_get(greg_year - 1);
+    } else if (entry != NULL && day_number >= entry->month_start_day[entry->bounds.months_count]) {
+        entry = lunar_year_entry_get(greg_year + 1);
+    }
+    return entry;
+}
+
+// Split a day number into lunar month and day within a cached lunar year
+static void lunar_year_entry_locate(const LunarYearEntry* entry, int32_t day_number,
+                                    int* lunar_month, int* lunar_day) {
+    int month = 0;
+    while (month + 1 < entry->bounds.months_count && day_number >= entry->month_start_day[month + 1]) {
+        month++;
+    }
+    *lunar_month = month + 1;
+    *lunar_day = (int)(day_number - entry->month_start_day[month]) + 1;
+}
+
+// Resolve a lunar date within a cached lunar year to a day number (-1 if it does not exist)
+static int32_t lunar_year_entry_resolve(const LunarYearEntry* entry, int lunar_month, int lunar_day) {
+    if (lunar_month < 1 || lunar_month > entry->bounds.months_count || lunar_day < 1) {
+        return -1;
+    }
+    int32_t day_number = entry->month_start_day[lunar_month - 1] + lunar_day - 1;
+    return day_number < entry->month_start_day[lunar_month] ? day_number : -1;
+}
+
+// Drop all expansions after a recurring event changed (boundaries are kept)
+static void recurrence_invalidate(void) {
+    if (g_lunar_years == NULL) {
+        return;
+    }
+    
+    GHashTableIter iter;
+    gpointer value;
+    g_hash_table_iter_init(&iter, g_lunar_years);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        LunarYearEntry* entry = (LunarYearEntry*)value;
+        if (entry->occurrences != NULL) {
+            g_array_free(entry->occurrences, TRUE);
+            entry->occurrences = NULL;
+        }
+    }
+}
+
+// Compare occurrences by day number
+static int compare_occurrences(const void* a, const void* b) {
+    int32_t day_a = ((const EventOccurrence*)a)->day_number;
+    int32_t day_b = ((const EventOccurrence*)b)->day_number;
+    return (day_a > day_b) - (day_a < day_b);
+}
+
+// Add an occurrence if it falls within the lunar year and not before the event's start date
+static void recurrence_add_occurrence(LunarYearEntry* entry, CalendarEvent* event, int32_t day_number) {
+    if (day_number < entry->month_start_day[0] ||
+        day_number >= entry->month_start_day[entry->bounds.months_count]) {
+        return;
+    }
+    if (day_number < event_day_number(event->year, event->month, event->day)) {
+        return;
+    }
+    
+    EventOccurrence occurrence = { day_number, event };
+    g_array_append_val(entry->occurrences, occurrence);
+}
+
+// Expand every recurring event into the lunar year's day range
+static void recurrence_year_expand(LunarYearEntry* entry) {
+    int lunar_year = entry->bounds.lunar_year;
+    entry->occurrences = g_array_new(FALSE, FALSE, sizeof(EventOccurrence));
+    
+    for (int i = 0; i < g_all_events->count; i++) {
+        CalendarEvent* event = g_all_events->events[i];
+        
+        switch (event->recurrence) {
+            case EVENT_RECUR_YEARLY_GREGORIAN:
+                // A lunar year spans parts of two Gregorian years
+                for (int year = lunar_year; year <= lunar_year + 1; year++) {
+                    if (event->month == 2 && event->day == 29 && !is_gregorian_leap_year(year)) {
+                        continue;
+                    }
+                    recurrence_add_occurrence(entry, event, event_day_number(year, event->month, event->day));
+                }
+                break;
+            case EVENT_RECUR_LUNAR_MONTH_START:
+                if (event->recur_month >= 1 && event->recur_month <= entry->bounds.months_count) {
+                    recurrence_add_occurrence(entry, event, entry->month_start_day[event->recur_month - 1]);
+                }
+                break;
+            case EVENT_RECUR_WINTER_SOLSTICE: {
+                // The solstice in December of the lunar year's starting Gregorian year
+                int ws_month, ws_day;
+                if (calculate_winter_solstice(lunar_year, &ws_month, &ws_day)) {
+                    recurrence_add_occurrence(entry, event, event_day_number(lunar_year, ws_month, ws_day));
+                }
+                break;
+            }
+            case EVENT_RECUR_NONE:
+            default:
+                break;
+        }
+    }
+    
+    g_array_sort(entry->occurrences, compare_occurrences);
+}
+
+// Get a lunar year with its recurring events expanded
+static LunarYearEntry* recurrence_year_get(int lunar_year) {
+    LunarYearEntry* entry = lunar_year_entry_get(lunar_year);
+    if (entry != NULL && entry->occurrences == NULL) {
+        recurrence_year_expand(entry);
+    }
+    return entry;
+}
+
+// Find the recurring occurrences on a day in an expanded lunar year; returns the count and the first one
+static int recurrence_occurrences_on_day(LunarYearEntry* entry, int32_t day_number,
+                                         const EventOccurrence** first) {
+    *first = NULL;
+    if (entry->occurrences->len == 0) {
+        return 0;
+    }
+    
+    // Binary search for the first occurrence on or after the day
+    const EventOccurrence* items = (const EventOccurrence*)entry->occurrences->data;
+    guint low = 0;
+    guint high = entry->occurrences->len;
+    while (low < high) {
+        guint mid = low + (high - low) / 2;
+        if (items[mid].day_number < day_number) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    int count = 0;
+    while (low + count < entry->occurrences->len && items[low + count].day_number == day_number) {
+        count++;
+    }
+    if (count > 0) {
+        *first = &items[low];
+    }
+    return count;
+}
+
+// Compare index entries by key
+static int compare_index_entries(const void* a, const void* b) {
+    int64_t key_a = ((const EventIndexEntry*)a)->key;
+    int64_t key_b = ((const EventIndexEntry*)b)->key;
+    return (key_a > key_b) - (key_a < key_b);
+}
+
+// Find the first index entry with a key not less than the given one
+static guint event_index_lower_bound(GArray* index, int64_t key) {
+    const EventIndexEntry* items = (const EventIndexEntry*)index->data;
+    guint low = 0;
+    guint high = index->len;
+    while (low < high) {
+        guint mid = low + (high - low) / 2;
+        if (items[mid].key < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Free the lookup indexes
+static void event_indexes_free(void) {
+    if (g_day_index != NULL) {
+        g_array_free(g_day_index, TRUE);
+        g_day_index = NULL;
+    }
+    if (g_lunar_index != NULL) {
+        g_array_free(g_lunar_index, TRUE);
+        g_lunar_index = NULL;
+    }
+    if (g_lunar_yearly_index != NULL) {
+        g_array_free(g_lunar_yearly_index, TRUE);
+        g_lunar_yearly_index = NULL;
+    }
+    g_indexes_dirty = true;
+}
+
+// Get the lookup index an event belongs in and its key there (NULL for
+// recurring events, which are found through the per-year expansions)
+static GArray* event_index_for(const CalendarEvent* event, int64_t* key) {
+    if (event->recurrence != EVENT_RECUR_NONE) {
+        return NULL;
+    }
+    
+    switch (event->key) {
+        case EVENT_KEY_LUNAR:
+            *key = lunar_key(event->lunar_year, event->lunar_month, event->lunar_day);
+            return g_lunar_index;
+        case EVENT_KEY_LUNAR_YEARLY:
+            *key = lunar_key(0, event->lunar_month, event->lunar_day);
+            return g_lunar_yearly_index;
+        case EVENT_KEY_GREGORIAN:
+        default:
+            *key = event_day_number(event->year, event->month, event->day);
+            return g_day_index;
+    }
+}
+
+// Rebuild the lookup indexes if the event set changed since the last lookup
+static void event_indexes_update(void) {
+    if (!g_indexes_dirty) {
+        return;
+    }
+    
+    event_indexes_free();
+    g_day_index = g_array_new(FALSE, FALSE, sizeof(EventIndexEntry));
+    g_lunar_index = g_array_new(FALSE, FALSE, sizeof(EventIndexEntry));
+    g_lunar_yearly_index = g_array_new(FALSE, FALSE, sizeof(EventIndexEntry));
+    
+    for (int i = 0; i < g_all_events->count; i++) {
+        EventIndexEntry entry = { 0, g_all_events->events[i] };
+        GArray* index = event_index_for(entry.event, &entry.key);
+        if (index != NULL) {
+            g_array_append_val(index, entry);
+        }
+    }
+    
+    g_array_sort(g_day_index, compare_index_entries);
+    g_array_sort(g_lunar_index, compare_index_entries);
+    g_array_sort(g_lunar_yearly_index, compare_index_entries);
+    g_indexes_dirty = false;
+}
+
+// Insert a new event into a built index, after any events with the same key
+static void event_indexes_insert(CalendarEvent* event) {
+    if (g_indexes_dirty) {
+        return;  // Picked up by the next rebuild
+    }
+    
+    EventIndexEntry entry = { 0, event };
+    GArray* index = event_index_for(event, &entry.key);
+    if (index != NULL) {
+        g_array_insert_val(index, event_index_lower_bound(index, entry.key + 1), entry);
+    }
+}
+
+// Remove an event from a built index
+static void event_indexes_remove(CalendarEvent* event) {
+    if (g_indexes_dirty) {
+        return;
+    }
+    
+    int64_t key;
+    GArray* index = event_index_for(event, &key);
+    if (index == NULL) {
+        return;
+    }
+    
+    for (guint i = event_index_lower_bound(index, key);
+         i < index->len && g_array_index(index, EventIndexEntry, i).key == key; i++) {
+        if (g_array_index(index, EventIndexEntry, i).event == event) {
+            g_array_remove_index(index, i);
+            return;
+        }
+    }
+}
+
+// Track an event's slot in g_all_events
+static void event_slot_set(CalendarEvent* event, int slot) {
+    g_hash_table_insert(g_event_slots, &event->id, GINT_TO_POINTER(slot));
+}
+
+// Give an event an ID: keep a loaded one if it is valid and unused, else assign the next
+static void event_assign_id(CalendarEvent* event) {
+    if (event->id == 0 || g_hash_table_contains(g_event_slots, &event->id)) {
+        event->id = g_next_event_id;
+    }
+    if (event->id >= g_next_event_id) {
+        g_next_event_id = event->id + 1;
+    }
+}
+
+// Raise the next ID to a saved high-water mark, so no ID is handed out twice
+static void event_next_id_restore(uint64_t next_id) {
+    if (next_id > g_next_event_id) {
+        g_next_event_id = next_id;
+    }
+}
+
+// Collect the events on a day into out (if not NULL), in a stable order:
+// Gregorian-keyed, fixed lunar, yearly lunar, then recurring occurrences.
+// Returns the number of events.
+static int events_collect_for_day(int year, int month, int day, GPtrArray* out) {
+    event_indexes_update();
+    
+    int count = 0;
+    int32_t day_number = event_day_number(year, month, day);
+    
+    // Gregorian-keyed events
+    guint i = event_index_lower_bound(g_day_index, day_number);
+    for (; i < g_day_index->len && g_array_index(g_day_index, EventIndexEntry, i).key == day_number; i++) {
+        if (out != NULL) {
+            g_ptr_array_add(out, g_array_index(g_day_index, EventIndexEntry, i).event);
+        }
+        count++;
+    }
+    
+    if (g_lunar_index->len == 0 && g_lunar_yearly_index->len == 0 && g_recurring_count == 0) {
+        return count;
+    }
+    
+    LunarYearEntry* entry = lunar_year_entry_for_day(day_number, year);
+    if (entry == NULL) {
+        return count;
+    }
+    
+    // Lunar-keyed events, looked up by the day's lunar date
+    int lunar_year = entry->bounds.lunar_year;
+    int lunar_month, lunar_day;
+    lunar_year_entry_locate(entry, day_number, &lunar_month, &lunar_day);
+    
+    int64_t key = lunar_key(lunar_year, lunar_month, lunar_day);
+    i = event_index_lower_bound(g_lunar_index, key);
+    for (; i < g_lunar_index->len && g_array_index(g_lunar_index, EventIndexEntry, i).key == key; i++) {
+        if (out != NULL) {
+            g_ptr_array_add(out, g_array_index(g_lunar_index, EventIndexEntry, i).event);
+        }
+        count++;
+    }
+    
+    key = lunar_key(0, lunar_month, lunar_day);
+    i = event_index_lower_bound(g_lunar_yearly_index, key);
+    for (; i < g_lunar_yearly_index->len && g_array_index(g_lunar_yearly_index, EventIndexEntry, i).key == key; i++) {
+        CalendarEvent* event = g_array_index(g_lunar_yearly_index, EventIndexEntry, i).event;
+        if (event->lunar_year <= lunar_year) {
+            if (out != NULL) {
+                g_ptr_array_add(out, event);
+            }
+            count++;
+        }
+    }
+    
+    // Recurring occurrences
+    if (g_recurring_count > 0) {
+        const EventOccurrence* occurrences;
+        int occurrence_count = recurrence_occurrences_on_day(recurrence_year_get(lunar_year),
+                                                             day_number, &occurrences);
+        for (int j = 0; j < occurrence_count; j++) {
+            if (out != NULL) {
+                g_ptr_array_add(out, occurrences[j].event);
+            }
+        }
+        count += occurrence_count;
+    }
+    
+    return count;
+}
+
+// Get the snapshot path for an events file ("events.json" -> "events.bin")
+static char* events_snapshot_path(const char* events_file_path) {
+    if (g_str_has_suffix(events_file_path, ".json")) {
+        size_t base_len = strlen(events_file_path) - strlen(".json");
+        char* base = g_strndup(events_file_path, base_len);
+        char* path = g_strconcat(base, ".bin", NULL);
+        g_free(base);
+        return path;
+    }
+    return g_strconcat(events_file_path, ".bin", NULL);
+}
+
 // Initialize the event system
 bool events_init(const char* events_file_path) {
     // If already initialized, clean up first
@@ -49,78 +602,350 @@ bool events_init(const char* events_file_path) {
     g_all_events->events = NULL;
     g_all_events->count = 0;
     g_all_events->capacity = 0;
+    g_event_slots = g_hash_table_new(g_int64_hash, g_int64_equal);
     
     // Store the events file path
     if (events_file_path != NULL) {
         g_events_file_path = strdup(events_file_path);
         
-        // Try to load events from the file
-        FILE* file = fopen(events_file_path, "r");
-        if (file != NULL) {
-            fclose(file);
-            
-            // Load the events from the file
-            JsonParser* parser = json_parser_new();
-            GError* error = NULL;
+        // Prefer the binary snapshot when it matches the JSON file; without
+        // the JSON file there is nothing to check a snapshot against
+        struct stat json_stat;
+        bool have_json = g_stat(events_file_path, &json_stat) == 0;
+        char* snapshot_path = events_snapshot_path(events_file_path);
+        
+        if (have_json && events_load_snapshot(snapshot_path, &json_stat)) {
+            g_free(snapshot_path);
+            return true;
+        }
+        
+        // Fall back to the JSON file and refresh the snapshot for next time
+        if (have_json && events_load_json(events_file_path)) {
+            events_write_snapshot(snapshot_path, events_file_path);
+        }
+        g_free(snapshot_path);
+    }
+    
+    return true;
+}
+
+// Load events from the JSON interchange file
+static bool events_load_json(const char* events_file_path) {
+    JsonParser* parser = json_parser_new();
+    GError* error = NULL;
+    bool loaded = false;
+    
+    if (json_parser_load_from_file(parser, events_file_path, &error)) {
+        // Version 1 files are a bare array of events; later ones wrap it in
+        // an object with the ID high-water mark
+        JsonNode* root = json_parser_get_root(parser);
+        JsonObject* file = NULL;
+        JsonArray* array = NULL;
+        if (JSON_NODE_HOLDS_ARRAY(root)) {
+            array = json_node_get_array(root);
+        } else if (JSON_NODE_HOLDS_OBJECT(root)) {
+            file = json_node_get_object(root);
+            if (json_object_has_member(file, "events")) {
+                array = json_object_get_array_member(file, "events");
+            }
+        }
+        if (array != NULL) {
+            guint length = json_array_get_length(array);
             
-            if (json_parser_load_from_file(parser, events_file_path, &error)) {
-                JsonNode* root = json_parser_get_root(parser);
-                if (JSON_NODE_HOLDS_ARRAY(root)) {
-                    JsonArray* array = json_node_get_array(root);
-                    guint length = json_array_get_length(array);
-                    
-                    for (guint i = 0; i < length; i++) {
-                        JsonObject* obj = json_array_get_object_element(array, i);
-                        
-                        // Extract event data
-                        int year = json_object_get_int_member(obj, "year");
-                        int month = json_object_get_int_member(obj, "month");
-                        int day = json_object_get_int_member(obj, "day");
-                        const char* title = json_object_get_string_member(obj, "title");
-                        const char* description = "";
-                        if (json_object_has_member(obj, "description")) {
-                            description = json_object_get_string_member(obj, "description");
-                        }
-                        
-                        // Get color if present
-                        GdkRGBA color = {0.8, 0.9, 0.8, 0.3};  // Default color
-                        bool has_custom_color = false;
-                        
-                        if (json_object_has_member(obj, "color")) {
-                            JsonObject* color_obj = json_object_get_object_member(obj, "color");
-                            color.red = json_object_get_double_member(color_obj, "red");
-                            color.green = json_object_get_double_member(color_obj, "green");
-                            color.blue = json_object_get_double_member(color_obj, "blue");
-                            color.alpha = json_object_get_double_member(color_obj, "alpha");
-                            has_custom_color = true;
-                        }
-                        
-                        // Add the event
-                        event_add(year, month, day, title, description, has_custom_color ? &color : NULL);
+            for (guint i = 0; i < length; i++) {
+                JsonObject* obj = json_array_get_object_element(array, i);
+                
+                // Extract event data
+                int year = json_object_get_int_member(obj, "year");
+                int month = json_object_get_int_member(obj, "month");
+                int day = json_object_get_int_member(obj, "day");
+                const char* title = json_object_get_string_member(obj, "title");
+                const char* description = "";
+                if (json_object_has_member(obj, "description")) {
+                    description = json_object_get_string_member(obj, "description");
+                }
+                
+                // Get color if present
+                GdkRGBA color = {0.8, 0.9, 0.8, 0.3};  // Default color
+                bool has_custom_color = false;
+                
+                if (json_object_has_member(obj, "color")) {
+                    JsonObject* color_obj = json_object_get_object_member(obj, "color");
+                    color.red = json_object_get_double_member(color_obj, "red");
+                    color.green = json_object_get_double_member(color_obj, "green");
+                    color.blue = json_object_get_double_member(color_obj, "blue");
+                    color.alpha = json_object_get_double_member(color_obj, "alpha");
+                    has_custom_color = true;
+                }
+                
+                // Get the recurrence rule if present
+                EventRecurrence recurrence = EVENT_RECUR_NONE;
+                int recur_month = 0;
+                if (json_object_has_member(obj, "recurrence")) {
+                    const char* rule = json_object_get_string_member(obj, "recurrence");
+                    if (g_strcmp0(rule, "yearly") == 0) {
+                        recurrence = EVENT_RECUR_YEARLY_GREGORIAN;
+                    } else if (g_strcmp0(rule, "lunar_month_start") == 0) {
+                        recurrence = EVENT_RECUR_LUNAR_MONTH_START;
+                    } else if (g_strcmp0(rule, "winter_solstice") == 0) {
+                        recurrence = EVENT_RECUR_WINTER_SOLSTICE;
                     }
                 }
+                if (json_object_has_member(obj, "recur_month")) {
+                    recur_month = json_object_get_int_member(obj, "recur_month");
+                }
+                
+                // Get the lunar key if present (year/month/day hold its resolved date)
+                CalendarEvent fields = {0};
+                if (json_object_has_member(obj, "calendar")) {
+                    const char* calendar = json_object_get_string_member(obj, "calendar");
+                    if (g_strcmp0(calendar, "lunar") == 0) {
+                        fields.key = EVENT_KEY_LUNAR;
+                    } else if (g_strcmp0(calendar, "lunar_yearly") == 0) {
+                        fields.key = EVENT_KEY_LUNAR_YEARLY;
+                    }
+                }
+                if (fields.key != EVENT_KEY_GREGORIAN) {
+                    fields.lunar_year = json_object_get_int_member(obj, "lunar_year");
+                    fields.lunar_month = json_object_get_int_member(obj, "lunar_month");
+                    fields.lunar_day = json_object_get_int_member(obj, "lunar_day");
+                }
+                
+                // Keep the stored ID so references survive a reload
+                if (json_object_has_member(obj, "id")) {
+                    fields.id = (uint64_t)json_object_get_int_member(obj, "id");
+                }
+                
+                // Add the event
+                fields.year = year;
+                fields.month = month;
+                fields.day = day;
+                fields.recurrence = recurrence;
+                fields.recur_month = recur_month;
+                event_append(&fields, title, description, has_custom_color ? &color : NULL);
             }
-            
-            if (error != NULL) {
-                g_error_free(error);
+            if (file != NULL && json_object_has_member(file, "next_id")) {
+                event_next_id_restore((uint64_t)json_object_get_int_member(file, "next_id"));
             }
-            
-            g_object_unref(parser);
+            loaded = true;
+        }
+    }
+    
+    if (error != NULL) {
+        g_error_free(error);
+    }
+    
+    g_object_unref(parser);
+    return loaded;
+}
+
+// Map the binary snapshot and set up the event list from it without parsing.
+// json_stat is the state of the JSON file; a snapshot written for a different
+// JSON file (size or mtime, to the nanosecond, differ) is ignored.
+static bool events_load_snapshot(const char* snapshot_path, const struct stat* json_stat) {
+    GMappedFile* mapped = g_mapped_file_new(snapshot_path, FALSE, NULL);
+    if (mapped == NULL) {
+        return false;
+    }
+    
+    const char* data = g_mapped_file_get_contents(mapped);
+    gsize length = g_mapped_file_get_length(mapped);
+    const EventSnapshotHeader* header = (const EventSnapshotHeader*)data;
+    
+    // Validate the header and table bounds
+    if (data == NULL || length < sizeof(EventSnapshotHeader) ||
+        memcmp(header->magic, EVENTS_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != EVENTS_SNAPSHOT_VERSION ||
+        header->byte_order != EVENTS_SNAPSHOT_BYTE_ORDER ||
+        header->header_size != sizeof(EventSnapshotHeader) ||
+        header->record_size != sizeof(EventSnapshotRecord) ||
+        header->records_offset % sizeof(double) != 0 ||
+        header->records_offset + (uint64_t)header->record_count * header->record_size > length ||
+        header->strings_offset + header->strings_size > length ||
+        (header->strings_size > 0 && data[header->strings_offset + header->strings_size - 1] != '\0')) {
+        g_mapped_file_unref(mapped);
+        return false;
+    }
+    
+    // The JSON file is authoritative: only use a snapshot written alongside it
+    if (header->source_mtime != (int64_t)json_stat->st_mtim.tv_sec ||
+        header->source_mtime_nsec != (int64_t)json_stat->st_mtim.tv_nsec ||
+        header->source_size != (int64_t)json_stat->st_size) {
+        g_mapped_file_unref(mapped);
+        return false;
+    }
+    
+    int count = (int)header->record_count;
+    const EventSnapshotRecord* records = (const EventSnapshotRecord*)(data + header->records_offset);
+    const char* strings = data + header->strings_offset;
+    
+    // One allocation for the events and one for the pointer table
+    CalendarEvent* slab = count > 0 ? (CalendarEvent*)calloc(count, sizeof(CalendarEvent)) : NULL;
+    CalendarEvent** table = (CalendarEvent**)malloc((count > 0 ? count : 1) * sizeof(CalendarEvent*));
+    if ((count > 0 && slab == NULL) || table == NULL) {
+        free(slab);
+        free(table);
+        g_mapped_file_unref(mapped);
+        return false;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        const EventSnapshotRecord* record = &records[i];
+        if (record->title_offset >= header->strings_size ||
+            record->description_offset >= header->strings_size) {
+            free(slab);
+            free(table);
+            g_mapped_file_unref(mapped);
+            return false;
+        }
+        
+        CalendarEvent* event = &slab[i];
+        event->year = record->year;
+        event->month = record->month;
+        event->day = record->day;
+        event->title = (char*)(strings + record->title_offset);
+        event->description = (char*)(strings + record->description_offset);
+        event->has_custom_color = (record->flags & EVENTS_SNAPSHOT_FLAG_CUSTOM_COLOR) != 0;
+        event->color.red = record->color[0];
+        event->color.green = record->color[1];
+        event->color.blue = record->color[2];
+        event->color.alpha = record->color[3];
+        event->recurrence = (EventRecurrence)record->recurrence;
+        event->recur_month = record->recur_month;
+        event->key = (EventKey)record->key;
+        event->lunar_year = record->lunar_year;
+        event->lunar_month = record->lunar_month;
+        event->lunar_day = record->lunar_day;
+        event->id = record->id;
+        table[i] = event;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        event_assign_id(table[i]);
+        event_slot_set(table[i], i);
+        if (table[i]->recurrence != EVENT_RECUR_NONE) {
+            g_recurring_count++;
         }
     }
+    event_next_id_restore(header->next_event_id);
+    
+    free(g_all_events->events);
+    g_all_events->events = table;
+    g_all_events->count = count;
+    g_all_events->capacity = count > 0 ? count : 1;
+    
+    g_snapshot_file = mapped;
+    g_snapshot_strings = strings;
+    g_snapshot_strings_size = header->strings_size;
+    g_snapshot_slab = slab;
+    g_snapshot_slab_count = count;
     
     return true;
 }
 
+// Append a NUL-terminated string to the snapshot blob, returning its offset
+static uint32_t snapshot_append_string(GByteArray* blob, const char* str) {
+    uint32_t offset = blob->len;
+    const char* value = str != NULL ? str : "";
+    g_byte_array_append(blob, (const guint8*)value, strlen(value) + 1);
+    return offset;
+}
+
+// Compare events by day number for the snapshot record table
+static int compare_events_by_day_number(const void* a, const void* b) {
+    int32_t day_a = event_day_number((*(CalendarEvent**)a)->year, (*(CalendarEvent**)a)->month,
+                                     (*(CalendarEvent**)a)->day);
+    int32_t day_b = event_day_number((*(CalendarEvent**)b)->year, (*(CalendarEvent**)b)->month,
+                                     (*(CalendarEvent**)b)->day);
+    return (day_a > day_b) - (day_a < day_b);
+}
+
+// Write the binary snapshot for the current events. json_path is the JSON file
+// that was just read or written; its size and mtime tie the two together.
+static bool events_write_snapshot(const char* snapshot_path, const char* json_path) {
+    struct stat json_stat;
+    if (g_all_events == NULL || g_stat(json_path, &json_stat) != 0) {
+        return false;
+    }
+    
+    int count = g_all_events->count;
+    
+    // Sort a copy of the pointer table by day number. g_array_sort is stable,
+    // so events on the same day keep their insertion order.
+    GArray* order = g_array_sized_new(FALSE, FALSE, sizeof(CalendarEvent*), count);
+    g_array_append_vals(order, g_all_events->events, count);
+    g_array_sort(order, compare_events_by_day_number);
+    CalendarEvent** sorted = (CalendarEvent**)order->data;
+    
+    GByteArray* strings = g_byte_array_new();
+    EventSnapshotRecord* records = g_new0(EventSnapshotRecord, count > 0 ? count : 1);
+    
+    for (int i = 0; i < count; i++) {
+        CalendarEvent* event = sorted[i];
+        EventSnapshotRecord* record = &records[i];
+        record->day_number = event_day_number(event->year, event->month, event->day);
+        record->year = event->year;
+        record->month = event->month;
+        record->day = event->day;
+        record->flags = event->has_custom_color ? EVENTS_SNAPSHOT_FLAG_CUSTOM_COLOR : 0;
+        record->title_offset = snapshot_append_string(strings, event->title);
+        record->description_offset = snapshot_append_string(strings, event->description);
+        record->recurrence = event->recurrence;
+        record->recur_month = event->recur_month;
+        record->key = event->key;
+        record->lunar_year = event->lunar_year;
+        record->lunar_month = event->lunar_month;
+        record->lunar_day = event->lunar_day;
+        record->id = event->id;
+        record->color[0] = event->color.red;
+        record->color[1] = event->color.green;
+        record->color[2] = event->color.blue;
+        record->color[3] = event->color.alpha;
+    }
+    
+    EventSnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, EVENTS_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = EVENTS_SNAPSHOT_VERSION;
+    header.byte_order = EVENTS_SNAPSHOT_BYTE_ORDER;
+    header.header_size = sizeof(EventSnapshotHeader);
+    header.record_size = sizeof(EventSnapshotRecord);
+    header.record_count = count;
+    header.records_offset = sizeof(EventSnapshotHeader);
+    header.strings_offset = header.records_offset + (uint64_t)count * sizeof(EventSnapshotRecord);
+    header.strings_size = strings->len;
+    header.source_mtime = (int64_t)json_stat.st_mtim.tv_sec;
+    header.source_mtime_nsec = (int64_t)json_stat.st_mtim.tv_nsec;
+    header.source_size = (int64_t)json_stat.st_size;
+    header.next_event_id = g_next_event_id;
+    
+    GByteArray* file = g_byte_array_sized_new(header.strings_offset + strings->len);
+    g_byte_array_append(file, (const guint8*)&header, sizeof(header));
+    g_byte_array_append(file, (const guint8*)records, count * sizeof(EventSnapshotRecord));
+    g_byte_array_append(file, strings->data, strings->len);
+    
+    // g_file_set_contents writes a temporary file and renames it, so an
+    // existing mapping of the old snapshot stays valid
+    GError* error = NULL;
+    bool success = g_file_set_contents(snapshot_path, (const char*)file->data, file->len, &error);
+    if (error != NULL) {
+        g_error_free(error);
+    }
+    
+    g_byte_array_free(file, TRUE);
+    g_byte_array_free(strings, TRUE);
+    g_free(records);
+    g_array_free(order, TRUE);
+    
+    return success;
+}
+
 // Clean up the event system
 void events_cleanup(void) {
     if (g_all_events != NULL) {
         // Free all events
         for (int i = 0; i < g_all_events->count; i++) {
-            CalendarEvent* event = g_all_events->events[i];
-            free(event->title);
-            free(event->description);
-            free(event);
+            event_free(g_all_events->events[i]);
         }
         
         // Free the events array
@@ -129,6 +954,31 @@ void events_cleanup(void) {
         g_all_events = NULL;
     }
     
+    // Drop the ID map, the lookup and search indexes and cached lunar years
+    if (g_event_slots != NULL) {
+        g_hash_table_destroy(g_event_slots);
+        g_event_slots = NULL;
+    }
+    g_next_event_id = 1;
+    event_indexes_free();
+    event_search_index_reset();
+    if (g_lunar_years != NULL) {
+        g_hash_table_destroy(g_lunar_years);
+        g_lunar_years = NULL;
+    }
+    g_recurring_count = 0;
+    
+    // Release the snapshot mapping
+    free(g_snapshot_slab);
+    g_snapshot_slab = NULL;
+    g_snapshot_slab_count = 0;
+    g_snapshot_strings = NULL;
+    g_snapshot_strings_size = 0;
+    if (g_snapshot_file != NULL) {
+        g_mapped_file_unref(g_snapshot_file);
+        g_snapshot_file = NULL;
+    }
+    
     // Free the events file path
     if (g_events_file_path != NULL) {
         free(g_events_file_path);
@@ -138,6 +988,13 @@ void events_cleanup(void) {
 
 // Add a new event
 bool event_add(int year, int month, int day, const char* title, const char* description, GdkRGBA* color) {
+    return event_add_recurring(year, month, day, EVENT_RECUR_NONE, 0, title, description, color);
+}
+
+// Append an event to the store. The template supplies the date, key and
+// recurrence fields; strings are copied.
+static bool event_append(const CalendarEvent* fields, const char* title, const char* description,
+                         GdkRGBA* color) {
     if (g_all_events == NULL) {
         return false;
     }
@@ -149,9 +1006,7 @@ bool event_add(int year, int month, int day, const char* title, const char* desc
     }
     
     // Fill in the event data
-    event->year = year;
-    event->month = month;
-    event->day = day;
+    *event = *fields;
     event->title = strdup(title);
     event->description = description != NULL ? strdup(description) : strdup("");
     event->has_custom_color = color != NULL;
@@ -183,69 +1038,110 @@ bool event_add(int year, int month, int day, const char* title, const char* desc
     }
     
     // Add the event to the list
+    event_assign_id(event);
+    event_slot_set(event, g_all_events->count);
     g_all_events->events[g_all_events->count++] = event;
+    event_indexes_insert(event);
+    event_search_index_add(event);
+    
+    if (event->recurrence != EVENT_RECUR_NONE) {
+        g_recurring_count++;
+        recurrence_invalidate();
+    }
     
     return true;
 }
 
-// Delete an event
-bool event_delete(int year, int month, int day, int event_index) {
-    if (g_all_events == NULL) {
+// Add a new event with a recurrence rule
+bool event_add_recurring(int year, int month, int day, EventRecurrence recurrence, int recur_month,
+                         const char* title, const char* description, GdkRGBA* color) {
+    CalendarEvent fields = {0};
+    fields.year = year;
+    fields.month = month;
+    fields.day = day;
+    fields.recurrence = recurrence;
+    fields.recur_month = recur_month;
+    fields.key = EVENT_KEY_GREGORIAN;
+    
+    return event_append(&fields, title, description, color);
+}
+
+// Add a new event keyed by a lunar date
+bool event_add_lunar(int lunar_year, int lunar_month, int lunar_day, bool yearly,
+                     const char* title, const char* description, GdkRGBA* color) {
+    // Resolve the (first) occurrence through the cached month boundaries
+    LunarYearEntry* entry = lunar_year_entry_get(lunar_year);
+    if (entry == NULL) {
+        return false;
+    }
+    int32_t day_number = lunar_year_entry_resolve(entry, lunar_month, lunar_day);
+    if (day_number < 0) {
         return false;
     }
     
-    // Find the event in the global list
-    int global_index = -1;
-    int date_index = 0;
+    CalendarEvent fields = {0};
+    event_day_to_gregorian(day_number, &fields.year, &fields.month, &fields.day);
+    fields.recurrence = EVENT_RECUR_NONE;
+    fields.key = yearly ? EVENT_KEY_LUNAR_YEARLY : EVENT_KEY_LUNAR;
+    fields.lunar_year = lunar_year;
+    fields.lunar_month = lunar_month;
+    fields.lunar_day = lunar_day;
     
-    for (int i = 0; i < g_all_events->count; i++) {
-        CalendarEvent* event = g_all_events->events[i];
-        
-        if (event->year == year && event->month == month && event->day == day) {
-            if (date_index == event_index) {
-                global_index = i;
-                break;
-            }
-            date_index++;
-        }
+    return event_append(&fields, title, description, color);
+}
+
+// Get an event by ID
+CalendarEvent* event_get_by_id(uint64_t event_id) {
+    gpointer slot;
+    if (g_event_slots == NULL || !g_hash_table_lookup_extended(g_event_slots, &event_id, NULL, &slot)) {
+        return NULL;
     }
-    
-    if (global_index == -1) {
+    return g_all_events->events[GPOINTER_TO_INT(slot)];
+}
+
+// Delete an event
+bool event_delete(uint64_t event_id) {
+    gpointer slot_ptr;
+    if (g_event_slots == NULL || !g_hash_table_lookup_extended(g_event_slots, &event_id, NULL, &slot_ptr)) {
         return false;
     }
     
-    // Free the event
-    CalendarEvent* event = g_all_events->events[global_index];
-    free(event->title);
-    free(event->description);
-    free(event);
+    int slot = GPOINTER_TO_INT(slot_ptr);
+    CalendarEvent* target = g_all_events->events[slot];
+    bool recurring = target->recurrence != EVENT_RECUR_NONE;
+    
+    // Unlink the event before freeing it (the map key lives in the event)
+    g_hash_table_remove(g_event_slots, &event_id);
+    event_indexes_remove(target);
+    event_search_index_remove(target);
+    event_free(target);
     
-    // Remove the event from the list by shifting remaining events
-    for (int i = global_index; i < g_all_events->count - 1; i++) {
-        g_all_events->events[i] = g_all_events->events[i + 1];
+    // Move the last event into the freed slot
+    int last = g_all_events->count - 1;
+    if (slot != last) {
+        g_all_events->events[slot] = g_all_events->events[last];
+        event_slot_set(g_all_events->events[slot], slot);
     }
     
     // Decrease the count
     g_all_events->count--;
     
+    // Expansions hold pointers to recurring events, so drop them
+    if (recurring) {
+        g_recurring_count--;
+        recurrence_invalidate();
+    }
+    
     return true;
 }
 
 // Update an event
-bool event_update(int year, int month, int day, int event_index, 
-                 const char* title, const char* description, GdkRGBA* color) {
-    // Get the events for this date
-    EventList* events = event_get_for_date(year, month, day);
-    if (events == NULL || event_index >= events->count) {
-        if (events != NULL) {
-            event_list_free(events);
-        }
+bool event_update(uint64_t event_id, const char* title, const char* description, GdkRGBA* color) {
+    CalendarEvent* event = event_get_by_id(event_id);
+    if (event == NULL) {
         return false;
     }
     
-    // Get the event to update
-    CalendarEvent* event = events->events[event_index];
-    
     // Update the event
     char* new_title = strdup(title);
     char* new_description = description != NULL ? strdup(description) : strdup("");
@@ -253,26 +1149,23 @@ bool event_update(int year, int month, int day, int event_index,
     if (new_title == NULL || new_description == NULL) {
         free(new_title);
         free(new_description);
-        event_list_free(events);
         return false;
     }
     
     // Free the old strings
-    free(event->title);
-    free(event->description);
+    event_search_index_remove(event);
+    event_free_strings(event);
     
     // Update the event
     event->title = new_title;
     event->description = new_description;
+    event_search_index_add(event);
     
     if (color != NULL) {
         event->color = *color;
         event->has_custom_color = true;
     }
     
-    // Free the event list (but not the events themselves)
-    event_list_free(events);
-    
     return true;
 }
 
@@ -282,44 +1175,68 @@ EventList* event_get_for_date(int year, int month, int day) {
         return NULL;
     }
     
-    // Count events for this date
-    int count = 0;
-    for (int i = 0; i < g_all_events->count; i++) {
-        CalendarEvent* event = g_all_events->events[i];
-        if (event->year == year && event->month == month && event->day == day) {
-            count++;
-        }
-    }
+    GPtrArray* found = g_ptr_array_new();
+    int count = events_collect_for_day(year, month, day, found);
     
     if (count == 0) {
+        g_ptr_array_free(found, TRUE);
         return NULL;
     }
     
     // Create a new event list
     EventList* list = (EventList*)malloc(sizeof(EventList));
     if (list == NULL) {
+        g_ptr_array_free(found, TRUE);
         return NULL;
     }
     
     list->events = (CalendarEvent**)malloc(count * sizeof(CalendarEvent*));
     if (list->events == NULL) {
         free(list);
+        g_ptr_array_free(found, TRUE);
         return NULL;
     }
     
     list->count = count;
     list->capacity = count;
+    memcpy(list->events, found->pdata, count * sizeof(CalendarEvent*));
     
-    // Fill in the list
-    int index = 0;
-    for (int i = 0; i < g_all_events->count; i++) {
-        CalendarEvent* event = g_all_events->events[i];
-        if (event->year == year && event->month == month && event->day == day) {
-            list->events[index++] = event;
-        }
+    g_ptr_array_free(found, TRUE);
+    return list;
+}
+
+// Get events for a lunar date
+EventList* event_get_for_lunar_date(int lunar_year, int lunar_month, int lunar_day) {
+    if (g_all_events == NULL) {
+        return NULL;
     }
     
-    return list;
+    LunarYearEntry* entry = lunar_year_entry_get(lunar_year);
+    if (entry == NULL) {
+        return NULL;
+    }
+    int32_t day_number = lunar_year_entry_resolve(entry, lunar_month, lunar_day);
+    if (day_number < 0) {
+        return NULL;
+    }
+    
+    int year, month, day;
+    event_day_to_gregorian(day_number, &year, &month, &day);
+    return event_get_for_date(year, month, day);
+}
+
+// Convert a Gregorian date to its lunar date using the cached month boundaries
+bool events_gregorian_to_lunar(int year, int month, int day,
+                               int* lunar_year, int* lunar_month, int* lunar_day) {
+    int32_t day_number = event_day_number(year, month, day);
+    LunarYearEntry* entry = lunar_year_entry_for_day(day_number, year);
+    if (entry == NULL) {
+        return false;
+    }
+    
+    *lunar_year = entry->bounds.lunar_year;
+    lunar_year_entry_locate(entry, day_number, lunar_month, lunar_day);
+    return true;
 }
 
 // Check if a date has events
@@ -328,14 +1245,7 @@ bool event_date_has_events(int year, int month, int day) {
         return false;
     }
     
-    for (int i = 0; i < g_all_events->count; i++) {
-        CalendarEvent* event = g_all_events->events[i];
-        if (event->year == year && event->month == month && event->day == day) {
-            return true;
-        }
-    }
-    
-    return false;
+    return events_collect_for_day(year, month, day, NULL) > 0;
 }
 
 // Get color for date (if it has a custom color event)
@@ -344,16 +1254,154 @@ bool event_get_date_color(int year, int month, int day, GdkRGBA* color) {
         return false;
     }
     
+    GPtrArray* found = g_ptr_array_new();
+    events_collect_for_day(year, month, day, found);
+    
     // Look for the first event with a custom color
-    for (int i = 0; i < g_all_events->count; i++) {
-        CalendarEvent* event = g_all_events->events[i];
-        if (event->year == year && event->month == month && event->day == day && event->has_custom_color) {
+    bool has_color = false;
+    for (guint i = 0; i < found->len; i++) {
+        CalendarEvent* event = g_ptr_array_index(found, i);
+        if (event->has_custom_color) {
             *color = event->color;
-            return true;
+            has_color = true;
+            break;
+        }
+    }
+    
+    g_ptr_array_free(found, TRUE);
+    return has_color;
+}
+
+// Visit every stored event
+void event_foreach(EventFunc func, void* user_data) {
+    if (g_all_events == NULL || func == NULL) {
+        return;
+    }
+    
+    for (int i = 0; i < g_all_events->count; i++) {
+        func(g_all_events->events[i], user_data);
+    }
+}
+
+// Visit every event occurrence between two Gregorian dates (inclusive)
+void event_foreach_in_range(int start_year, int start_month, int start_day,
+                            int end_year, int end_month, int end_day,
+                            EventOccurrenceFunc func, void* user_data) {
+    if (g_all_events == NULL || func == NULL) {
+        return;
+    }
+    
+    int32_t first = event_day_number(start_year, start_month, start_day);
+    int32_t last = event_day_number(end_year, end_month, end_day);
+    if (last < first) {
+        return;
+    }
+    
+    event_indexes_update();
+    
+    // Gregorian-keyed one-off events
+    for (guint i = event_index_lower_bound(g_day_index, first); i < g_day_index->len; i++) {
+        const EventIndexEntry* item = &g_array_index(g_day_index, EventIndexEntry, i);
+        if (item->key > last) {
+            break;
         }
+        func(item->event, item->event->year, item->event->month, item->event->day, user_data);
+    }
+    
+    if (g_lunar_index->len == 0 && g_lunar_yearly_index->len == 0 && g_recurring_count == 0) {
+        return;
     }
     
-    return false;
+    // Lunar-keyed and recurring events, one lunar year at a time
+    LunarYearEntry* entry = lunar_year_entry_for_day(first, start_year);
+    while (entry != NULL && entry->month_start_day[0] <= last) {
+        int lunar_year = entry->bounds.lunar_year;
+        int year, month, day;
+        
+        // Fixed lunar dates in this year
+        guint i = event_index_lower_bound(g_lunar_index, lunar_key(lunar_year, 0, 0));
+        for (; i < g_lunar_index->len; i++) {
+            CalendarEvent* event = g_array_index(g_lunar_index, EventIndexEntry, i).event;
+            if (event->lunar_year != lunar_year) {
+                break;
+            }
+            int32_t day_number = lunar_year_entry_resolve(entry, event->lunar_month, event->lunar_day);
+            if (day_number >= first && day_number <= last) {
+                event_day_to_gregorian(day_number, &year, &month, &day);
+                func(event, year, month, day, user_data);
+            }
+        }
+        
+        // Yearly lunar dates: walk only the index slice of the days each
+        // month has inside the range
+        for (int m = 1; m <= entry->bounds.months_count && g_lunar_yearly_index->len > 0; m++) {
+            int32_t month_first = entry->month_start_day[m - 1];
+            int32_t lo = MAX(month_first, first);
+            int32_t hi = MIN(entry->month_start_day[m] - 1, last);
+            if (lo > hi) {
+                continue;
+            }
+            int64_t last_key = lunar_key(0, m, hi - month_first + 1);
+            i = event_index_lower_bound(g_lunar_yearly_index, lunar_key(0, m, lo - month_first + 1));
+            for (; i < g_lunar_yearly_index->len; i++) {
+                const EventIndexEntry* item = &g_array_index(g_lunar_yearly_index, EventIndexEntry, i);
+                if (item->key > last_key) {
+                    break;
+                }
+                if (item->event->lunar_year > lunar_year) {
+                    continue;
+                }
+                int32_t day_number = lunar_year_entry_resolve(entry, item->event->lunar_month, item->event->lunar_day);
+                if (day_number >= lo && day_number <= hi) {
+                    event_day_to_gregorian(day_number, &year, &month, &day);
+                    func(item->event, year, month, day, user_data);
+                }
+            }
+        }
+        
+        // Recurring occurrences
+        if (g_recurring_count > 0) {
+            if (entry->occurrences == NULL) {
+                recurrence_year_expand(entry);
+            }
+            const EventOccurrence* items = (const EventOccurrence*)entry->occurrences->data;
+            for (i = 0; i < entry->occurrences->len; i++) {
+                if (items[i].day_number < first) {
+                    continue;
+                }
+                if (items[i].day_number > last) {
+                    break;
+                }
+                event_day_to_gregorian(items[i].day_number, &year, &month, &day);
+                func(items[i].event, year, month, day, user_data);
+            }
+        }
+        
+        entry = lunar_year_entry_get(lunar_year + 1);
+    }
+}
+
+// Describe an event's recurrence rule for display
+const char* event_recurrence_describe(const CalendarEvent* event) {
+    if (event == NULL) {
+        return NULL;
+    }
+    
+    if (event->key == EVENT_KEY_LUNAR_YEARLY) {
+        return "Repeats yearly on this lunar date";
+    }
+    
+    switch (event->recurrence) {
+        case EVENT_RECUR_YEARLY_GREGORIAN:
+            return "Repeats yearly on this date";
+        case EVENT_RECUR_LUNAR_MONTH_START:
+            return "Repeats at the full moon starting its lunar month";
+        case EVENT_RECUR_WINTER_SOLSTICE:
+            return "Repeats every winter solstice";
+        case EVENT_RECUR_NONE:
+        default:
+            return NULL;
+    }
 }
 
 // Free event list (but not the events themselves)
@@ -376,8 +1424,15 @@ bool events_save(const char* filename) {
         return false;
     }
     
-    // Create a JSON array
+    // The root object carries the ID high-water mark next to the events, so
+    // IDs of deleted events are not handed out again after a reload
     JsonBuilder* builder = json_builder_new();
+    json_builder_begin_object(builder);
+    json_builder_set_member_name(builder, "version");
+    json_builder_add_int_value(builder, EVENTS_FILE_VERSION);
+    json_builder_set_member_name(builder, "next_id");
+    json_builder_add_int_value(builder, (gint64)g_next_event_id);
+    json_builder_set_member_name(builder, "events");
     json_builder_begin_array(builder);
     
     // Add each event to the array
@@ -388,6 +1443,9 @@ bool events_save(const char* filename) {
         json_builder_begin_object(builder);
         
         // Add event properties
+        json_builder_set_member_name(builder, "id");
+        json_builder_add_int_value(builder, (gint64)event->id);
+        
         json_builder_set_member_name(builder, "year");
         json_builder_add_int_value(builder, event->year);
         
@@ -405,6 +1463,33 @@ bool events_save(const char* filename) {
             json_builder_add_string_value(builder, event->description);
         }
         
+        if (event->recurrence != EVENT_RECUR_NONE) {
+            const char* rule = event->recurrence == EVENT_RECUR_YEARLY_GREGORIAN ? "yearly" :
+                               event->recurrence == EVENT_RECUR_LUNAR_MONTH_START ? "lunar_month_start" :
+                               "winter_solstice";
+            json_builder_set_member_name(builder, "recurrence");
+            json_builder_add_string_value(builder, rule);
+            
+            if (event->recurrence == EVENT_RECUR_LUNAR_MONTH_START) {
+                json_builder_set_member_name(builder, "recur_month");
+                json_builder_add_int_value(builder, event->recur_month);
+            }
+        }
+        
+        if (event->key != EVENT_KEY_GREGORIAN) {
+            json_builder_set_member_name(builder, "calendar");
+            json_builder_add_string_value(builder, event->key == EVENT_KEY_LUNAR ? "lunar" : "lunar_yearly");
+            
+            json_builder_set_member_name(builder, "lunar_year");
+            json_builder_add_int_value(builder, event->lunar_year);
+            
+            json_builder_set_member_name(builder, "lunar_month");
+            json_builder_add_int_value(builder, event->lunar_month);
+            
+            json_builder_set_member_name(builder, "lunar_day");
+            json_builder_add_int_value(builder, event->lunar_day);
+        }
+        
         if (event->has_custom_color) {
             json_builder_set_member_name(builder, "color");
             json_builder_begin_object(builder);
@@ -428,8 +1513,9 @@ bool events_save(const char* filename) {
         json_builder_end_object(builder);
     }
     
-    // End the array
+    // End the array and the root object
     json_builder_end_array(builder);
+    json_builder_end_object(builder);
     
     // Get the root node
     JsonNode* root = json_builder_get_root(builder);
@@ -447,6 +1533,13 @@ bool events_save(const char* filename) {
         g_error_free(error);
     }
     
+    // Refresh the binary snapshot so the next start can map it directly
+    if (success) {
+        char* snapshot_path = events_snapshot_path(file_path);
+        events_write_snapshot(snapshot_path, file_path);
+        g_free(snapshot_path);
+    }
+    
     // Clean up
     json_node_free(root);
     g_object_unref(generator);
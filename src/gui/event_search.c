@@ -0,0 +1,271 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gtk/gtk.h>
+#include "../../include/gui/event_search.h"
+#include "../../include/gui/calendar_events.h"
+
+// Posting list for one token
+typedef struct {
+    char* token;
+    GArray* ids;        // Event IDs (uint64_t), each at most once
+} SearchPosting;
+
+// Inverted index. The vocabulary is kept sorted so a prefix maps to one
+// contiguous run of tokens.
+static GHashTable* g_postings = NULL;     // token -> SearchPosting*
+static GPtrArray* g_vocabulary = NULL;    // SearchPosting* sorted by token
+static bool g_index_built = false;
+
+// Callback for each token in a piece of text
+typedef void (*TokenFunc)(const char* token, void* user_data);
+
+// Split text into lowercased alphanumeric tokens
+static void search_tokenize(const char* text, TokenFunc func, void* user_data) {
+    if (text == NULL || !g_utf8_validate(text, -1, NULL)) {
+        return;
+    }
+    
+    GString* token = g_string_new(NULL);
+    for (const char* p = text; ; p = g_utf8_next_char(p)) {
+        gunichar c = g_utf8_get_char(p);
+        if (c != 0 && g_unichar_isalnum(c)) {
+            g_string_append_unichar(token, g_unichar_tolower(c));
+            continue;
+        }
+        
+        if (token->len > 0) {
+            func(token->str, user_data);
+            g_string_truncate(token, 0);
+        }
+        if (c == 0) {
+            break;
+        }
+    }
+    g_string_free(token, TRUE);
+}
+
+// Free a posting list
+static void search_posting_free(gpointer data) {
+    SearchPosting* posting = (SearchPosting*)data;
+    g_array_free(posting->ids, TRUE);
+    g_free(posting->token);
+    g_free(posting);
+}
+
+// Find the first vocabulary slot whose token is not less than key
+static guint search_vocabulary_lower_bound(const char* key) {
+    guint low = 0;
+    guint high = g_vocabulary->len;
+    while (low < high) {
+        guint mid = low + (high - low) / 2;
+        SearchPosting* posting = g_ptr_array_index(g_vocabulary, mid);
+        if (strcmp(posting->token, key) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Add one token occurrence for an event
+static void search_add_token(const char* token, void* user_data) {
+    uint64_t id = ((CalendarEvent*)user_data)->id;
+    SearchPosting* posting = g_hash_table_lookup(g_postings, token);
+    
+    if (posting == NULL) {
+        posting = g_new0(SearchPosting, 1);
+        posting->token = g_strdup(token);
+        posting->ids = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+        g_hash_table_insert(g_postings, posting->token, posting);
+        g_ptr_array_insert(g_vocabulary, search_vocabulary_lower_bound(token), posting);
+    }
+    
+    // Tokens of one event are added together, so a repeat shows up at the end
+    if (posting->ids->len > 0 && g_array_index(posting->ids, uint64_t, posting->ids->len - 1) == id) {
+        return;
+    }
+    g_array_append_val(posting->ids, id);
+}
+
+// Remove an event from one token's posting list
+static void search_remove_token(const char* token, void* user_data) {
+    uint64_t id = ((CalendarEvent*)user_data)->id;
+    SearchPosting* posting = g_hash_table_lookup(g_postings, token);
+    if (posting == NULL) {
+        return;
+    }
+    
+    // A repeated token was already handled on its first occurrence
+    guint i = 0;
+    while (i < posting->ids->len && g_array_index(posting->ids, uint64_t, i) != id) {
+        i++;
+    }
+    if (i == posting->ids->len) {
+        return;
+    }
+    g_array_remove_index_fast(posting->ids, i);
+    
+    if (posting->ids->len == 0) {
+        g_ptr_array_remove_index(g_vocabulary, search_vocabulary_lower_bound(token));
+        g_hash_table_remove(g_postings, token);
+    }
+}
+
+// Index one event (event_foreach callback)
+static void search_index_event(CalendarEvent* event, void* user_data) {
+    event_search_index_add(event);
+}
+
+// Build the index over all events
+static void search_index_build(void) {
+    g_postings = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, search_posting_free);
+    g_vocabulary = g_ptr_array_new();
+    g_index_built = true;
+    
+    event_foreach(search_index_event, NULL);
+}
+
+void event_search_index_add(CalendarEvent* event) {
+    if (!g_index_built || event == NULL) {
+        return;
+    }
+    search_tokenize(event->title, search_add_token, event);
+    search_tokenize(event->description, search_add_token, event);
+}
+
+void event_search_index_remove(CalendarEvent* event) {
+    if (!g_index_built || event == NULL) {
+        return;
+    }
+    search_tokenize(event->title, search_remove_token, event);
+    search_tokenize(event->description, search_remove_token, event);
+}
+
+void event_search_index_reset(void) {
+    if (g_vocabulary != NULL) {
+        g_ptr_array_free(g_vocabulary, TRUE);
+        g_vocabulary = NULL;
+    }
+    if (g_postings != NULL) {
+        g_hash_table_destroy(g_postings);
+        g_postings = NULL;
+    }
+    g_index_built = false;
+}
+
+// State for evaluating a query
+typedef struct {
+    GHashTable* matches;  // IDs matching all words so far (NULL before the first word)
+    bool empty;           // Some word matched nothing
+} SearchQuery;
+
+// Narrow the matches to events having a token that starts with the word
+static void search_match_word(const char* word, void* user_data) {
+    SearchQuery* query = (SearchQuery*)user_data;
+    if (query->empty) {
+        return;
+    }
+    
+    // Keys point into the posting lists, which do not change during a query
+    GHashTable* word_matches = g_hash_table_new(g_int64_hash, g_int64_equal);
+    size_t word_len = strlen(word);
+    
+    for (guint i = search_vocabulary_lower_bound(word); i < g_vocabulary->len; i++) {
+        SearchPosting* posting = g_ptr_array_index(g_vocabulary, i);
+        if (strncmp(posting->token, word, word_len) != 0) {
+            break;
+        }
+        
+        for (guint j = 0; j < posting->ids->len; j++) {
+            uint64_t* id = &g_array_index(posting->ids, uint64_t, j);
+            if (query->matches == NULL || g_hash_table_contains(query->matches, id)) {
+                g_hash_table_add(word_matches, id);
+            }
+        }
+    }
+    
+    if (query->matches != NULL) {
+        g_hash_table_destroy(query->matches);
+    }
+    query->matches = word_matches;
+    query->empty = g_hash_table_size(word_matches) == 0;
+}
+
+// Order results by date
+static gint compare_results_by_date(gconstpointer a, gconstpointer b) {
+    const CalendarEvent* event_a = *(CalendarEvent* const*)a;
+    const CalendarEvent* event_b = *(CalendarEvent* const*)b;
+    
+    if (event_a->year != event_b->year) {
+        return event_a->year - event_b->year;
+    }
+    if (event_a->month != event_b->month) {
+        return event_a->month - event_b->month;
+    }
+    return event_a->day - event_b->day;
+}
+
+EventList* event_search(const char* query, int max_results) {
+    if (query == NULL) {
+        return NULL;
+    }
+    
+    if (!g_index_built) {
+        search_index_build();
+    }
+    
+    SearchQuery state = { NULL, false };
+    search_tokenize(query, search_match_word, &state);
+    if (state.matches == NULL) {
+        return NULL;  // No words in the query
+    }
+    
+    guint count = g_hash_table_size(state.matches);
+    if (count == 0) {
+        g_hash_table_destroy(state.matches);
+        return NULL;
+    }
+    
+    // Collect and sort the hits
+    GPtrArray* hits = g_ptr_array_sized_new(count);
+    GHashTableIter iter;
+    gpointer key;
+    g_hash_table_iter_init(&iter, state.matches);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+        CalendarEvent* event = event_get_by_id(*(uint64_t*)key);
+        if (event != NULL) {
+            g_ptr_array_add(hits, event);
+        }
+    }
+    g_hash_table_destroy(state.matches);
+    g_ptr_array_sort(hits, compare_results_by_date);
+    
+    count = hits->len;
+    if (count == 0) {
+        g_ptr_array_free(hits, TRUE);
+        return NULL;
+    }
+    if (max_results > 0 && count > (guint)max_results) {
+        count = (guint)max_results;
+    }
+    
+    EventList* list = (EventList*)malloc(sizeof(EventList));
+    if (list == NULL) {
+        g_ptr_array_free(hits, TRUE);
+        return NULL;
+    }
+    list->events = (CalendarEvent**)malloc(count * sizeof(CalendarEvent*));
+    if (list->events == NULL) {
+        free(list);
+        g_ptr_array_free(hits, TRUE);
+        return NULL;
+    }
+    memcpy(list->events, hits->pdata, count * sizeof(CalendarEvent*));
+    list->count = (int)count;
+    list->capacity = (int)count;
+    
+    g_ptr_array_free(hits, TRUE);
+    return list;
+}
@@ -1,16 +1,24 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <inttypes.h>
 #include <gtk/gtk.h>
+#include <glib/gstdio.h>
 #include <math.h>
 #include <time.h>
 #include "../../include/gui/gui_app.h"
 #include "../../include/gui/config.h"
 #include "../../include/gui/calendar_adapter.h"
 #include "../../include/gui/calendar_events.h"
+#include "../../include/gui/event_search.h"
 #include "../../include/gui/settings_dialog.h"
 #include "../../include/lunar_calendar.h"
 #include "../../include/lunar_renderer.h"
+#include "../../include/lunar_ics.h"
+#include "../../include/lunar_stats.h"
+#include "../../include/lunar_logger.h"
+#include "../../include/lunar_trace.h"
 
 // Data structure for day click event
 typedef struct {
@@ -39,14 +47,27 @@ static void activate(GtkApplication* app, gpointer user_data);
 static void build_ui(LunarCalendarApp* app);
 static void on_window_destroy(GtkWidget* widget, gpointer data);
 static void update_calendar_view(LunarCalendarApp* app);
+static void rebuild_calendar_grid(LunarCalendarApp* app);
+static void update_stats_overlay(LunarCalendarApp* app);
 static void on_month_changed(GtkWidget* widget, gpointer data);
 static void on_year_changed(GtkWidget* widget, gpointer data);
 static void on_prev_month(GtkWidget* widget, gpointer data);
 static void on_next_month(GtkWidget* widget, gpointer data);
 static void update_header(LunarCalendarApp* app);
 static void update_sidebar(LunarCalendarApp* app);
+static void rebuild_sidebar(LunarCalendarApp* app);
 static void update_ui(LunarCalendarApp* app);
 static void update_month_label(LunarCalendarApp* app);
+static void refresh_month_label(LunarCalendarApp* app);
+static void load_css(GtkCssProvider* provider, const char* css);
+static void trace_frame_phases(LunarCalendarApp* app);
+static void write_trace(LunarCalendarApp* app);
+static gboolean navigate_step(gpointer user_data);
+static void startup_mark(LunarCalendarApp* app, StartupStage stage);
+static gboolean on_first_draw(GtkWidget* widget, cairo_t* cr, gpointer user_data);
+static gboolean run_startup_stage(gpointer user_data);
+static GtkWidget* deferred_icon_button(LunarCalendarApp* app, const char* icon_name);
+static gboolean load_events(LunarCalendarApp* app);
 static gboolean on_day_clicked(GtkWidget* widget, GdkEventButton* event, gpointer user_data);
 static void update_event_editor(LunarCalendarApp* app);
 static void on_add_event(GtkWidget* widget, gpointer user_data);
@@ -56,7 +77,13 @@ static void init_metonic_cycle_bar(LunarCalendarApp* app);
 static void update_metonic_cycle_display(LunarCalendarApp* app);
 static void on_metonic_help_clicked(GtkButton* button, gpointer user_data);
 static void update_ui_from_config(LunarCalendarApp* app);
+static void configure_logger(LunarCalendarApp* app);
+static const char* cache_directory(LunarCalendarApp* app);
+static char* computation_cache_path(LunarCalendarApp* app);
 static void on_settings_clicked(GtkButton* button, gpointer user_data);
+static void on_export_ics_clicked(GtkButton* button, gpointer user_data);
+static void on_search_changed(GtkSearchEntry* entry, gpointer user_data);
+static void on_search_result_activated(GtkListBox* box, GtkListBoxRow* row, gpointer user_data);
 static gboolean draw_moon_phase_cairo(GtkWidget *widget, cairo_t *cr, gpointer data);
 
 /**
@@ -109,10 +136,24 @@ int main(int argc, char** argv) {
 
 // Initialize the GUI application
 LunarCalendarApp* gui_app_init(int* argc, char*** argv) {
+    guint64 startup_begin = lunar_trace_now();
     gtk_init(argc, argv);
     
+    // --trace records where UI updates spend their time (see write_trace);
+    // --navigate N steps N months forward and back again, then quits
+    int navigate_steps = 0;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp((*argv)[i], "--trace") == 0) {
+            lunar_trace_enable(true);
+        } else if (strcmp((*argv)[i], "--navigate") == 0 && i + 1 < *argc) {
+            navigate_steps = atoi((*argv)[++i]);
+        }
+    }
+    
     // Initialize the application
     LunarCalendarApp* app = g_malloc0(sizeof(LunarCalendarApp));
+    app->navigate_steps = navigate_steps;
+    app->startup_mark = startup_begin;
     app->app = gtk_application_new("org.lunar.mani", G_APPLICATION_DEFAULT_FLAGS); // Fix deprecated flag
     
     // Connect the activate signal
@@ -145,8 +186,21 @@ LunarCalendarApp* gui_app_init(int* argc, char*** argv) {
         config_save(app->config_file_path, app->config);
     }
     
-    // Initialize the events system
-    events_init(app->events_file_path);
+    // Calculations share one context whose year table outlives the session:
+    // what earlier runs computed is loaded from the cache directory
+    app->lunar_ctx = lunar_ctx_new(LUNAR_CTX_SHARED);
+    lunar_ctx_activate(app->lunar_ctx);
+    
+    // Start logging before anything else can report a problem
+    configure_logger(app);
+    
+    char* cache_path = computation_cache_path(app);
+    if (app->lunar_ctx && lunar_year_table_load(lunar_ctx_year_table(app->lunar_ctx), cache_path)) {
+        lunar_logger_log(NULL, LUNAR_LOG_DEBUG, "Loaded computation cache %s", cache_path);
+    }
+    g_free(cache_path);
+    
+    // The events file is loaded once the window is up (see load_events)
     
     // Get the current date for initializing the view
     time_t now = time(NULL);
@@ -168,6 +222,7 @@ LunarCalendarApp* gui_app_init(int* argc, char*** argv) {
     // Clean up
     g_free(config_dir);
     
+    startup_mark(app, STARTUP_INIT);
     return app;
 }
 
@@ -191,6 +246,16 @@ int gui_app_run(LunarCalendarApp* app) {
 // Clean up resources
 void gui_app_cleanup(LunarCalendarApp* app) {
     if (app) {
+        // Write out the trace and the computation cache while the cache
+        // directory is still known
+        write_trace(app);
+        if (app->lunar_ctx) {
+            char* cache_path = computation_cache_path(app);
+            g_mkdir_with_parents(cache_directory(app), 0755);
+            lunar_year_table_save(lunar_ctx_year_table(app->lunar_ctx), cache_path);
+            g_free(cache_path);
+        }
+        
         // Save configuration
         if (app->config && app->config_file_path) {
             config_save(app->config_file_path, app->config);
@@ -218,6 +283,18 @@ void gui_app_cleanup(LunarCalendarApp* app) {
         // Clean up events system
         events_cleanup();
         
+        if (app->deferred_icon_buttons) {
+            g_ptr_array_free(app->deferred_icon_buttons, TRUE);
+        }
+        
+        lunar_ctx_activate(NULL);
+        lunar_ctx_free(app->lunar_ctx);
+        
+        // Stop the logger last, once nothing is left to report
+        lunar_logger_set_default(NULL);
+        lunar_logger_free(app->logger);
+        g_free(app->logger_path);
+        
         // Unreference GTK application
         if (app->app) {
             g_object_unref(app->app);
@@ -232,6 +309,7 @@ void gui_app_cleanup(LunarCalendarApp* app) {
 static void activate(GtkApplication* app, gpointer user_data) {
     // Get the application data
     LunarCalendarApp* lunar_app = (LunarCalendarApp*)user_data;
+    startup_mark(lunar_app, STARTUP_APPLICATION);
     
     // Create the main window if it doesn't exist
     if (!lunar_app->window) {
@@ -263,8 +341,20 @@ static void activate(GtkApplication* app, gpointer user_data) {
     // Build the UI
     build_ui(lunar_app);
     
-    // Show the window and all its contents
+    // Show the window and all its contents; the rest of startup waits until
+    // it has been drawn
     gtk_widget_show_all(lunar_app->window);
+    startup_mark(lunar_app, STARTUP_BUILD_UI);
+    g_signal_connect_after(lunar_app->window, "draw", G_CALLBACK(on_first_draw), lunar_app);
+    
+    if (lunar_trace_enabled()) {
+        trace_frame_phases(lunar_app);
+    }
+    
+    // Scripted navigation runs one step per idle, so each month is laid out and drawn
+    if (lunar_app->navigate_steps > 0) {
+        g_idle_add(navigate_step, lunar_app);
+    }
     
     // Hide the metonic cycle status bar if not enabled in config
     if (lunar_app->metonic_cycle_bar && !lunar_app->config->show_metonic_cycle) {
@@ -294,11 +384,36 @@ static void build_ui(LunarCalendarApp* app) {
     gtk_header_bar_set_title(GTK_HEADER_BAR(app->header_bar), title);
     
     // Add settings button to the header bar
-    GtkWidget* settings_button = gtk_button_new_from_icon_name("preferences-system-symbolic", GTK_ICON_SIZE_BUTTON);
+    GtkWidget* settings_button = deferred_icon_button(app, "preferences-system-symbolic");
     gtk_widget_set_tooltip_text(settings_button, "Settings");
     g_signal_connect(settings_button, "clicked", G_CALLBACK(on_settings_clicked), app);
     gtk_header_bar_pack_end(GTK_HEADER_BAR(app->header_bar), settings_button);
     
+    // Add iCalendar export button to the header bar
+    GtkWidget* export_ics_button = deferred_icon_button(app, "x-office-calendar-symbolic");
+    gtk_widget_set_tooltip_text(export_ics_button, "Export iCalendar");
+    g_signal_connect(export_ics_button, "clicked", G_CALLBACK(on_export_ics_clicked), app);
+    gtk_header_bar_pack_end(GTK_HEADER_BAR(app->header_bar), export_ics_button);
+    
+    // Add the event search box with a results popover
+    app->search_entry = gtk_search_entry_new();
+    gtk_entry_set_placeholder_text(GTK_ENTRY(app->search_entry), "Search events");
+    g_signal_connect(app->search_entry, "search-changed", G_CALLBACK(on_search_changed), app);
+    gtk_header_bar_pack_end(GTK_HEADER_BAR(app->header_bar), app->search_entry);
+    
+    app->search_popover = gtk_popover_new(app->search_entry);
+    gtk_popover_set_modal(GTK_POPOVER(app->search_popover), FALSE);
+    GtkWidget* results_scroll = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(results_scroll),
+                                  GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+    gtk_scrolled_window_set_min_content_height(GTK_SCROLLED_WINDOW(results_scroll), 200);
+    gtk_scrolled_window_set_min_content_width(GTK_SCROLLED_WINDOW(results_scroll), 280);
+    app->search_results = gtk_list_box_new();
+    g_signal_connect(app->search_results, "row-activated", G_CALLBACK(on_search_result_activated), app);
+    gtk_container_add(GTK_CONTAINER(results_scroll), app->search_results);
+    gtk_container_add(GTK_CONTAINER(app->search_popover), results_scroll);
+    gtk_widget_show_all(results_scroll);
+    
     gtk_window_set_titlebar(GTK_WINDOW(app->window), app->header_bar);
     
     // Create main layout
@@ -314,12 +429,31 @@ static void build_ui(LunarCalendarApp* app) {
     gtk_widget_set_size_request(app->sidebar, 200, -1);
     gtk_box_pack_start(GTK_BOX(content_box), app->sidebar, FALSE, FALSE, 0);
     
+    // Overlay holding the calendar and, in debug mode, the hot-path counters
+    GtkWidget* calendar_overlay = gtk_overlay_new();
+    gtk_box_pack_start(GTK_BOX(content_box), calendar_overlay, TRUE, TRUE, 0);
+    
     // Create a scrolled window for the calendar
     GtkWidget* scroll = gtk_scrolled_window_new(NULL, NULL);
     gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scroll), 
                                   GTK_POLICY_AUTOMATIC, 
                                   GTK_POLICY_AUTOMATIC);
-    gtk_box_pack_start(GTK_BOX(content_box), scroll, TRUE, TRUE, 0);
+    gtk_container_add(GTK_CONTAINER(calendar_overlay), scroll);
+    
+    app->stats_overlay = gtk_label_new(NULL);
+    gtk_widget_set_halign(app->stats_overlay, GTK_ALIGN_END);
+    gtk_widget_set_valign(app->stats_overlay, GTK_ALIGN_END);
+    gtk_widget_set_margin_end(app->stats_overlay, 8);
+    gtk_widget_set_margin_bottom(app->stats_overlay, 8);
+    gtk_widget_set_no_show_all(app->stats_overlay, TRUE);
+    GtkCssProvider* stats_css = gtk_css_provider_new();
+    load_css(stats_css,
+        "label { background-color: rgba(0,0,0,0.75); color: #e0e0e0; padding: 6px; border-radius: 4px; }");
+    gtk_style_context_add_provider(gtk_widget_get_style_context(app->stats_overlay),
+                                   GTK_STYLE_PROVIDER(stats_css), GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    g_object_unref(stats_css);
+    gtk_overlay_add_overlay(GTK_OVERLAY(calendar_overlay), app->stats_overlay);
+    gtk_overlay_set_overlay_pass_through(GTK_OVERLAY(calendar_overlay), app->stats_overlay, TRUE);
     
     // Create a box for the calendar
     app->calendar_view = gtk_box_new(GTK_ORIENTATION_VERTICAL, 10);
@@ -332,7 +466,7 @@ static void build_ui(LunarCalendarApp* app) {
     gtk_box_pack_start(GTK_BOX(app->calendar_view), nav_box, FALSE, FALSE, 0);
     
     // Previous month button
-    GtkWidget* prev_button = gtk_button_new_from_icon_name("go-previous-symbolic", GTK_ICON_SIZE_BUTTON);
+    GtkWidget* prev_button = deferred_icon_button(app, "go-previous-symbolic");
     gtk_box_pack_start(GTK_BOX(nav_box), prev_button, FALSE, FALSE, 0);
     g_signal_connect(prev_button, "clicked", G_CALLBACK(on_prev_month), app);
     
@@ -354,7 +488,7 @@ static void build_ui(LunarCalendarApp* app) {
     g_signal_connect(year_spin, "value-changed", G_CALLBACK(on_year_changed), app);
     
     // Next month button
-    GtkWidget* next_button = gtk_button_new_from_icon_name("go-next-symbolic", GTK_ICON_SIZE_BUTTON);
+    GtkWidget* next_button = deferred_icon_button(app, "go-next-symbolic");
     gtk_box_pack_start(GTK_BOX(nav_box), next_button, FALSE, FALSE, 0);
     g_signal_connect(next_button, "clicked", G_CALLBACK(on_next_month), app);
     
@@ -369,13 +503,23 @@ static void build_ui(LunarCalendarApp* app) {
     update_ui(app);
 }
 
-// Update the calendar view to show the current LUNAR month using the CalendarGridModel
+// Update the calendar view to show the current LUNAR month
 static void update_calendar_view(LunarCalendarApp* app) {
+    LUNAR_TRACE_BEGIN(span);
+    LUNAR_STATS_TIMER_START(timer);
+    rebuild_calendar_grid(app);
+    LUNAR_STATS_TIMER_STOP(LUNAR_STAT_GRID_REBUILD, timer);
+    LUNAR_TRACE_END(span, "gui", "update_calendar_view");
+}
+
+// Rebuild the calendar grid from the CalendarGridModel
+static void rebuild_calendar_grid(LunarCalendarApp* app) {
     // ---- Variable Declarations ----
     char status_msg[256]; // Single declaration for status message
     // ---- End Variable Declarations ----
 
     // Clear the calendar view, but keep the navigation controls
+    LUNAR_TRACE_BEGIN(teardown_span);
     GList* children = gtk_container_get_children(GTK_CONTAINER(app->calendar_view));
     // Skip the first child which is the navigation controls
     if (children != NULL) {
@@ -389,6 +533,7 @@ static void update_calendar_view(LunarCalendarApp* app) {
         }
     }
     g_list_free(children);
+    LUNAR_TRACE_END(teardown_span, "gtk", "widget teardown");
     
     // Create a calendar grid
     GtkWidget* calendar_grid = gtk_grid_new();
@@ -454,6 +599,7 @@ static void update_calendar_view(LunarCalendarApp* app) {
         grid_row = 0; // If not showing headers, start grid at row 0
     }
 
+    LUNAR_TRACE_BEGIN(cells_span);
     for (int i = 0; i < model->rows * model->cols; i++) {
         CalendarDayCell* cell = model->cells[i];
         int col = i % model->cols;
@@ -480,7 +626,7 @@ static void update_calendar_view(LunarCalendarApp* app) {
         // Make it obvious that the day is clickable
         GtkCssProvider* day_provider = gtk_css_provider_new();
         const char* day_css = ".day-cell:hover { background-color: rgba(120, 120, 120, 0.2); }";
-        gtk_css_provider_load_from_data(day_provider, day_css, -1, NULL);
+        load_css(day_provider, day_css);
             gtk_style_context_add_provider(style_context, 
                                     GTK_STYLE_PROVIDER(day_provider), 
                                     GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
@@ -551,7 +697,7 @@ static void update_calendar_view(LunarCalendarApp* app) {
                     ".special-day { background-color: rgba(%d, %d, %d, %f); }",
                     (int)(color.red * 255), (int)(color.green * 255), 
                     (int)(color.blue * 255), color.alpha);
-            gtk_css_provider_load_from_data(provider, css, -1, NULL);
+            load_css(provider, css);
                 gtk_style_context_add_provider(style_context, 
                                         GTK_STYLE_PROVIDER(provider), 
                                         GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
@@ -568,7 +714,7 @@ static void update_calendar_view(LunarCalendarApp* app) {
                     ".event-day { background-color: rgba(%d, %d, %d, %f); }",
                     (int)(event_color.red * 255), (int)(event_color.green * 255), 
                     (int)(event_color.blue * 255), event_color.alpha);
-            gtk_css_provider_load_from_data(provider, css, -1, NULL);
+            load_css(provider, css);
                 gtk_style_context_add_provider(style_context, 
                                         GTK_STYLE_PROVIDER(provider), 
                                         GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
@@ -591,7 +737,7 @@ static void update_calendar_view(LunarCalendarApp* app) {
                 gtk_style_context_add_class(style_context, "selected-day");
             GtkCssProvider* provider = gtk_css_provider_new();
             const char* css = ".selected-day { border: 2px solid #3584e4; background-color: rgba(53, 132, 228, 0.3); }";
-            gtk_css_provider_load_from_data(provider, css, -1, NULL);
+            load_css(provider, css);
                 gtk_style_context_add_provider(style_context, 
                                         GTK_STYLE_PROVIDER(provider), 
                                         GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
@@ -604,11 +750,15 @@ static void update_calendar_view(LunarCalendarApp* app) {
         gtk_grid_attach(GTK_GRID(calendar_grid), day_frame, col, row, 1, 1);
     }
 
+    LUNAR_TRACE_END(cells_span, "gui", "grid cells");
+
     // Free the model now that the grid is built
     calendar_adapter_free_model(model);
     
     // Show all the widgets
+    LUNAR_TRACE_BEGIN(show_span);
     gtk_widget_show_all(app->calendar_view);
+    LUNAR_TRACE_END(show_span, "gtk", "show widgets");
 }
 
 // Callback when month is changed
@@ -701,18 +851,32 @@ static void on_window_destroy(GtkWidget* widget, gpointer data) {
         g_list_free(children);
     }
     
+    // Startup stages left over would find the widgets gone
+    if (app && app->startup_source) {
+        g_source_remove(app->startup_source);
+        app->startup_source = 0;
+    }
+    
     // Ensure we quit the main loop
     gtk_main_quit();
 }
 
 /* Update the sidebar with current date information including a wireframe moon phase */
 static void update_sidebar(LunarCalendarApp* app) {
+    LUNAR_TRACE_BEGIN(span);
+    rebuild_sidebar(app);
+    LUNAR_TRACE_END(span, "gui", "update_sidebar");
+}
+
+static void rebuild_sidebar(LunarCalendarApp* app) {
     // Clear existing widgets
+    LUNAR_TRACE_BEGIN(teardown_span);
     GList* children = gtk_container_get_children(GTK_CONTAINER(app->sidebar));
     for (GList* iter = children; iter != NULL; iter = g_list_next(iter)) {
         gtk_widget_destroy(GTK_WIDGET(iter->data));
     }
     g_list_free(children);
+    LUNAR_TRACE_END(teardown_span, "gtk", "widget teardown");
     
     // Get today's date
     time_t now = time(NULL);
@@ -779,6 +943,84 @@ static void update_sidebar(LunarCalendarApp* app) {
     update_event_editor(app);
 }
 
+// Maximum number of search hits listed in the results popover
+#define SEARCH_MAX_RESULTS 50
+
+// Search events as the query changes and list the hits
+static void on_search_changed(GtkSearchEntry* entry, gpointer user_data) {
+    LunarCalendarApp* app = (LunarCalendarApp*)user_data;
+    load_events(app);  // In case this comes before the startup stage
+    
+    // Clear the previous results
+    GList* children = gtk_container_get_children(GTK_CONTAINER(app->search_results));
+    for (GList* iter = children; iter != NULL; iter = g_list_next(iter)) {
+        gtk_widget_destroy(GTK_WIDGET(iter->data));
+    }
+    g_list_free(children);
+    
+    const char* query = gtk_entry_get_text(GTK_ENTRY(entry));
+    if (query == NULL || strlen(query) == 0) {
+        gtk_widget_hide(app->search_popover);
+        return;
+    }
+    
+    EventList* hits = event_search(query, SEARCH_MAX_RESULTS);
+    if (hits == NULL) {
+        GtkWidget* none = gtk_label_new("No matching events");
+        gtk_widget_set_sensitive(none, FALSE);
+        gtk_list_box_insert(GTK_LIST_BOX(app->search_results), none, -1);
+    } else {
+        for (int i = 0; i < hits->count; i++) {
+            CalendarEvent* event = hits->events[i];
+            
+            char text[256];
+            snprintf(text, sizeof(text), "%04d-%02d-%02d  %s",
+                     event->year, event->month, event->day, event->title);
+            GtkWidget* label = gtk_label_new(text);
+            gtk_widget_set_halign(label, GTK_ALIGN_START);
+            gtk_label_set_ellipsize(GTK_LABEL(label), PANGO_ELLIPSIZE_END);
+            
+            // Remember the hit's date on the row
+            GtkWidget* row = gtk_list_box_row_new();
+            gtk_container_add(GTK_CONTAINER(row), label);
+            g_object_set_data(G_OBJECT(row), "event-year", GINT_TO_POINTER(event->year));
+            g_object_set_data(G_OBJECT(row), "event-month", GINT_TO_POINTER(event->month));
+            g_object_set_data(G_OBJECT(row), "event-day", GINT_TO_POINTER(event->day));
+            gtk_list_box_insert(GTK_LIST_BOX(app->search_results), row, -1);
+        }
+        event_list_free(hits);
+    }
+    
+    gtk_widget_show_all(app->search_results);
+    gtk_popover_popup(GTK_POPOVER(app->search_popover));
+}
+
+// Jump the calendar to the lunar month containing a search hit and select its day
+static void on_search_result_activated(GtkListBox* box, GtkListBoxRow* row, gpointer user_data) {
+    LunarCalendarApp* app = (LunarCalendarApp*)user_data;
+    
+    int year = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(row), "event-year"));
+    int month = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(row), "event-month"));
+    int day = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(row), "event-day"));
+    if (year == 0) {
+        return;  // The "no matches" placeholder
+    }
+    
+    int lunar_year, lunar_month, lunar_day;
+    if (!events_gregorian_to_lunar(year, month, day, &lunar_year, &lunar_month, &lunar_day)) {
+        return;
+    }
+    
+    app->current_year = lunar_year;
+    app->current_month = lunar_month;
+    app->selected_day_year = year;
+    app->selected_day_month = month;
+    app->selected_day_day = day;
+    
+    gtk_popover_popdown(GTK_POPOVER(app->search_popover));
+    update_ui(app);
+}
+
 // Implement the update_event_editor function
 static void update_event_editor(LunarCalendarApp* app) {
     if (!app->event_editor) {
@@ -839,7 +1081,7 @@ static void update_event_editor(LunarCalendarApp* app) {
                         (int)(event->color.red * 255), (int)(event->color.green * 255), 
                         (int)(event->color.blue * 255), event->color.alpha);
                         
-                gtk_css_provider_load_from_data(provider, css, -1, NULL);
+                load_css(provider, css);
                 gtk_style_context_add_provider(context, 
                                             GTK_STYLE_PROVIDER(provider), 
                                             GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
@@ -852,6 +1094,15 @@ static void update_event_editor(LunarCalendarApp* app) {
             gtk_widget_set_halign(title_label, GTK_ALIGN_START);
             gtk_box_pack_start(GTK_BOX(title_box), title_label, FALSE, FALSE, 0);
             
+            // Recurrence rule, if any
+            const char* recurrence = event_recurrence_describe(event);
+            if (recurrence != NULL) {
+                GtkWidget* recur_label = gtk_label_new(recurrence);
+                gtk_widget_set_halign(recur_label, GTK_ALIGN_START);
+                gtk_widget_set_sensitive(recur_label, FALSE);
+                gtk_box_pack_start(GTK_BOX(title_box), recur_label, FALSE, FALSE, 0);
+            }
+            
             // Short preview of the description
             if (event->description && strlen(event->description) > 0) {
                 char preview[40];
@@ -876,14 +1127,18 @@ static void update_event_editor(LunarCalendarApp* app) {
             // Edit button
             GtkWidget* edit_button = gtk_button_new_from_icon_name("document-edit-symbolic", GTK_ICON_SIZE_BUTTON);
             gtk_widget_set_tooltip_text(edit_button, "Edit event");
-            g_object_set_data(G_OBJECT(edit_button), "event-index", GINT_TO_POINTER(i));
+            guint64* edit_id = g_new(guint64, 1);
+            *edit_id = event->id;
+            g_object_set_data_full(G_OBJECT(edit_button), "event-id", edit_id, g_free);
             g_signal_connect(edit_button, "clicked", G_CALLBACK(on_edit_event), app);
             gtk_box_pack_start(GTK_BOX(event_box), edit_button, FALSE, FALSE, 2);
             
             // Delete button
             GtkWidget* delete_button = gtk_button_new_from_icon_name("edit-delete-symbolic", GTK_ICON_SIZE_BUTTON);
             gtk_widget_set_tooltip_text(delete_button, "Delete event");
-            g_object_set_data(G_OBJECT(delete_button), "event-index", GINT_TO_POINTER(i));
+            guint64* delete_id = g_new(guint64, 1);
+            *delete_id = event->id;
+            g_object_set_data_full(G_OBJECT(delete_button), "event-id", delete_id, g_free);
             g_signal_connect(delete_button, "clicked", G_CALLBACK(on_delete_event), app);
             gtk_box_pack_start(GTK_BOX(event_box), delete_button, FALSE, FALSE, 2);
             
@@ -951,6 +1206,23 @@ static void update_event_editor(LunarCalendarApp* app) {
     
     gtk_box_pack_start(GTK_BOX(form_box), color_box, FALSE, FALSE, 5);
     
+    // Recurrence selection
+    GtkWidget* repeat_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+    GtkWidget* repeat_label = gtk_label_new("Repeat:");
+    gtk_widget_set_halign(repeat_label, GTK_ALIGN_START);
+    gtk_box_pack_start(GTK_BOX(repeat_box), repeat_label, FALSE, FALSE, 5);
+    
+    app->event_repeat_combo = gtk_combo_box_text_new();
+    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(app->event_repeat_combo), "none", "Never");
+    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(app->event_repeat_combo), "yearly", "Yearly on this date");
+    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(app->event_repeat_combo), "lunar_yearly", "Yearly on this lunar date");
+    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(app->event_repeat_combo), "lunar_month_start", "Start of this lunar month");
+    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(app->event_repeat_combo), "winter_solstice", "Every winter solstice");
+    gtk_combo_box_set_active(GTK_COMBO_BOX(app->event_repeat_combo), 0);
+    gtk_box_pack_start(GTK_BOX(repeat_box), app->event_repeat_combo, TRUE, TRUE, 5);
+    
+    gtk_box_pack_start(GTK_BOX(form_box), repeat_box, FALSE, FALSE, 5);
+    
     // Add button
     GtkWidget* add_button = gtk_button_new_with_label("Add Event");
     g_signal_connect(add_button, "clicked", G_CALLBACK(on_add_event), app);
@@ -968,6 +1240,7 @@ static void update_event_editor(LunarCalendarApp* app) {
 // Add event handler
 static void on_add_event(GtkWidget* widget, gpointer user_data) {
     LunarCalendarApp* app = (LunarCalendarApp*)user_data;
+    load_events(app);  // In case this comes before the startup stage
     
     // Get the event title
     const char* title = gtk_entry_get_text(GTK_ENTRY(app->event_title_entry));
@@ -993,9 +1266,34 @@ static void on_add_event(GtkWidget* widget, gpointer user_data) {
     GdkRGBA color;
     gtk_color_chooser_get_rgba(GTK_COLOR_CHOOSER(app->event_color_button), &color);
     
+    // Get the recurrence rule; lunar rules anchor to the selected cell's lunar date
+    const char* repeat_id = NULL;
+    if (app->event_repeat_combo != NULL) {
+        repeat_id = gtk_combo_box_get_active_id(GTK_COMBO_BOX(app->event_repeat_combo));
+    }
+    
+    int lunar_year = 0, lunar_month = 0, lunar_day = 0;
+    events_gregorian_to_lunar(app->selected_day_year, app->selected_day_month, app->selected_day_day,
+                              &lunar_year, &lunar_month, &lunar_day);
+    
     // Add the event
-    bool success = event_add(app->selected_day_year, app->selected_day_month, 
-                            app->selected_day_day, title, description, &color);
+    bool success;
+    if (g_strcmp0(repeat_id, "lunar_yearly") == 0) {
+        success = event_add_lunar(lunar_year, lunar_month, lunar_day, true, title, description, &color);
+    } else {
+        EventRecurrence recurrence = EVENT_RECUR_NONE;
+        if (g_strcmp0(repeat_id, "yearly") == 0) {
+            recurrence = EVENT_RECUR_YEARLY_GREGORIAN;
+        } else if (g_strcmp0(repeat_id, "lunar_month_start") == 0) {
+            recurrence = EVENT_RECUR_LUNAR_MONTH_START;
+        } else if (g_strcmp0(repeat_id, "winter_solstice") == 0) {
+            recurrence = EVENT_RECUR_WINTER_SOLSTICE;
+        }
+        success = event_add_recurring(app->selected_day_year, app->selected_day_month,
+                                      app->selected_day_day, recurrence,
+                                      recurrence == EVENT_RECUR_LUNAR_MONTH_START ? lunar_month : 0,
+                                      title, description, &color);
+    }
     
     // Free the description
     g_free(description);
@@ -1029,21 +1327,16 @@ static void on_add_event(GtkWidget* widget, gpointer user_data) {
 static void on_edit_event(GtkWidget* widget, gpointer user_data) {
     LunarCalendarApp* app = (LunarCalendarApp*)user_data;
     
-    // Get the event index
-    int event_index = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(widget), "event-index"));
-    
-    // Get the event
-    EventList* events = event_get_for_date(
-        app->selected_day_year, app->selected_day_month, app->selected_day_day);
-    
-    if (!events || event_index >= events->count) {
-        if (events) {
-            event_list_free(events);
-        }
+    // Get the event bound to the button
+    guint64* event_id = g_object_get_data(G_OBJECT(widget), "event-id");
+    if (!event_id) {
+        return;
+    }
+    guint64 id = *event_id;
+    CalendarEvent* event = event_get_by_id(id);
+    if (!event) {
         return;
     }
-    
-    CalendarEvent* event = events->events[event_index];
     
     // Create a dialog for editing
     GtkWidget* dialog = gtk_dialog_new_with_buttons("Edit Event",
@@ -1124,9 +1417,7 @@ static void on_edit_event(GtkWidget* widget, gpointer user_data) {
         gtk_color_chooser_get_rgba(GTK_COLOR_CHOOSER(color_button), &new_color);
         
         // Update the event
-        bool success = event_update(app->selected_day_year, app->selected_day_month, 
-                                   app->selected_day_day, event_index, 
-                                   new_title, new_description, &new_color);
+        bool success = event_update(id, new_title, new_description, &new_color);
         
         // Free the description
         g_free(new_description);
@@ -1152,9 +1443,6 @@ static void on_edit_event(GtkWidget* widget, gpointer user_data) {
         }
     }
     
-    // Free events
-    event_list_free(events);
-    
     // Destroy the dialog
     gtk_widget_destroy(dialog);
 }
@@ -1163,8 +1451,12 @@ static void on_edit_event(GtkWidget* widget, gpointer user_data) {
 static void on_delete_event(GtkWidget* widget, gpointer user_data) {
     LunarCalendarApp* app = (LunarCalendarApp*)user_data;
     
-    // Get the event index
-    int event_index = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(widget), "event-index"));
+    // Get the event bound to the button
+    guint64* event_id = g_object_get_data(G_OBJECT(widget), "event-id");
+    if (!event_id) {
+        return;
+    }
+    guint64 id = *event_id;  // The button may be destroyed while the dialog runs
     
     // Confirm the deletion
     GtkWidget* dialog = gtk_message_dialog_new(GTK_WINDOW(app->window),
@@ -1181,8 +1473,7 @@ static void on_delete_event(GtkWidget* widget, gpointer user_data) {
     }
     
     // Delete the event
-    bool success = event_delete(app->selected_day_year, app->selected_day_month, 
-                               app->selected_day_day, event_index);
+    bool success = event_delete(id);
     
     if (success) {
         // Save events
@@ -1218,14 +1509,50 @@ static void update_header(LunarCalendarApp* app) {
 
 /* Update the main UI */
 static void update_ui(LunarCalendarApp* app) {
+    LUNAR_TRACE_BEGIN(span);
     update_calendar_view(app);
     update_month_label(app);
     update_header(app);
     update_sidebar(app);
+    update_stats_overlay(app);
+    LUNAR_TRACE_END(span, "gui", "update_ui");
+}
+
+/* Show what the work since the last update cost, when debug logging is on */
+static void update_stats_overlay(LunarCalendarApp* app) {
+    if (!app->stats_overlay) return;
+    
+    if (!app->config || !app->config->debug_logging) {
+        gtk_widget_hide(app->stats_overlay);
+        return;
+    }
+    
+    char table[2048];
+    if (lunar_stats_enabled()) {
+        LunarStats stats;
+        lunar_stats_snapshot(&stats);
+        lunar_stats_format(&stats, table, sizeof(table));
+        lunar_stats_reset();
+    } else {
+        snprintf(table, sizeof(table), "Counters are not compiled in (make STATS=1)");
+    }
+    
+    gchar* escaped = g_markup_escape_text(table, -1);
+    gchar* markup = g_strdup_printf("<tt>%s</tt>", escaped);
+    gtk_label_set_markup(GTK_LABEL(app->stats_overlay), markup);
+    g_free(markup);
+    g_free(escaped);
+    gtk_widget_show(app->stats_overlay);
 }
 
 /* Update the month label */
 static void update_month_label(LunarCalendarApp* app) {
+    LUNAR_TRACE_BEGIN(span);
+    refresh_month_label(app);
+    LUNAR_TRACE_END(span, "gui", "update_month_label");
+}
+
+static void refresh_month_label(LunarCalendarApp* app) {
     const char* month_names[] = {
         "January", "February", "March", "April", "May", "June",
         "July", "August", "September", "October", "November", "December", "Thirteenth"
@@ -1276,11 +1603,11 @@ static gboolean on_day_clicked(GtkWidget* widget, GdkEventButton* event, gpointe
     // Get the click data from the widget
     DayClickData* data = g_object_get_data(G_OBJECT(widget), "click-data");
     if (!data) {
-        g_print("ERROR: No click data found on widget\n");
+        lunar_logger_log(NULL, LUNAR_LOG_ERROR, "No click data found on widget");
         return FALSE;
     }
     
-    g_print("Day clicked: %04d-%02d-%02d\n", data->year, data->month, data->day);
+    lunar_logger_log(NULL, LUNAR_LOG_DEBUG, "Day clicked: %04d-%02d-%02d", data->year, data->month, data->day);
     
     LunarCalendarApp* app = data->app;
     
@@ -1425,8 +1752,10 @@ static void on_metonic_help_clicked(GtkButton* button, gpointer user_data) {
 static void update_ui_from_config(LunarCalendarApp* app) {
     if (!app) return;
     
-    // Print debug info to confirm this is being called
-    g_print("Applying settings changes...\n");
+    // The log file and level may have changed too
+    configure_logger(app);
+    lunar_logger_log(NULL, LUNAR_LOG_DEBUG, "Applying settings changes");
+    LUNAR_TRACE_BEGIN(span);
     
     // Update theme based on settings
     GtkSettings* settings = gtk_settings_get_default();
@@ -1472,7 +1801,7 @@ static void update_ui_from_config(LunarCalendarApp* app) {
     
     // Load the CSS if we have any
     if (css_string->len > 0) {
-        gtk_css_provider_load_from_data(provider, css_string->str, -1, NULL);
+        load_css(provider, css_string->str);
         gtk_style_context_add_provider_for_screen(
             gdk_screen_get_default(),
             GTK_STYLE_PROVIDER(provider),
@@ -1506,6 +1835,9 @@ static void update_ui_from_config(LunarCalendarApp* app) {
     // Update header
     update_header(app);
     
+    // Show or hide the debug counters
+    update_stats_overlay(app);
+    
     // Redraw the entire window to reflect changes
     if (app->window) {
         gtk_widget_queue_draw(app->window);
@@ -1516,6 +1848,321 @@ static void update_ui_from_config(LunarCalendarApp* app) {
         gtk_statusbar_push(GTK_STATUSBAR(app->status_bar), 0, 
                        "Settings have been applied successfully.");
     }
+    LUNAR_TRACE_END(span, "gui", "update_ui_from_config");
+}
+
+// Load a style sheet, timed as a CSS parse span when tracing
+static void load_css(GtkCssProvider* provider, const char* css) {
+    LUNAR_TRACE_BEGIN(span);
+    gtk_css_provider_load_from_data(provider, css, -1, NULL);
+    LUNAR_TRACE_END(span, "gtk", "css parse");
+}
+
+/*
+ * Frame phases as trace spans. Layout runs from the frame clock's "layout"
+ * signal until the window starts drawing (or the frame ends, if nothing is
+ * drawn); paint is the window's "draw" signal, children included.
+ */
+static void on_frame_layout(GdkFrameClock* clock, gpointer user_data) {
+    (void)clock;
+    LunarCalendarApp* app = (LunarCalendarApp*)user_data;
+    app->trace_layout_start = lunar_trace_now();
+}
+
+static void end_frame_layout(LunarCalendarApp* app, guint64 now) {
+    if (app->trace_layout_start) {
+        lunar_trace_record("gtk", "layout", app->trace_layout_start, now);
+        app->trace_layout_start = 0;
+    }
+}
+
+static void on_frame_after_paint(GdkFrameClock* clock, gpointer user_data) {
+    (void)clock;
+    end_frame_layout((LunarCalendarApp*)user_data, lunar_trace_now());
+}
+
+static gboolean on_window_draw_begin(GtkWidget* widget, cairo_t* cr, gpointer user_data) {
+    (void)widget; (void)cr;
+    LunarCalendarApp* app = (LunarCalendarApp*)user_data;
+    app->trace_paint_start = lunar_trace_now();
+    end_frame_layout(app, app->trace_paint_start);
+    return FALSE;
+}
+
+static gboolean on_window_draw_end(GtkWidget* widget, cairo_t* cr, gpointer user_data) {
+    (void)widget; (void)cr;
+    LunarCalendarApp* app = (LunarCalendarApp*)user_data;
+    if (app->trace_paint_start) {
+        lunar_trace_record("gtk", "paint", app->trace_paint_start, lunar_trace_now());
+        app->trace_paint_start = 0;
+    }
+    return FALSE;
+}
+
+static void trace_frame_phases(LunarCalendarApp* app) {
+    GdkFrameClock* clock = gtk_widget_get_frame_clock(app->window);
+    if (clock) {
+        g_signal_connect(clock, "layout", G_CALLBACK(on_frame_layout), app);
+        g_signal_connect(clock, "after-paint", G_CALLBACK(on_frame_after_paint), app);
+    }
+    g_signal_connect(app->window, "draw", G_CALLBACK(on_window_draw_begin), app);
+    g_signal_connect_after(app->window, "draw", G_CALLBACK(on_window_draw_end), app);
+}
+
+/*
+ * Write the recorded spans as <cache dir>/trace-YYYYMMDD-HHMMSS.json, in the
+ * Chrome trace-event format that chrome://tracing and Perfetto open.
+ */
+static void write_trace(LunarCalendarApp* app) {
+    if (!lunar_trace_enabled() || lunar_trace_event_count() == 0) return;
+    
+    const char* cache_dir = cache_directory(app);
+    g_mkdir_with_parents(cache_dir, 0755);
+    
+    char file_name[64];
+    time_t now = time(NULL);
+    struct tm tm_now;
+    localtime_r(&now, &tm_now);
+    strftime(file_name, sizeof(file_name), "trace-%Y%m%d-%H%M%S.json", &tm_now);
+    char* path = g_build_filename(cache_dir, file_name, NULL);
+    
+    if (lunar_trace_write(path)) {
+        lunar_logger_log(NULL, LUNAR_LOG_INFO, "Trace of %zu spans written to %s", lunar_trace_event_count(), path);
+    } else {
+        lunar_logger_log(NULL, LUNAR_LOG_ERROR, "Could not write trace to %s", path);
+    }
+    g_free(path);
+    lunar_trace_clear();
+}
+
+/*
+ * One step of --navigate: the next month for the first navigate_steps
+ * calls, the previous month for as many more, then close the window.
+ */
+static gboolean navigate_step(gpointer user_data) {
+    LunarCalendarApp* app = (LunarCalendarApp*)user_data;
+    
+    if (app->navigate_done < app->navigate_steps) {
+        on_next_month(NULL, app);
+    } else if (app->navigate_done < 2 * app->navigate_steps) {
+        on_prev_month(NULL, app);
+    } else {
+        gtk_widget_destroy(app->window);
+        return G_SOURCE_REMOVE;
+    }
+    app->navigate_done++;
+    return G_SOURCE_CONTINUE;
+}
+
+/*
+ * The configured cache directory (Advanced settings), or the user's cache
+ * directory when none is set.
+ */
+static const char* cache_directory(LunarCalendarApp* app) {
+    return app->config && app->config->cache_dir && app->config->cache_dir[0] != '\0'
+        ? app->config->cache_dir : g_get_user_cache_dir();
+}
+
+// Year boundaries and phase instants computed so far, kept between runs
+static char* computation_cache_path(LunarCalendarApp* app) {
+    return g_build_filename(cache_directory(app), "lunar-cache.bin", NULL);
+}
+
+// Forget the computation cache, in memory and on disk
+void gui_app_clear_cache(LunarCalendarApp* app) {
+    char* cache_path = computation_cache_path(app);
+    if (g_remove(cache_path) != 0 && errno != ENOENT) {
+        lunar_logger_log(NULL, LUNAR_LOG_WARNING, "Could not remove %s: %s", cache_path, g_strerror(errno));
+    }
+    if (app->lunar_ctx) {
+        lunar_year_table_clear(lunar_ctx_year_table(app->lunar_ctx));
+    }
+    lunar_logger_log(NULL, LUNAR_LOG_INFO, "Cleared computation cache %s", cache_path);
+    g_free(cache_path);
+}
+
+// --- Startup ---
+
+static const char* STARTUP_STAGE_NAMES[STARTUP_STAGE_COUNT] = {
+    "init", "application", "build UI", "first frame", "icons", "events", "neighbor months"
+};
+
+// End a startup stage that began at the end of the previous one
+static void startup_mark(LunarCalendarApp* app, StartupStage stage) {
+    guint64 now = lunar_trace_now();
+    app->startup_ns[stage] = now - app->startup_mark;
+    if (lunar_trace_enabled()) {
+        lunar_trace_record("startup", STARTUP_STAGE_NAMES[stage], app->startup_mark, now);
+    }
+    app->startup_mark = now;
+}
+
+// The window has been drawn once: run the deferred stages between frames
+static gboolean on_first_draw(GtkWidget* widget, cairo_t* cr, gpointer user_data) {
+    LunarCalendarApp* app = (LunarCalendarApp*)user_data;
+    g_signal_handlers_disconnect_by_func(widget, G_CALLBACK(on_first_draw), user_data);
+    startup_mark(app, STARTUP_FIRST_FRAME);
+    app->startup_stage = STARTUP_ICONS;
+    app->startup_source = g_idle_add(run_startup_stage, app);
+    return FALSE;
+}
+
+// A button whose icon is only looked up in the icons stage
+static GtkWidget* deferred_icon_button(LunarCalendarApp* app, const char* icon_name) {
+    GtkWidget* button = gtk_button_new();
+    g_object_set_data(G_OBJECT(button), "icon-name", (gpointer)icon_name);
+    if (!app->deferred_icon_buttons) {
+        app->deferred_icon_buttons = g_ptr_array_new();
+    }
+    g_ptr_array_add(app->deferred_icon_buttons, button);
+    return button;
+}
+
+static void set_deferred_icons(LunarCalendarApp* app) {
+    if (app->deferred_icon_buttons) {
+        for (guint i = 0; i < app->deferred_icon_buttons->len; i++) {
+            GtkWidget* button = g_ptr_array_index(app->deferred_icon_buttons, i);
+            const char* icon_name = g_object_get_data(G_OBJECT(button), "icon-name");
+            gtk_button_set_image(GTK_BUTTON(button), gtk_image_new_from_icon_name(icon_name, GTK_ICON_SIZE_BUTTON));
+        }
+        g_ptr_array_free(app->deferred_icon_buttons, TRUE);
+        app->deferred_icon_buttons = NULL;
+    }
+    calendar_adapter_preload_icons();
+}
+
+// Load the events file once; TRUE if this call loaded it
+static gboolean load_events(LunarCalendarApp* app) {
+    if (app->events_loaded) return FALSE;
+    events_init(app->events_file_path);
+    app->events_loaded = TRUE;
+    return TRUE;
+}
+
+static void count_event(CalendarEvent* event, void* user_data) {
+    (void)event;
+    (*(int*)user_data)++;
+}
+
+// Build (and drop) the models of the months either side of the current one,
+// so their year boundaries and phase instants are in the year table
+static void prefetch_neighbor_months(LunarCalendarApp* app) {
+    int year = app->current_year;
+    int prev_month = app->current_month - 1;
+    int prev_year = year;
+    if (prev_month < 1) {
+        prev_year--;
+        prev_month = get_lunar_months_in_year(prev_year);
+    }
+    int next_month = app->current_month + 1;
+    int next_year = year;
+    if (next_month > get_lunar_months_in_year(year)) {
+        next_month = 1;
+        next_year++;
+    }
+    calendar_adapter_free_model(calendar_adapter_create_month_model(prev_year, prev_month));
+    calendar_adapter_free_model(calendar_adapter_create_month_model(next_year, next_month));
+}
+
+static void log_startup_timings(LunarCalendarApp* app) {
+    if (!lunar_logger_enabled(NULL, LUNAR_LOG_DEBUG)) return;
+    
+    GString* line = g_string_new("Startup:");
+    guint64 shown = 0, total = 0;
+    for (int stage = 0; stage < STARTUP_STAGE_COUNT; stage++) {
+        g_string_append_printf(line, "%s %s %.1f ms", stage > 0 ? "," : "", STARTUP_STAGE_NAMES[stage],
+                               app->startup_ns[stage] / 1e6);
+        if (stage <= STARTUP_FIRST_FRAME) shown += app->startup_ns[stage];
+        total += app->startup_ns[stage];
+    }
+    g_string_append_printf(line, "; window drawn after %.1f ms, %.1f ms in all", shown / 1e6, total / 1e6);
+    lunar_logger_log(NULL, LUNAR_LOG_DEBUG, "%s", line->str);
+    g_string_free(line, TRUE);
+}
+
+/*
+ * Run the next deferred startup stage. Each runs in its own idle callback,
+ * so input and redraws get in between; the time spent waiting is not counted.
+ */
+static gboolean run_startup_stage(gpointer user_data) {
+    LunarCalendarApp* app = (LunarCalendarApp*)user_data;
+    StartupStage stage = app->startup_stage;
+    
+    app->startup_mark = lunar_trace_now();
+    switch (stage) {
+        case STARTUP_ICONS:
+            set_deferred_icons(app);
+            break;
+        case STARTUP_EVENTS: {
+            int event_count = 0;
+            if (load_events(app)) {
+                event_foreach(count_event, &event_count);
+            }
+            // Show the event markers and the selected day's events
+            if (event_count > 0) {
+                update_calendar_view(app);
+                update_event_editor(app);
+            }
+            break;
+        }
+        default:
+            prefetch_neighbor_months(app);
+            break;
+    }
+    startup_mark(app, stage);
+    
+    if (stage + 1 < STARTUP_STAGE_COUNT) {
+        app->startup_stage = stage + 1;
+        return G_SOURCE_CONTINUE;
+    }
+    app->startup_source = 0;
+    log_startup_timings(app);
+    return G_SOURCE_REMOVE;
+}
+
+/**
+ * Point the default logger at the configured log file, keeping debug lines
+ * only when debug logging is on. The file is reopened only if its path changed.
+ */
+static void configure_logger(LunarCalendarApp* app) {
+    LunarLogLevel level = app->config->debug_logging ? LUNAR_LOG_DEBUG : LUNAR_LOG_WARNING;
+    const char* path = app->config->log_file_path ? app->config->log_file_path : "";
+    
+    if (app->lunar_ctx) {
+        lunar_ctx_set_log(app->lunar_ctx, NULL, NULL, level);
+    }
+    
+    // --trace reports where it wrote the trace at LUNAR_LOG_INFO (see write_trace)
+    if (lunar_trace_enabled() && level < LUNAR_LOG_INFO) {
+        level = LUNAR_LOG_INFO;
+    }
+    
+    if (app->logger && g_strcmp0(app->logger_path, path) == 0) {
+        lunar_logger_set_level(app->logger, level);
+        return;
+    }
+    
+    if (path[0] != '\0') {
+        char* log_dir = g_path_get_dirname(path);
+        g_mkdir_with_parents(log_dir, 0755);
+        g_free(log_dir);
+    }
+    LunarLogger* logger = lunar_logger_new(path, level);
+    if (!logger) {
+        lunar_logger_log(NULL, LUNAR_LOG_WARNING, "Could not open log file %s", path);
+        if (app->logger) {
+            lunar_logger_set_level(app->logger, level);
+        }
+        return;
+    }
+    
+    // Only this thread logs through the previous logger, so it can go now
+    LunarLogger* previous = app->logger;
+    lunar_logger_set_default(logger);
+    lunar_logger_free(previous);
+    app->logger = logger;
+    g_free(app->logger_path);
+    app->logger_path = g_strdup(path);
 }
 
 /**
@@ -1529,8 +2176,104 @@ static void on_settings_clicked(GtkButton* button, gpointer user_data) {
     if (settings_dialog_show(app, GTK_WINDOW(app->window), update_ui_from_config)) {
         // Settings were changed and saved (OK was clicked)
         // No need to call update_ui_from_config again here as it's handled by settings_dialog_show
-        g_print("Settings updated after dialog closed with OK.\n");
+        lunar_logger_log(NULL, LUNAR_LOG_DEBUG, "Settings updated after dialog closed with OK");
+    }
+}
+
+// State of one year's user events being added to an iCalendar export
+typedef struct {
+    IcsWriter* writer;
+    bool ok;
+} IcsEventExport;
+
+// Write one event occurrence as an all-day VEVENT
+static void export_event_occurrence(CalendarEvent* event, int year, int month, int day, void* user_data) {
+    IcsEventExport* export = (IcsEventExport*)user_data;
+    char uid[96];
+    
+    snprintf(uid, sizeof(uid), "event-%" PRIu64 "-%04d%02d%02d@" ICS_UID_DOMAIN, event->id, year, month, day);
+    IcsEvent ics_event = { uid, year, month, day, event->title, event->description, "Event" };
+    if (!ics_write_event(export->writer, &ics_event)) {
+        export->ok = false;
+    }
+}
+
+// Add the user events of a Gregorian year after its astronomical events
+static bool export_year_events(IcsWriter* writer, int year, void* user_data) {
+    IcsEventExport export = { writer, true };
+    event_foreach_in_range(year, 1, 1, year, 12, 31, export_event_occurrence, &export);
+    return export.ok;
+}
+
+/**
+ * Handle iCalendar export button click.
+ * Asks for a file and a year range, then streams lunar months, moon phases,
+ * seasons and user events to it.
+ */
+static void on_export_ics_clicked(GtkButton* button, gpointer user_data) {
+    LunarCalendarApp* app = (LunarCalendarApp*)user_data;
+    load_events(app);  // In case this comes before the startup stage
+    GtkWidget* dialog = gtk_file_chooser_dialog_new("Export iCalendar",
+                                                  GTK_WINDOW(app->window),
+                                                  GTK_FILE_CHOOSER_ACTION_SAVE,
+                                                  "_Cancel", GTK_RESPONSE_CANCEL,
+                                                  "_Export", GTK_RESPONSE_ACCEPT,
+                                                  NULL);
+    gtk_file_chooser_set_current_name(GTK_FILE_CHOOSER(dialog), "lunar_calendar.ics");
+    gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(dialog), TRUE);
+    
+    GtkFileFilter* filter = gtk_file_filter_new();
+    gtk_file_filter_add_pattern(filter, "*.ics");
+    gtk_file_filter_set_name(filter, "iCalendar Files (*.ics)");
+    gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(dialog), filter);
+    
+    // Year range, defaulting to the displayed year
+    GtkWidget* range_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
+    GtkWidget* from_spin = gtk_spin_button_new_with_range(1, 9999, 1);
+    GtkWidget* to_spin = gtk_spin_button_new_with_range(1, 9999, 1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(from_spin), app->current_year);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(to_spin), app->current_year);
+    gtk_box_pack_start(GTK_BOX(range_box), gtk_label_new("From year"), FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(range_box), from_spin, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(range_box), gtk_label_new("to"), FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(range_box), to_spin, FALSE, FALSE, 0);
+    gtk_widget_show_all(range_box);
+    gtk_file_chooser_set_extra_widget(GTK_FILE_CHOOSER(dialog), range_box);
+    
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        char* filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
+        IcsOptions options = default_ics_options();
+        options.from_year = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(from_spin));
+        options.to_year = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(to_spin));
+        
+        long events = -1;
+        FILE* out = fopen(filename, "wb");
+        if (out) {
+            events = run_ics_export(out, &options, export_year_events, NULL);
+            if (fclose(out) != 0) {
+                events = -1;
+            }
+        }
+        
+        if (events >= 0) {
+            char status_msg[128];
+            snprintf(status_msg, sizeof(status_msg), "Exported %ld events to iCalendar.", events);
+            gtk_statusbar_push(GTK_STATUSBAR(app->status_bar), 0, status_msg);
+        } else {
+            GtkWidget* error = gtk_message_dialog_new(GTK_WINDOW(app->window),
+                                                   GTK_DIALOG_MODAL,
+                                                   GTK_MESSAGE_ERROR,
+                                                   GTK_BUTTONS_OK,
+                                                   "Failed to export iCalendar");
+            gtk_message_dialog_format_secondary_text(GTK_MESSAGE_DIALOG(error),
+                                                   "Check the year range (from must not be after to) and the file location.");
+            gtk_dialog_run(GTK_DIALOG(error));
+            gtk_widget_destroy(error);
+        }
+        g_free(filename);
     }
+    
+    gtk_widget_destroy(dialog);
 }
 
 // Cairo drawing function for the moon phase
@@ -4,6 +4,7 @@
 #include "../../include/gui/settings_dialog.h"
 #include "../../include/gui/config.h"
 #include "../../include/gui/gui_app.h"
+#include "../../include/lunar_logger.h"
 
 // Structure to hold pointers to widgets used in the settings dialog
 typedef struct {
@@ -798,9 +799,8 @@ static void on_browse_log_file(GtkButton* button, gpointer user_data) {
 
 // Clear cache button handler
 static void on_clear_cache(GtkButton* button, gpointer user_data) {
-    // LunarCalendarApp* app = (LunarCalendarApp*)user_data; // Unused variable
-    // Implement cache clearing logic here
-    g_print("Cache clearing not yet implemented.\n");
+    LunarCalendarApp* app = (LunarCalendarApp*)user_data;
+    gui_app_clear_cache(app);
 }
 
 // Reset all settings button handler
@@ -816,7 +816,7 @@ static void on_reset_all_settings(GtkButton* button, gpointer user_data) {
  */
 static void apply_settings(LunarCalendarApp* app) {
     if (!app || !app->config || !app->window) return;
-    g_print("--- apply_settings called ---\n"); // Debug start
+    lunar_logger_log(NULL, LUNAR_LOG_DEBUG, "apply_settings called");
 
     // Retrieve widget pointers (using g_object_get_data)
     GtkWidget* theme_combo = g_object_get_data(G_OBJECT(app->window), "theme_combo");
@@ -837,7 +837,7 @@ static void apply_settings(LunarCalendarApp* app) {
     GtkWidget* log_file_path_entry = g_object_get_data(G_OBJECT(app->window), "log_file_path_entry");
     GtkWidget* debug_logging_check = g_object_get_data(G_OBJECT(app->window), "debug_logging_check");
 
-    g_print("Widget pointers retrieved (sample: theme_combo=%p)\n", theme_combo); // Debug retrieval
+    lunar_logger_log(NULL, LUNAR_LOG_DEBUG, "Widget pointers retrieved (sample: theme_combo=%p)", (void*)theme_combo);
 
     // Apply settings from Appearance tab (if widgets exist)
     if (theme_combo) {
@@ -955,28 +955,28 @@ static void apply_settings(LunarCalendarApp* app) {
         // g_free(app->events_file_path);
         // app->events_file_path = g_strdup(text);
          // g_print("Applied events_file_path: %s\n", app->config->events_file_path ? app->config->events_file_path : "(null)"); // DEBUG REMOVED
-    } else { g_print("WARN: events_file_path_entry not found\n"); } // DEBUG REMOVED
+    } else { lunar_logger_log(NULL, LUNAR_LOG_WARNING, "events_file_path_entry not found"); }
     if (cache_dir_entry) {
         const char* text = gtk_entry_get_text(GTK_ENTRY(cache_dir_entry));
         g_free(app->config->cache_dir);
         app->config->cache_dir = g_strdup(text);
         // g_print("Applied cache_dir: %s\n", app->config->cache_dir ? app->config->cache_dir : "(null)"); // DEBUG REMOVED
-    } else { g_print("WARN: cache_dir_entry not found\n"); } // DEBUG REMOVED
+    } else { lunar_logger_log(NULL, LUNAR_LOG_WARNING, "cache_dir_entry not found"); }
     if (log_file_path_entry) {
         const char* text = gtk_entry_get_text(GTK_ENTRY(log_file_path_entry));
         g_free(app->config->log_file_path);
         app->config->log_file_path = g_strdup(text);
          // g_print("Applied log_file_path: %s\n", app->config->log_file_path ? app->config->log_file_path : "(null)"); // DEBUG REMOVED
-    } else { g_print("WARN: log_file_path_entry not found\n"); } // DEBUG REMOVED
+    } else { lunar_logger_log(NULL, LUNAR_LOG_WARNING, "log_file_path_entry not found"); }
     if (debug_logging_check) {
         // Use gtk_switch_get_active for GtkSwitch
         app->config->debug_logging = gtk_switch_get_active(GTK_SWITCH(debug_logging_check));
          // g_print("Applied debug_logging: %d\n", app->config->debug_logging); // DEBUG REMOVED
-    } else { g_print("WARN: debug_logging_check not found\n"); } // DEBUG REMOVED
+    } else { lunar_logger_log(NULL, LUNAR_LOG_WARNING, "debug_logging_check not found"); }
 
     // Indicate that settings have been applied
     // g_print("Configuration update attempted from settings dialog.\n"); // DEBUG REMOVED
-    g_print("--- apply_settings finished ---\n"); // Debug end
+    lunar_logger_log(NULL, LUNAR_LOG_DEBUG, "apply_settings finished");
 
     // Remove call to local update function - this should be handled externally
     // update_ui_from_config(app);
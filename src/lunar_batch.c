@@ -0,0 +1,316 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "../include/lunar_calendar.h"
+#include "../include/lunar_batch.h"
+
+// --- Constants ---
+#define BATCH_LINE_MAX 1024
+#define BATCH_ROW_MAX (BATCH_LINE_MAX * 2 + 512)
+
+/* Column names shared by the TSV/CSV header and the JSON keys */
+static const char *BATCH_COLUMNS[] = {
+    "input", "gregorian_date", "lunar_year", "lunar_month", "lunar_day",
+    "weekday", "moon_phase", "eld_year", "metonic_year", "metonic_cycle", "error"
+};
+#define BATCH_COLUMN_COUNT (sizeof(BATCH_COLUMNS) / sizeof(BATCH_COLUMNS[0]))
+
+/* Output row under construction */
+typedef struct {
+    char data[BATCH_ROW_MAX];
+    size_t len;
+    int column;
+    BatchFormat format;
+} BatchRow;
+
+/**
+ * @brief Default batch options
+ */
+BatchOptions default_batch_options(void) {
+    BatchOptions options;
+    options.format = BATCH_FORMAT_TSV;
+    options.direction = BATCH_GREGORIAN_TO_LUNAR;
+    options.header = true;
+    return options;
+}
+
+/**
+ * @brief Parse an output format name
+ */
+bool parse_batch_format(const char *name, BatchFormat *format) {
+    if (strcmp(name, "tsv") == 0) {
+        *format = BATCH_FORMAT_TSV;
+    } else if (strcmp(name, "csv") == 0) {
+        *format = BATCH_FORMAT_CSV;
+    } else if (strcmp(name, "jsonl") == 0 || strcmp(name, "json") == 0) {
+        *format = BATCH_FORMAT_JSONL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// --- Row Formatting ---
+
+static void row_append(BatchRow *row, const char *text, size_t len) {
+    if (row->len + len < sizeof(row->data)) {
+        memcpy(row->data + row->len, text, len);
+        row->len += len;
+    }
+}
+
+static void row_append_char(BatchRow *row, char c) {
+    if (row->len + 1 < sizeof(row->data)) {
+        row->data[row->len++] = c;
+    }
+}
+
+/* Append a decimal integer without going through printf */
+static void row_append_int(BatchRow *row, int value, int min_digits) {
+    char digits[16];
+    int count = 0;
+    unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+
+    do {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    while (count < min_digits) {
+        digits[count++] = '0';
+    }
+
+    if (value < 0) {
+        row_append_char(row, '-');
+    }
+    while (count > 0) {
+        row_append_char(row, digits[--count]);
+    }
+}
+
+/* Start the next column: separator, and the JSON key */
+static void row_begin_column(BatchRow *row) {
+    int column = row->column++;
+    switch (row->format) {
+        case BATCH_FORMAT_TSV:
+            if (column > 0) row_append_char(row, '\t');
+            break;
+        case BATCH_FORMAT_CSV:
+            if (column > 0) row_append_char(row, ',');
+            break;
+        case BATCH_FORMAT_JSONL:
+            row_append(row, column > 0 ? ",\"" : "{\"", 2);
+            row_append(row, BATCH_COLUMNS[column], strlen(BATCH_COLUMNS[column]));
+            row_append(row, "\":", 2);
+            break;
+    }
+}
+
+/* Append a text column, quoting and escaping as the format requires */
+static void row_text(BatchRow *row, const char *text) {
+    row_begin_column(row);
+
+    if (row->format == BATCH_FORMAT_JSONL) {
+        if (text == NULL) {
+            row_append(row, "null", 4);
+            return;
+        }
+        row_append_char(row, '"');
+        for (const char *p = text; *p; p++) {
+            unsigned char c = (unsigned char)*p;
+            if (c == '"' || c == '\\') {
+                row_append_char(row, '\\');
+                row_append_char(row, (char)c);
+            } else if (c < 0x20) {
+                static const char hex[] = "0123456789abcdef";
+                row_append(row, "\\u00", 4);
+                row_append_char(row, hex[c >> 4]);
+                row_append_char(row, hex[c & 0xF]);
+            } else {
+                row_append_char(row, (char)c);
+            }
+        }
+        row_append_char(row, '"');
+        return;
+    }
+
+    if (text == NULL) {
+        return;
+    }
+    if (row->format == BATCH_FORMAT_CSV && strpbrk(text, ",\"\r\n") != NULL) {
+        row_append_char(row, '"');
+        for (const char *p = text; *p; p++) {
+            if (*p == '"') row_append_char(row, '"');
+            row_append_char(row, *p);
+        }
+        row_append_char(row, '"');
+        return;
+    }
+    for (const char *p = text; *p; p++) {
+        /* Tabs would shift TSV columns */
+        row_append_char(row, (*p == '\t' && row->format == BATCH_FORMAT_TSV) ? ' ' : *p);
+    }
+}
+
+/* Append an integer column */
+static void row_int(BatchRow *row, int value) {
+    row_begin_column(row);
+    row_append_int(row, value, 1);
+}
+
+/* Append an empty column (null in JSON) */
+static void row_empty(BatchRow *row) {
+    if (row->format == BATCH_FORMAT_JSONL) {
+        row_text(row, NULL);
+    } else {
+        row_begin_column(row);
+    }
+}
+
+/* Append a YYYY-MM-DD column */
+static void row_date(BatchRow *row, int year, int month, int day) {
+    row_begin_column(row);
+    if (row->format == BATCH_FORMAT_JSONL) row_append_char(row, '"');
+    row_append_int(row, year, 4);
+    row_append_char(row, '-');
+    row_append_int(row, month, 2);
+    row_append_char(row, '-');
+    row_append_int(row, day, 2);
+    if (row->format == BATCH_FORMAT_JSONL) row_append_char(row, '"');
+}
+
+static void row_end(BatchRow *row) {
+    if (row->format == BATCH_FORMAT_JSONL) {
+        row_append_char(row, '}');
+    }
+    row_append_char(row, '\n');
+}
+
+// --- Input Parsing ---
+
+/* Write the header row */
+static void batch_write_header(FILE *out, const BatchOptions *options) {
+    char separator = options->format == BATCH_FORMAT_CSV ? ',' : '\t';
+    for (size_t i = 0; i < BATCH_COLUMN_COUNT; i++) {
+        if (i > 0) fputc(separator, out);
+        fputs(BATCH_COLUMNS[i], out);
+    }
+    fputc('\n', out);
+}
+
+/* Convert one input line into a result row */
+static bool batch_convert_line(LunarCache *cache, const char *line, const BatchOptions *options, BatchRow *row) {
+    int fields[3];
+    const char *error = NULL;
+    LunarDay result = {0};
+
+    if (!parse_int_fields(line, fields, 3)) {
+        error = "unparsable date";
+    } else if (options->direction == BATCH_LUNAR_TO_GREGORIAN) {
+        int greg_year, greg_month, greg_day;
+        if (lunar_to_gregorian_cached(cache, fields[0], fields[1], fields[2], &greg_year, &greg_month, &greg_day)) {
+            result = gregorian_to_lunar_cached(cache, greg_year, greg_month, greg_day);
+            /* The lunar columns must echo the input; never emit a row that contradicts it */
+            if (result.lunar_year != fields[0] || result.lunar_month != fields[1] || result.lunar_day != fields[2]) {
+                error = "conversion failed";
+            }
+        } else {
+            error = "invalid lunar date";
+        }
+    } else if (!is_valid_gregorian_date(fields[0], fields[1], fields[2])) {
+        error = "invalid gregorian date";
+    } else {
+        result = gregorian_to_lunar_cached(cache, fields[0], fields[1], fields[2]);
+        if (result.lunar_month == 0) {
+            error = "conversion failed";
+        }
+    }
+
+    row_text(row, line);
+    if (error != NULL) {
+        for (size_t i = 1; i < BATCH_COLUMN_COUNT - 1; i++) {
+            row_empty(row);
+        }
+        row_text(row, error);
+        row_end(row);
+        return false;
+    }
+
+    row_date(row, result.greg_year, result.greg_month, result.greg_day);
+    row_int(row, result.lunar_year);
+    row_int(row, result.lunar_month);
+    row_int(row, result.lunar_day);
+    row_text(row, get_weekday_name(result.weekday));
+    row_text(row, get_moon_phase_name(result.moon_phase));
+    row_int(row, result.eld_year);
+    row_int(row, result.metonic_year);
+    row_int(row, result.metonic_cycle);
+    row_empty(row);
+    row_end(row);
+    return true;
+}
+
+/**
+ * @brief Convert every date in the input stream
+ */
+long run_batch(FILE *in, FILE *out, const BatchOptions *options) {
+    char line[BATCH_LINE_MAX];
+    BatchRow row;
+    LunarCache cache;
+    long failures = 0;
+    bool truncated = false;
+
+    lunar_cache_init(&cache);
+    row.format = options->format;
+
+    if (options->header && options->format != BATCH_FORMAT_JSONL) {
+        batch_write_header(out, options);
+    }
+
+    while (fgets(line, sizeof(line), in) != NULL) {
+        size_t len = strlen(line);
+        bool complete = len > 0 && line[len - 1] == '\n';
+
+        /* Skip the remainder of an over-long line */
+        if (truncated) {
+            truncated = !complete;
+            continue;
+        }
+        if (!complete && !feof(in)) {
+            truncated = true;
+            line[0] = '\0';
+            len = 0;
+            row.len = 0;
+            row.column = 0;
+            row_text(&row, "");
+            for (size_t i = 1; i < BATCH_COLUMN_COUNT - 1; i++) row_empty(&row);
+            row_text(&row, "line too long");
+            row_end(&row);
+            fwrite(row.data, 1, row.len, out);
+            failures++;
+            continue;
+        }
+
+        /* Trim surrounding whitespace (including CR from CRLF input) */
+        while (len > 0 && isspace((unsigned char)line[len - 1])) {
+            line[--len] = '\0';
+        }
+        char *start = line;
+        while (isspace((unsigned char)*start)) start++;
+        if (*start == '\0' || *start == '#') {
+            continue;
+        }
+
+        row.len = 0;
+        row.column = 0;
+        if (!batch_convert_line(&cache, start, options, &row)) {
+            failures++;
+        }
+        fwrite(row.data, 1, row.len, out);
+    }
+
+    if (fflush(out) != 0 || ferror(out)) {
+        return -1;
+    }
+    return failures;
+}
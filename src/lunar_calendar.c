@@ -1,8 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <math.h>
+#include <string.h>
+#include <stdint.h>
 #include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include "../include/lunar_calendar.h"
+#include "../include/lunar_stats.h"
+#include "../include/lunar_logger.h"
 
 // --- Constants ---
 #define GERMANIC_EPOCH_BC 750 
@@ -18,9 +25,86 @@
 #define RAD_TO_DEG(rad) ((rad) * 180.0 / PI)
 #define DEG_TO_RAD(deg) ((deg) * PI / 180.0)
 
+/* The trig-heavy phase series, built for baseline x86-64 and for x86-64-v3
+ * (AVX2, FMA) with the variant picked for the CPU at load time. Only the
+ * optimized builds define LUNAR_MULTIVERSION (make release / make pgo):
+ * fused multiply-adds round differently in the last bits. */
+#if defined(LUNAR_MULTIVERSION) && defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define PHASE_KERNEL __attribute__((target_clones("default", "arch=x86-64-v3")))
+#define PHASE_KERNEL_VARIANT 1
+#else
+#define PHASE_KERNEL
+#define PHASE_KERNEL_VARIANT 0
+#endif
+
 // --- Internal Helper Function Declarations ---
 double calculate_mean_phase_jd(double k, int phase_type); 
 double calculate_true_phase_jd(double k, int phase_type);
+static double true_phase_jd(double k, int phase_type);
+
+// --- Contexts and Diagnostics ---
+
+/* Lunar years a shared context memoizes */
+#define CONTEXT_TABLE_FIRST_YEAR -1000
+#define CONTEXT_TABLE_LAST_YEAR 4000
+#define LOG_MESSAGE_MAX 512
+
+struct LunarContext {
+    unsigned flags;
+    LunarCache cache;              /* Private contexts */
+    LunarYearTable *years;         /* Shared contexts */
+    LunarLogCallback log_callback; /* NULL: stderr */
+    void *log_user_data;
+    LunarLogLevel log_level;
+    bool use_utc_offset;           /* Otherwise today is in the local time zone */
+    int utc_offset_minutes;
+    bool has_today;
+    int today_day_number;
+    double phase_tolerance;
+};
+
+/* Context the plain functions use on this thread, or NULL for the defaults */
+static _Thread_local LunarContext *t_active_context;
+
+/* Report a diagnostic through the active context */
+static void lunar_log(LunarLogLevel level, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static void lunar_log(LunarLogLevel level, const char *format, ...) {
+    const LunarContext *ctx = t_active_context;
+    char message[LOG_MESSAGE_MAX];
+    va_list args;
+
+    if (ctx != NULL ? level > ctx->log_level : !lunar_logger_enabled(NULL, level)) {
+        return;
+    }
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    if (ctx != NULL && ctx->log_callback != NULL) {
+        ctx->log_callback(level, message, ctx->log_user_data);
+    } else {
+        lunar_logger_log(NULL, level, "%s", message);
+    }
+}
+
+static double active_phase_tolerance(void) {
+    return t_active_context != NULL ? t_active_context->phase_tolerance : MOON_PHASE_TOLERANCE_DAYS;
+}
+
+/* Activate ctx (NULL: keep the active one) for one call; returns what to restore */
+static LunarContext *context_enter(LunarContext *ctx) {
+    LunarContext *previous = t_active_context;
+    if (ctx != NULL) {
+        t_active_context = ctx;
+    }
+    return previous;
+}
+
+static void context_leave(LunarContext *previous) {
+    t_active_context = previous;
+}
 
 // --- Julian Day Conversion ---
 
@@ -82,6 +166,25 @@ void julian_day_to_gregorian(double julian_day, int *year, int *month, int *day,
 }
 
 
+/**
+ * @brief Convert a day number (JDN) to a proleptic Gregorian date.
+ * Inverse of floor(gregorian_to_julian_day(y, m, d, 12.0)) for all years;
+ * julian_day_to_gregorian switches to the Julian calendar before 1582.
+ */
+void day_number_to_gregorian(int day_number, int *year, int *month, int *day) {
+    /* Days since 0000-03-01, split into 400-year eras */
+    long long days = (long long)day_number - 1721120;
+    long long era = (days >= 0 ? days : days - 146096) / 146097;
+    long long day_of_era = days - era * 146097;
+    long long year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    long long day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    long long shifted_month = (5 * day_of_year + 2) / 153;
+
+    *day = (int)(day_of_year - (153 * shifted_month + 2) / 5 + 1);
+    *month = (int)(shifted_month < 10 ? shifted_month + 3 : shifted_month - 9);
+    *year = (int)(year_of_era + era * 400 + (*month <= 2 ? 1 : 0));
+}
+
 // --- Gregorian Calendar Helpers ---
 
 /**
@@ -92,20 +195,28 @@ bool is_gregorian_leap_year(int year) {
 }
 
 /**
- * @brief Calculate the weekday for a given Gregorian date (Zeller's congruence)
+ * @brief Check that a Gregorian date exists
  */
-Weekday calculate_weekday(int year, int month, int day) {
-    if (month < 3) {
-        month += 12;
-        year--;
+bool is_valid_gregorian_date(int year, int month, int day) {
+    static const int days_in_month[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if (month < 1 || month > 12 || day < 1) {
+        return false;
     }
-    int K = year % 100;
-    int J = year / 100;
-    // Using Meeus' version of Zeller's congruence for Gregorian calendar
-    int h = (day + (int)floor(13.0 * (month + 1.0) / 5.0) + K + K/4 + J/4 + 5*J) % 7;
-    
-    // Convert result (0=Sat, 1=Sun, ...) to 0=Sun, 1=Mon, ...
-    return (Weekday)((h + 1) % 7); 
+    int length = days_in_month[month - 1];
+    if (month == 2 && is_gregorian_leap_year(year)) {
+        length = 29;
+    }
+    return day <= length;
+}
+
+/**
+ * @brief Calculate the weekday for a given Gregorian date
+ * Uses the Julian Day Number, which also holds for years before 1 CE.
+ */
+Weekday calculate_weekday(int year, int month, int day) {
+    long jdn = (long)floor(gregorian_to_julian_day(year, month, day, 12.0));
+    // JDN 0 was a Monday; convert to 0=Sun, 1=Mon, ...
+    return (Weekday)(((jdn + 1) % 7 + 7) % 7);
 }
 
 // --- Solstice/Equinox Calculation ---
@@ -133,7 +244,7 @@ double calculate_solstice_equinox_jde(int year, int season) {
              JDE0 = 2451810.21715 + 365242.01767 * y - 0.11575 * y * y;
             break;
         default:
-            fprintf(stderr, "Error: Invalid season %d in calculate_solstice_equinox_jde\\n", season);
+            lunar_log(LUNAR_LOG_ERROR, "Invalid season %d in calculate_solstice_equinox_jde", season);
             return 0; // Invalid season
     }
     // Note: Neglects periodic terms and Delta T correction for simplicity.
@@ -205,7 +316,8 @@ double calculate_mean_phase_jd(double k, int phase_type) {
  * @brief Calculate the true Julian Day (UT) for the k-th phase, including corrections.
  * phase_type: 0=NM, 1=FQ, 2=FM, 3=LQ
  */
-double calculate_true_phase_jd(double k, int phase_type) {
+PHASE_KERNEL double calculate_true_phase_jd(double k, int phase_type) {
+    LUNAR_STATS_TIMER_START(timer);
     double jde_mean = calculate_mean_phase_jd(k, phase_type);
     double T = (jde_mean - J2000_EPOCH) / DAYS_PER_JULIAN_CENTURY;
     
@@ -237,14 +349,14 @@ double calculate_true_phase_jd(double k, int phase_type) {
         corrections += +0.00797 * E * sin(M_moon - M_sun) + 0.00691 * sin(2 * F_moon);
     }
     // Add more periodic terms for higher accuracy if needed
+    LUNAR_STATS_TIMER_STOP(LUNAR_STAT_TRUE_PHASE, timer);
     return jde_mean + corrections;
 }
 
 /**
- * @brief Find the Julian Day (UT) of the first occurrence of a specific phase 
- * (0=NM, 1=FQ, 2=FM, 3=LQ) *after* a given Julian Day (start_jd).
+ * @brief Search for the first phase instant after start_jd; see find_next_phase_jd.
  */
-double find_next_phase_jd(double start_jd, int phase_type) {
+static double search_next_phase_jd(double start_jd, int phase_type) {
     double k_approx = (start_jd - 2451550.09766) / LUNAR_CYCLE_DAYS; 
     k_approx -= (double)phase_type / 4.0; 
     double k = floor(k_approx); 
@@ -255,19 +367,19 @@ double find_next_phase_jd(double start_jd, int phase_type) {
     double epsilon = 1e-5; // Tolerance for comparison
     
     while (iterations < MAX_ITERATIONS) { 
-        phase_jd = calculate_true_phase_jd(k, phase_type);
+        phase_jd = true_phase_jd(k, phase_type);
         if (phase_jd >= start_jd - epsilon) { 
             // If it's very close or slightly before, try next k to ensure it's strictly *after*
             if (phase_jd < start_jd + epsilon) { 
                 k += 1.0;
-                phase_jd = calculate_true_phase_jd(k, phase_type);
+                phase_jd = true_phase_jd(k, phase_type);
             }
             // Check for calculation error (returned 0?)
              if (phase_jd == 0 && k > 0) { 
-                 fprintf(stderr, "Error: calculate_true_phase_jd returned 0 unexpectedly for k=%.1f, phase=%d\n", k, phase_type);
+                 lunar_log(LUNAR_LOG_ERROR, "calculate_true_phase_jd returned 0 unexpectedly for k=%.1f, phase=%d", k, phase_type);
                  // Attempt recovery? Maybe try k+1?
                  k += 1.0;
-                 phase_jd = calculate_true_phase_jd(k, phase_type);
+                 phase_jd = true_phase_jd(k, phase_type);
                  if (phase_jd == 0) return 0; // Still failed
              }
             return phase_jd;
@@ -276,61 +388,116 @@ double find_next_phase_jd(double start_jd, int phase_type) {
         iterations++;
     }
     
-    fprintf(stderr, "Warning: find_next_phase_jd failed to converge for start_jd=%.4f, phase=%d. Returning estimate.\n", start_jd, phase_type);
-    return calculate_true_phase_jd(floor(k_approx) + 1.0, phase_type); 
+    lunar_log(LUNAR_LOG_WARNING, "find_next_phase_jd failed to converge for start_jd=%.4f, phase=%d. Returning estimate.", start_jd, phase_type);
+    return true_phase_jd(floor(k_approx) + 1.0, phase_type); 
 }
 
 /**
- * @brief Calculate the moon phase for a given Julian Day (UT)
+ * @brief Find the Julian Day (UT) of the first occurrence of a specific phase 
+ * (0=NM, 1=FQ, 2=FM, 3=LQ) *after* a given Julian Day (start_jd).
  */
-MoonPhase calculate_moon_phase_from_jd(double jd) {
-    double k_approx = (jd - 2451550.09766) / LUNAR_CYCLE_DAYS;
-    double k_base = floor(k_approx);
+double find_next_phase_jd(double start_jd, int phase_type) {
+    LUNAR_STATS_TIMER_START(timer);
+    double phase_jd = search_next_phase_jd(start_jd, phase_type);
+    LUNAR_STATS_TIMER_STOP(LUNAR_STAT_NEXT_PHASE, timer);
+    return phase_jd;
+}
+
+/**
+ * @brief Compute the phase instants of the lunation starting at mean new moon k_base.
+ * Falls back to a sequential search if the instants come out of order; valid is
+ * false if that fails as well.
+ */
+static void compute_lunation_phases(double k_base, LunationPhases *phases) {
     double epsilon = 1e-5;
 
-    double nm0_jd = calculate_true_phase_jd(k_base, 0); 
-    double fq0_jd = find_next_phase_jd(nm0_jd - epsilon, 1); 
-    double fm0_jd = find_next_phase_jd(nm0_jd - epsilon, 2); 
-    double lq0_jd = find_next_phase_jd(nm0_jd - epsilon, 3); 
-    double nm1_jd = find_next_phase_jd(nm0_jd + epsilon, 0); 
-
-    if (jd < nm0_jd + epsilon) { // Check if before the calculated NM0
-       nm1_jd = nm0_jd;
-       // Find phases for the previous lunation
-       lq0_jd = calculate_true_phase_jd(k_base - 1.0, 3);
-       fm0_jd = calculate_true_phase_jd(k_base - 1.0, 2);
-       fq0_jd = calculate_true_phase_jd(k_base - 1.0, 1);
-       nm0_jd = calculate_true_phase_jd(k_base - 1.0, 0);
-    } else if (!(nm0_jd < fq0_jd && fq0_jd < fm0_jd && fm0_jd < lq0_jd && lq0_jd < nm1_jd)) {
-        // Fallback if phases are out of order
-        fprintf(stderr, "Warning: Moon phase boundaries disordered for JD %.4f. Recalculating sequentially.\n", jd);
-        fq0_jd = find_next_phase_jd(nm0_jd, 1);
-        fm0_jd = find_next_phase_jd(fq0_jd, 2);
-        lq0_jd = find_next_phase_jd(fm0_jd, 3);
-        nm1_jd = find_next_phase_jd(lq0_jd, 0);
-        if (!(nm0_jd < fq0_jd && fq0_jd < fm0_jd && fm0_jd < lq0_jd && lq0_jd < nm1_jd)) {
-            fprintf(stderr, "Error: Sequential recalculation failed. Cannot determine phase for JD %.4f.\n", jd);
-            return NEW_MOON; 
-        }
+    phases->k_base = k_base;
+    phases->new_moon = true_phase_jd(k_base, 0);
+    phases->first_quarter = find_next_phase_jd(phases->new_moon - epsilon, 1);
+    phases->full_moon = find_next_phase_jd(phases->new_moon - epsilon, 2);
+    phases->last_quarter = find_next_phase_jd(phases->new_moon - epsilon, 3);
+    phases->next_new_moon = find_next_phase_jd(phases->new_moon + epsilon, 0);
+    phases->valid = true;
+    phases->computed = true;
+}
+
+/**
+ * @brief Check the phase instants are in order, recalculating them sequentially if not.
+ */
+static void order_lunation_phases(double jd, LunationPhases *phases) {
+    if (phases->new_moon < phases->first_quarter && phases->first_quarter < phases->full_moon &&
+        phases->full_moon < phases->last_quarter && phases->last_quarter < phases->next_new_moon) {
+        return;
     }
-    
-    double tolerance = 0.75; // Tolerance for primary phase names
 
-    if (fabs(jd - nm0_jd) < tolerance || fabs(jd - nm1_jd) < tolerance) return NEW_MOON;
-    if (fabs(jd - fq0_jd) < tolerance) return FIRST_QUARTER;
-    if (fabs(jd - fm0_jd) < tolerance) return FULL_MOON;
-    if (fabs(jd - lq0_jd) < tolerance) return LAST_QUARTER;
+    lunar_log(LUNAR_LOG_WARNING, "Moon phase boundaries disordered for JD %.4f. Recalculating sequentially.", jd);
+    phases->first_quarter = find_next_phase_jd(phases->new_moon, 1);
+    phases->full_moon = find_next_phase_jd(phases->first_quarter, 2);
+    phases->last_quarter = find_next_phase_jd(phases->full_moon, 3);
+    phases->next_new_moon = find_next_phase_jd(phases->last_quarter, 0);
+    if (!(phases->new_moon < phases->first_quarter && phases->first_quarter < phases->full_moon &&
+          phases->full_moon < phases->last_quarter && phases->last_quarter < phases->next_new_moon)) {
+        phases->valid = false;
+    }
+}
 
-    if (jd > nm0_jd && jd < fq0_jd) return WAXING_CRESCENT;
-    if (jd > fq0_jd && jd < fm0_jd) return WAXING_GIBBOUS;
-    if (jd > fm0_jd && jd < lq0_jd) return WANING_GIBBOUS;
-    if (jd > lq0_jd && jd < nm1_jd) return WANING_CRESCENT;
+/**
+ * @brief Compute the phase instants of the lunation before mean new moon k_base.
+ */
+static void compute_previous_lunation_phases(double k_base, LunationPhases *phases) {
+    phases->k_base = k_base;
+    phases->next_new_moon = true_phase_jd(k_base, 0);
+    phases->last_quarter = true_phase_jd(k_base - 1.0, 3);
+    phases->full_moon = true_phase_jd(k_base - 1.0, 2);
+    phases->first_quarter = true_phase_jd(k_base - 1.0, 1);
+    phases->new_moon = true_phase_jd(k_base - 1.0, 0);
+    phases->valid = true;
+    phases->computed = true;
+}
+
+/**
+ * @brief Name the phase of a Julian Day within a lunation.
+ */
+static MoonPhase classify_moon_phase(double jd, const LunationPhases *phases) {
+    if (!phases->valid) {
+        lunar_log(LUNAR_LOG_ERROR, "Sequential recalculation failed. Cannot determine phase for JD %.4f.", jd);
+        return NEW_MOON;
+    }
+
+    double tolerance = active_phase_tolerance(); // Tolerance for primary phase names
+
+    if (fabs(jd - phases->new_moon) < tolerance || fabs(jd - phases->next_new_moon) < tolerance) return NEW_MOON;
+    if (fabs(jd - phases->first_quarter) < tolerance) return FIRST_QUARTER;
+    if (fabs(jd - phases->full_moon) < tolerance) return FULL_MOON;
+    if (fabs(jd - phases->last_quarter) < tolerance) return LAST_QUARTER;
+
+    if (jd > phases->new_moon && jd < phases->first_quarter) return WAXING_CRESCENT;
+    if (jd > phases->first_quarter && jd < phases->full_moon) return WAXING_GIBBOUS;
+    if (jd > phases->full_moon && jd < phases->last_quarter) return WANING_GIBBOUS;
+    if (jd > phases->last_quarter && jd < phases->next_new_moon) return WANING_CRESCENT;
 
-    fprintf(stderr, "Warning: Could not classify moon phase for JD %.4f. Boundaries: NM0=%.2f, FQ=%.2f, FM=%.2f, LQ=%.2f, NM1=%.2f. Returning New Moon.\n", 
-            jd, nm0_jd, fq0_jd, fm0_jd, lq0_jd, nm1_jd);
+    lunar_log(LUNAR_LOG_WARNING, "Could not classify moon phase for JD %.4f. Boundaries: NM0=%.2f, FQ=%.2f, FM=%.2f, LQ=%.2f, NM1=%.2f. Returning New Moon.",
+            jd, phases->new_moon, phases->first_quarter, phases->full_moon, phases->last_quarter, phases->next_new_moon);
     return NEW_MOON; 
 }
 
+/**
+ * @brief Calculate the moon phase for a given Julian Day (UT)
+ */
+MoonPhase calculate_moon_phase_from_jd(double jd) {
+    double k_base = floor((jd - 2451550.09766) / LUNAR_CYCLE_DAYS);
+    double epsilon = 1e-5;
+    LunationPhases phases;
+
+    compute_lunation_phases(k_base, &phases);
+    if (jd < phases.new_moon + epsilon) { // Check if before the calculated NM0
+        compute_previous_lunation_phases(k_base, &phases);
+    } else {
+        order_lunation_phases(jd, &phases);
+    }
+    return classify_moon_phase(jd, &phases);
+}
+
 /**
  * @brief Calculate the moon phase for a given Gregorian date
  */
@@ -340,60 +507,176 @@ MoonPhase calculate_moon_phase(int year, int month, int day) {
 }
 
 
+/**
+ * @brief Find the first instant of a phase (0=NM, 2=FM) within a Gregorian month.
+ * Returns false if the month has none (possible only in February).
+ */
+static bool find_phase_in_month(int year, int month, int phase_type, int *phase_day, double *phase_hour) {
+    if (month < 1 || month > 12) {
+        return false;
+    }
+
+    double month_start_jd = gregorian_to_julian_day(year, month, 1, 0.0);
+    double phase_jd = find_next_phase_jd(month_start_jd - 1e-4, phase_type);
+    if (phase_jd == 0) {
+        return false;
+    }
+
+    int phase_year, phase_month;
+    julian_day_to_gregorian(phase_jd, &phase_year, &phase_month, phase_day, phase_hour);
+    return phase_year == year && phase_month == month;
+}
+
+/**
+ * @brief Calculate the day and UT hour of the first new moon in a Gregorian month
+ */
+bool calculate_new_moon(int year, int month, int *new_moon_day, double *new_moon_hour) {
+    return find_phase_in_month(year, month, 0, new_moon_day, new_moon_hour);
+}
+
+/**
+ * @brief Calculate the day and UT hour of the first full moon in a Gregorian month
+ */
+bool calculate_full_moon(int year, int month, int *full_moon_day, double *full_moon_hour) {
+    return find_phase_in_month(year, month, 2, full_moon_day, full_moon_hour);
+}
+
 // --- Core Lunar Calendar Logic (Based on New Rules) ---
 
 /**
- * @brief Calculate the Julian Day (UT) of the start of the specified lunar year.
+ * @brief Full moon opening a lunar year; see calculate_lunar_new_year_jd.
  */
-double calculate_lunar_new_year_jd(int gregorian_year_of_start) {
+static double compute_lunar_new_year_jd(int gregorian_year_of_start) {
     int ws_year = gregorian_year_of_start - 1;
     double ws_jd = calculate_solstice_equinox_jde(ws_year, 0);
     if (ws_jd == 0) {
         ws_jd = gregorian_to_julian_day(ws_year, 12, 21, 12.0); 
-        fprintf(stderr, "Warning: Using approximate WS JD for year %d in New Year calc.\n", ws_year);
+        lunar_log(LUNAR_LOG_WARNING, "Using approximate WS JD for year %d in New Year calc.", ws_year);
     }
     double first_nm_jd = find_next_phase_jd(ws_jd, 0);
     if (first_nm_jd == 0) {
-         fprintf(stderr, "Error: Could not find New Moon after WS JD %.4f\\n", ws_jd);
+         lunar_log(LUNAR_LOG_ERROR, "Could not find New Moon after WS JD %.4f", ws_jd);
          return 0; 
     }
     double first_fm_jd = find_next_phase_jd(first_nm_jd, 2);
      if (first_fm_jd == 0) {
-         fprintf(stderr, "Error: Could not find Full Moon after NM JD %.4f\\n", first_nm_jd);
+         lunar_log(LUNAR_LOG_ERROR, "Could not find Full Moon after NM JD %.4f", first_nm_jd);
          return 0; 
     }
     return first_fm_jd;
 }
 
+/**
+ * @brief Calculate the Julian Day (UT) of the start of the specified lunar year.
+ */
+double calculate_lunar_new_year_jd(int gregorian_year_of_start) {
+    LUNAR_STATS_TIMER_START(timer);
+    double new_year_jd = compute_lunar_new_year_jd(gregorian_year_of_start);
+    LUNAR_STATS_TIMER_STOP(LUNAR_STAT_NEW_YEAR, timer);
+    return new_year_jd;
+}
+
+/**
+ * @brief Calculate the Gregorian date of the Germanic New Year: the day of the
+ * first full moon after the first new moon after the preceding winter solstice.
+ */
+int calculate_germanic_new_year(int year, int *month, int *day) {
+    double new_year_jd = calculate_lunar_new_year_jd(year);
+    if (new_year_jd == 0) {
+        return 0;
+    }
+
+    int new_year_year;
+    double hour_unused;
+    julian_day_to_gregorian(new_year_jd, &new_year_year, month, day, &hour_unused);
+    return 1;
+}
+
 /**
  * @brief Calculate the number of lunar months in a given lunar year.
+ * Counts the year's boundaries, so the active context's table is reused.
  */
 int get_lunar_months_in_year(int lunar_year_identifier) {
-    double year_start_jd = calculate_lunar_new_year_jd(lunar_year_identifier);
-    double next_year_start_jd = calculate_lunar_new_year_jd(lunar_year_identifier + 1);
-    if (year_start_jd == 0 || next_year_start_jd == 0) {
-        fprintf(stderr, "Error: Could not calculate New Year JDs for year id %d. Falling back to 12 months.\n", lunar_year_identifier);
+    LunarYearBoundaries bounds;
+    if (!lunar_ctx_year_boundaries(NULL, lunar_year_identifier, &bounds)) {
+        lunar_log(LUNAR_LOG_ERROR, "Could not calculate New Year JDs for year id %d. Falling back to 12 months.", lunar_year_identifier);
         return 12; 
     }
+    return bounds.months_count;
+}
 
-    int full_moon_count = 0;
-    double current_fm_jd = year_start_jd; 
+/**
+ * @brief Fill the month boundaries of a lunar year whose start and the next
+ * year's start are already known, walking the full moons in between once.
+ */
+static bool lunar_year_boundaries_between(int lunar_year_identifier, double year_start_jd,
+                                          double next_year_start_jd, LunarYearBoundaries *bounds) {
     double epsilon = 1e-5;
+    double current_fm_jd = year_start_jd;
+    int months = 1;
+
+    bounds->lunar_year = lunar_year_identifier;
+    bounds->month_start_jd[0] = year_start_jd;
 
-    while (1) {
+    while (months < 13) {
         current_fm_jd = find_next_phase_jd(current_fm_jd, 2);
-        if (current_fm_jd == 0) { 
-             fprintf(stderr, "Error: Failed finding next FM during month count for year %d.\n", lunar_year_identifier);
-             return 12; // Fallback
+        if (current_fm_jd == 0) {
+            return false;
         }
-        // Check if the found FM is strictly before the next year starts
-        if (current_fm_jd < next_year_start_jd - epsilon) {
-            full_moon_count++;
-        } else {
-            break; // Found FM is on or after next year start
+        if (current_fm_jd >= next_year_start_jd - epsilon) {
+            break;
         }
+        bounds->month_start_jd[months++] = current_fm_jd;
     }
-    return full_moon_count + 1; // Add 1 for the first month
+
+    bounds->months_count = months;
+    bounds->month_start_jd[months] = next_year_start_jd;
+    return true;
+}
+
+/**
+ * @brief Calculate the start JD of every month of a lunar year.
+ * Walks the full moons from the year's start to the next year's start once,
+ * so callers needing several months of the same year avoid repeated searches.
+ */
+bool calculate_lunar_year_boundaries(int lunar_year_identifier, LunarYearBoundaries *bounds) {
+    LUNAR_STATS_TIMER_START(timer);
+    double year_start_jd = calculate_lunar_new_year_jd(lunar_year_identifier);
+    double next_year_start_jd = calculate_lunar_new_year_jd(lunar_year_identifier + 1);
+    bool found = year_start_jd != 0 && next_year_start_jd != 0 &&
+                 lunar_year_boundaries_between(lunar_year_identifier, year_start_jd, next_year_start_jd, bounds);
+    LUNAR_STATS_TIMER_STOP(LUNAR_STAT_YEAR_BOUNDARIES, timer);
+    return found;
+}
+
+/**
+ * @brief Day number (JDN) of the first day of a month starting at month_start_jd.
+ * A day belongs to the month once its noon is past the full moon, as in gregorian_to_lunar.
+ */
+static int lunar_month_first_day(double month_start_jd) {
+    return (int)ceil(month_start_jd - 1e-5);
+}
+
+/**
+ * @brief Day number (JDN) of the first day of a month of a lunar year.
+ * month may be months_count + 1, giving the first day of the next year.
+ */
+int lunar_month_start_day(const LunarYearBoundaries *bounds, int month) {
+    return lunar_month_first_day(bounds->month_start_jd[month - 1]);
+}
+
+/**
+ * @brief Calculate the number of days (29 or 30) in a month of a lunar year.
+ * Returns 0 if the month does not exist.
+ */
+int calculate_lunar_month_length(int lunar_year_identifier, int month) {
+    LunarYearBoundaries bounds;
+    if (!lunar_ctx_year_boundaries(NULL, lunar_year_identifier, &bounds) ||
+        month < 1 || month > bounds.months_count) {
+        return 0;
+    }
+    return lunar_month_first_day(bounds.month_start_jd[month]) -
+           lunar_month_first_day(bounds.month_start_jd[month - 1]);
 }
 
 /**
@@ -410,6 +693,13 @@ int calculate_eld_year_from_gregorian(int gregorian_year) {
     return gregorian_year + GERMANIC_EPOCH_BC;
 }
 
+/**
+ * @brief Calculate the Germanic Eld year from a Gregorian year
+ */
+int calculate_eld_year(int gregorian_year) {
+    return calculate_eld_year_from_gregorian(gregorian_year);
+}
+
 /**
  * @brief Get the position of a *Lunar Year* (identified by its Gregorian start year) within the conceptual Metonic cycle
  */
@@ -426,126 +716,995 @@ void get_metonic_position(int lunar_year_identifier, int *metonic_year_pos, int
 
 /**
  * @brief Convert a Gregorian date to its corresponding lunar date based on the new rules.
+ * Computes the boundaries of the candidate lunar years once each.
  */
 LunarDay gregorian_to_lunar(int year, int month, int day) {
-    LunarDay result = {0}; 
+    return lunar_ctx_gregorian_to_lunar(NULL, year, month, day);
+}
+
+/**
+ * @brief Convert a lunar date (year, month, day based on new rules) to a Gregorian date.
+ */
+bool lunar_to_gregorian(int lunar_year_id, int lunar_month, int lunar_day, 
+                        int *greg_year, int *greg_month, int *greg_day) {
+    return lunar_ctx_lunar_to_gregorian(NULL, lunar_year_id, lunar_month, lunar_day,
+                                        greg_year, greg_month, greg_day);
+}
+
+// --- Shared Year Table ---
+
+/* Cache files (lunar_year_table_save): a header of little-endian 32-bit
+ * fields, the year records, runs of consecutive phase instants and an
+ * FNV-1a checksum of everything before it */
+#define TABLE_FILE_MAGIC 0x4354594Cu   /* "LYTC" */
+#define TABLE_FILE_VERSION 1
+#define TABLE_FILE_HEADER_BYTES 28
+/* The multiversioned phase series rounds differently; keep its files apart */
+#define TABLE_FILE_ALGORITHM ((uint32_t)LUNAR_ALGORITHM_VERSION | (PHASE_KERNEL_VARIANT << 16))
+
+struct LunarYearTable {
+    int first_year;
+    int last_year;
+    LunarYearBoundaries *years;
+    atomic_uchar *ready;         /* Set (release) once years[i] is published */
+    int first_k;                 /* Lunations whose phase instants are kept */
+    int last_k;
+    double *phases;              /* Instant of phase p of lunation k at (k - first_k) * 4 + p */
+    atomic_uchar *phase_ready;
+    pthread_mutex_t publish_lock;
+};
+
+/**
+ * @brief Create a shared table for lunar years first_year..last_year.
+ * The phase instants kept are those of the lunations from the winter solstice
+ * before first_year to the end of last_year + 1, with a margin for searches.
+ */
+LunarYearTable *lunar_year_table_new(int first_year, int last_year) {
+    if (last_year < first_year) {
+        return NULL;
+    }
+    size_t count = (size_t)last_year - (size_t)first_year + 1;
+    LunarYearTable *table = calloc(1, sizeof(LunarYearTable));
+    if (table == NULL) {
+        return NULL;
+    }
+    table->first_year = first_year;
+    table->last_year = last_year;
+    table->first_k = (int)floor((first_year - 2001) * 365.2425 / LUNAR_CYCLE_DAYS) - 2;
+    table->last_k = (int)ceil((last_year - 1998) * 365.2425 / LUNAR_CYCLE_DAYS) + 2;
+    size_t phase_count = ((size_t)table->last_k - (size_t)table->first_k + 1) * 4;
+    pthread_mutex_init(&table->publish_lock, NULL);
+    table->years = malloc(count * sizeof(LunarYearBoundaries));
+    table->ready = calloc(count, sizeof(atomic_uchar));
+    table->phases = malloc(phase_count * sizeof(double));
+    table->phase_ready = calloc(phase_count, sizeof(atomic_uchar));
+    if (table->years == NULL || table->ready == NULL || table->phases == NULL || table->phase_ready == NULL) {
+        lunar_year_table_free(table);
+        return NULL;
+    }
+    return table;
+}
+
+/**
+ * @brief Free a shared year table; no thread may still be using it.
+ */
+void lunar_year_table_free(LunarYearTable *table) {
+    if (table == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&table->publish_lock);
+    free(table->years);
+    free(table->ready);
+    free(table->phases);
+    free(table->phase_ready);
+    free(table);
+}
+
+/**
+ * @brief Forget every year and phase instant of a table.
+ */
+void lunar_year_table_clear(LunarYearTable *table) {
+    size_t count = (size_t)(table->last_year - table->first_year) + 1;
+    size_t phase_count = ((size_t)(table->last_k - table->first_k) + 1) * 4;
+
+    pthread_mutex_lock(&table->publish_lock);
+    for (size_t i = 0; i < count; i++) {
+        atomic_store_explicit(&table->ready[i], 0, memory_order_relaxed);
+    }
+    for (size_t i = 0; i < phase_count; i++) {
+        atomic_store_explicit(&table->phase_ready[i], 0, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&table->publish_lock);
+}
+
+/**
+ * @brief Get the boundaries of a lunar year from a shared table.
+ * Two threads missing the same year may both compute it; the first to
+ * publish wins and the results are identical.
+ */
+bool lunar_year_table_get(LunarYearTable *table, int lunar_year_id, LunarYearBoundaries *bounds) {
+    if (lunar_year_id < table->first_year || lunar_year_id > table->last_year) {
+        return calculate_lunar_year_boundaries(lunar_year_id, bounds);
+    }
+
+    size_t index = (size_t)(lunar_year_id - table->first_year);
+    if (atomic_load_explicit(&table->ready[index], memory_order_acquire)) {
+        *bounds = table->years[index];
+        return true;
+    }
+
+    if (!calculate_lunar_year_boundaries(lunar_year_id, bounds)) {
+        return false;
+    }
+    pthread_mutex_lock(&table->publish_lock);
+    if (!atomic_load_explicit(&table->ready[index], memory_order_relaxed)) {
+        table->years[index] = *bounds;
+        atomic_store_explicit(&table->ready[index], 1, memory_order_release);
+    }
+    pthread_mutex_unlock(&table->publish_lock);
+    return true;
+}
+
+/**
+ * @brief Instant of a phase of lunation k, from the active context's table
+ * when it has one; every phase search and lunation goes through here.
+ */
+static double true_phase_jd(double k, int phase_type) {
+    LunarYearTable *table = t_active_context != NULL ? t_active_context->years : NULL;
+    if (table == NULL || phase_type < 0 || phase_type > 3 || k != floor(k) ||
+        k < table->first_k || k > table->last_k) {
+        return calculate_true_phase_jd(k, phase_type);
+    }
+
+    size_t index = (size_t)((int)k - table->first_k) * 4 + (size_t)phase_type;
+    if (atomic_load_explicit(&table->phase_ready[index], memory_order_acquire)) {
+        return table->phases[index];
+    }
+
+    double jd = calculate_true_phase_jd(k, phase_type);
+    pthread_mutex_lock(&table->publish_lock);
+    if (!atomic_load_explicit(&table->phase_ready[index], memory_order_relaxed)) {
+        table->phases[index] = jd;
+        atomic_store_explicit(&table->phase_ready[index], 1, memory_order_release);
+    }
+    pthread_mutex_unlock(&table->publish_lock);
+    return jd;
+}
+
+// --- Cache Files ---
+
+static uint32_t fnv1a(const unsigned char *data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static unsigned char *put_u32(unsigned char *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        *out++ = (unsigned char)(value >> (8 * i));
+    }
+    return out;
+}
+
+static unsigned char *put_f64(unsigned char *out, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; i++) {
+        *out++ = (unsigned char)(bits >> (8 * i));
+    }
+    return out;
+}
+
+/* Bounds-checked reading of a loaded file */
+typedef struct {
+    const unsigned char *data;
+    size_t length;
+    size_t pos;
+    bool failed;
+} TableReader;
+
+static uint32_t get_u32(TableReader *reader) {
+    if (reader->length - reader->pos < 4) {
+        reader->failed = true;
+        return 0;
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (uint32_t)reader->data[reader->pos++] << (8 * i);
+    }
+    return value;
+}
+
+static double get_f64(TableReader *reader) {
+    if (reader->length - reader->pos < 8) {
+        reader->failed = true;
+        return 0;
+    }
+    uint64_t bits = 0;
+    double value;
+    for (int i = 0; i < 8; i++) {
+        bits |= (uint64_t)reader->data[reader->pos++] << (8 * i);
+    }
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/* Length of the run of published phase instants starting at index */
+static size_t phase_run_length(const LunarYearTable *table, size_t index, size_t phase_count) {
+    size_t end = index;
+    while (end < phase_count && atomic_load_explicit(&table->phase_ready[end], memory_order_relaxed)) {
+        end++;
+    }
+    return end - index;
+}
+
+/**
+ * @brief Write the computed years and phase instants of a table to a cache file.
+ * Written to a temporary file first and renamed, so readers never see half a file.
+ */
+bool lunar_year_table_save(LunarYearTable *table, const char *path) {
+    size_t count = (size_t)(table->last_year - table->first_year) + 1;
+    size_t phase_count = ((size_t)(table->last_k - table->first_k) + 1) * 4;
+    uint32_t year_records = 0, runs = 0;
+    size_t size = TABLE_FILE_HEADER_BYTES + 4;
+
+    /* Hold off publishers so the sizes counted are the sizes written */
+    pthread_mutex_lock(&table->publish_lock);
+    for (size_t i = 0; i < count; i++) {
+        if (atomic_load_explicit(&table->ready[i], memory_order_relaxed)) {
+            year_records++;
+            size += 8 + 8 * (size_t)(table->years[i].months_count + 1);
+        }
+    }
+    for (size_t i = 0; i < phase_count; ) {
+        size_t length = phase_run_length(table, i, phase_count);
+        if (length > 0) {
+            runs++;
+            size += 8 + 8 * length;
+        }
+        i += length > 0 ? length : 1;
+    }
+
+    unsigned char *data = malloc(size);
+    if (data == NULL) {
+        pthread_mutex_unlock(&table->publish_lock);
+        return false;
+    }
+    unsigned char *out = data;
+    out = put_u32(out, TABLE_FILE_MAGIC);
+    out = put_u32(out, TABLE_FILE_VERSION);
+    out = put_u32(out, TABLE_FILE_ALGORITHM);
+    out = put_u32(out, (uint32_t)table->first_year);
+    out = put_u32(out, (uint32_t)table->last_year);
+    out = put_u32(out, year_records);
+    out = put_u32(out, runs);
+    for (size_t i = 0; i < count; i++) {
+        const LunarYearBoundaries *bounds = &table->years[i];
+        if (!atomic_load_explicit(&table->ready[i], memory_order_relaxed)) {
+            continue;
+        }
+        out = put_u32(out, (uint32_t)bounds->lunar_year);
+        out = put_u32(out, (uint32_t)bounds->months_count);
+        for (int m = 0; m <= bounds->months_count; m++) {
+            out = put_f64(out, bounds->month_start_jd[m]);
+        }
+    }
+    for (size_t i = 0; i < phase_count; ) {
+        size_t length = phase_run_length(table, i, phase_count);
+        if (length > 0) {
+            /* Instants are numbered k * 4 + phase */
+            out = put_u32(out, (uint32_t)(table->first_k * 4 + (int)i));
+            out = put_u32(out, (uint32_t)length);
+            for (size_t j = 0; j < length; j++) {
+                out = put_f64(out, table->phases[i + j]);
+            }
+        }
+        i += length > 0 ? length : 1;
+    }
+    pthread_mutex_unlock(&table->publish_lock);
+    put_u32(out, fnv1a(data, size - 4));
+
+    size_t temp_length = strlen(path) + 5;
+    char *temp_path = malloc(temp_length);
+    bool written = false;
+    if (temp_path != NULL) {
+        snprintf(temp_path, temp_length, "%s.tmp", path);
+        FILE *file = fopen(temp_path, "wb");
+        written = file != NULL && fwrite(data, 1, size, file) == size;
+        if (file != NULL && fclose(file) != 0) {
+            written = false;
+        }
+        written = written && rename(temp_path, path) == 0;
+        if (!written) {
+            remove(temp_path);
+        }
+        free(temp_path);
+    }
+    free(data);
+    if (!written) {
+        lunar_log(LUNAR_LOG_ERROR, "Could not write cache file '%s'.", path);
+    }
+    return written;
+}
+
+/**
+ * @brief Publish the years and phase instants of a cache file into a table.
+ * Entries outside the table's window are skipped.
+ */
+static bool load_table_records(LunarYearTable *table, TableReader *reader, uint32_t year_records, uint32_t runs) {
+    for (uint32_t r = 0; r < year_records && !reader->failed; r++) {
+        LunarYearBoundaries bounds;
+        bounds.lunar_year = (int32_t)get_u32(reader);
+        bounds.months_count = (int32_t)get_u32(reader);
+        if (bounds.months_count < 12 || bounds.months_count > 13) {
+            return false;
+        }
+        for (int m = 0; m <= bounds.months_count; m++) {
+            bounds.month_start_jd[m] = get_f64(reader);
+        }
+        if (!reader->failed && bounds.lunar_year >= table->first_year && bounds.lunar_year <= table->last_year) {
+            size_t index = (size_t)(bounds.lunar_year - table->first_year);
+            if (!atomic_load_explicit(&table->ready[index], memory_order_relaxed)) {
+                table->years[index] = bounds;
+                atomic_store_explicit(&table->ready[index], 1, memory_order_release);
+            }
+        }
+    }
+
+    long long first_instant = (long long)table->first_k * 4;
+    long long last_instant = (long long)table->last_k * 4 + 3;
+    for (uint32_t r = 0; r < runs && !reader->failed; r++) {
+        long long instant = (int32_t)get_u32(reader);
+        uint32_t length = get_u32(reader);
+        for (uint32_t j = 0; j < length && !reader->failed; j++, instant++) {
+            double jd = get_f64(reader);
+            if (!reader->failed && instant >= first_instant && instant <= last_instant) {
+                size_t index = (size_t)(instant - first_instant);
+                if (!atomic_load_explicit(&table->phase_ready[index], memory_order_relaxed)) {
+                    table->phases[index] = jd;
+                    atomic_store_explicit(&table->phase_ready[index], 1, memory_order_release);
+                }
+            }
+        }
+    }
+    return !reader->failed && reader->pos == reader->length;
+}
+
+/**
+ * @brief Fill a table from a cache file written by lunar_year_table_save.
+ * A missing file fails quietly; a file from another algorithm version or
+ * failing its checksum is ignored with a warning.
+ */
+bool lunar_year_table_load(LunarYearTable *table, const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char *data = size >= TABLE_FILE_HEADER_BYTES + 4 ? malloc((size_t)size) : NULL;
+    bool read = data != NULL && fread(data, 1, (size_t)size, file) == (size_t)size;
+    fclose(file);
+    if (!read) {
+        free(data);
+        lunar_log(LUNAR_LOG_WARNING, "Ignoring unreadable cache file '%s'.", path);
+        return false;
+    }
+
+    TableReader reader = { data, (size_t)size - 4, 0, false };
+    TableReader trailer = { data + size - 4, 4, 0, false };
+    uint32_t magic = get_u32(&reader);
+    uint32_t version = get_u32(&reader);
+    uint32_t algorithm = get_u32(&reader);
+    get_u32(&reader);   /* The writer's window, informational */
+    get_u32(&reader);
+    uint32_t year_records = get_u32(&reader);
+    uint32_t runs = get_u32(&reader);
+
+    bool loaded = false;
+    if (magic != TABLE_FILE_MAGIC || version != TABLE_FILE_VERSION) {
+        lunar_log(LUNAR_LOG_WARNING, "Ignoring cache file '%s': not a version %d cache file.", path,
+                  TABLE_FILE_VERSION);
+    } else if (algorithm != TABLE_FILE_ALGORITHM) {
+        lunar_log(LUNAR_LOG_INFO, "Ignoring cache file '%s': computed by another algorithm version.", path);
+    } else if (get_u32(&trailer) != fnv1a(data, (size_t)size - 4)) {
+        lunar_log(LUNAR_LOG_WARNING, "Ignoring cache file '%s': it fails its checksum.", path);
+    } else {
+        pthread_mutex_lock(&table->publish_lock);
+        loaded = load_table_records(table, &reader, year_records, runs);
+        pthread_mutex_unlock(&table->publish_lock);
+        if (!loaded) {
+            lunar_log(LUNAR_LOG_WARNING, "Cache file '%s' is malformed; loaded only part of it.", path);
+        }
+    }
+    free(data);
+    return loaded;
+}
+
+// --- Cached Conversions ---
+
+/**
+ * @brief Reset a conversion cache.
+ */
+void lunar_cache_init(LunarCache *cache) {
+    cache->years_used = 0;
+    cache->next_slot = 0;
+    cache->lunation.computed = false;
+    cache->previous_lunation.computed = false;
+    cache->table = NULL;
+}
+
+/**
+ * @brief Back a cache with a shared year table.
+ */
+void lunar_cache_use_table(LunarCache *cache, LunarYearTable *table) {
+    cache->table = table;
+}
+
+/**
+ * @brief Get the month boundaries of a lunar year, computing and caching them on a miss.
+ */
+static const LunarYearBoundaries *lunar_cache_year(LunarCache *cache, int lunar_year_id) {
+    for (int i = 0; i < cache->years_used; i++) {
+        if (cache->years[i].lunar_year == lunar_year_id) {
+            return &cache->years[i];
+        }
+    }
+
+    LUNAR_STATS_EVENT(LUNAR_STAT_CACHE_YEAR_MISS);
+    LunarYearBoundaries *slot = &cache->years[cache->next_slot];
+    bool found = cache->table != NULL ? lunar_year_table_get(cache->table, lunar_year_id, slot)
+                                      : calculate_lunar_year_boundaries(lunar_year_id, slot);
+    if (!found) {
+        return NULL;
+    }
+    cache->next_slot = (cache->next_slot + 1) % LUNAR_CACHE_YEARS;
+    if (cache->years_used < LUNAR_CACHE_YEARS) {
+        cache->years_used++;
+    }
+    return slot;
+}
+
+/**
+ * @brief Moon phase for a Julian Day, reusing the cached lunation when it matches.
+ */
+static MoonPhase lunar_cache_moon_phase(LunarCache *cache, double jd) {
+    double k_base = floor((jd - 2451550.09766) / LUNAR_CYCLE_DAYS);
+    double epsilon = 1e-5;
+
+    if (!cache->lunation.computed || cache->lunation.k_base != k_base) {
+        LUNAR_STATS_EVENT(LUNAR_STAT_CACHE_LUNATION_MISS);
+        compute_lunation_phases(k_base, &cache->lunation);
+    }
+    if (jd < cache->lunation.new_moon + epsilon) {
+        if (!cache->previous_lunation.computed || cache->previous_lunation.k_base != k_base) {
+            LUNAR_STATS_EVENT(LUNAR_STAT_CACHE_LUNATION_MISS);
+            compute_previous_lunation_phases(k_base, &cache->previous_lunation);
+        }
+        return classify_moon_phase(jd, &cache->previous_lunation);
+    }
+    order_lunation_phases(jd, &cache->lunation);
+    return classify_moon_phase(jd, &cache->lunation);
+}
+
+/**
+ * @brief Convert a Gregorian date to a lunar date using a conversion cache.
+ * Gives the same result as gregorian_to_lunar.
+ */
+LunarDay gregorian_to_lunar_cached(LunarCache *cache, int year, int month, int day) {
+    LunarDay result = {0};
     result.greg_year = year;
     result.greg_month = month;
     result.greg_day = day;
     result.weekday = calculate_weekday(year, month, day);
-    double target_jd = gregorian_to_julian_day(year, month, day, 12.0); 
-    result.moon_phase = calculate_moon_phase_from_jd(target_jd);
-    result.eld_year = calculate_eld_year_from_gregorian(year); 
+    double target_jd = gregorian_to_julian_day(year, month, day, 12.0);
+    result.moon_phase = lunar_cache_moon_phase(cache, target_jd);
+    result.eld_year = calculate_eld_year_from_gregorian(year);
 
-    int lunar_year_id = year; // Initialize to default
-    double year_start_jd_guess = calculate_lunar_new_year_jd(year);
-    if (year_start_jd_guess == 0) goto conversion_error;
     double epsilon = 1e-5;
-
-    if (target_jd < year_start_jd_guess - epsilon) { 
-        lunar_year_id = year - 1;
-    } else {
-        double next_year_start_jd = calculate_lunar_new_year_jd(year + 1);
-        if (next_year_start_jd == 0) goto conversion_error; 
-        if (target_jd >= next_year_start_jd - epsilon) { 
+    int lunar_year_id = year;
+    const LunarYearBoundaries *bounds = lunar_cache_year(cache, year);
+    if (bounds != NULL) {
+        if (target_jd < bounds->month_start_jd[0] - epsilon) {
+            lunar_year_id = year - 1;
+            bounds = lunar_cache_year(cache, lunar_year_id);
+        } else if (target_jd >= bounds->month_start_jd[bounds->months_count] - epsilon) {
             lunar_year_id = year + 1;
-        } else {
-            lunar_year_id = year; 
+            bounds = lunar_cache_year(cache, lunar_year_id);
         }
     }
     result.lunar_year = lunar_year_id;
 
-    double year_start_jd = calculate_lunar_new_year_jd(lunar_year_id);
-    if (year_start_jd == 0) goto conversion_error;
-
-    int lunar_month_num = 1;
-    double month_start_jd = year_start_jd; 
-    double next_month_start_jd;
-    int months_in_this_year = get_lunar_months_in_year(lunar_year_id);
-
-    while (lunar_month_num <= months_in_this_year) {
-        next_month_start_jd = find_next_phase_jd(month_start_jd, 2); 
-        if (next_month_start_jd == 0) goto conversion_error;
-        
-        if (target_jd >= month_start_jd - epsilon && target_jd < next_month_start_jd - epsilon) {
-            result.lunar_month = lunar_month_num;
-            result.lunar_day = (int)floor(target_jd - month_start_jd) + 1; 
-            goto conversion_success; 
+    if (bounds != NULL) {
+        for (int m = 0; m < bounds->months_count; m++) {
+            if (target_jd >= bounds->month_start_jd[m] - epsilon &&
+                target_jd < bounds->month_start_jd[m + 1] - epsilon) {
+                result.lunar_month = m + 1;
+                result.lunar_day = (int)floor(target_jd) - lunar_month_first_day(bounds->month_start_jd[m]) + 1;
+                break;
+            }
         }
-        
-        month_start_jd = next_month_start_jd;
-        lunar_month_num++;
     }
-    
-    fprintf(stderr, "Error in gregorian_to_lunar: Could not place JD %.4f within year %d.\n", 
-            target_jd, lunar_year_id);
-
-conversion_error:
-    // Indicate error by setting lunar day/month to 0 or similar?
-    result.lunar_day = 0; 
-    result.lunar_month = 0;
-    fprintf(stderr, "Returning invalid LunarDay due to conversion error.\n");
-conversion_success:
+
     get_metonic_position(lunar_year_id, &result.metonic_year, &result.metonic_cycle);
     return result;
 }
 
 /**
- * @brief Convert a lunar date (year, month, day based on new rules) to a Gregorian date.
+ * @brief Convert a lunar date to a Gregorian date using a conversion cache.
  */
-bool lunar_to_gregorian(int lunar_year_id, int lunar_month, int lunar_day, 
-                        int *greg_year, int *greg_month, int *greg_day) {
-
-    int months_in_year = get_lunar_months_in_year(lunar_year_id);
-    if (lunar_month < 1 || lunar_month > months_in_year || lunar_day < 1) {
-        fprintf(stderr, "Error: Invalid lunar date input %d/%d/%d (year has %d months).\n", 
-                lunar_year_id, lunar_month, lunar_day, months_in_year);
+bool lunar_to_gregorian_cached(LunarCache *cache, int lunar_year_id, int lunar_month, int lunar_day,
+                               int *greg_year, int *greg_month, int *greg_day) {
+    const LunarYearBoundaries *bounds = lunar_cache_year(cache, lunar_year_id);
+    if (bounds == NULL || lunar_month < 1 || lunar_month > bounds->months_count || lunar_day < 1) {
         return false;
     }
-    
-    double year_start_jd = calculate_lunar_new_year_jd(lunar_year_id);
-    if (year_start_jd == 0) return false;
-    
-    double month_start_jd = year_start_jd;
-    for (int m = 1; m < lunar_month; m++) {
-        month_start_jd = find_next_phase_jd(month_start_jd, 2); 
-        if (month_start_jd == 0) return false;
+
+    /* Day 1 is the first day whose noon is past the full moon, as in gregorian_to_lunar */
+    int first_day = lunar_month_start_day(bounds, lunar_month);
+    if (lunar_day > lunar_month_start_day(bounds, lunar_month + 1) - first_day) {
+        return false;
     }
 
-    double target_jd = month_start_jd + (double)(lunar_day - 1);
-    double epsilon = 1e-5;
+    day_number_to_gregorian(first_day + lunar_day - 1, greg_year, greg_month, greg_day);
+    return true;
+}
 
-    // Validate Day Number within Month
-    double next_month_start_jd = find_next_phase_jd(month_start_jd, 2);
-    if (next_month_start_jd == 0) return false;
-    int month_length = (int)floor(next_month_start_jd - month_start_jd + 0.5); // Round
-    if (lunar_day > month_length) {
-         fprintf(stderr, "Error: Lunar day %d invalid for month %d/%d (length %d days).\n",
-                 lunar_day, lunar_month, lunar_year_id, month_length);
-         return false; 
-    }
-    if (target_jd >= next_month_start_jd - epsilon) { 
-         fprintf(stderr, "Error: Calculated target JD %.4f >= next month start JD %.4f.\n",
-                 target_jd, next_month_start_jd);
-         return false;
+// --- Metonic Cycle ---
+
+/**
+ * @brief Fill the months and days of a lunar year from its boundaries.
+ */
+static void fill_lunar_year(LunarCache *cache, const LunarYearBoundaries *bounds, LunarYear *year) {
+    int metonic_year, metonic_cycle;
+    get_metonic_position(bounds->lunar_year, &metonic_year, &metonic_cycle);
+
+    year->year = bounds->lunar_year;
+    year->months_count = bounds->months_count;
+    year->days_count = 0;
+    year->metonic_year = metonic_year;
+
+    for (int m = 0; m < bounds->months_count; m++) {
+        LunarMonth *month = &year->months[m];
+        int first_day = lunar_month_first_day(bounds->month_start_jd[m]);
+        int days = lunar_month_first_day(bounds->month_start_jd[m + 1]) - first_day;
+        if (days > 30) days = 30;
+
+        month->year = bounds->lunar_year;
+        month->month_number = m + 1;
+        month->is_leap_month = m == 12;
+        month->days_count = days;
+        month->julian_start = bounds->month_start_jd[m];
+
+        for (int d = 0; d < days; d++) {
+            LunarDay *lunar = &month->days[d];
+            double noon_jd = (double)(first_day + d);
+
+            day_number_to_gregorian(first_day + d, &lunar->greg_year, &lunar->greg_month,
+                                    &lunar->greg_day);
+            lunar->lunar_year = bounds->lunar_year;
+            lunar->lunar_month = m + 1;
+            lunar->lunar_day = d + 1;
+            lunar->moon_phase = lunar_cache_moon_phase(cache, noon_jd);
+            lunar->eld_year = calculate_eld_year_from_gregorian(lunar->greg_year);
+            lunar->metonic_year = metonic_year;
+            lunar->metonic_cycle = metonic_cycle;
+            lunar->weekday = calculate_weekday(lunar->greg_year, lunar->greg_month, lunar->greg_day);
+        }
+        year->days_count += days;
     }
 
     double hour_unused;
-    julian_day_to_gregorian(target_jd, greg_year, greg_month, greg_day, &hour_unused);
-    
+    int start_year;
+    julian_day_to_gregorian(bounds->month_start_jd[0], &start_year,
+                            &year->germanic_start_greg_month, &year->germanic_start_greg_day,
+                            &hour_unused);
+}
+
+/**
+ * @brief Calculate the months and days of one lunar year.
+ */
+bool calculate_lunar_year(int lunar_year_identifier, LunarYear *year) {
+    LunarYearBoundaries bounds;
+    LunarCache cache;
+
+    memset(year, 0, sizeof(*year));
+    year->year = lunar_year_identifier;
+    if (!calculate_lunar_year_boundaries(lunar_year_identifier, &bounds)) {
+        return false;
+    }
+
+    lunar_cache_init(&cache);
+    fill_lunar_year(&cache, &bounds, year);
     return true;
 }
 
+/**
+ * @brief Initialize the 19 lunar years of a Metonic cycle starting at a lunar year.
+ * Each new year is computed once and shared as the end of the previous year.
+ */
+MetonicCycle initialize_metonic_cycle(int start_year) {
+    MetonicCycle cycle;
+    LunarCache cache;
+    double new_year_jd[YEARS_PER_METONIC_CYCLE + 1];
+    int metonic_year;
+
+    memset(&cycle, 0, sizeof(cycle));
+    lunar_cache_init(&cache);
+    get_metonic_position(start_year, &metonic_year, &cycle.cycle_number);
+
+    for (int i = 0; i <= YEARS_PER_METONIC_CYCLE; i++) {
+        new_year_jd[i] = calculate_lunar_new_year_jd(start_year + i);
+    }
+    cycle.start_julian_day = new_year_jd[0];
+    cycle.end_julian_day = new_year_jd[YEARS_PER_METONIC_CYCLE];
+
+    for (int i = 0; i < YEARS_PER_METONIC_CYCLE; i++) {
+        LunarYearBoundaries bounds;
+        if (new_year_jd[i] == 0 || new_year_jd[i + 1] == 0 ||
+            !lunar_year_boundaries_between(start_year + i, new_year_jd[i], new_year_jd[i + 1], &bounds)) {
+            lunar_log(LUNAR_LOG_ERROR, "Could not calculate lunar year %d of the Metonic cycle.", start_year + i);
+            cycle.years[i].year = start_year + i;
+            continue;
+        }
+        fill_lunar_year(&cache, &bounds, &cycle.years[i]);
+    }
+
+    return cycle;
+}
+
 // --- Utility Functions ---
+/**
+ * @brief Get the display name of a moon phase
+ */
+const char* get_moon_phase_name(MoonPhase phase) {
+    switch (phase) {
+        case NEW_MOON: return "New Moon";
+        case WAXING_CRESCENT: return "Waxing Crescent";
+        case FIRST_QUARTER: return "First Quarter";
+        case WAXING_GIBBOUS: return "Waxing Gibbous";
+        case FULL_MOON: return "Full Moon";
+        case WANING_GIBBOUS: return "Waning Gibbous";
+        case LAST_QUARTER: return "Last Quarter";
+        case WANING_CRESCENT: return "Waning Crescent";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * @brief Get the display name of a weekday
+ */
+const char* get_weekday_name(Weekday weekday) {
+    switch (weekday) {
+        case SUNDAY: return "Sunday";
+        case MONDAY: return "Monday";
+        case TUESDAY: return "Tuesday";
+        case WEDNESDAY: return "Wednesday";
+        case THURSDAY: return "Thursday";
+        case FRIDAY: return "Friday";
+        case SATURDAY: return "Saturday";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * @brief Parse a fixed number of separated integers without sscanf
+ */
+bool parse_int_fields(const char *text, int *values, int count) {
+    const char *p = text;
+
+    while (*p == ' ' || *p == '\t') p++;
+
+    for (int i = 0; i < count; i++) {
+        bool negative = false;
+        if (i == 0 && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            p++;
+        }
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+
+        int value = 0;
+        while (*p >= '0' && *p <= '9') {
+            if (value > 99999999) {
+                return false;  /* Far outside any supported date */
+            }
+            value = value * 10 + (*p - '0');
+            p++;
+        }
+        values[i] = negative ? -value : value;
+
+        if (i < count - 1) {
+            /* One separator, optionally surrounded by blanks */
+            while (*p == ' ' || *p == '\t') p++;
+            if (*p == '-' || *p == '/' || *p == ',') {
+                p++;
+                while (*p == ' ' || *p == '\t') p++;
+            } else if (p[-1] != ' ' && p[-1] != '\t') {
+                return false;
+            }
+        }
+    }
+
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+    return *p == '\0';
+}
+
 /**
  * @brief Get the lunar date for today
  */
 LunarDay get_today_lunar_date(void) {
+    return lunar_ctx_today(NULL);
+}
+
+// --- Contexts ---
+
+/**
+ * @brief Create a conversion context with the default settings.
+ */
+LunarContext *lunar_ctx_new(unsigned flags) {
+    LunarContext *ctx = calloc(1, sizeof(LunarContext));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->flags = flags;
+    ctx->log_level = LUNAR_LOG_WARNING;
+    ctx->phase_tolerance = MOON_PHASE_TOLERANCE_DAYS;
+    lunar_cache_init(&ctx->cache);
+    if (flags & LUNAR_CTX_SHARED) {
+        ctx->years = lunar_year_table_new(CONTEXT_TABLE_FIRST_YEAR, CONTEXT_TABLE_LAST_YEAR);
+        if (ctx->years == NULL) {
+            free(ctx);
+            return NULL;
+        }
+    }
+    return ctx;
+}
+
+void lunar_ctx_free(LunarContext *ctx) {
+    if (ctx == NULL) {
+        return;
+    }
+    if (t_active_context == ctx) {
+        t_active_context = NULL;
+    }
+    lunar_year_table_free(ctx->years);
+    free(ctx);
+}
+
+LunarYearTable *lunar_ctx_year_table(LunarContext *ctx) {
+    return ctx->years;
+}
+
+void lunar_ctx_set_log(LunarContext *ctx, LunarLogCallback callback, void *user_data, LunarLogLevel max_level) {
+    ctx->log_callback = callback;
+    ctx->log_user_data = user_data;
+    ctx->log_level = max_level;
+}
+
+void lunar_ctx_set_utc_offset(LunarContext *ctx, int minutes) {
+    ctx->use_utc_offset = true;
+    ctx->utc_offset_minutes = minutes;
+}
+
+void lunar_ctx_use_local_time(LunarContext *ctx) {
+    ctx->use_utc_offset = false;
+}
+
+bool lunar_ctx_set_today(LunarContext *ctx, int year, int month, int day) {
+    if (!is_valid_gregorian_date(year, month, day)) {
+        return false;
+    }
+    ctx->has_today = true;
+    ctx->today_day_number = (int)floor(gregorian_to_julian_day(year, month, day, 12.0));
+    return true;
+}
+
+void lunar_ctx_clear_today(LunarContext *ctx) {
+    ctx->has_today = false;
+}
+
+bool lunar_ctx_set_phase_tolerance(LunarContext *ctx, double days) {
+    if (!(days > 0 && days <= 3.0)) {
+        return false;
+    }
+    ctx->phase_tolerance = days;
+    return true;
+}
+
+double lunar_ctx_phase_tolerance(const LunarContext *ctx) {
+    if (ctx == NULL) {
+        ctx = t_active_context;
+    }
+    return ctx != NULL ? ctx->phase_tolerance : MOON_PHASE_TOLERANCE_DAYS;
+}
+
+LunarContext *lunar_ctx_activate(LunarContext *ctx) {
+    LunarContext *previous = t_active_context;
+    t_active_context = ctx;
+    return previous;
+}
+
+/**
+ * @brief The cache a call converts with: a private context's own, or a
+ * call-local one (over the shared table, if the context has one).
+ */
+static LunarCache *context_cache(LunarContext *ctx, LunarCache *local) {
+    if (ctx != NULL && !(ctx->flags & LUNAR_CTX_SHARED)) {
+        return &ctx->cache;
+    }
+    lunar_cache_init(local);
+    if (ctx != NULL) {
+        lunar_cache_use_table(local, ctx->years);
+    }
+    return local;
+}
+
+LunarDay lunar_ctx_gregorian_to_lunar(LunarContext *ctx, int year, int month, int day) {
+    LunarContext *previous = context_enter(ctx);
+    LunarCache local;
+
+    LunarDay result = gregorian_to_lunar_cached(context_cache(t_active_context, &local), year, month, day);
+    if (result.lunar_month == 0) {
+        lunar_log(LUNAR_LOG_ERROR, "Could not place %04d-%02d-%02d within lunar year %d.",
+                  year, month, day, result.lunar_year);
+    }
+    context_leave(previous);
+    return result;
+}
+
+bool lunar_ctx_lunar_to_gregorian(LunarContext *ctx, int lunar_year, int lunar_month, int lunar_day,
+                                  int *greg_year, int *greg_month, int *greg_day) {
+    LunarContext *previous = context_enter(ctx);
+    LunarCache local;
+
+    bool converted = lunar_to_gregorian_cached(context_cache(t_active_context, &local),
+                                               lunar_year, lunar_month, lunar_day,
+                                               greg_year, greg_month, greg_day);
+    if (!converted) {
+        lunar_log(LUNAR_LOG_ERROR, "Invalid lunar date input %d/%d/%d.", lunar_year, lunar_month, lunar_day);
+    }
+    context_leave(previous);
+    return converted;
+}
+
+MoonPhase lunar_ctx_moon_phase(LunarContext *ctx, int year, int month, int day) {
+    LunarContext *previous = context_enter(ctx);
+    LunarCache local;
+
+    MoonPhase phase = lunar_cache_moon_phase(context_cache(t_active_context, &local),
+                                             gregorian_to_julian_day(year, month, day, 12.0));
+    context_leave(previous);
+    return phase;
+}
+
+bool lunar_ctx_year_boundaries(LunarContext *ctx, int lunar_year, LunarYearBoundaries *bounds) {
+    LunarContext *previous = context_enter(ctx);
+    LunarCache local;
+
+    const LunarYearBoundaries *cached = lunar_cache_year(context_cache(t_active_context, &local), lunar_year);
+    if (cached != NULL) {
+        *bounds = *cached;
+    }
+    context_leave(previous);
+    return cached != NULL;
+}
+
+bool lunar_ctx_lunar_year(LunarContext *ctx, int lunar_year, LunarYear *year) {
+    LunarContext *previous = context_enter(ctx);
+    LunarCache local;
+    LunarCache *cache = context_cache(t_active_context, &local);
+    LunarYearBoundaries bounds;
+
+    memset(year, 0, sizeof(*year));
+    year->year = lunar_year;
+    const LunarYearBoundaries *cached = lunar_cache_year(cache, lunar_year);
+    if (cached != NULL) {
+        bounds = *cached;
+        fill_lunar_year(cache, &bounds, year);
+    }
+    context_leave(previous);
+    return cached != NULL;
+}
+
+double lunar_ctx_next_phase_jd(LunarContext *ctx, double start_jd, int phase_type) {
+    LunarContext *previous = context_enter(ctx);
+    double jd = find_next_phase_jd(start_jd, phase_type);
+    context_leave(previous);
+    return jd;
+}
+
+bool lunar_ctx_new_moon(LunarContext *ctx, int year, int month, int *new_moon_day, double *new_moon_hour) {
+    LunarContext *previous = context_enter(ctx);
+    bool found = calculate_new_moon(year, month, new_moon_day, new_moon_hour);
+    context_leave(previous);
+    return found;
+}
+
+bool lunar_ctx_full_moon(LunarContext *ctx, int year, int month, int *full_moon_day, double *full_moon_hour) {
+    LunarContext *previous = context_enter(ctx);
+    bool found = calculate_full_moon(year, month, full_moon_day, full_moon_hour);
+    context_leave(previous);
+    return found;
+}
+
+double lunar_ctx_solstice_equinox_jde(LunarContext *ctx, int year, int season) {
+    LunarContext *previous = context_enter(ctx);
+    double jde = calculate_solstice_equinox_jde(year, season);
+    context_leave(previous);
+    return jde;
+}
+
+double lunar_ctx_lunar_new_year_jd(LunarContext *ctx, int gregorian_year) {
+    LunarContext *previous = context_enter(ctx);
+    double jd = calculate_lunar_new_year_jd(gregorian_year);
+    context_leave(previous);
+    return jd;
+}
+
+int lunar_ctx_germanic_new_year(LunarContext *ctx, int year, int *month, int *day) {
+    LunarContext *previous = context_enter(ctx);
+    int found = calculate_germanic_new_year(year, month, day);
+    context_leave(previous);
+    return found;
+}
+
+int lunar_ctx_months_in_year(LunarContext *ctx, int lunar_year) {
+    LunarContext *previous = context_enter(ctx);
+    int months = get_lunar_months_in_year(lunar_year);
+    context_leave(previous);
+    return months;
+}
+
+bool lunar_ctx_is_leap_year(LunarContext *ctx, int lunar_year) {
+    return lunar_ctx_months_in_year(ctx, lunar_year) == 13;
+}
+
+int lunar_ctx_month_length(LunarContext *ctx, int lunar_year, int month) {
+    LunarContext *previous = context_enter(ctx);
+    int days = calculate_lunar_month_length(lunar_year, month);
+    context_leave(previous);
+    return days;
+}
+
+MetonicCycle lunar_ctx_metonic_cycle(LunarContext *ctx, int start_year) {
+    LunarContext *previous = context_enter(ctx);
+    MetonicCycle cycle = initialize_metonic_cycle(start_year);
+    context_leave(previous);
+    return cycle;
+}
+
+/**
+ * @brief Today's day number: the pinned date, or the current date in the
+ * context's time zone.
+ */
+int lunar_ctx_today_day_number(const LunarContext *ctx) {
     time_t now = time(NULL);
-    struct tm *tm_now = localtime(&now);
-    return gregorian_to_lunar(tm_now->tm_year + 1900, 
-                             tm_now->tm_mon + 1, 
-                             tm_now->tm_mday);
+    struct tm today;
+
+    if (ctx == NULL) {
+        ctx = t_active_context;
+    }
+    if (ctx != NULL && ctx->has_today) {
+        return ctx->today_day_number;
+    }
+    if (ctx != NULL && ctx->use_utc_offset) {
+        now += (time_t)ctx->utc_offset_minutes * 60;
+        gmtime_r(&now, &today);
+    } else {
+        localtime_r(&now, &today);
+    }
+    return (int)floor(gregorian_to_julian_day(today.tm_year + 1900, today.tm_mon + 1, today.tm_mday, 12.0));
+}
+
+LunarDay lunar_ctx_today(LunarContext *ctx) {
+    int year, month, day;
+    day_number_to_gregorian(lunar_ctx_today_day_number(ctx), &year, &month, &day);
+    return lunar_ctx_gregorian_to_lunar(ctx, year, month, day);
 }
 
 // --- Removed / Obsolete Code Stubs ---
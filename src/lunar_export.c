@@ -0,0 +1,493 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "../include/lunar_calendar.h"
+#include "../include/lunar_export.h"
+#include "../include/lunar_renderer.h"
+
+// --- Constants ---
+#define EXPORT_CHUNKS_PER_THREAD 4   /* Converted chunks allowed ahead of the writer */
+#define EXPORT_ROW_MAX 512
+
+/* Columns, in LunarDay field order, then the day's special-day type */
+static const char *EXPORT_COLUMNS[] = {
+    "greg_year", "greg_month", "greg_day", "lunar_year", "lunar_month", "lunar_day",
+    "moon_phase", "weekday", "eld_year", "metonic_year", "metonic_cycle", "special_day"
+};
+#define EXPORT_COLUMN_COUNT (sizeof(EXPORT_COLUMNS) / sizeof(EXPORT_COLUMNS[0]))
+
+/* Growable output buffer owned by one chunk */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t capacity;
+} ExportBuffer;
+
+/* One lunar year (clipped to the range) of output */
+typedef struct {
+    int32_t first_day;         /* Day numbers (JDN), inclusive */
+    int32_t last_day;
+    ExportBuffer buffer;
+    bool done;
+    bool failed;
+} ExportChunk;
+
+/* Shared state of one export run */
+typedef struct {
+    ExportChunk *chunks;
+    int chunk_count;
+    int next_chunk;            /* Next chunk to hand to a worker */
+    int written;               /* Chunks already written out */
+    int window;                /* Max chunks converted ahead of the writer */
+    ExportFormat format;
+    pthread_mutex_t lock;
+    pthread_cond_t chunk_done;
+    pthread_cond_t window_open;
+} ExportJob;
+
+/**
+ * @brief Default export options
+ */
+ExportOptions default_export_options(void) {
+    ExportOptions options;
+    memset(&options, 0, sizeof(options));
+    options.format = EXPORT_FORMAT_CSV;
+    options.header = true;
+    options.threads = 0;
+    return options;
+}
+
+/**
+ * @brief Parse an export format name
+ */
+bool parse_export_format(const char *name, ExportFormat *format) {
+    if (strcmp(name, "csv") == 0) {
+        *format = EXPORT_FORMAT_CSV;
+    } else if (strcmp(name, "jsonl") == 0 || strcmp(name, "json") == 0) {
+        *format = EXPORT_FORMAT_JSONL;
+    } else if (strcmp(name, "binary") == 0 || strcmp(name, "parquet-like-binary") == 0) {
+        *format = EXPORT_FORMAT_BINARY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// --- Buffers ---
+
+static bool buffer_reserve(ExportBuffer *buffer, size_t extra) {
+    if (buffer->len + extra <= buffer->capacity) {
+        return true;
+    }
+    size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+    while (capacity < buffer->len + extra) {
+        capacity *= 2;
+    }
+    char *data = realloc(buffer->data, capacity);
+    if (data == NULL) {
+        return false;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+/* Callers reserve space first; the appenders do not check */
+static void buffer_append(ExportBuffer *buffer, const void *bytes, size_t len) {
+    memcpy(buffer->data + buffer->len, bytes, len);
+    buffer->len += len;
+}
+
+static void buffer_append_char(ExportBuffer *buffer, char c) {
+    buffer->data[buffer->len++] = c;
+}
+
+static void buffer_append_str(ExportBuffer *buffer, const char *text) {
+    buffer_append(buffer, text, strlen(text));
+}
+
+/* Append a decimal integer without going through printf */
+static void buffer_append_int(ExportBuffer *buffer, int value) {
+    char digits[16];
+    int count = 0;
+    unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+
+    do {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    if (value < 0) {
+        buffer_append_char(buffer, '-');
+    }
+    while (count > 0) {
+        buffer_append_char(buffer, digits[--count]);
+    }
+}
+
+// --- Row Formatting ---
+
+/* Field values of a day, in EXPORT_COLUMNS order */
+static void export_day_values(const LunarDay *day, SpecialDayType special_day,
+                              int32_t values[EXPORT_COLUMN_COUNT]) {
+    values[0] = day->greg_year;
+    values[1] = day->greg_month;
+    values[2] = day->greg_day;
+    values[3] = day->lunar_year;
+    values[4] = day->lunar_month;
+    values[5] = day->lunar_day;
+    values[6] = (int32_t)day->moon_phase;
+    values[7] = (int32_t)day->weekday;
+    values[8] = day->eld_year;
+    values[9] = day->metonic_year;
+    values[10] = day->metonic_cycle;
+    values[11] = (int32_t)special_day;
+}
+
+static bool export_text_row(ExportBuffer *buffer, ExportFormat format, const LunarDay *day,
+                            SpecialDayType special_day) {
+    int32_t values[EXPORT_COLUMN_COUNT];
+
+    if (!buffer_reserve(buffer, EXPORT_ROW_MAX)) {
+        return false;
+    }
+    export_day_values(day, special_day, values);
+
+    for (size_t i = 0; i < EXPORT_COLUMN_COUNT; i++) {
+        /* Names for the enum fields keep the text formats self-describing */
+        const char *name = NULL;
+        if (i == 6) name = get_moon_phase_name(day->moon_phase);
+        if (i == 7) name = get_weekday_name(day->weekday);
+        if (i == 11) name = get_special_day_name(special_day);
+
+        if (format == EXPORT_FORMAT_JSONL) {
+            buffer_append_str(buffer, i == 0 ? "{\"" : ",\"");
+            buffer_append_str(buffer, EXPORT_COLUMNS[i]);
+            buffer_append_str(buffer, "\":");
+            if (name != NULL) {
+                buffer_append_char(buffer, '"');
+                buffer_append_str(buffer, name);
+                buffer_append_char(buffer, '"');
+            } else {
+                buffer_append_int(buffer, values[i]);
+            }
+        } else {
+            if (i > 0) buffer_append_char(buffer, ',');
+            if (name != NULL) {
+                buffer_append_str(buffer, name);
+            } else {
+                buffer_append_int(buffer, values[i]);
+            }
+        }
+    }
+
+    if (format == EXPORT_FORMAT_JSONL) {
+        buffer_append_char(buffer, '}');
+    }
+    buffer_append_char(buffer, '\n');
+    return true;
+}
+
+/* Write a chunk's days as one columnar row group; values are row-major */
+static bool export_binary_row_group(ExportBuffer *buffer, const int32_t *values, uint32_t count) {
+    size_t size = sizeof(uint32_t) + (size_t)count * EXPORT_COLUMN_COUNT * sizeof(int32_t);
+    if (!buffer_reserve(buffer, size)) {
+        return false;
+    }
+
+    buffer_append(buffer, &count, sizeof(count));
+    for (size_t column = 0; column < EXPORT_COLUMN_COUNT; column++) {
+        int32_t *out = (int32_t *)(void *)(buffer->data + buffer->len);
+        for (uint32_t i = 0; i < count; i++) {
+            memcpy(&out[i], &values[(size_t)i * EXPORT_COLUMN_COUNT + column], sizeof(int32_t));
+        }
+        buffer->len += (size_t)count * sizeof(int32_t);
+    }
+    return true;
+}
+
+// --- Chunk Conversion ---
+
+static int32_t export_day_number(int year, int month, int day) {
+    return (int32_t)floor(gregorian_to_julian_day(year, month, day, 12.0));
+}
+
+/* Advance a Gregorian date by one day */
+static void export_next_date(int *year, int *month, int *day) {
+    if (is_valid_gregorian_date(*year, *month, *day + 1)) {
+        (*day)++;
+    } else if (*month < 12) {
+        (*month)++;
+        *day = 1;
+    } else {
+        (*year)++;
+        *month = 1;
+        *day = 1;
+    }
+}
+
+/* Convert one chunk into its output buffer; runs on a worker thread */
+static bool export_convert_chunk(ExportChunk *chunk, ExportFormat format) {
+    LunarCache cache;
+    SpecialDaySet special_days;
+    int year, month, day;
+    uint32_t count = (uint32_t)(chunk->last_day - chunk->first_day + 1);
+    int32_t *values = NULL;
+
+    lunar_cache_init(&cache);
+    /* Chunks are at most a lunar year, so one set covers the whole chunk */
+    bool have_special_days = special_day_set_build(&special_days, chunk->first_day, (int)count, false);
+    day_number_to_gregorian(chunk->first_day, &year, &month, &day);
+
+    if (format == EXPORT_FORMAT_BINARY) {
+        values = malloc((size_t)count * EXPORT_COLUMN_COUNT * sizeof(int32_t));
+        if (values == NULL) {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        LunarDay lunar = gregorian_to_lunar_cached(&cache, year, month, day);
+        SpecialDayType special_day = have_special_days
+            ? special_day_set_classify(&special_days, chunk->first_day + (int32_t)i) : NORMAL_DAY;
+        if (values != NULL) {
+            export_day_values(&lunar, special_day, &values[(size_t)i * EXPORT_COLUMN_COUNT]);
+        } else if (!export_text_row(&chunk->buffer, format, &lunar, special_day)) {
+            return false;
+        }
+        export_next_date(&year, &month, &day);
+    }
+
+    if (values != NULL) {
+        bool ok = export_binary_row_group(&chunk->buffer, values, count);
+        free(values);
+        return ok;
+    }
+    return true;
+}
+
+/* Split [first_day, last_day] at lunar year boundaries */
+static ExportChunk *export_plan_chunks(int32_t first_day, int32_t last_day, int from_year, int *chunk_count) {
+    int capacity = 16;
+    int count = 0;
+    ExportChunk *chunks = calloc((size_t)capacity, sizeof(ExportChunk));
+    if (chunks == NULL) {
+        return NULL;
+    }
+
+    /* The lunar year containing the first day started in its Gregorian year or the one before */
+    int lunar_year = from_year - 1;
+    int32_t start = first_day;
+
+    while (start <= last_day) {
+        LunarYearBoundaries bounds;
+        int32_t end;
+
+        if (calculate_lunar_year_boundaries(lunar_year, &bounds)) {
+            end = lunar_month_start_day(&bounds, bounds.months_count + 1) - 1;
+        } else {
+            /* Boundaries unavailable: fall back to a Gregorian-year-sized chunk */
+            end = start + 364;
+        }
+        lunar_year++;
+
+        if (end < start) {
+            continue;
+        }
+        if (end > last_day) {
+            end = last_day;
+        }
+
+        if (count == capacity) {
+            capacity *= 2;
+            ExportChunk *grown = realloc(chunks, (size_t)capacity * sizeof(ExportChunk));
+            if (grown == NULL) {
+                free(chunks);
+                return NULL;
+            }
+            chunks = grown;
+            memset(chunks + count, 0, (size_t)(capacity - count) * sizeof(ExportChunk));
+        }
+
+        chunks[count].first_day = start;
+        chunks[count].last_day = end;
+        count++;
+        start = end + 1;
+    }
+
+    *chunk_count = count;
+    return chunks;
+}
+
+// --- Thread Pool ---
+
+static void *export_worker(void *data) {
+    ExportJob *job = data;
+
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        while (job->next_chunk < job->chunk_count &&
+               job->next_chunk >= job->written + job->window) {
+            pthread_cond_wait(&job->window_open, &job->lock);
+        }
+        if (job->next_chunk >= job->chunk_count) {
+            pthread_mutex_unlock(&job->lock);
+            break;
+        }
+        ExportChunk *chunk = &job->chunks[job->next_chunk++];
+        pthread_mutex_unlock(&job->lock);
+
+        bool ok = export_convert_chunk(chunk, job->format);
+
+        pthread_mutex_lock(&job->lock);
+        chunk->failed = !ok;
+        chunk->done = true;
+        pthread_cond_broadcast(&job->chunk_done);
+        pthread_mutex_unlock(&job->lock);
+    }
+
+    return NULL;
+}
+
+static int export_thread_count(int requested, int chunk_count) {
+    long threads = requested;
+    if (threads <= 0) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+        if (threads <= 0) threads = 1;
+    }
+    if (threads > EXPORT_MAX_THREADS) threads = EXPORT_MAX_THREADS;
+    if (threads > chunk_count) threads = chunk_count;
+    return threads > 0 ? (int)threads : 1;
+}
+
+static void export_write_header(FILE *out, ExportFormat format) {
+    if (format == EXPORT_FORMAT_BINARY) {
+        uint32_t version = EXPORT_BINARY_VERSION;
+        uint32_t byte_order = EXPORT_BINARY_BYTE_ORDER;
+        uint32_t columns = EXPORT_COLUMN_COUNT;
+
+        fwrite(EXPORT_BINARY_MAGIC, 1, 8, out);
+        fwrite(&version, sizeof(version), 1, out);
+        fwrite(&byte_order, sizeof(byte_order), 1, out);
+        fwrite(&columns, sizeof(columns), 1, out);
+        for (size_t i = 0; i < EXPORT_COLUMN_COUNT; i++) {
+            uint8_t length = (uint8_t)strlen(EXPORT_COLUMNS[i]);
+            fwrite(&length, 1, 1, out);
+            fwrite(EXPORT_COLUMNS[i], 1, length, out);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < EXPORT_COLUMN_COUNT; i++) {
+        if (i > 0) fputc(',', out);
+        fputs(EXPORT_COLUMNS[i], out);
+    }
+    fputc('\n', out);
+}
+
+/**
+ * @brief Export every day of a Gregorian date range
+ */
+long long run_export(FILE *out, const ExportOptions *options) {
+    if (!is_valid_gregorian_date(options->from_year, options->from_month, options->from_day) ||
+        !is_valid_gregorian_date(options->to_year, options->to_month, options->to_day)) {
+        return -1;
+    }
+
+    int32_t first_day = export_day_number(options->from_year, options->from_month, options->from_day);
+    int32_t last_day = export_day_number(options->to_year, options->to_month, options->to_day);
+    if (last_day < first_day) {
+        return -1;
+    }
+
+    ExportJob job;
+    memset(&job, 0, sizeof(job));
+    job.format = options->format;
+    job.chunks = export_plan_chunks(first_day, last_day, options->from_year, &job.chunk_count);
+    if (job.chunks == NULL) {
+        return -1;
+    }
+
+    int thread_count = export_thread_count(options->threads, job.chunk_count);
+    job.window = thread_count * EXPORT_CHUNKS_PER_THREAD;
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.chunk_done, NULL);
+    pthread_cond_init(&job.window_open, NULL);
+
+    pthread_t threads[EXPORT_MAX_THREADS];
+    int started = 0;
+    for (int i = 0; i < thread_count; i++) {
+        if (pthread_create(&threads[started], NULL, export_worker, &job) == 0) {
+            started++;
+        }
+    }
+
+    long long rows = 0;
+    bool failed = started == 0;
+
+    if (!failed && (options->header || options->format == EXPORT_FORMAT_BINARY) &&
+        options->format != EXPORT_FORMAT_JSONL) {
+        export_write_header(out, options->format);
+    }
+
+    /* Write chunks in order as the workers finish them */
+    for (int i = 0; i < job.chunk_count && !failed; i++) {
+        ExportChunk *chunk = &job.chunks[i];
+
+        pthread_mutex_lock(&job.lock);
+        while (!chunk->done) {
+            pthread_cond_wait(&job.chunk_done, &job.lock);
+        }
+        pthread_mutex_unlock(&job.lock);
+
+        if (chunk->failed ||
+            fwrite(chunk->buffer.data, 1, chunk->buffer.len, out) != chunk->buffer.len) {
+            failed = true;
+        } else {
+            rows += chunk->last_day - chunk->first_day + 1;
+        }
+        free(chunk->buffer.data);
+        chunk->buffer.data = NULL;
+
+        pthread_mutex_lock(&job.lock);
+        job.written++;
+        pthread_cond_broadcast(&job.window_open);
+        pthread_mutex_unlock(&job.lock);
+    }
+
+    /* On failure, stop handing out chunks and let the workers drain */
+    pthread_mutex_lock(&job.lock);
+    if (failed) {
+        job.next_chunk = job.chunk_count;
+        pthread_cond_broadcast(&job.window_open);
+    }
+    pthread_mutex_unlock(&job.lock);
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    if (!failed && options->format == EXPORT_FORMAT_BINARY) {
+        uint32_t end_marker = 0;
+        uint64_t total_rows = (uint64_t)rows;
+        fwrite(&end_marker, sizeof(end_marker), 1, out);
+        fwrite(&total_rows, sizeof(total_rows), 1, out);
+    }
+
+    for (int i = 0; i < job.chunk_count; i++) {
+        free(job.chunks[i].buffer.data);
+    }
+    free(job.chunks);
+    pthread_cond_destroy(&job.window_open);
+    pthread_cond_destroy(&job.chunk_done);
+    pthread_mutex_destroy(&job.lock);
+
+    if (fflush(out) != 0 || ferror(out)) {
+        failed = true;
+    }
+    return failed ? -1 : rows;
+}
@@ -0,0 +1,377 @@
+#define _POSIX_C_SOURCE 200809L  /* For gmtime_r() */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "../include/lunar_calendar.h"
+#include "../include/lunar_ics.h"
+
+// --- Constants ---
+#define ICS_LINE_OCTETS 75          /* RFC 5545 content line limit, excluding CRLF */
+#define ICS_MAX_YEAR_ITEMS 64       /* Astronomical events of one Gregorian year */
+#define ICS_DATE_SIZE 24            /* YYYYMMDD, with room for any int year */
+#define ICS_TIME_SIZE 40            /* YYYYMMDDTHHMMSSZ, likewise */
+
+/* Kinds of astronomical events, in the order they are listed on the same instant */
+typedef enum {
+    ICS_ITEM_MONTH_START,
+    ICS_ITEM_NEW_MOON,
+    ICS_ITEM_FULL_MOON,
+    ICS_ITEM_SEASON
+} IcsItemKind;
+
+/* One astronomical event of a year, collected before sorting */
+typedef struct {
+    double jd;                 /* Instant (UT); all-day events use the start of their day */
+    IcsItemKind kind;
+    int lunar_year;            /* Month starts only */
+    int lunar_month;
+    int season;                /* Seasons only, as calculate_solstice_equinox_jde */
+} IcsItem;
+
+/* A lunar year's full moons (month starts) and the new moon of each month */
+typedef struct {
+    LunarYearBoundaries bounds;
+    double new_moon_jd[13];
+    bool valid;
+} IcsLunarYear;
+
+static const char *SEASON_NAMES[] = {
+    "Winter Solstice", "Spring Equinox", "Summer Solstice", "Fall Equinox"
+};
+
+/**
+ * @brief Default iCalendar options
+ */
+IcsOptions default_ics_options(void) {
+    IcsOptions options;
+    memset(&options, 0, sizeof(options));
+    options.month_starts = true;
+    options.moon_phases = true;
+    options.seasons = true;
+    return options;
+}
+
+// --- Buffered Output ---
+
+static void ics_flush(IcsWriter *writer) {
+    if (!writer->failed && writer->length > 0 &&
+        fwrite(writer->buffer, 1, writer->length, writer->stream) != writer->length) {
+        writer->failed = true;
+    }
+    writer->length = 0;
+}
+
+static void ics_put(IcsWriter *writer, const char *bytes, size_t length) {
+    while (length > 0 && !writer->failed) {
+        size_t room = ICS_BUFFER_SIZE - writer->length;
+        size_t chunk = length < room ? length : room;
+        memcpy(writer->buffer + writer->length, bytes, chunk);
+        writer->length += chunk;
+        bytes += chunk;
+        length -= chunk;
+        if (writer->length == ICS_BUFFER_SIZE) {
+            ics_flush(writer);
+        }
+    }
+}
+
+static void ics_puts(IcsWriter *writer, const char *text) {
+    ics_put(writer, text, strlen(text));
+}
+
+/* Octets in the UTF-8 sequence starting with lead */
+static size_t utf8_sequence_length(unsigned char lead) {
+    if (lead >= 0xF0) return 4;
+    if (lead >= 0xE0) return 3;
+    if (lead >= 0xC0) return 2;
+    return 1;
+}
+
+/* Write a content line. TEXT values are escaped; long lines are folded at
+ * 75 octets without splitting a UTF-8 sequence. */
+static void ics_line(IcsWriter *writer, const char *name, const char *value, bool text) {
+    size_t column = strlen(name) + 1;
+
+    ics_puts(writer, name);
+    ics_put(writer, ":", 1);
+    for (const unsigned char *p = (const unsigned char *)value; *p; p++) {
+        char escaped[2];
+        size_t length = 1;
+
+        escaped[0] = (char)*p;
+        if (text && (*p == '\\' || *p == ';' || *p == ',')) {
+            escaped[0] = '\\';
+            escaped[1] = (char)*p;
+            length = 2;
+        } else if (text && *p == '\n') {
+            escaped[0] = '\\';
+            escaped[1] = 'n';
+            length = 2;
+        } else if (*p < 0x20 && *p != '\t') {
+            continue;  /* Other control characters are not allowed */
+        }
+
+        if ((*p & 0xC0) != 0x80) {
+            size_t needed = length == 2 ? 2 : utf8_sequence_length(*p);
+            if (column + needed > ICS_LINE_OCTETS) {
+                ics_put(writer, "\r\n ", 3);
+                column = 1;
+            }
+        }
+        ics_put(writer, escaped, length);
+        column += length;
+    }
+    ics_put(writer, "\r\n", 2);
+}
+
+// --- Dates ---
+
+/* DATE value (YYYYMMDD) of a day number */
+static void ics_format_date(char out[ICS_DATE_SIZE], int day_number) {
+    int year, month, day;
+    day_number_to_gregorian(day_number, &year, &month, &day);
+    snprintf(out, ICS_DATE_SIZE, "%04d%02d%02d", year, month, day);
+}
+
+/* UTC DATE-TIME value (YYYYMMDDTHHMMSSZ) of a Julian day, to the second */
+static void ics_format_time(char out[ICS_TIME_SIZE], double jd) {
+    int day_number = (int)floor(jd + 0.5);
+    unsigned int seconds = (unsigned int)lround((jd + 0.5 - day_number) * 86400.0);
+    int year, month, day;
+
+    if (seconds >= 86400) {
+        day_number++;
+        seconds -= 86400;
+    }
+    day_number_to_gregorian(day_number, &year, &month, &day);
+    snprintf(out, ICS_TIME_SIZE, "%04d%02d%02dT%02u%02u%02uZ", year, month, day,
+             seconds / 3600, (seconds / 60) % 60, seconds % 60);
+}
+
+// --- Events ---
+
+static void ics_event_begin(IcsWriter *writer, const char *uid) {
+    ics_puts(writer, "BEGIN:VEVENT\r\n");
+    ics_line(writer, "UID", uid, false);
+    ics_line(writer, "DTSTAMP", writer->dtstamp, false);
+}
+
+static void ics_event_end(IcsWriter *writer, const char *summary, const char *description,
+                          const char *categories) {
+    ics_line(writer, "SUMMARY", summary, true);
+    if (description != NULL && description[0] != '\0') {
+        ics_line(writer, "DESCRIPTION", description, true);
+    }
+    if (categories != NULL && categories[0] != '\0') {
+        ics_line(writer, "CATEGORIES", categories, false);
+    }
+    ics_puts(writer, "TRANSP:TRANSPARENT\r\nEND:VEVENT\r\n");
+    writer->events++;
+}
+
+static void ics_all_day_event(IcsWriter *writer, const char *uid, int day_number, const char *summary,
+                              const char *description, const char *categories) {
+    char start[ICS_DATE_SIZE], end[ICS_DATE_SIZE];
+
+    ics_format_date(start, day_number);
+    ics_format_date(end, day_number + 1);
+    ics_event_begin(writer, uid);
+    ics_line(writer, "DTSTART;VALUE=DATE", start, false);
+    ics_line(writer, "DTEND;VALUE=DATE", end, false);
+    ics_event_end(writer, summary, description, categories);
+}
+
+/* An event at an instant; without DTEND it has no duration */
+static void ics_timed_event(IcsWriter *writer, const char *uid, double jd, const char *summary,
+                            const char *categories) {
+    char start[ICS_TIME_SIZE];
+
+    ics_format_time(start, jd);
+    ics_event_begin(writer, uid);
+    ics_line(writer, "DTSTART", start, false);
+    ics_event_end(writer, summary, NULL, categories);
+}
+
+/**
+ * @brief Start a calendar
+ */
+void ics_writer_begin(IcsWriter *writer, FILE *stream) {
+    time_t now = time(NULL);
+    struct tm utc;
+
+    writer->stream = stream;
+    writer->length = 0;
+    writer->events = 0;
+    writer->failed = false;
+    gmtime_r(&now, &utc);
+    strftime(writer->dtstamp, sizeof(writer->dtstamp), "%Y%m%dT%H%M%SZ", &utc);
+
+    ics_puts(writer,
+             "BEGIN:VCALENDAR\r\n"
+             "VERSION:2.0\r\n"
+             "PRODID:-//MANI//Lunar Calendar//EN\r\n"
+             "CALSCALE:GREGORIAN\r\n"
+             "X-WR-CALNAME:Lunar Calendar\r\n");
+}
+
+/**
+ * @brief Write one all-day event
+ */
+bool ics_write_event(IcsWriter *writer, const IcsEvent *event) {
+    if (!is_valid_gregorian_date(event->year, event->month, event->day) || event->uid == NULL) {
+        return !writer->failed;
+    }
+    int day_number = (int)floor(gregorian_to_julian_day(event->year, event->month, event->day, 12.0));
+    ics_all_day_event(writer, event->uid, day_number, event->summary ? event->summary : "",
+                      event->description, event->categories);
+    return !writer->failed;
+}
+
+/**
+ * @brief Close the calendar and flush
+ */
+bool ics_writer_end(IcsWriter *writer) {
+    ics_puts(writer, "END:VCALENDAR\r\n");
+    ics_flush(writer);
+    return !writer->failed;
+}
+
+// --- Astronomical Events ---
+
+/* Walk a lunar year's full moons once and find each month's new moon */
+static void ics_load_lunar_year(int lunar_year, IcsLunarYear *year) {
+    year->valid = calculate_lunar_year_boundaries(lunar_year, &year->bounds);
+    if (!year->valid) {
+        return;
+    }
+    for (int m = 0; m < year->bounds.months_count; m++) {
+        year->new_moon_jd[m] = find_next_phase_jd(year->bounds.month_start_jd[m], 0);
+    }
+}
+
+/* Add the month starts, full moons and new moons of a lunar year that fall
+ * on days in [first_day, last_day] */
+static int ics_collect_lunar_year(const IcsLunarYear *year, const IcsOptions *options,
+                                  int first_day, int last_day, IcsItem *items, int count) {
+    if (!year->valid) {
+        return count;
+    }
+    for (int m = 0; m < year->bounds.months_count && count < ICS_MAX_YEAR_ITEMS - 3; m++) {
+        double full_moon_jd = year->bounds.month_start_jd[m];
+        int start_day = lunar_month_start_day(&year->bounds, m + 1);
+        double new_moon_jd = year->new_moon_jd[m];
+
+        if (options->month_starts && start_day >= first_day && start_day <= last_day) {
+            items[count++] = (IcsItem){ start_day - 0.5, ICS_ITEM_MONTH_START,
+                                        year->bounds.lunar_year, m + 1, 0 };
+        }
+        if (options->moon_phases) {
+            int full_moon_day = (int)floor(full_moon_jd + 0.5);
+            int new_moon_day = (int)floor(new_moon_jd + 0.5);
+            if (full_moon_day >= first_day && full_moon_day <= last_day) {
+                items[count++] = (IcsItem){ full_moon_jd, ICS_ITEM_FULL_MOON, 0, 0, 0 };
+            }
+            if (new_moon_jd != 0 && new_moon_day >= first_day && new_moon_day <= last_day) {
+                items[count++] = (IcsItem){ new_moon_jd, ICS_ITEM_NEW_MOON, 0, 0, 0 };
+            }
+        }
+    }
+    return count;
+}
+
+static int compare_items(const void *a, const void *b) {
+    const IcsItem *left = a;
+    const IcsItem *right = b;
+    if (left->jd != right->jd) {
+        return left->jd < right->jd ? -1 : 1;
+    }
+    return (int)left->kind - (int)right->kind;
+}
+
+static void ics_write_item(IcsWriter *writer, const IcsItem *item) {
+    char uid[96];
+    char stamp[ICS_TIME_SIZE];
+    char summary[64];
+
+    switch (item->kind) {
+        case ICS_ITEM_MONTH_START:
+            snprintf(uid, sizeof(uid), "lunar-month-%d-%02d@" ICS_UID_DOMAIN,
+                     item->lunar_year, item->lunar_month);
+            if (item->lunar_month == 1) {
+                snprintf(summary, sizeof(summary), "Lunar New Year %d", item->lunar_year);
+            } else {
+                snprintf(summary, sizeof(summary), "Lunar Month %d of %d",
+                         item->lunar_month, item->lunar_year);
+            }
+            ics_all_day_event(writer, uid, (int)(item->jd + 0.5), summary, NULL, "Lunar Month");
+            break;
+        case ICS_ITEM_NEW_MOON:
+        case ICS_ITEM_FULL_MOON:
+            ics_format_time(stamp, item->jd);
+            snprintf(uid, sizeof(uid), "%s-%.8s@" ICS_UID_DOMAIN,
+                     item->kind == ICS_ITEM_NEW_MOON ? "new-moon" : "full-moon", stamp);
+            ics_timed_event(writer, uid, item->jd,
+                            item->kind == ICS_ITEM_NEW_MOON ? "New Moon" : "Full Moon", "Moon Phase");
+            break;
+        case ICS_ITEM_SEASON:
+            ics_format_time(stamp, item->jd);
+            snprintf(uid, sizeof(uid), "season-%d-%.8s@" ICS_UID_DOMAIN, item->season, stamp);
+            ics_timed_event(writer, uid, item->jd, SEASON_NAMES[item->season], "Season");
+            break;
+    }
+}
+
+/**
+ * @brief Export astronomical (and caller) events of a year range as iCalendar
+ */
+long run_ics_export(FILE *out, const IcsOptions *options, IcsYearCallback extra_events, void *user_data) {
+    if (options->from_year < 1 || options->to_year > 9999 || options->to_year < options->from_year) {
+        return -1;
+    }
+
+    IcsWriter *writer = malloc(sizeof(IcsWriter));
+    if (writer == NULL) {
+        return -1;
+    }
+    ics_writer_begin(writer, out);
+
+    /* Gregorian year Y overlaps lunar years Y-1 and Y; each is loaded once */
+    IcsLunarYear lunar_years[2];
+    ics_load_lunar_year(options->from_year - 1, &lunar_years[(options->from_year - 1) & 1]);
+
+    for (int year = options->from_year; year <= options->to_year && !writer->failed; year++) {
+        IcsLunarYear *previous = &lunar_years[(year - 1) & 1];
+        IcsLunarYear *current = &lunar_years[year & 1];
+        int first_day = (int)floor(gregorian_to_julian_day(year, 1, 1, 12.0));
+        int last_day = (int)floor(gregorian_to_julian_day(year, 12, 31, 12.0));
+        IcsItem items[ICS_MAX_YEAR_ITEMS];
+        int count = 0;
+
+        ics_load_lunar_year(year, current);
+        count = ics_collect_lunar_year(previous, options, first_day, last_day, items, count);
+        count = ics_collect_lunar_year(current, options, first_day, last_day, items, count);
+
+        for (int season = 0; options->seasons && season < 4 && count < ICS_MAX_YEAR_ITEMS; season++) {
+            double jde = calculate_solstice_equinox_jde(year, season);
+            if (jde != 0) {
+                items[count++] = (IcsItem){ jde, ICS_ITEM_SEASON, 0, 0, season };
+            }
+        }
+
+        qsort(items, (size_t)count, sizeof(IcsItem), compare_items);
+        for (int i = 0; i < count; i++) {
+            ics_write_item(writer, &items[i]);
+        }
+
+        if (extra_events != NULL && !extra_events(writer, year, user_data)) {
+            writer->failed = true;
+        }
+    }
+
+    bool ok = ics_writer_end(writer);
+    long events = writer->events;
+    free(writer);
+    return ok ? events : -1;
+}
@@ -0,0 +1,516 @@
+#define _GNU_SOURCE  /* For strcasestr() and memmem() */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "../include/lunar_calendar.h"
+#include "../include/lunar_loadgen.h"
+#include "../include/lunar_server.h"
+#include "../include/lunar_client.h"
+
+// --- Constants ---
+#define LOADGEN_MAX_CONNECTIONS 1024
+#define LOADGEN_REQUEST_MAX 512
+#define LOADGEN_HEADER_MAX 4096
+#define LOADGEN_READ_CHUNK 65536
+#define LOADGEN_STALL_MS 10000     /* Give up when no response arrives for this long */
+
+/* One client connection with at most one request in flight */
+typedef struct {
+    int fd;
+    bool connected;
+    bool answered_any;         /* Reconnect after a failure only if the daemon ever answered */
+    char request[LOADGEN_REQUEST_MAX];
+    size_t request_length;
+    size_t request_sent;
+    char header[LOADGEN_HEADER_MAX];
+    size_t header_length;
+    bool in_body;
+    long body_remaining;
+    int status;
+    bool server_closes;        /* Response said Connection: close */
+    struct timespec started;
+} LoadConnection;
+
+/* Shared state of a run */
+typedef struct {
+    const LoadgenOptions *options;
+    struct sockaddr_in address;
+    int epoll_fd;
+    long issued;
+    long completed;
+    long errors;
+    int active;
+    double *latencies_ms;
+} LoadRun;
+
+/**
+ * @brief Default load generator options
+ */
+LoadgenOptions default_loadgen_options(void) {
+    LoadgenOptions options;
+    memset(&options, 0, sizeof(options));
+    options.host = "127.0.0.1";
+    options.port = SERVER_DEFAULT_PORT;
+    options.connections = 8;
+    options.requests = 100000;
+    options.path = NULL;
+    options.socket_path = NULL;
+    return options;
+}
+
+static double elapsed_ms(const struct timespec *start, const struct timespec *end) {
+    return (double)(end->tv_sec - start->tv_sec) * 1000.0 + (double)(end->tv_nsec - start->tv_nsec) / 1e6;
+}
+
+/* Request target number n of the mixed workload: every endpoint in turn,
+ * with dates spread pseudo-randomly over 1900-2100 */
+static void mixed_path(long n, char *path, size_t size) {
+    uint64_t x = (uint64_t)n * 0x9E3779B97F4A7C15ull + 1;
+    x ^= x >> 31;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+
+    int year = 1900 + (int)(x % 201);
+    int month = 1 + (int)((x >> 12) % 12);
+    int day = 1 + (int)((x >> 20) % 22);
+
+    switch (n % 5) {
+        case 0:  snprintf(path, size, "/g2l?date=%04d-%02d-%02d", year, month, day); break;
+        case 1:  snprintf(path, size, "/l2g?year=%d&month=%d&day=%d", year, month, day); break;
+        case 2:  snprintf(path, size, "/phase?date=%04d-%02d-%02d", year, month, day); break;
+        case 3:  snprintf(path, size, "/year?year=%d", year); break;
+        default: snprintf(path, size, "/range?from=%04d-%02d-%02d&to=%04d-%02d-%02d",
+                          year, month, day, year, month, day + 6); break;
+    }
+}
+
+static void watch(LoadRun *run, LoadConnection *conn, uint32_t events, int op) {
+    struct epoll_event event = { .events = events, .data.ptr = conn };
+    epoll_ctl(run->epoll_fd, op, conn->fd, &event);
+}
+
+static bool open_connection(LoadRun *run, LoadConnection *conn) {
+    conn->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (conn->fd < 0) {
+        return false;
+    }
+    int one = 1;
+    setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    conn->connected = false;
+    if (connect(conn->fd, (struct sockaddr *)&run->address, sizeof(run->address)) < 0 &&
+        errno != EINPROGRESS) {
+        close(conn->fd);
+        conn->fd = -1;
+        return false;
+    }
+    watch(run, conn, EPOLLOUT, EPOLL_CTL_ADD);
+    return true;
+}
+
+static void close_connection(LoadRun *run, LoadConnection *conn) {
+    epoll_ctl(run->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    conn->fd = -1;
+    run->active--;
+}
+
+/* Send the unsent part of the current request */
+static bool send_request(LoadRun *run, LoadConnection *conn) {
+    while (conn->request_sent < conn->request_length) {
+        ssize_t sent = send(conn->fd, conn->request + conn->request_sent,
+                            conn->request_length - conn->request_sent, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                watch(run, conn, EPOLLOUT, EPOLL_CTL_MOD);
+                return true;
+            }
+            return false;
+        }
+        conn->request_sent += (size_t)sent;
+    }
+    watch(run, conn, EPOLLIN, EPOLL_CTL_MOD);
+    return true;
+}
+
+/* Issue the next request, or close the connection once all are issued */
+static bool start_request(LoadRun *run, LoadConnection *conn) {
+    if (run->issued >= run->options->requests) {
+        close_connection(run, conn);
+        return true;
+    }
+
+    char path[LOADGEN_REQUEST_MAX / 2];
+    if (run->options->path != NULL) {
+        snprintf(path, sizeof(path), "%s", run->options->path);
+    } else {
+        mixed_path(run->issued, path, sizeof(path));
+    }
+    run->issued++;
+
+    int length = snprintf(conn->request, sizeof(conn->request), "GET %s HTTP/1.1\r\nHost: %s:%d\r\n\r\n",
+                          path, run->options->host, run->options->port);
+    conn->request_length = length > 0 && (size_t)length < sizeof(conn->request) ? (size_t)length : 0;
+    conn->request_sent = 0;
+    conn->header_length = 0;
+    conn->in_body = false;
+    clock_gettime(CLOCK_MONOTONIC, &conn->started);
+    return send_request(run, conn);
+}
+
+/* A connection broke: count the request in flight as failed and reconnect
+ * if the daemon has answered on it before */
+static void connection_failed(LoadRun *run, LoadConnection *conn) {
+    bool retry = conn->answered_any;
+    run->errors++;
+    close_connection(run, conn);
+    if (retry && run->issued < run->options->requests && open_connection(run, conn)) {
+        run->active++;
+    }
+}
+
+static void response_done(LoadRun *run, LoadConnection *conn) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    run->latencies_ms[run->completed++] = elapsed_ms(&conn->started, &now);
+    if (conn->status != 200) {
+        run->errors++;
+    }
+    conn->answered_any = true;
+
+    if (conn->server_closes) {
+        close_connection(run, conn);
+        if (run->issued < run->options->requests && open_connection(run, conn)) {
+            run->active++;
+        }
+        return;
+    }
+    if (!start_request(run, conn)) {
+        connection_failed(run, conn);
+    }
+}
+
+/* Feed received bytes to the response parser */
+static bool consume_response(LoadRun *run, LoadConnection *conn, const char *data, size_t length) {
+    if (!conn->in_body) {
+        size_t room = LOADGEN_HEADER_MAX - 1 - conn->header_length;
+        size_t take = length < room ? length : room;
+        memcpy(conn->header + conn->header_length, data, take);
+        conn->header_length += take;
+        conn->header[conn->header_length] = '\0';
+
+        char *end = strstr(conn->header, "\r\n\r\n");
+        if (end == NULL) {
+            return conn->header_length < LOADGEN_HEADER_MAX - 1;
+        }
+        size_t header_size = (size_t)(end - conn->header) + 4;
+        *end = '\0';
+        conn->status = 0;
+        sscanf(conn->header, "HTTP/1.%*d %d", &conn->status);
+        const char *content_length = strcasestr(conn->header, "\r\nContent-Length:");
+        conn->body_remaining = content_length != NULL ? atol(content_length + 17) : 0;
+        conn->server_closes = strcasestr(conn->header, "\r\nConnection: close") != NULL;
+        conn->in_body = true;
+
+        /* Bytes after the header belong to the body */
+        size_t used = header_size - (conn->header_length - take);
+        data += used;
+        length -= used;
+    }
+
+    conn->body_remaining -= (long)length;
+    if (conn->body_remaining <= 0) {
+        response_done(run, conn);
+    }
+    return true;
+}
+
+static void on_readable(LoadRun *run, LoadConnection *conn) {
+    static char chunk[LOADGEN_READ_CHUNK];
+
+    long completed = run->completed;
+    for (;;) {
+        ssize_t received = recv(conn->fd, chunk, sizeof(chunk), 0);
+        if (received > 0) {
+            if (!consume_response(run, conn, chunk, (size_t)received)) {
+                connection_failed(run, conn);
+                return;
+            }
+            if (conn->fd < 0 || run->completed != completed) {
+                return;  /* Closed, or the response is complete and the next one is in flight */
+            }
+            continue;
+        }
+        if (received < 0 && errno == EINTR) continue;
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        connection_failed(run, conn);
+        return;
+    }
+}
+
+static void on_writable(LoadRun *run, LoadConnection *conn) {
+    if (!conn->connected) {
+        int error = 0;
+        socklen_t error_length = sizeof(error);
+        getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &error, &error_length);
+        if (error != 0) {
+            connection_failed(run, conn);
+            return;
+        }
+        conn->connected = true;
+        if (!start_request(run, conn)) {
+            connection_failed(run, conn);
+        }
+        return;
+    }
+    if (!send_request(run, conn)) {
+        connection_failed(run, conn);
+    }
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double left = *(const double *)a;
+    double right = *(const double *)b;
+    return (left > right) - (left < right);
+}
+
+static double percentile(const double *sorted, long count, double fraction) {
+    long index = (long)(fraction * (double)count + 0.999999) - 1;
+    if (index < 0) index = 0;
+    if (index >= count) index = count - 1;
+    return sorted[index];
+}
+
+// --- Binary Protocol ---
+
+/* One socket client thread; converts batches of dates until the run is done */
+typedef struct {
+    const LoadgenOptions *options;
+    pthread_mutex_t *lock;
+    long *batches_claimed;     /* Shared batch counter, guarded by lock */
+    double *latencies_ms;      /* One slot per batch of the run */
+    long completed;
+    long errors;
+    bool connected;
+} SocketWorker;
+
+static void *socket_worker(void *data) {
+    SocketWorker *worker = (SocketWorker *)data;
+    const LoadgenOptions *options = worker->options;
+    long batch_count = (options->requests + LOADGEN_SOCKET_BATCH - 1) / LOADGEN_SOCKET_BATCH;
+    LunarWireDate *dates = malloc(LOADGEN_SOCKET_BATCH * sizeof(LunarWireDate));
+    LunarWireDay *days = malloc(LOADGEN_SOCKET_BATCH * sizeof(LunarWireDay));
+    LunarClient client;
+
+    worker->connected = dates != NULL && days != NULL && lunar_client_connect(&client, options->socket_path);
+    while (worker->connected) {
+        pthread_mutex_lock(worker->lock);
+        long batch = (*worker->batches_claimed)++;
+        pthread_mutex_unlock(worker->lock);
+        if (batch >= batch_count) {
+            break;
+        }
+
+        long first = batch * LOADGEN_SOCKET_BATCH;
+        size_t count = (size_t)(options->requests - first < LOADGEN_SOCKET_BATCH ?
+                                options->requests - first : LOADGEN_SOCKET_BATCH);
+        /* Consecutive days from a pseudo-random start, as a bulk caller would send */
+        int day_number = 2415021 + (int)(((uint64_t)batch * 2654435761u) % 73000);
+        for (size_t i = 0; i < count; i++) {
+            int year, month, day;
+            day_number_to_gregorian(day_number + (int)i, &year, &month, &day);
+            dates[i] = (LunarWireDate){ year, (uint8_t)month, (uint8_t)day, 0 };
+        }
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        bool ok = lunar_client_g2l(&client, dates, count, days);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if (!ok) {
+            worker->errors += (long)count;
+            break;
+        }
+        worker->latencies_ms[batch] = elapsed_ms(&start, &end);
+        worker->completed += (long)count;
+        for (size_t i = 0; i < count; i++) {
+            if (days[i].lunar_day == 0) worker->errors++;
+        }
+    }
+
+    if (worker->connected) {
+        lunar_client_close(&client);
+    }
+    free(dates);
+    free(days);
+    return NULL;
+}
+
+/* Batch conversions over the Unix socket, one thread per connection */
+static bool run_socket_loadgen(const LoadgenOptions *options, int connection_count, LoadgenReport *report) {
+    long batch_count = (options->requests + LOADGEN_SOCKET_BATCH - 1) / LOADGEN_SOCKET_BATCH;
+    double *latencies_ms = calloc((size_t)batch_count, sizeof(double));
+    SocketWorker *workers = calloc((size_t)connection_count, sizeof(SocketWorker));
+    pthread_t *threads = calloc((size_t)connection_count, sizeof(pthread_t));
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    long batches_claimed = 0;
+
+    if (latencies_ms == NULL || workers == NULL || threads == NULL) {
+        free(latencies_ms);
+        free(workers);
+        free(threads);
+        return false;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int started = 0;
+    for (int i = 0; i < connection_count; i++) {
+        workers[i] = (SocketWorker){ options, &lock, &batches_claimed, latencies_ms, 0, 0, false };
+        if (pthread_create(&threads[started], NULL, socket_worker, &workers[i]) == 0) {
+            started++;
+        }
+    }
+    bool connected = false;
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+        report->completed += workers[i].completed;
+        report->errors += workers[i].errors;
+        connected = connected || workers[i].connected;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    report->seconds = elapsed_ms(&start, &end) / 1000.0;
+    report->qps = report->seconds > 0 ? (double)report->completed / report->seconds : 0;
+
+    /* Batches that were not converted keep a zero latency; leave them out */
+    long measured = 0;
+    for (long i = 0; i < batch_count; i++) {
+        if (latencies_ms[i] > 0) latencies_ms[measured++] = latencies_ms[i];
+    }
+    if (measured > 0) {
+        qsort(latencies_ms, (size_t)measured, sizeof(double), compare_doubles);
+        report->p50_ms = percentile(latencies_ms, measured, 0.50);
+        report->p90_ms = percentile(latencies_ms, measured, 0.90);
+        report->p99_ms = percentile(latencies_ms, measured, 0.99);
+        report->max_ms = latencies_ms[measured - 1];
+    }
+    if (!connected) {
+        fprintf(stderr, "Error: Could not connect to unix:%s\n", options->socket_path);
+    }
+
+    free(latencies_ms);
+    free(workers);
+    free(threads);
+    return connected && report->completed > 0;
+}
+
+/**
+ * @brief Run a closed-loop load test against the daemon
+ */
+bool run_loadgen(const LoadgenOptions *options, LoadgenReport *report) {
+    LoadRun run;
+    memset(&run, 0, sizeof(run));
+    memset(report, 0, sizeof(*report));
+    run.options = options;
+
+    int connection_count = options->connections;
+    if (connection_count < 1) connection_count = 1;
+    if (connection_count > LOADGEN_MAX_CONNECTIONS) connection_count = LOADGEN_MAX_CONNECTIONS;
+    if (options->requests < 1) {
+        return false;
+    }
+    if (options->socket_path != NULL) {
+        return run_socket_loadgen(options, connection_count, report);
+    }
+
+    run.address.sin_family = AF_INET;
+    run.address.sin_port = htons((uint16_t)options->port);
+    if (inet_pton(AF_INET, options->host, &run.address.sin_addr) != 1) {
+        fprintf(stderr, "Error: Invalid host address '%s'\n", options->host);
+        return false;
+    }
+
+    run.latencies_ms = malloc((size_t)options->requests * sizeof(double));
+    LoadConnection *connections = calloc((size_t)connection_count, sizeof(LoadConnection));
+    run.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (run.latencies_ms == NULL || connections == NULL || run.epoll_fd < 0) {
+        free(run.latencies_ms);
+        free(connections);
+        if (run.epoll_fd >= 0) close(run.epoll_fd);
+        return false;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < connection_count; i++) {
+        if (open_connection(&run, &connections[i])) {
+            run.active++;
+        }
+    }
+
+    bool stalled = false;
+    struct epoll_event events[64];
+    while (run.active > 0) {
+        int count = epoll_wait(run.epoll_fd, events, 64, LOADGEN_STALL_MS);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (count == 0) {
+            stalled = true;
+            break;
+        }
+        for (int i = 0; i < count; i++) {
+            LoadConnection *conn = (LoadConnection *)events[i].data.ptr;
+            if (conn->fd < 0) {
+                continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                if (conn->connected) {
+                    on_readable(&run, conn);
+                } else {
+                    on_writable(&run, conn);
+                }
+            } else if (events[i].events & EPOLLOUT) {
+                on_writable(&run, conn);
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for (int i = 0; i < connection_count; i++) {
+        if (connections[i].fd >= 0) {
+            close(connections[i].fd);
+        }
+    }
+    close(run.epoll_fd);
+    free(connections);
+
+    report->completed = run.completed;
+    report->errors = run.errors;
+    report->seconds = elapsed_ms(&start, &end) / 1000.0;
+    report->qps = report->seconds > 0 ? (double)run.completed / report->seconds : 0;
+    if (run.completed > 0) {
+        qsort(run.latencies_ms, (size_t)run.completed, sizeof(double), compare_doubles);
+        report->p50_ms = percentile(run.latencies_ms, run.completed, 0.50);
+        report->p90_ms = percentile(run.latencies_ms, run.completed, 0.90);
+        report->p99_ms = percentile(run.latencies_ms, run.completed, 0.99);
+        report->max_ms = run.latencies_ms[run.completed - 1];
+    }
+    free(run.latencies_ms);
+
+    if (stalled) {
+        fprintf(stderr, "Error: No response for %d ms; giving up\n", LOADGEN_STALL_MS);
+    }
+    return !stalled && run.completed > 0;
+}
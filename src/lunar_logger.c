@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include "../include/lunar_logger.h"
+
+// --- Constants ---
+#define LOGGER_QUEUE_SLOTS 1024        /* A power of two */
+#define LOGGER_MESSAGE_MAX 512
+
+static const char *LEVEL_NAMES[] = { "NONE", "ERROR", "WARNING", "INFO", "DEBUG" };
+static const char *STDERR_PREFIXES[] = { "", "Error", "Warning", "Info", "Debug" };
+
+/* One queued line. A slot is free for the producer claiming queue position p
+ * when sequence == p, and holds a line for the writer when sequence == p + 1. */
+typedef struct {
+    atomic_size_t sequence;
+    LunarLogLevel level;
+    struct timespec time;
+    char message[LOGGER_MESSAGE_MAX];
+} LoggerSlot;
+
+struct LunarLogger {
+    FILE *stream;
+    bool owns_stream;                  /* Opened by the logger (not stderr) */
+    atomic_int max_level;
+    LoggerSlot slots[LOGGER_QUEUE_SLOTS];
+    atomic_size_t tail;                /* Next position producers claim */
+    size_t head;                       /* Next position the writer reads */
+    atomic_ulong dropped;
+    unsigned long dropped_reported;    /* Writer only */
+    atomic_llong rate_second;          /* Second the rate count is for */
+    atomic_int rate_count;
+    sem_t pending;                     /* Posted once per queued line */
+    atomic_bool stopping;
+    pthread_t writer;
+};
+
+static _Atomic(LunarLogger *) g_default_logger = NULL;
+
+// --- Writer ---
+
+static void write_line(LunarLogger *logger, const LoggerSlot *slot) {
+    struct tm local;
+    char stamp[32];
+
+    localtime_r(&slot->time.tv_sec, &local);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+    fprintf(logger->stream, "%s.%03ld %s %s\n", stamp, slot->time.tv_nsec / 1000000L,
+            LEVEL_NAMES[slot->level], slot->message);
+}
+
+/* Write every line queued so far, then note any that were dropped */
+static void drain_queue(LunarLogger *logger) {
+    for (;;) {
+        LoggerSlot *slot = &logger->slots[logger->head & (LOGGER_QUEUE_SLOTS - 1)];
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != logger->head + 1) {
+            break;
+        }
+        write_line(logger, slot);
+        atomic_store_explicit(&slot->sequence, logger->head + LOGGER_QUEUE_SLOTS, memory_order_release);
+        logger->head++;
+    }
+
+    unsigned long dropped = atomic_load_explicit(&logger->dropped, memory_order_relaxed);
+    if (dropped != logger->dropped_reported) {
+        fprintf(logger->stream, "(%lu log lines dropped)\n", dropped - logger->dropped_reported);
+        logger->dropped_reported = dropped;
+    }
+    fflush(logger->stream);
+}
+
+static void *logger_writer(void *arg) {
+    LunarLogger *logger = arg;
+
+    for (;;) {
+        while (sem_wait(&logger->pending) != 0 && errno == EINTR) {
+        }
+        bool stopping = atomic_load(&logger->stopping);
+        drain_queue(logger);
+        if (stopping) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+// --- Lifecycle ---
+
+LunarLogger *lunar_logger_new(const char *path, LunarLogLevel max_level) {
+    LunarLogger *logger = calloc(1, sizeof(LunarLogger));
+    if (logger == NULL) {
+        return NULL;
+    }
+
+    if (path != NULL && path[0] != '\0') {
+        logger->stream = fopen(path, "a");
+        logger->owns_stream = true;
+    } else {
+        logger->stream = stderr;
+    }
+    if (logger->stream == NULL || sem_init(&logger->pending, 0, 0) != 0) {
+        free(logger);
+        return NULL;
+    }
+    for (size_t i = 0; i < LOGGER_QUEUE_SLOTS; i++) {
+        atomic_init(&logger->slots[i].sequence, i);
+    }
+    atomic_init(&logger->max_level, max_level);
+
+    if (pthread_create(&logger->writer, NULL, logger_writer, logger) != 0) {
+        sem_destroy(&logger->pending);
+        if (logger->owns_stream) {
+            fclose(logger->stream);
+        }
+        free(logger);
+        return NULL;
+    }
+    return logger;
+}
+
+void lunar_logger_free(LunarLogger *logger) {
+    if (logger == NULL) {
+        return;
+    }
+    LunarLogger *expected = logger;
+    atomic_compare_exchange_strong(&g_default_logger, &expected, NULL);
+
+    atomic_store(&logger->stopping, true);
+    sem_post(&logger->pending);
+    pthread_join(logger->writer, NULL);
+    if (logger->owns_stream) {
+        fclose(logger->stream);
+    }
+    sem_destroy(&logger->pending);
+    free(logger);
+}
+
+void lunar_logger_set_level(LunarLogger *logger, LunarLogLevel max_level) {
+    atomic_store_explicit(&logger->max_level, max_level, memory_order_relaxed);
+}
+
+void lunar_logger_set_default(LunarLogger *logger) {
+    atomic_store(&g_default_logger, logger);
+}
+
+LunarLogger *lunar_logger_get_default(void) {
+    return atomic_load(&g_default_logger);
+}
+
+unsigned long lunar_logger_dropped(const LunarLogger *logger) {
+    return atomic_load_explicit(&logger->dropped, memory_order_relaxed);
+}
+
+// --- Logging ---
+
+bool lunar_logger_enabled(const LunarLogger *logger, LunarLogLevel level) {
+    if (logger == NULL) {
+        logger = atomic_load_explicit(&g_default_logger, memory_order_acquire);
+    }
+    if (level <= LUNAR_LOG_NONE || level > LUNAR_LOG_DEBUG) {
+        return false;
+    }
+    if (logger == NULL) {
+        return level <= LUNAR_LOG_WARNING;
+    }
+    return (int)level <= atomic_load_explicit(&logger->max_level, memory_order_relaxed);
+}
+
+/* Count the line against this second's allowance */
+static bool within_rate(LunarLogger *logger, long long second) {
+    long long window = atomic_load_explicit(&logger->rate_second, memory_order_relaxed);
+    if (window != second &&
+        atomic_compare_exchange_strong_explicit(&logger->rate_second, &window, second,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+        atomic_store_explicit(&logger->rate_count, 0, memory_order_relaxed);
+    }
+    return atomic_fetch_add_explicit(&logger->rate_count, 1, memory_order_relaxed) < LUNAR_LOGGER_RATE_LIMIT;
+}
+
+static void logger_enqueue(LunarLogger *logger, LunarLogLevel level, const char *format, va_list args) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    if (!within_rate(logger, (long long)now.tv_sec)) {
+        atomic_fetch_add_explicit(&logger->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    /* Claim a free slot; a full queue drops the line rather than wait */
+    size_t position = atomic_load_explicit(&logger->tail, memory_order_relaxed);
+    LoggerSlot *slot;
+    for (;;) {
+        slot = &logger->slots[position & (LOGGER_QUEUE_SLOTS - 1)];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&logger->tail, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            atomic_fetch_add_explicit(&logger->dropped, 1, memory_order_relaxed);
+            return;
+        } else {
+            position = atomic_load_explicit(&logger->tail, memory_order_relaxed);
+        }
+    }
+
+    slot->level = level;
+    slot->time = now;
+    vsnprintf(slot->message, sizeof(slot->message), format, args);
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+    sem_post(&logger->pending);
+}
+
+void lunar_logger_log(LunarLogger *logger, LunarLogLevel level, const char *format, ...) {
+    va_list args;
+
+    if (logger == NULL) {
+        logger = atomic_load_explicit(&g_default_logger, memory_order_acquire);
+    }
+    if (!lunar_logger_enabled(logger, level)) {
+        return;
+    }
+    va_start(args, format);
+    if (logger != NULL) {
+        logger_enqueue(logger, level, format, args);
+    } else {
+        fprintf(stderr, "%s: ", STDERR_PREFIXES[level]);
+        vfprintf(stderr, format, args);
+        fputc('\n', stderr);
+    }
+    va_end(args);
+}
+
+void lunar_logger_callback(LunarLogLevel level, const char *message, void *user_data) {
+    lunar_logger_log((LunarLogger *)user_data, level, "%s", message);
+}
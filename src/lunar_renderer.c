@@ -2,7 +2,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
 #include <time.h>
+#include <math.h>
 #include "../include/lunar_calendar.h"
 #include "../include/lunar_renderer.h"
 
@@ -10,6 +12,19 @@
 #define LEAP_YEARS_COUNT 7
 static const int LEAP_YEARS_IN_CYCLE[] = {3, 6, 8, 11, 14, 17, 19};
 
+/* Moon phase glyphs (two terminal columns each), indexed by MoonPhase */
+static const char *MOON_GLYPHS[] = {
+    "🌑", "🌒", "🌓", "🌔", "🌕", "🌖", "🌗", "🌘"
+};
+
+/* Weekday column headers, Sunday first */
+static const char *WEEKDAY_HEADERS[] = { "Su", "Mo", "Tu", "We", "Th", "Fr", "Sa" };
+
+/* Lines in a month block: header, weekday names, rule, six weeks */
+#define MONTH_BLOCK_LINES 9
+#define MONTH_BLOCK_WEEKS 6
+#define MONTH_BLOCK_GAP "   "
+
 /* Month names array */
 static const char *MONTH_NAMES[] = {
     "January", "February", "March", "April", "May", "June",
@@ -24,131 +39,174 @@ RenderOptions default_render_options(void) {
         .show_weekday = true,
         .use_colors = true,
         .highlight_today = true,
-        .highlight_special_days = true
+        .highlight_special_days = true,
+        .months_per_row = 2
     };
     return options;
 }
 
-/* Determine if a date is a special day */
+static int day_number_of(int year, int month, int day) {
+    return (int)floor(gregorian_to_julian_day(year, month, day, 12.0));
+}
+
+/* Determine if a date is a special day. Builds a one-day set; use a
+ * SpecialDaySet directly when classifying many days. */
 SpecialDayType get_special_day_type(LunarDay day) {
-    /* Check if it's today */
-    time_t now = time(NULL);
-    struct tm *today = localtime(&now);
-    
-    if (day.greg_year == today->tm_year + 1900 &&
-        day.greg_month == today->tm_mon + 1 &&
-        day.greg_day == today->tm_mday) {
-        return TODAY;
+    return lunar_ctx_special_day_type(NULL, day);
+}
+
+SpecialDayType lunar_ctx_special_day_type(LunarContext *ctx, LunarDay day) {
+    SpecialDaySet set;
+    int day_number = day_number_of(day.greg_year, day.greg_month, day.greg_day);
+
+    if (!lunar_ctx_special_day_set_build(ctx, &set, day_number, 1, true)) {
+        return NORMAL_DAY;
     }
-    
-    /* Check moon phases directly from LunarDay struct */
-    if (day.moon_phase == NEW_MOON) {
-        return NEW_MOON_DAY;
+    return special_day_set_classify(&set, day_number);
+}
+
+/* Short name of a special day type; empty for a normal day */
+const char *get_special_day_name(SpecialDayType type) {
+    static const char *NAMES[SPECIAL_DAY_TYPE_COUNT] = {
+        "", "today", "new_moon", "full_moon", "new_year",
+        "winter_solstice", "spring_equinox", "summer_solstice", "fall_equinox", "festival"
+    };
+    return (type >= NORMAL_DAY && type < SPECIAL_DAY_TYPE_COUNT) ? NAMES[type] : "";
+}
+
+/* --- Special Day Sets --- */
+
+void special_day_set_mark(SpecialDaySet *set, int day_number, SpecialDayType type) {
+    int index = day_number - set->first_day;
+    if (index >= 0 && index < set->day_count && type > NORMAL_DAY && type < SPECIAL_DAY_TYPE_COUNT) {
+        set->bits[type][index / 64] |= UINT64_C(1) << (index % 64);
     }
-    if (day.moon_phase == FULL_MOON) {
-        /* Check if it's the first day of a lunar month */
-        if (day.lunar_day == 1) {
-             return FULL_MOON_DAY; /* Emphasize month start */
-        } /* Else just mark as full moon anyway? */
-        return FULL_MOON_DAY;
+}
+
+bool special_day_set_has(const SpecialDaySet *set, int day_number, SpecialDayType type) {
+    int index = day_number - set->first_day;
+    if (index < 0 || index >= set->day_count || type <= NORMAL_DAY || type >= SPECIAL_DAY_TYPE_COUNT) {
+        return false;
     }
-    
-    /* Check if it's the Lunar New Year */
-    /* Calculate the JD for the start of the lunar year this day falls into */
-    double new_year_jd = calculate_lunar_new_year_jd(day.lunar_year); 
-    if (new_year_jd > 0) {
-        /* Convert the New Year JD back to Gregorian */
-        int ny_year, ny_month, ny_day;
-        double hour_unused;
-        julian_day_to_gregorian(new_year_jd, &ny_year, &ny_month, &ny_day, &hour_unused);
-        
-        /* Compare Gregorian dates */
-        if (day.greg_year == ny_year && day.greg_month == ny_month && day.greg_day == ny_day) {
-            return GERMANIC_NEW_YEAR_DAY; /* Keep enum name, but logic is updated */
-        }
+    return (set->bits[type][index / 64] >> (index % 64)) & 1;
+}
+
+SpecialDayType special_day_set_classify(const SpecialDaySet *set, int day_number) {
+    static const SpecialDayType PRIORITY[] = {
+        TODAY, GERMANIC_NEW_YEAR_DAY,
+        WINTER_SOLSTICE_DAY, SPRING_EQUINOX_DAY, SUMMER_SOLSTICE_DAY, FALL_EQUINOX_DAY,
+        NEW_MOON_DAY, FULL_MOON_DAY, FESTIVAL_DAY
+    };
+    int index = day_number - set->first_day;
+
+    if (index < 0 || index >= set->day_count) {
+        return NORMAL_DAY;
     }
-    
-    /* Check if winter solstice */
-    int ws_month, ws_day;
-    /* Use the Gregorian year for solstice calculation */
-    if (calculate_winter_solstice(day.greg_year, &ws_month, &ws_day)) {
-        if (day.greg_month == ws_month && day.greg_day == ws_day) {
-            return WINTER_SOLSTICE_DAY;
+    for (size_t i = 0; i < sizeof(PRIORITY) / sizeof(PRIORITY[0]); i++) {
+        if ((set->bits[PRIORITY[i]][index / 64] >> (index % 64)) & 1) {
+            return PRIORITY[i];
         }
     }
-    
-    /* Check if spring equinox */
-    int se_month, se_day;
-    if (calculate_spring_equinox(day.greg_year, &se_month, &se_day)) {
-        if (day.greg_month == se_month && day.greg_day == se_day) {
-            return SPRING_EQUINOX_DAY;
+    return NORMAL_DAY;
+}
+
+/* Mark the days whose noon lies within the phase tolerance of every instant
+ * of a phase in the set; the same days calculate_moon_phase names after it */
+static void mark_phase_days(SpecialDaySet *set, int phase_type, SpecialDayType type) {
+    int last_day = set->first_day + set->day_count - 1;
+    double tolerance = lunar_ctx_phase_tolerance(NULL);
+    double jd = find_next_phase_jd(set->first_day - 1.0, phase_type);
+
+    while (jd != 0 && jd - tolerance < last_day) {
+        int first = (int)floor(jd - tolerance) + 1;
+        int last = (int)ceil(jd + tolerance) - 1;
+        for (int day_number = first; day_number <= last; day_number++) {
+            special_day_set_mark(set, day_number, type);
         }
+        jd = find_next_phase_jd(jd + 1.0, phase_type);
     }
-    
-    /* Check if summer solstice */
-    int ss_month, ss_day;
-    if (calculate_summer_solstice(day.greg_year, &ss_month, &ss_day)) {
-        if (day.greg_month == ss_month && day.greg_day == ss_day) {
-            return SUMMER_SOLSTICE_DAY;
-        }
+}
+
+bool special_day_set_build(SpecialDaySet *set, int first_day, int day_count, bool mark_today) {
+    return lunar_ctx_special_day_set_build(NULL, set, first_day, day_count, mark_today);
+}
+
+/* Build a special day set with the active context's tolerance and today */
+static bool build_special_days(SpecialDaySet *set, int first_day, int day_count, bool mark_today) {
+    static const SpecialDayType SEASON_TYPES[] = {
+        WINTER_SOLSTICE_DAY, SPRING_EQUINOX_DAY, SUMMER_SOLSTICE_DAY, FALL_EQUINOX_DAY
+    };
+    int first_year, last_year, month, day;
+
+    if (!set || day_count <= 0 || day_count > SPECIAL_DAY_SET_MAX_DAYS) {
+        return false;
     }
-    
-    /* Check if fall equinox */
-    int fe_month, fe_day;
-    if (calculate_fall_equinox(day.greg_year, &fe_month, &fe_day)) {
-        if (day.greg_month == fe_month && day.greg_day == fe_day) {
-            return FALL_EQUINOX_DAY;
+    memset(set, 0, sizeof(*set));
+    set->first_day = first_day;
+    set->day_count = day_count;
+
+    mark_phase_days(set, 0, NEW_MOON_DAY);
+    mark_phase_days(set, 2, FULL_MOON_DAY);
+
+    /* New years and seasons of every Gregorian year the range touches; a
+     * lunar year starts in January or February of the year it is named after */
+    day_number_to_gregorian(first_day, &first_year, &month, &day);
+    day_number_to_gregorian(first_day + day_count - 1, &last_year, &month, &day);
+    for (int year = first_year; year <= last_year; year++) {
+        double new_year_jd = calculate_lunar_new_year_jd(year);
+        if (new_year_jd != 0) {
+            special_day_set_mark(set, (int)ceil(new_year_jd - 1e-5), GERMANIC_NEW_YEAR_DAY);
+        }
+        for (int season = 0; season < 4; season++) {
+            double jde = calculate_solstice_equinox_jde(year, season);
+            if (jde != 0) {
+                special_day_set_mark(set, (int)floor(jde + 0.5), SEASON_TYPES[season]);
+            }
         }
     }
-    
-    /* TODO: Add checks for user-defined festivals/events if needed */
-    
-    return NORMAL_DAY;
+
+    if (mark_today) {
+        special_day_set_mark(set, lunar_ctx_today_day_number(NULL), TODAY);
+    }
+    return true;
 }
 
-/* Format a cell for a special day with appropriate coloring */
-char *format_special_day(SpecialDayType type, RenderOptions options, const char *text) {
-    if (!options.use_colors || !options.highlight_special_days) {
-        return strdup(text);
+bool lunar_ctx_special_day_set_build(LunarContext *ctx, SpecialDaySet *set, int first_day, int day_count,
+                                     bool mark_today) {
+    if (ctx == NULL) {
+        return build_special_days(set, first_day, day_count, mark_today);
     }
-    
-    char *result = NULL;
-    const char *color_code = COLOR_RESET;
-    
+    LunarContext *previous = lunar_ctx_activate(ctx);
+    bool built = build_special_days(set, first_day, day_count, mark_today);
+    lunar_ctx_activate(previous);
+    return built;
+}
+
+/* ANSI color of a special day, or NULL for a normal day */
+static const char *special_day_color(SpecialDayType type) {
     switch (type) {
-        case TODAY:
-            color_code = COLOR_BOLD COLOR_BLUE;
-            break;
-        case NEW_MOON_DAY:
-            color_code = COLOR_BOLD COLOR_WHITE;
-            break;
-        case FULL_MOON_DAY:
-            color_code = COLOR_BOLD COLOR_YELLOW;
-            break;
-        case GERMANIC_NEW_YEAR_DAY:
-            color_code = COLOR_BOLD COLOR_RED;
-            break;
-        case WINTER_SOLSTICE_DAY:
-            color_code = COLOR_BOLD COLOR_CYAN;
-            break;
-        case SPRING_EQUINOX_DAY:
-            color_code = COLOR_BOLD COLOR_GREEN;
-            break;
-        case SUMMER_SOLSTICE_DAY:
-            color_code = COLOR_BOLD COLOR_RED;
-            break;
-        case FALL_EQUINOX_DAY:
-            color_code = COLOR_BOLD COLOR_MAGENTA;
-            break;
-        case FESTIVAL_DAY:
-            color_code = COLOR_BOLD COLOR_MAGENTA;
-            break;
+        case TODAY:                 return COLOR_BOLD COLOR_BLUE;
+        case NEW_MOON_DAY:          return COLOR_BOLD COLOR_WHITE;
+        case FULL_MOON_DAY:         return COLOR_BOLD COLOR_YELLOW;
+        case GERMANIC_NEW_YEAR_DAY: return COLOR_BOLD COLOR_RED;
+        case WINTER_SOLSTICE_DAY:   return COLOR_BOLD COLOR_CYAN;
+        case SPRING_EQUINOX_DAY:    return COLOR_BOLD COLOR_GREEN;
+        case SUMMER_SOLSTICE_DAY:   return COLOR_BOLD COLOR_RED;
+        case FALL_EQUINOX_DAY:      return COLOR_BOLD COLOR_MAGENTA;
+        case FESTIVAL_DAY:          return COLOR_BOLD COLOR_MAGENTA;
         case NORMAL_DAY:
-        default:
-            return strdup(text);
+        default:                    return NULL;
+    }
+}
+
+/* Format a cell for a special day with appropriate coloring */
+char *format_special_day(SpecialDayType type, RenderOptions options, const char *text) {
+    const char *color_code = special_day_color(type);
+    if (!options.use_colors || !options.highlight_special_days || !color_code) {
+        return strdup(text);
     }
     
-    result = malloc(strlen(text) + strlen(color_code) + strlen(COLOR_RESET) + 1);
+    char *result = malloc(strlen(text) + strlen(color_code) + strlen(COLOR_RESET) + 1);
     if (result) {
         sprintf(result, "%s%s%s", color_code, text, COLOR_RESET);
     }
@@ -156,205 +214,430 @@ char *format_special_day(SpecialDayType type, RenderOptions options, const char
     return result;
 }
 
-/* Calculate cell width based on options */
+/* Calculate cell width based on options, including the separating space */
 int calculate_cell_width(RenderOptions options) {
-    int width = 3; /* Minimum width for day number */
+    int width = 3; /* Day number and separator */
     
     if (options.show_gregorian_date) {
-        width += 5; /* Space for G-DD */
+        width += 5; /* " (DD)" Gregorian day */
     }
     
     if (options.show_moon_phase) {
-        width += 2; /* Space for symbol */
+        width += 3; /* Space and two-column glyph */
     }
     
     return width;
 }
 
-/* Simple month rendering function */
-RenderedMonth render_lunar_month(int year, int month, RenderOptions options __attribute__((unused))) {
-    RenderedMonth result = {0};
-    
-    /* Allocate a reasonable-sized buffer */
-    result.buffer_size = 4096;
-    result.buffer = malloc(result.buffer_size);
-    
-    if (!result.buffer) {
-        return result;
+/* --- Render Sinks --- */
+
+/* Initialize a sink that collects text in memory */
+void render_sink_init_buffer(RenderSink *sink) {
+    memset(sink, 0, sizeof(*sink));
+}
+
+/* Initialize a sink that writes to a stream */
+void render_sink_init_stream(RenderSink *sink, FILE *stream) {
+    memset(sink, 0, sizeof(*sink));
+    sink->stream = stream;
+}
+
+/* Make room for `extra` more bytes plus the terminator */
+static bool render_sink_reserve(RenderSink *sink, size_t extra) {
+    if (sink->length + extra + 1 <= sink->capacity) {
+        return true;
     }
-    
-    /* Start with a clean buffer */
-    result.buffer[0] = '\0';
-    
-    /* Build a simple text representation */
-    char temp[4096];
+    size_t capacity = sink->capacity ? sink->capacity : 1024;
+    while (capacity < sink->length + extra + 1) {
+        capacity *= 2;
+    }
+    char *buffer = realloc(sink->buffer, capacity);
+    if (!buffer) {
+        sink->failed = true;
+        return false;
+    }
+    sink->buffer = buffer;
+    sink->capacity = capacity;
+    return true;
+}
+
+/* Append text to a sink */
+void render_sink_append(RenderSink *sink, const char *text, size_t length) {
+    if (sink->failed) {
+        return;
+    }
+    if (sink->stream) {
+        if (fwrite(text, 1, length, sink->stream) != length) {
+            sink->failed = true;
+        }
+        return;
+    }
+    if (render_sink_reserve(sink, length)) {
+        memcpy(sink->buffer + sink->length, text, length);
+        sink->length += length;
+        sink->buffer[sink->length] = '\0';
+    }
+}
+
+void render_sink_puts(RenderSink *sink, const char *text) {
+    render_sink_append(sink, text, strlen(text));
+}
+
+void render_sink_printf(RenderSink *sink, const char *format, ...) {
+    va_list args;
+    if (sink->failed) {
+        return;
+    }
+
+    va_start(args, format);
+    if (sink->stream) {
+        if (vfprintf(sink->stream, format, args) < 0) {
+            sink->failed = true;
+        }
+        va_end(args);
+        return;
+    }
+
+    /* Format straight into the buffer, growing it once if needed */
+    va_list retry;
+    va_copy(retry, args);
+    size_t available = sink->capacity > sink->length ? sink->capacity - sink->length : 0;
+    int needed = vsnprintf(available ? sink->buffer + sink->length : NULL, available, format, args);
+    if (needed >= 0 && (size_t)needed >= available) {
+        if (render_sink_reserve(sink, (size_t)needed)) {
+            vsnprintf(sink->buffer + sink->length, (size_t)needed + 1, format, retry);
+        }
+    }
+    if (needed < 0) {
+        sink->failed = true;
+    } else if (!sink->failed) {
+        sink->length += (size_t)needed;
+    }
+    va_end(retry);
+    va_end(args);
+}
+
+/* Release a buffer sink's text */
+void render_sink_reset(RenderSink *sink) {
+    sink->length = 0;
+    sink->failed = false;
+    if (sink->buffer) {
+        sink->buffer[0] = '\0';
+    }
+}
+
+void render_sink_free(RenderSink *sink) {
+    free(sink->buffer);
+    sink->buffer = NULL;
+    sink->length = 0;
+    sink->capacity = 0;
+}
+
+/* Count the lines of collected text */
+static int count_lines(const char *text) {
+    int lines = 0;
+    for (const char *p = text; *p; p++) {
+        if (*p == '\n') lines++;
+    }
+    return lines;
+}
+
+/* --- Cell Layout --- */
+
+static void render_spaces(RenderSink *sink, int count) {
+    static const char SPACES[] = "                                                                ";
+    while (count > 0) {
+        int chunk = count < (int)sizeof(SPACES) - 1 ? count : (int)sizeof(SPACES) - 1;
+        render_sink_append(sink, SPACES, (size_t)chunk);
+        count -= chunk;
+    }
+}
+
+/* Write text centered in width columns (ASCII text; cut if too long) */
+static void render_centered(RenderSink *sink, const char *text, int width) {
+    int length = (int)strlen(text);
+    if (length > width) length = width;
+    int left = (width - length) / 2;
+    render_spaces(sink, left);
+    render_sink_append(sink, text, (size_t)length);
+    render_spaces(sink, width - length - left);
+}
+
+/* Write one day cell (without the separating space) */
+static void render_day_cell(RenderSink *sink, const LunarDay *day, SpecialDayType type, RenderOptions options) {
+    const char *color = (options.use_colors && options.highlight_special_days) ? special_day_color(type) : NULL;
+
+    if (color) render_sink_puts(sink, color);
+    render_sink_printf(sink, "%2d", day->lunar_day);
+    if (options.show_gregorian_date) {
+        render_sink_printf(sink, " (%2d)", day->greg_day);
+    }
+    if (options.show_moon_phase) {
+        render_sink_puts(sink, " ");
+        render_sink_puts(sink, (day->moon_phase >= NEW_MOON && day->moon_phase <= WANING_CRESCENT)
+                               ? MOON_GLYPHS[day->moon_phase] : "  ");
+    }
+    if (color) render_sink_puts(sink, COLOR_RESET);
+}
+
+/* Write one line of a month block; every line is 7 cells wide */
+static void render_month_block_line(RenderSink *sink, const LunarYear *year, int month_index,
+                                     int day_offset, const SpecialDaySet *special_days, int line,
+                                     RenderOptions options) {
+    const LunarMonth *month = &year->months[month_index];
+    int cell_width = calculate_cell_width(options);
+    int block_width = cell_width * 7;
+
+    if (line == 0) {
+        char header[64];
+        const char *month_name = MONTH_NAMES[month_index < 12 ? month_index : 12];
+        snprintf(header, sizeof(header), "%s (%d days)", month_name, month->days_count);
+        render_centered(sink, header, block_width - 1);
+        render_spaces(sink, 1);
+        return;
+    }
+    if (line == 1) {
+        for (int c = 0; c < 7; c++) {
+            if (options.show_weekday) {
+                render_sink_puts(sink, WEEKDAY_HEADERS[c]);
+                render_spaces(sink, cell_width - 2);
+            } else {
+                render_spaces(sink, cell_width);
+            }
+        }
+        return;
+    }
+    if (line == 2) {
+        for (int i = 0; i < block_width - 1; i++) {
+            render_sink_append(sink, "-", 1);
+        }
+        render_spaces(sink, 1);
+        return;
+    }
+
+    int week = line - 3;
+    int first_weekday = month->days_count > 0 ? (int)month->days[0].weekday : 0;
+    for (int c = 0; c < 7; c++) {
+        int d = week * 7 + c - first_weekday;
+        if (d < 0 || d >= month->days_count) {
+            render_spaces(sink, cell_width);
+            continue;
+        }
+        render_day_cell(sink, &month->days[d],
+                        special_day_set_classify(special_days, special_days->first_day + day_offset + d),
+                        options);
+        render_spaces(sink, 1);
+    }
+}
+
+/* Offset of each month's first day from the first day of the year */
+static void month_day_offsets(const LunarYear *year, int offsets[13]) {
+    int offset = 0;
+    for (int m = 0; m < year->months_count; m++) {
+        offsets[m] = offset;
+        offset += year->months[m].days_count;
+    }
+}
+
+/* --- Rendering --- */
+
+/* Special days of a computed year, built once per rendered year */
+static void build_year_special_days(const LunarYear *year, RenderOptions options, SpecialDaySet *set) {
+    const LunarDay *first = &year->months[0].days[0];
+    int day_count = 0;
+
+    for (int m = 0; m < year->months_count; m++) {
+        day_count += year->months[m].days_count;
+    }
+    special_day_set_build(set, day_number_of(first->greg_year, first->greg_month, first->greg_day),
+                          day_count, options.highlight_today);
+}
+
+/* Render one month of a computed year */
+static void render_month_of_year(RenderSink *sink, const LunarYear *year, int month, RenderOptions options) {
+    const LunarMonth *lunar_month = &year->months[month - 1];
+    const LunarDay *first = &lunar_month->days[0];
+    const LunarDay *last = &lunar_month->days[lunar_month->days_count - 1];
     const char *month_name = (month <= 12) ? MONTH_NAMES[month - 1] : MONTH_NAMES[12];
-    
-    /* Format basic info */
-    sprintf(temp, "Lunar Month: %s %d\n", month_name, year);
-    strcat(result.buffer, temp);
-    
-    strcat(result.buffer, "--------------------\n");
-    
-    /* Add days in simple format */
-    // int days_in_month = calculate_lunar_month_length(year, month); // This function is obsolete
-    sprintf(temp, "Days in month: %d\n\n", 29); // Using a hardcoded value as the original function is obsolete
-    strcat(result.buffer, temp);
-    
-    /* Create a basic calendar grid */
-    strcat(result.buffer, "Su Mo Tu We Th Fr Sa\n");
-    strcat(result.buffer, "--------------------\n");
-    
-    /* Calculate the weekday of the first day of the month */
-    int first_day_of_month = 1;
-    
-    /* Get the Gregorian date for the 1st of the month */
-    int greg_year, greg_month, greg_day;
-    
-    /* Try to convert lunar to Gregorian */
-    if (!lunar_to_gregorian(year, month, first_day_of_month, 
-                          &greg_year, &greg_month, &greg_day)) {
-        /* If conversion fails, approximate */
-        greg_year = year;
-        greg_month = month;
-        greg_day = 1;
+    SpecialDaySet special_days;
+    int offsets[13];
+
+    build_year_special_days(year, options, &special_days);
+    month_day_offsets(year, offsets);
+
+    render_sink_printf(sink, "Lunar Month: %s %d\n", month_name, year->year);
+    render_sink_puts(sink, "--------------------\n");
+    render_sink_printf(sink, "Days in month: %d\n", lunar_month->days_count);
+    render_sink_printf(sink, "Gregorian: %04d-%02d-%02d to %04d-%02d-%02d\n\n",
+                       first->greg_year, first->greg_month, first->greg_day,
+                       last->greg_year, last->greg_month, last->greg_day);
+
+    for (int line = 1; line < MONTH_BLOCK_LINES; line++) {
+        render_month_block_line(sink, year, month - 1, offsets[month - 1], &special_days, line, options);
+        render_sink_puts(sink, "\n");
     }
-    
-    /* Calculate the weekday for the first day */
-    Weekday first_day_weekday = calculate_weekday(greg_year, greg_month, greg_day);
-    
-    /* Add leading spaces for the first week */
-    for (int i = 0; i < first_day_weekday; i++) {
-        strcat(result.buffer, "   ");
+}
+
+/* Render a month calendar to a sink */
+bool render_lunar_month_to(RenderSink *sink, int year, int month, RenderOptions options) {
+    LunarYear lunar_year;
+    if (!calculate_lunar_year(year, &lunar_year) || month < 1 || month > lunar_year.months_count) {
+        return false;
     }
-    
-    /* Current weekday position (0-6) */
-    int current_weekday = first_day_weekday;
-    
-    /* Add all days of the month */
-    for (int day = 1; day <= 29; day++) {
-        sprintf(temp, "%2d ", day);
-        strcat(result.buffer, temp);
-        
-        /* Increment weekday and add line break if it's end of week */
-        current_weekday = (current_weekday + 1) % 7;
-        if (current_weekday == 0 && day < 29) {
-            strcat(result.buffer, "\n");
+    render_month_of_year(sink, &lunar_year, month, options);
+    return !sink->failed;
+}
+
+/* Render a year as rows of months_per_row month blocks */
+static void render_year_grid(RenderSink *sink, const LunarYear *year, RenderOptions options) {
+    int eld_year = calculate_eld_year_from_gregorian(year->year);
+    int metonic_year = 0;
+    int metonic_cycle = 0;
+    int per_row = options.months_per_row > 0 ? options.months_per_row : 1;
+    SpecialDaySet special_days;
+    int offsets[13];
+
+    get_metonic_position(year->year, &metonic_year, &metonic_cycle);
+    build_year_special_days(year, options, &special_days);
+    month_day_offsets(year, offsets);
+
+    render_sink_printf(sink, "Lunar Calendar for Year %d (Eld Year %d)\n", year->year, eld_year);
+    if (year->months_count == 13) {
+        render_sink_puts(sink, "This is a leap year with 13 lunar months\n");
+    } else {
+        render_sink_puts(sink, "This is a regular year with 12 lunar months\n");
+    }
+    render_sink_puts(sink, "====================================\n\n");
+    render_sink_printf(sink, "Metonic Cycle: Year %d of Cycle %d\n\n", metonic_year, metonic_cycle);
+
+    for (int row_start = 0; row_start < year->months_count; row_start += per_row) {
+        int row_end = row_start + per_row < year->months_count ? row_start + per_row : year->months_count;
+        for (int line = 0; line < MONTH_BLOCK_LINES; line++) {
+            for (int m = row_start; m < row_end; m++) {
+                if (m > row_start) render_sink_puts(sink, MONTH_BLOCK_GAP);
+                render_month_block_line(sink, year, m, offsets[m], &special_days, line, options);
+            }
+            render_sink_puts(sink, "\n");
         }
+        render_sink_puts(sink, "\n");
     }
-    
-    /* Add final newline */
-    strcat(result.buffer, "\n");
-    
-    /* Set dimensions */
-    result.width = 20;
-    result.height = 10;  /* Rough estimate */
-    
+}
+
+/* Render a year calendar to a sink */
+bool render_lunar_year_to(RenderSink *sink, int year, RenderOptions options) {
+    LunarYear lunar_year;
+    if (!calculate_lunar_year(year, &lunar_year)) {
+        return false;
+    }
+    render_year_grid(sink, &lunar_year, options);
+    return !sink->failed;
+}
+
+/* Render consecutive years in one streamed pass; each year is computed once */
+bool render_lunar_years_to(RenderSink *sink, int first_year, int last_year, RenderOptions options) {
+    LunarYear lunar_year;
+    for (int year = first_year; year <= last_year && !sink->failed; year++) {
+        if (!calculate_lunar_year(year, &lunar_year)) {
+            return false;
+        }
+        render_year_grid(sink, &lunar_year, options);
+    }
+    return !sink->failed;
+}
+
+/* Format a single day cell */
+char *format_day_cell(LunarDay day, RenderOptions options) {
+    RenderSink sink;
+    render_sink_init_buffer(&sink);
+    render_day_cell(&sink, &day, get_special_day_type(day), options);
+    if (sink.failed) {
+        render_sink_free(&sink);
+        return NULL;
+    }
+    return sink.buffer;
+}
+
+/* Format a month header centered in width columns */
+char *format_month_header(int year, int month, int width) {
+    char header[64];
+    RenderSink sink;
+    const char *month_name = (month >= 1 && month <= 12) ? MONTH_NAMES[month - 1] : MONTH_NAMES[12];
+
+    snprintf(header, sizeof(header), "%s %d", month_name, year);
+    render_sink_init_buffer(&sink);
+    render_centered(&sink, header, width);
+    if (sink.failed) {
+        render_sink_free(&sink);
+        return NULL;
+    }
+    return sink.buffer;
+}
+
+/* Simple month rendering function */
+RenderedMonth render_lunar_month(int year, int month, RenderOptions options) {
+    RenderedMonth result = {0};
+    RenderSink sink;
+
+    render_sink_init_buffer(&sink);
+    if (!render_lunar_month_to(&sink, year, month, options)) {
+        render_sink_free(&sink);
+        return result;
+    }
+
+    result.buffer = sink.buffer;
+    result.buffer_size = (int)sink.capacity;
+    result.width = calculate_cell_width(options) * 7;
+    result.height = count_lines(sink.buffer);
     return result;
 }
 
 /* Render a lunar year */
 RenderedYear render_lunar_year(int year, RenderOptions options) {
     RenderedYear result = {0};
-    int eld_year = calculate_eld_year_from_gregorian(year);
-    char title[100];
-    snprintf(title, sizeof(title), "Eld Year %d", eld_year);
-    
-    /* Get Metonic position for the year */
-    int metonic_year = 0;
-    int metonic_cycle = 0;
-    get_metonic_position(year, &metonic_year, &metonic_cycle);
-    
-    /* Allocate buffer */
-    result.buffer_size = 16384;
-    result.buffer = malloc(result.buffer_size);
-    
-    if (!result.buffer) {
+    RenderSink sink;
+    int per_row = options.months_per_row > 0 ? options.months_per_row : 1;
+
+    render_sink_init_buffer(&sink);
+    if (!render_lunar_year_to(&sink, year, options)) {
+        render_sink_free(&sink);
         return result;
     }
-    
-    /* Start with a clean buffer */
-    result.buffer[0] = '\0';
-    
-    /* Header */
-    char temp[4096];
-    bool is_leap = is_lunar_leap_year(year);
-    
-    sprintf(temp, "Lunar Calendar for Year %d (Eld Year %d)\n", year, eld_year);
-    strcat(result.buffer, temp);
-    
-    if (is_leap) {
-        strcat(result.buffer, "This is a leap year with 13 lunar months\n");
-    } else {
-        strcat(result.buffer, "This is a regular year with 12 lunar months\n");
-    }
-    
-    strcat(result.buffer, "====================================\n\n");
-    
-    /* Get Metonic position */
-    sprintf(temp, "Metonic Cycle: Year %d of Cycle %d\n\n", metonic_year, metonic_cycle);
-    strcat(result.buffer, temp);
-    
-    /* List months */
-    int month_count = is_leap ? 13 : 12;
-    
-    for (int m = 1; m <= month_count; m++) {
-        const char *month_name = (m <= 12) ? MONTH_NAMES[m - 1] : MONTH_NAMES[12];
-        // int days = calculate_lunar_month_length(year, m); // This function is obsolete
-        sprintf(temp, "Month %2d: %s - %d days\n", m, month_name, 29); // Using a hardcoded value as the original function is obsolete
-        strcat(result.buffer, temp);
-    }
-    
-    /* Set dimensions */
-    result.width = 50;
-    result.height = month_count + 10;
-    result.months_per_row = 1;
-    
+
+    result.buffer = sink.buffer;
+    result.buffer_size = (int)sink.capacity;
+    result.months_per_row = per_row;
+    result.width = per_row * calculate_cell_width(options) * 7 +
+                   (per_row - 1) * (int)strlen(MONTH_BLOCK_GAP);
+    result.height = count_lines(sink.buffer);
     return result;
 }
 
-/* Render the position within the Metonic cycle */
-char *render_metonic_cycle_position(int year, RenderOptions options) {
+/* Render the position within the Metonic cycle to a sink */
+bool render_metonic_cycle_position_to(RenderSink *sink, int year, RenderOptions options) {
     (void)options; /* Suppress unused parameter warning */
-    
-    /* Allocate a generous buffer */
-    char *buffer = malloc(2048);
-    if (!buffer) {
-        return NULL;
-    }
-    
-    /* Start with an empty buffer */
-    buffer[0] = '\0';
-    
+
     /* Get Metonic cycle info */
     int metonic_year = 0;
     int metonic_cycle = 0;
     get_metonic_position(year, &metonic_year, &metonic_cycle);
-    
+
     bool is_leap = is_lunar_leap_year(year);
-    
+
     /* Format header */
-    char temp[2048];
-    sprintf(temp, "Metonic Cycle Position for Year %d\n", year);
-    strcat(buffer, temp);
-    strcat(buffer, "--------------------------------\n\n");
-    
+    render_sink_printf(sink, "Metonic Cycle Position for Year %d\n", year);
+    render_sink_puts(sink, "--------------------------------\n\n");
+
     /* Position info */
-    sprintf(temp, "Year %d is in position %d of the 19-year Metonic cycle\n", 
-           year, metonic_year);
-    strcat(buffer, temp);
-    
-    sprintf(temp, "This is Metonic cycle number: %d\n", metonic_cycle);
-    strcat(buffer, temp);
-    
-    sprintf(temp, "This year is a %s lunar year\n\n", 
-           is_leap ? "leap (13 months)" : "regular (12 months)");
-    strcat(buffer, temp);
-    
+    render_sink_printf(sink, "Year %d is in position %d of the 19-year Metonic cycle\n",
+                       year, metonic_year);
+    render_sink_printf(sink, "This is Metonic cycle number: %d\n", metonic_cycle);
+    render_sink_printf(sink, "This year is a %s lunar year\n\n",
+                       is_leap ? "leap (13 months)" : "regular (12 months)");
+
     /* Visual representation */
-    strcat(buffer, "Cycle visualization (years marked with * are leap years):\n");
-    strcat(buffer, "======================================================\n");
-    
+    render_sink_puts(sink, "Cycle visualization (years marked with * are leap years):\n");
+    render_sink_puts(sink, "======================================================\n");
+
     /* Create a visual representation of the cycle */
     for (int i = 1; i <= YEARS_PER_METONIC_CYCLE; i++) {
         /* Check if this is a leap year */
@@ -365,22 +648,116 @@ char *render_metonic_cycle_position(int year, RenderOptions options) {
                 break;
             }
         }
-        
+
         /* Highlight current position */
         if (i == metonic_year) {
-            sprintf(temp, "[%2d%s] << Current ", i, is_year_leap ? "*" : " ");
+            render_sink_printf(sink, "[%2d%s] << Current ", i, is_year_leap ? "*" : " ");
         } else {
-            sprintf(temp, "[%2d%s] ", i, is_year_leap ? "*" : " ");
+            render_sink_printf(sink, "[%2d%s] ", i, is_year_leap ? "*" : " ");
         }
-        strcat(buffer, temp);
-        
+
         /* Line break for readability */
-        if (i % 5 == 0) {
-            strcat(buffer, "\n");
+        if (i % 5 == 0 || i == YEARS_PER_METONIC_CYCLE) {
+            render_sink_puts(sink, "\n");
         }
     }
-    
-    return buffer;
+
+    return !sink->failed;
+}
+
+/* Render the position within the Metonic cycle */
+char *render_metonic_cycle_position(int year, RenderOptions options) {
+    RenderSink sink;
+    render_sink_init_buffer(&sink);
+    if (!render_metonic_cycle_position_to(&sink, year, options)) {
+        render_sink_free(&sink);
+        return NULL;
+    }
+    return sink.buffer;
+}
+
+/* Context variants: run the plain renderer with ctx active (NULL keeps the active one) */
+bool lunar_ctx_render_lunar_month_to(LunarContext *ctx, RenderSink *sink, int year, int month,
+                                     RenderOptions options) {
+    if (ctx == NULL) {
+        return render_lunar_month_to(sink, year, month, options);
+    }
+    LunarContext *previous = lunar_ctx_activate(ctx);
+    bool rendered = render_lunar_month_to(sink, year, month, options);
+    lunar_ctx_activate(previous);
+    return rendered;
+}
+
+bool lunar_ctx_render_lunar_year_to(LunarContext *ctx, RenderSink *sink, int year, RenderOptions options) {
+    if (ctx == NULL) {
+        return render_lunar_year_to(sink, year, options);
+    }
+    LunarContext *previous = lunar_ctx_activate(ctx);
+    bool rendered = render_lunar_year_to(sink, year, options);
+    lunar_ctx_activate(previous);
+    return rendered;
+}
+
+bool lunar_ctx_render_lunar_years_to(LunarContext *ctx, RenderSink *sink, int first_year, int last_year,
+                                     RenderOptions options) {
+    if (ctx == NULL) {
+        return render_lunar_years_to(sink, first_year, last_year, options);
+    }
+    LunarContext *previous = lunar_ctx_activate(ctx);
+    bool rendered = render_lunar_years_to(sink, first_year, last_year, options);
+    lunar_ctx_activate(previous);
+    return rendered;
+}
+
+bool lunar_ctx_render_metonic_cycle_position_to(LunarContext *ctx, RenderSink *sink, int year,
+                                                RenderOptions options) {
+    if (ctx == NULL) {
+        return render_metonic_cycle_position_to(sink, year, options);
+    }
+    LunarContext *previous = lunar_ctx_activate(ctx);
+    bool rendered = render_metonic_cycle_position_to(sink, year, options);
+    lunar_ctx_activate(previous);
+    return rendered;
+}
+
+char *lunar_ctx_render_metonic_cycle_position(LunarContext *ctx, int year, RenderOptions options) {
+    if (ctx == NULL) {
+        return render_metonic_cycle_position(year, options);
+    }
+    LunarContext *previous = lunar_ctx_activate(ctx);
+    char *position = render_metonic_cycle_position(year, options);
+    lunar_ctx_activate(previous);
+    return position;
+}
+
+char *lunar_ctx_format_day_cell(LunarContext *ctx, LunarDay day, RenderOptions options) {
+    if (ctx == NULL) {
+        return format_day_cell(day, options);
+    }
+    LunarContext *previous = lunar_ctx_activate(ctx);
+    char *cell = format_day_cell(day, options);
+    lunar_ctx_activate(previous);
+    return cell;
+}
+
+RenderedMonth lunar_ctx_render_lunar_month(LunarContext *ctx, int year, int month, RenderOptions options) {
+    if (ctx == NULL) {
+        return render_lunar_month(year, month, options);
+    }
+    LunarContext *previous = lunar_ctx_activate(ctx);
+    RenderedMonth rendered = render_lunar_month(year, month, options);
+    lunar_ctx_activate(previous);
+    return rendered;
+}
+
+RenderedYear lunar_ctx_render_lunar_year(LunarContext *ctx, int year, RenderOptions options) {
+    if (ctx == NULL) {
+        return render_lunar_year(year, options);
+    }
+    LunarContext *previous = lunar_ctx_activate(ctx);
+    RenderedYear rendered = render_lunar_year(year, options);
+    lunar_ctx_activate(previous);
+    return rendered;
 }
 
 /* Free memory allocated for rendered month */
@@ -0,0 +1,1081 @@
+#define _GNU_SOURCE  /* For accept4() and memmem() */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdint.h>
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "../include/lunar_calendar.h"
+#include "../include/lunar_renderer.h"
+#include "../include/lunar_server.h"
+#include "../include/lunar_wire.h"
+
+// --- Constants ---
+#define SERVER_DEFAULT_WORKERS_MAX 8
+#define SERVER_MAX_EVENTS 64
+#define SERVER_LISTEN_BACKLOG 512
+#define SERVER_PARAM_MAX 64
+
+/* Protocol spoken on a connection, set by the socket it was accepted on */
+typedef enum {
+    PROTOCOL_HTTP,             /* TCP listener: HTTP/1.1 with JSON bodies */
+    PROTOCOL_WIRE              /* Unix socket listener: binary frames, see lunar_wire.h */
+} ServerProtocol;
+
+/* One client connection. The I/O thread owns it except while busy, when a
+ * worker is building the response to the request(s) at the front of in[]. */
+typedef struct ServerConnection {
+    int fd;
+    ServerProtocol protocol;
+    char *in;
+    size_t in_capacity;        /* SERVER_REQUEST_MAX, or LUNAR_WIRE_FRAME_MAX for frames */
+    size_t in_length;
+    size_t request_length;     /* Bytes of in[] taken by the request (or frames) being answered */
+    bool request_invalid;      /* Headers too large (HTTP) or a bad frame header (wire) */
+    RenderSink out;            /* Response being sent; the allocation is reused */
+    size_t out_sent;
+    bool keep_alive;
+    bool busy;
+    bool read_closed;          /* Peer shut down its side; close after answering */
+    bool peer_gone;            /* Hung up while busy; close instead of answering */
+    struct ServerConnection *next;              /* Work, finished or closed queue */
+    struct ServerConnection *all_prev, *all_next; /* Every open connection */
+} ServerConnection;
+
+/* FIFO of connections */
+typedef struct {
+    ServerConnection *head;
+    ServerConnection *tail;
+} ConnectionQueue;
+
+typedef struct {
+    int epoll_fd;
+    int listen_fd;
+    int unix_fd;               /* Binary protocol listener, or -1 */
+    int wake_fd;               /* eventfd the workers signal when a response is ready */
+    LunarYearTable *years;
+    pthread_mutex_t lock;      /* Guards the queues and stopping */
+    pthread_cond_t work_ready;
+    ConnectionQueue pending;   /* Requests waiting for a worker */
+    ConnectionQueue finished;  /* Responses waiting to be sent */
+    ConnectionQueue closed;    /* Freed after the current batch of events */
+    bool stopping;
+    ServerConnection *all;
+    int connections;
+    int max_connections;
+} Server;
+
+/* Per-thread state of a request worker */
+typedef struct {
+    Server *server;
+    LunarCache cache;
+    RenderSink body;
+} ServerWorker;
+
+typedef int (*EndpointHandler)(ServerWorker *worker, const char *query, RenderSink *body);
+
+static volatile sig_atomic_t g_stop_requested = 0;
+
+/**
+ * @brief Default daemon options
+ */
+ServerOptions default_server_options(void) {
+    ServerOptions options;
+    memset(&options, 0, sizeof(options));
+    options.bind_address = "127.0.0.1";
+    options.port = SERVER_DEFAULT_PORT;
+    options.workers = 0;
+    options.max_connections = 1024;
+    options.socket_path = NULL;
+    return options;
+}
+
+static void on_stop_signal(int signum) {
+    (void)signum;
+    g_stop_requested = 1;
+}
+
+// --- Queues ---
+
+static void queue_push(ConnectionQueue *queue, ServerConnection *conn) {
+    conn->next = NULL;
+    if (queue->tail != NULL) {
+        queue->tail->next = conn;
+    } else {
+        queue->head = conn;
+    }
+    queue->tail = conn;
+}
+
+static ServerConnection *queue_pop(ConnectionQueue *queue) {
+    ServerConnection *conn = queue->head;
+    if (conn != NULL) {
+        queue->head = conn->next;
+        if (queue->head == NULL) {
+            queue->tail = NULL;
+        }
+    }
+    return conn;
+}
+
+// --- Request Parsing ---
+
+/* Copy the value of a query parameter; false if it is missing or too long */
+static bool query_param(const char *query, const char *name, char *value, size_t size) {
+    size_t name_length = strlen(name);
+
+    for (const char *p = query; p != NULL && *p != '\0'; ) {
+        const char *end = strchr(p, '&');
+        size_t length = end != NULL ? (size_t)(end - p) : strlen(p);
+
+        if (length > name_length && strncmp(p, name, name_length) == 0 && p[name_length] == '=') {
+            size_t value_length = length - name_length - 1;
+            if (value_length >= size) {
+                return false;
+            }
+            memcpy(value, p + name_length + 1, value_length);
+            value[value_length] = '\0';
+            return true;
+        }
+        p = end != NULL ? end + 1 : NULL;
+    }
+    return false;
+}
+
+static bool query_date(const char *query, const char *name, int *year, int *month, int *day) {
+    char value[SERVER_PARAM_MAX];
+    int fields[3];
+
+    if (!query_param(query, name, value, sizeof(value)) || !parse_int_fields(value, fields, 3) ||
+        !is_valid_gregorian_date(fields[0], fields[1], fields[2])) {
+        return false;
+    }
+    *year = fields[0];
+    *month = fields[1];
+    *day = fields[2];
+    return true;
+}
+
+static bool query_int(const char *query, const char *name, int *result) {
+    char value[SERVER_PARAM_MAX];
+    return query_param(query, name, value, sizeof(value)) && parse_int_fields(value, result, 1);
+}
+
+// --- JSON Output ---
+
+static void json_error(RenderSink *body, const char *message) {
+    render_sink_printf(body, "{\"error\":\"%s\"}", message);
+}
+
+static void json_day(RenderSink *body, const LunarDay *day) {
+    render_sink_printf(body,
+                       "{\"gregorian\":\"%04d-%02d-%02d\",\"lunar_year\":%d,\"lunar_month\":%d,"
+                       "\"lunar_day\":%d,\"weekday\":\"%s\",\"moon_phase\":\"%s\",\"eld_year\":%d,"
+                       "\"metonic_year\":%d,\"metonic_cycle\":%d}",
+                       day->greg_year, day->greg_month, day->greg_day,
+                       day->lunar_year, day->lunar_month, day->lunar_day,
+                       get_weekday_name(day->weekday), get_moon_phase_name(day->moon_phase),
+                       day->eld_year, day->metonic_year, day->metonic_cycle);
+}
+
+/* ISO 8601 UTC time of a Julian day, to the second */
+static void json_time(RenderSink *body, double jd) {
+    int day_number = (int)floor(jd + 0.5);
+    int seconds = (int)lround((jd + 0.5 - day_number) * 86400.0);
+    int year, month, day;
+
+    if (seconds >= 86400) {
+        day_number++;
+        seconds -= 86400;
+    }
+    day_number_to_gregorian(day_number, &year, &month, &day);
+    render_sink_printf(body, "\"%04d-%02d-%02dT%02d:%02d:%02dZ\"",
+                       year, month, day, seconds / 3600, (seconds / 60) % 60, seconds % 60);
+}
+
+// --- Endpoints ---
+
+static int endpoint_g2l(ServerWorker *worker, const char *query, RenderSink *body) {
+    int year, month, day;
+
+    if (!query_date(query, "date", &year, &month, &day)) {
+        json_error(body, "expected date=YYYY-MM-DD");
+        return 400;
+    }
+    LunarDay lunar = gregorian_to_lunar_cached(&worker->cache, year, month, day);
+    if (lunar.lunar_day == 0) {
+        json_error(body, "date could not be converted");
+        return 400;
+    }
+    json_day(body, &lunar);
+    return 200;
+}
+
+/* Days in a month of a lunar year; months start on lunar_month_start_day, as in /year */
+static int month_days(const LunarYearBoundaries *bounds, int month) {
+    return lunar_month_start_day(bounds, month + 1) - lunar_month_start_day(bounds, month);
+}
+
+static int endpoint_l2g(ServerWorker *worker, const char *query, RenderSink *body) {
+    LunarYearBoundaries bounds;
+    int lunar_year, lunar_month, lunar_day;
+    int year, month, day;
+
+    if (!query_int(query, "year", &lunar_year) || !query_int(query, "month", &lunar_month) ||
+        !query_int(query, "day", &lunar_day)) {
+        json_error(body, "expected year, month and day");
+        return 400;
+    }
+    if (!lunar_year_table_get(worker->server->years, lunar_year, &bounds) ||
+        lunar_month < 1 || lunar_month > bounds.months_count ||
+        lunar_day < 1 || lunar_day > month_days(&bounds, lunar_month)) {
+        json_error(body, "no such lunar date");
+        return 400;
+    }
+    day_number_to_gregorian(lunar_month_start_day(&bounds, lunar_month) + lunar_day - 1, &year, &month, &day);
+    render_sink_printf(body,
+                       "{\"lunar_year\":%d,\"lunar_month\":%d,\"lunar_day\":%d,"
+                       "\"gregorian\":\"%04d-%02d-%02d\",\"weekday\":\"%s\"}",
+                       lunar_year, lunar_month, lunar_day, year, month, day,
+                       get_weekday_name(calculate_weekday(year, month, day)));
+    return 200;
+}
+
+static int endpoint_phase(ServerWorker *worker, const char *query, RenderSink *body) {
+    int year, month, day;
+
+    if (!query_date(query, "date", &year, &month, &day)) {
+        json_error(body, "expected date=YYYY-MM-DD");
+        return 400;
+    }
+    LunarDay lunar = gregorian_to_lunar_cached(&worker->cache, year, month, day);
+    double day_start_jd = gregorian_to_julian_day(year, month, day, 0.0);
+
+    render_sink_printf(body, "{\"date\":\"%04d-%02d-%02d\",\"moon_phase\":\"%s\",\"next_new_moon\":",
+                       year, month, day, get_moon_phase_name(lunar.moon_phase));
+    json_time(body, find_next_phase_jd(day_start_jd, 0));
+    render_sink_puts(body, ",\"next_full_moon\":");
+    json_time(body, find_next_phase_jd(day_start_jd, 2));
+    render_sink_puts(body, "}");
+    return 200;
+}
+
+static int endpoint_year(ServerWorker *worker, const char *query, RenderSink *body) {
+    LunarYearBoundaries bounds;
+    int lunar_year, metonic_year, metonic_cycle;
+
+    if (!query_int(query, "year", &lunar_year)) {
+        json_error(body, "expected year=Y");
+        return 400;
+    }
+    if (!lunar_year_table_get(worker->server->years, lunar_year, &bounds)) {
+        json_error(body, "year could not be calculated");
+        return 400;
+    }
+    get_metonic_position(lunar_year, &metonic_year, &metonic_cycle);
+
+    render_sink_printf(body,
+                       "{\"lunar_year\":%d,\"eld_year\":%d,\"metonic_year\":%d,\"metonic_cycle\":%d,"
+                       "\"months_count\":%d,\"months\":[",
+                       lunar_year, calculate_eld_year_from_gregorian(lunar_year),
+                       metonic_year, metonic_cycle, bounds.months_count);
+    for (int m = 1; m <= bounds.months_count; m++) {
+        int year, month, day;
+        day_number_to_gregorian(lunar_month_start_day(&bounds, m), &year, &month, &day);
+        render_sink_printf(body, "%s{\"month\":%d,\"start\":\"%04d-%02d-%02d\",\"days\":%d}",
+                           m > 1 ? "," : "", m, year, month, day, month_days(&bounds, m));
+    }
+    render_sink_puts(body, "]}");
+    return 200;
+}
+
+/* Advance a Gregorian date by one day */
+static void next_date(int *year, int *month, int *day) {
+    if (is_valid_gregorian_date(*year, *month, *day + 1)) {
+        (*day)++;
+    } else if (*month < 12) {
+        (*month)++;
+        *day = 1;
+    } else {
+        (*year)++;
+        *month = 1;
+        *day = 1;
+    }
+}
+
+static int endpoint_range(ServerWorker *worker, const char *query, RenderSink *body) {
+    int from_year, from_month, from_day;
+    int to_year, to_month, to_day;
+
+    if (!query_date(query, "from", &from_year, &from_month, &from_day) ||
+        !query_date(query, "to", &to_year, &to_month, &to_day)) {
+        json_error(body, "expected from=YYYY-MM-DD and to=YYYY-MM-DD");
+        return 400;
+    }
+
+    long from_key = ((long)from_year * 13 + from_month) * 32 + from_day;
+    long to_key = ((long)to_year * 13 + to_month) * 32 + to_day;
+    if (to_key < from_key) {
+        json_error(body, "from is after to");
+        return 400;
+    }
+
+    int year = from_year, month = from_month, day = from_day;
+    render_sink_printf(body, "{\"from\":\"%04d-%02d-%02d\",\"to\":\"%04d-%02d-%02d\",\"days\":[",
+                       from_year, from_month, from_day, to_year, to_month, to_day);
+    for (int count = 0; ; count++) {
+        if (count == SERVER_RANGE_MAX_DAYS) {
+            render_sink_reset(body);
+            json_error(body, "range is too long");
+            return 400;
+        }
+        LunarDay lunar = gregorian_to_lunar_cached(&worker->cache, year, month, day);
+        if (count > 0) {
+            render_sink_puts(body, ",");
+        }
+        json_day(body, &lunar);
+        if (year == to_year && month == to_month && day == to_day) {
+            break;
+        }
+        next_date(&year, &month, &day);
+    }
+    render_sink_puts(body, "]}");
+    return 200;
+}
+
+static const struct {
+    const char *path;
+    EndpointHandler handler;
+} ENDPOINTS[] = {
+    { "/g2l", endpoint_g2l },
+    { "/l2g", endpoint_l2g },
+    { "/phase", endpoint_phase },
+    { "/year", endpoint_year },
+    { "/range", endpoint_range },
+};
+
+static const char *status_text(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 431: return "Request Header Fields Too Large";
+        default:  return "Internal Server Error";
+    }
+}
+
+/* Find the value of a header in the request's header lines (case-insensitive name) */
+static bool request_header(const char *headers, const char *end, const char *name,
+                           char *value, size_t size) {
+    size_t name_length = strlen(name);
+
+    for (const char *line = headers; line < end; ) {
+        const char *line_end = memmem(line, (size_t)(end - line), "\r\n", 2);
+        if (line_end == NULL) {
+            line_end = end;
+        }
+        if ((size_t)(line_end - line) > name_length && strncasecmp(line, name, name_length) == 0 &&
+            line[name_length] == ':') {
+            const char *p = line + name_length + 1;
+            while (p < line_end && (*p == ' ' || *p == '\t')) p++;
+            size_t length = (size_t)(line_end - p);
+            if (length >= size) length = size - 1;
+            memcpy(value, p, length);
+            value[length] = '\0';
+            return true;
+        }
+        line = line_end + 2;
+    }
+    return false;
+}
+
+/* Build the response to the HTTP request at the front of conn->in */
+static void handle_http_request(ServerWorker *worker, ServerConnection *conn) {
+    RenderSink *body = &worker->body;
+    char line[SERVER_REQUEST_MAX];
+    char method[16], target[SERVER_REQUEST_MAX], version[16];
+    int status = 404;
+
+    render_sink_reset(body);
+    conn->keep_alive = false;
+
+    const char *request = conn->in;
+    const char *request_end = conn->in + conn->request_length;
+    const char *line_end = memmem(request, conn->request_length, "\r\n", 2);
+    size_t line_length = line_end != NULL ? (size_t)(line_end - request) : 0;
+
+    if (conn->request_invalid) {
+        status = 431;
+        json_error(body, "request headers are too large");
+    } else if (line_end == NULL || line_length >= sizeof(line)) {
+        status = 400;
+        json_error(body, "malformed request");
+    } else {
+        memcpy(line, request, line_length);
+        line[line_length] = '\0';
+        if (sscanf(line, "%15s %8191s %15s", method, target, version) != 3 ||
+            strncmp(version, "HTTP/1.", 7) != 0) {
+            status = 400;
+            json_error(body, "malformed request");
+        } else {
+            char value[64];
+            conn->keep_alive = strcmp(version, "HTTP/1.0") != 0;
+            if (request_header(line_end + 2, request_end, "Connection", value, sizeof(value))) {
+                if (strcasecmp(value, "close") == 0) conn->keep_alive = false;
+                if (strcasecmp(value, "keep-alive") == 0) conn->keep_alive = true;
+            }
+            /* Request bodies are not supported; the stream cannot be resynchronized */
+            if (request_header(line_end + 2, request_end, "Content-Length", value, sizeof(value)) &&
+                atol(value) != 0) {
+                conn->keep_alive = false;
+                status = 400;
+                json_error(body, "request bodies are not supported");
+            } else if (strcmp(method, "GET") != 0) {
+                status = 405;
+                json_error(body, "only GET is supported");
+            } else {
+                char *query = strchr(target, '?');
+                if (query != NULL) {
+                    *query++ = '\0';
+                } else {
+                    query = "";
+                }
+                status = 404;
+                for (size_t i = 0; i < sizeof(ENDPOINTS) / sizeof(ENDPOINTS[0]); i++) {
+                    if (strcmp(target, ENDPOINTS[i].path) == 0) {
+                        status = ENDPOINTS[i].handler(worker, query, body);
+                        break;
+                    }
+                }
+                if (status == 404) {
+                    json_error(body, "unknown endpoint");
+                }
+            }
+        }
+    }
+
+    if (body->failed) {
+        render_sink_reset(body);
+        status = 500;
+        json_error(body, "out of memory");
+        conn->keep_alive = false;
+    }
+
+    render_sink_reset(&conn->out);
+    render_sink_printf(&conn->out,
+                       "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nContent-Length: %zu\r\n"
+                       "Connection: %s\r\n\r\n",
+                       status, status_text(status), body->length,
+                       conn->keep_alive ? "keep-alive" : "close");
+    render_sink_append(&conn->out, body->buffer != NULL ? body->buffer : "", body->length);
+}
+
+// --- Binary Protocol ---
+
+/* Size of one request record of a frame operation, or 0 for an unknown op */
+static size_t wire_request_size(uint16_t op) {
+    switch (op) {
+        case LUNAR_OP_G2L: return sizeof(LunarWireDate);
+        case LUNAR_OP_L2G: return sizeof(LunarWireDate);
+        default:           return 0;
+    }
+}
+
+/* Length of the complete frames at the front of a buffer. Stops before a bad
+ * header; *invalid is set if the very first header is bad. */
+static size_t wire_frames_length(const char *in, size_t length, bool *invalid) {
+    size_t used = 0;
+
+    *invalid = false;
+    while (length - used >= sizeof(LunarWireHeader)) {
+        LunarWireHeader header;
+        memcpy(&header, in + used, sizeof(header));
+        size_t record_size = wire_request_size(header.op);
+        if (header.magic != LUNAR_WIRE_MAGIC || record_size == 0 || header.count > LUNAR_WIRE_MAX_RECORDS) {
+            *invalid = used == 0;
+            break;
+        }
+        size_t frame_length = sizeof(header) + record_size * header.count;
+        if (length - used < frame_length) {
+            break;
+        }
+        used += frame_length;
+    }
+    return used;
+}
+
+static LunarWireDay wire_g2l(ServerWorker *worker, const LunarWireDate *date) {
+    LunarWireDay reply;
+    memset(&reply, 0, sizeof(reply));
+
+    if (!is_valid_gregorian_date(date->year, date->month, date->day)) {
+        return reply;
+    }
+    LunarDay lunar = gregorian_to_lunar_cached(&worker->cache, date->year, date->month, date->day);
+    reply.lunar_year = lunar.lunar_year;
+    reply.lunar_month = (uint8_t)lunar.lunar_month;
+    reply.lunar_day = (uint8_t)lunar.lunar_day;
+    reply.moon_phase = (uint8_t)lunar.moon_phase;
+    reply.weekday = (uint8_t)lunar.weekday;
+    reply.eld_year = lunar.eld_year;
+    reply.metonic_cycle = (int16_t)lunar.metonic_cycle;
+    reply.metonic_year = (uint8_t)lunar.metonic_year;
+    return reply;
+}
+
+static LunarWireDate wire_l2g(ServerWorker *worker, const LunarWireDate *lunar_date) {
+    LunarWireDate reply;
+    int year, month, day;
+    memset(&reply, 0, sizeof(reply));
+
+    if (lunar_to_gregorian_cached(&worker->cache, lunar_date->year, lunar_date->month, lunar_date->day,
+                                  &year, &month, &day)) {
+        reply.year = year;
+        reply.month = (uint8_t)month;
+        reply.day = (uint8_t)day;
+    }
+    return reply;
+}
+
+/* Answer the frames at the front of conn->in, one reply frame each */
+static void handle_wire_request(ServerWorker *worker, ServerConnection *conn) {
+    RenderSink *out = &conn->out;
+    LunarWireHeader header;
+
+    render_sink_reset(out);
+    conn->keep_alive = !conn->request_invalid;
+    if (conn->request_invalid) {
+        memset(&header, 0, sizeof(header));
+        if (conn->request_length >= sizeof(header)) {
+            memcpy(&header, conn->in, sizeof(header));
+        }
+        header.magic = LUNAR_WIRE_MAGIC;
+        header.status = LUNAR_WIRE_BAD_FRAME;
+        header.count = 0;
+        render_sink_append(out, (const char *)&header, sizeof(header));
+        return;
+    }
+
+    for (size_t used = 0; used < conn->request_length; ) {
+        memcpy(&header, conn->in + used, sizeof(header));
+        const char *records = conn->in + used + sizeof(header);
+        used += sizeof(header) + wire_request_size(header.op) * header.count;
+
+        render_sink_append(out, (const char *)&header, sizeof(header));
+        for (uint32_t i = 0; i < header.count; i++) {
+            LunarWireDate date;
+            memcpy(&date, records + i * sizeof(date), sizeof(date));
+            if (header.op == LUNAR_OP_G2L) {
+                LunarWireDay reply = wire_g2l(worker, &date);
+                render_sink_append(out, (const char *)&reply, sizeof(reply));
+            } else {
+                LunarWireDate reply = wire_l2g(worker, &date);
+                render_sink_append(out, (const char *)&reply, sizeof(reply));
+            }
+        }
+    }
+
+    if (out->failed) {
+        render_sink_reset(out);
+        conn->keep_alive = false;
+    }
+}
+
+/* Build the response to the request(s) at the front of conn->in; runs on a worker */
+static void handle_request(ServerWorker *worker, ServerConnection *conn) {
+    if (conn->protocol == PROTOCOL_WIRE) {
+        handle_wire_request(worker, conn);
+    } else {
+        handle_http_request(worker, conn);
+    }
+}
+
+// --- Worker Pool ---
+
+static void *server_worker(void *data) {
+    ServerWorker *worker = (ServerWorker *)data;
+    Server *server = worker->server;
+    uint64_t one = 1;
+
+    for (;;) {
+        pthread_mutex_lock(&server->lock);
+        while (server->pending.head == NULL && !server->stopping) {
+            pthread_cond_wait(&server->work_ready, &server->lock);
+        }
+        ServerConnection *conn = queue_pop(&server->pending);
+        pthread_mutex_unlock(&server->lock);
+        if (conn == NULL) {
+            break;
+        }
+
+        handle_request(worker, conn);
+
+        pthread_mutex_lock(&server->lock);
+        queue_push(&server->finished, conn);
+        pthread_mutex_unlock(&server->lock);
+        if (write(server->wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            perror("Warning: Could not wake the I/O thread");
+        }
+    }
+    return NULL;
+}
+
+// --- Connections ---
+
+static void connection_watch(Server *server, ServerConnection *conn, uint32_t events) {
+    struct epoll_event event = { .events = events, .data.ptr = conn };
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+}
+
+/* Close a connection. It is freed only after the current batch of events,
+ * which may still refer to it. */
+static void connection_close(Server *server, ServerConnection *conn) {
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    conn->fd = -1;
+    if (conn->all_prev != NULL) {
+        conn->all_prev->all_next = conn->all_next;
+    } else {
+        server->all = conn->all_next;
+    }
+    if (conn->all_next != NULL) {
+        conn->all_next->all_prev = conn->all_prev;
+    }
+    server->connections--;
+    queue_push(&server->closed, conn);
+}
+
+static void free_closed_connections(Server *server) {
+    ServerConnection *conn;
+    while ((conn = queue_pop(&server->closed)) != NULL) {
+        render_sink_free(&conn->out);
+        free(conn->in);
+        free(conn);
+    }
+}
+
+/* Hand the next complete HTTP request, or every complete frame, to the
+ * workers. Returns false (and keeps reading) if the buffered bytes do not
+ * hold a whole request yet. */
+static bool connection_dispatch(Server *server, ServerConnection *conn) {
+    if (conn->protocol == PROTOCOL_WIRE) {
+        bool invalid;
+        conn->request_length = wire_frames_length(conn->in, conn->in_length, &invalid);
+        conn->request_invalid = invalid;
+        if (invalid) {
+            conn->request_length = conn->in_length;  /* Cannot resynchronize; answer and close */
+        } else if (conn->request_length == 0) {
+            return false;
+        }
+    } else {
+        const char *end = memmem(conn->in, conn->in_length, "\r\n\r\n", 4);
+
+        if (end != NULL) {
+            conn->request_length = (size_t)(end - conn->in) + 4;
+            conn->request_invalid = false;
+        } else if (conn->in_length == conn->in_capacity) {
+            conn->request_length = conn->in_length;
+            conn->request_invalid = true;
+        } else {
+            return false;
+        }
+    }
+
+    conn->busy = true;
+    connection_watch(server, conn, 0);
+    pthread_mutex_lock(&server->lock);
+    queue_push(&server->pending, conn);
+    pthread_cond_signal(&server->work_ready);
+    pthread_mutex_unlock(&server->lock);
+    return true;
+}
+
+/* Send as much of the response as the socket takes; then close, dispatch
+ * the next pipelined request, or wait for more input */
+static void connection_write(Server *server, ServerConnection *conn) {
+    while (conn->out_sent < conn->out.length) {
+        ssize_t sent = send(conn->fd, conn->out.buffer + conn->out_sent,
+                            conn->out.length - conn->out_sent, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                connection_watch(server, conn, EPOLLOUT);
+                return;
+            }
+            connection_close(server, conn);
+            return;
+        }
+        conn->out_sent += (size_t)sent;
+    }
+
+    render_sink_reset(&conn->out);
+    conn->out_sent = 0;
+    if (!conn->keep_alive) {
+        connection_close(server, conn);
+    } else if (connection_dispatch(server, conn)) {
+        return;  /* A pipelined request was already buffered */
+    } else if (conn->read_closed) {
+        connection_close(server, conn);
+    } else {
+        connection_watch(server, conn, EPOLLIN | EPOLLRDHUP);
+    }
+}
+
+static void connection_read(Server *server, ServerConnection *conn) {
+    while (conn->in_length < conn->in_capacity) {
+        ssize_t received = recv(conn->fd, conn->in + conn->in_length, conn->in_capacity - conn->in_length, 0);
+        if (received > 0) {
+            conn->in_length += (size_t)received;
+            continue;
+        }
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (received < 0) {
+            connection_close(server, conn);
+            return;
+        }
+        conn->read_closed = true;  /* Answer what was sent before the shutdown */
+        break;
+    }
+    if (!connection_dispatch(server, conn) && conn->read_closed) {
+        connection_close(server, conn);
+    }
+}
+
+/* Send the responses the workers have finished */
+static void server_send_finished(Server *server) {
+    uint64_t count;
+    if (read(server->wake_fd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+        perror("Warning: Could not read the wake-up counter");
+    }
+
+    pthread_mutex_lock(&server->lock);
+    ServerConnection *conn = server->finished.head;
+    server->finished.head = server->finished.tail = NULL;
+    pthread_mutex_unlock(&server->lock);
+
+    while (conn != NULL) {
+        ServerConnection *next = conn->next;
+        conn->busy = false;
+        if (conn->peer_gone) {
+            connection_close(server, conn);
+            conn = next;
+            continue;
+        }
+        conn->in_length -= conn->request_length;
+        memmove(conn->in, conn->in + conn->request_length, conn->in_length);
+        conn->request_length = 0;
+        connection_write(server, conn);
+        conn = next;
+    }
+}
+
+static void server_accept(Server *server, int listen_fd, ServerProtocol protocol) {
+    for (;;) {
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;  /* EAGAIN, or out of descriptors until a connection closes */
+        }
+        if (server->connections >= server->max_connections) {
+            close(fd);
+            continue;
+        }
+
+        ServerConnection *conn = calloc(1, sizeof(ServerConnection));
+        size_t capacity = protocol == PROTOCOL_WIRE ? LUNAR_WIRE_FRAME_MAX : SERVER_REQUEST_MAX;
+        char *in = conn != NULL ? malloc(capacity) : NULL;
+        if (in == NULL) {
+            free(conn);
+            close(fd);
+            continue;
+        }
+        if (protocol == PROTOCOL_HTTP) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        conn->fd = fd;
+        conn->protocol = protocol;
+        conn->in = in;
+        conn->in_capacity = capacity;
+        render_sink_init_buffer(&conn->out);
+
+        struct epoll_event event = { .events = EPOLLIN | EPOLLRDHUP, .data.ptr = conn };
+        if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            free(in);
+            free(conn);
+            continue;
+        }
+        conn->all_next = server->all;
+        if (server->all != NULL) {
+            server->all->all_prev = conn;
+        }
+        server->all = conn;
+        server->connections++;
+    }
+}
+
+// --- Setup ---
+
+static int server_listen(const ServerOptions *options) {
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)options->port);
+    if (inet_pton(AF_INET, options->bind_address, &address.sin_addr) != 1) {
+        fprintf(stderr, "Error: Invalid bind address '%s'\n", options->bind_address);
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("Error: Could not create socket");
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) < 0 ||
+        listen(fd, SERVER_LISTEN_BACKLOG) < 0) {
+        fprintf(stderr, "Error: Could not listen on %s:%d: %s\n",
+                options->bind_address, options->port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Listen on a Unix domain socket only the current user can connect to */
+static int server_listen_unix(const char *path) {
+    struct sockaddr_un address;
+    struct stat info;
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Error: Socket path '%s' is too long\n", path);
+        return -1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    /* A socket left behind by a daemon that did not stop cleanly */
+    if (stat(path, &info) == 0 && S_ISSOCK(info.st_mode)) {
+        unlink(path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("Error: Could not create socket");
+        return -1;
+    }
+    mode_t previous_umask = umask(0077);
+    int bound = bind(fd, (struct sockaddr *)&address, sizeof(address));
+    umask(previous_umask);
+    if (bound < 0 || listen(fd, SERVER_LISTEN_BACKLOG) < 0) {
+        fprintf(stderr, "Error: Could not listen on %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int server_worker_count(int requested) {
+    long workers = requested;
+    if (workers <= 0) {
+        workers = sysconf(_SC_NPROCESSORS_ONLN);
+        if (workers <= 0) workers = 1;
+        if (workers > SERVER_DEFAULT_WORKERS_MAX) workers = SERVER_DEFAULT_WORKERS_MAX;
+    }
+    if (workers > SERVER_MAX_WORKERS) workers = SERVER_MAX_WORKERS;
+    return (int)workers;
+}
+
+/**
+ * @brief Run the query daemon until SIGINT or SIGTERM
+ */
+int run_server(const ServerOptions *options) {
+    Server server;
+    memset(&server, 0, sizeof(server));
+    server.max_connections = options->max_connections > 0 ? options->max_connections : 1;
+    server.unix_fd = -1;
+
+    server.listen_fd = server_listen(options);
+    if (server.listen_fd < 0) {
+        return -1;
+    }
+    if (options->socket_path != NULL) {
+        server.unix_fd = server_listen_unix(options->socket_path);
+        if (server.unix_fd < 0) {
+            close(server.listen_fd);
+            return -1;
+        }
+    }
+    server.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    server.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    server.years = lunar_year_table_new(SERVER_TABLE_FIRST_YEAR, SERVER_TABLE_LAST_YEAR);
+    if (server.epoll_fd < 0 || server.wake_fd < 0 || server.years == NULL) {
+        fprintf(stderr, "Error: Could not set up the event loop\n");
+        close(server.listen_fd);
+        if (server.unix_fd >= 0) {
+            close(server.unix_fd);
+            unlink(options->socket_path);
+        }
+        if (server.epoll_fd >= 0) close(server.epoll_fd);
+        if (server.wake_fd >= 0) close(server.wake_fd);
+        lunar_year_table_free(server.years);
+        return -1;
+    }
+
+    /* The sentinels tell the listening sockets and the wake-up fd apart from connections */
+    struct epoll_event event = { .events = EPOLLIN, .data.ptr = &server.listen_fd };
+    epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.listen_fd, &event);
+    if (server.unix_fd >= 0) {
+        event.data.ptr = &server.unix_fd;
+        epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.unix_fd, &event);
+    }
+    event.data.ptr = &server.wake_fd;
+    epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.wake_fd, &event);
+
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.work_ready, NULL);
+
+    /* Stop signals are blocked everywhere except inside epoll_pwait, so
+     * neither the workers nor a gap before the wait can swallow them */
+    sigset_t stop_signals, previous_mask;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &previous_mask);
+
+    struct sigaction action, previous_int, previous_term;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_stop_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, &previous_int);
+    sigaction(SIGTERM, &action, &previous_term);
+    g_stop_requested = 0;
+
+    int worker_count = server_worker_count(options->workers);
+    ServerWorker *workers = calloc((size_t)worker_count, sizeof(ServerWorker));
+    pthread_t threads[SERVER_MAX_WORKERS];
+    int started = 0;
+    for (int i = 0; workers != NULL && i < worker_count; i++) {
+        workers[i].server = &server;
+        lunar_cache_init(&workers[i].cache);
+        lunar_cache_use_table(&workers[i].cache, server.years);
+        render_sink_init_buffer(&workers[i].body);
+        if (pthread_create(&threads[started], NULL, server_worker, &workers[i]) == 0) {
+            started++;
+        }
+    }
+
+    int result = 0;
+    if (started == 0) {
+        fprintf(stderr, "Error: Could not start worker threads\n");
+        result = -1;
+    } else {
+        fprintf(stderr, "Listening on http://%s:%d with %d worker%s\n",
+                options->bind_address, options->port, started, started == 1 ? "" : "s");
+        if (server.unix_fd >= 0) {
+            fprintf(stderr, "Listening on unix:%s\n", options->socket_path);
+        }
+    }
+
+    sigset_t wait_mask = previous_mask;
+    sigdelset(&wait_mask, SIGINT);
+    sigdelset(&wait_mask, SIGTERM);
+    struct epoll_event events[SERVER_MAX_EVENTS];
+
+    while (result == 0 && !g_stop_requested) {
+        int count = epoll_pwait(server.epoll_fd, events, SERVER_MAX_EVENTS, -1, &wait_mask);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            perror("Error: epoll_wait failed");
+            result = -1;
+            break;
+        }
+        for (int i = 0; i < count; i++) {
+            void *source = events[i].data.ptr;
+            if (source == &server.listen_fd) {
+                server_accept(&server, server.listen_fd, PROTOCOL_HTTP);
+            } else if (source == &server.unix_fd) {
+                server_accept(&server, server.unix_fd, PROTOCOL_WIRE);
+            } else if (source == &server.wake_fd) {
+                server_send_finished(&server);
+            } else {
+                ServerConnection *conn = (ServerConnection *)source;
+                if (conn->fd < 0) {
+                    continue;  /* Closed earlier in this batch */
+                }
+                if (conn->busy) {
+                    /* Hangups are reported even while disarmed; stop watching until answered */
+                    if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                        epoll_ctl(server.epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+                        conn->peer_gone = true;
+                    }
+                    continue;
+                }
+                if (events[i].events & EPOLLOUT) {
+                    connection_write(&server, conn);
+                } else if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                    connection_read(&server, conn);
+                }
+            }
+        }
+        free_closed_connections(&server);
+    }
+
+    /* Let the workers finish what they hold, then drop every connection */
+    pthread_mutex_lock(&server.lock);
+    server.stopping = true;
+    pthread_cond_broadcast(&server.work_ready);
+    pthread_mutex_unlock(&server.lock);
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    while (server.all != NULL) {
+        connection_close(&server, server.all);
+    }
+    free_closed_connections(&server);
+    for (int i = 0; workers != NULL && i < worker_count; i++) {
+        render_sink_free(&workers[i].body);
+    }
+    free(workers);
+
+    sigaction(SIGINT, &previous_int, NULL);
+    sigaction(SIGTERM, &previous_term, NULL);
+    pthread_sigmask(SIG_SETMASK, &previous_mask, NULL);
+
+    pthread_cond_destroy(&server.work_ready);
+    pthread_mutex_destroy(&server.lock);
+    lunar_year_table_free(server.years);
+    close(server.wake_fd);
+    close(server.epoll_fd);
+    close(server.listen_fd);
+    if (server.unix_fd >= 0) {
+        close(server.unix_fd);
+        unlink(options->socket_path);
+    }
+    if (result == 0) {
+        fprintf(stderr, "Server stopped\n");
+    }
+    return result;
+}
@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "../include/lunar_stats.h"
+
+// --- Constants ---
+#define STATS_CALIBRATION_NS 10000000L  /* Time the tick rate is measured over */
+
+static const char *STAT_NAMES[LUNAR_STAT_COUNT] = {
+    "calculate_true_phase_jd",
+    "find_next_phase_jd",
+    "calculate_lunar_new_year_jd",
+    "calculate_lunar_year_boundaries",
+    "cache year misses",
+    "cache lunation misses",
+    "month model",
+    "grid rebuild"
+};
+
+/* Counters of one thread. Only the owning thread writes them; relaxed
+ * atomics let the readers sum them without tearing. */
+typedef struct StatsBlock {
+    atomic_uint_fast64_t calls[LUNAR_STAT_COUNT];
+    atomic_uint_fast64_t ticks[LUNAR_STAT_COUNT];
+    struct StatsBlock *next;
+} StatsBlock;
+
+static pthread_mutex_t g_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static StatsBlock *g_blocks = NULL;        /* Live threads' blocks */
+static LunarStatValue g_retired[LUNAR_STAT_COUNT];   /* Sum of exited threads */
+static LunarStatValue g_baseline[LUNAR_STAT_COUNT];  /* Totals at the last reset */
+static pthread_key_t g_block_key;
+static pthread_once_t g_key_once = PTHREAD_ONCE_INIT;
+static pthread_once_t g_calibrate_once = PTHREAD_ONCE_INIT;
+static double g_ns_per_tick = 1.0;
+static _Thread_local StatsBlock *t_block = NULL;
+
+bool lunar_stats_enabled(void) {
+#ifdef LUNAR_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char *lunar_stat_name(LunarStat stat) {
+    return stat >= 0 && stat < LUNAR_STAT_COUNT ? STAT_NAMES[stat] : "unknown";
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t lunar_stats_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return monotonic_ns();
+#endif
+}
+
+static void calibrate_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    struct timespec pause = { 0, STATS_CALIBRATION_NS };
+    uint64_t start_ns = monotonic_ns();
+    uint64_t start_ticks = lunar_stats_ticks();
+    nanosleep(&pause, NULL);
+    uint64_t elapsed_ticks = lunar_stats_ticks() - start_ticks;
+    uint64_t elapsed_ns = monotonic_ns() - start_ns;
+    if (elapsed_ticks > 0) {
+        g_ns_per_tick = (double)elapsed_ns / (double)elapsed_ticks;
+    }
+#endif
+}
+
+// --- Per-Thread Blocks ---
+
+/* Fold an exiting thread's block into the retired totals */
+static void retire_block(void *data) {
+    StatsBlock *block = data;
+
+    pthread_mutex_lock(&g_stats_lock);
+    for (StatsBlock **link = &g_blocks; *link != NULL; link = &(*link)->next) {
+        if (*link == block) {
+            *link = block->next;
+            break;
+        }
+    }
+    for (int s = 0; s < LUNAR_STAT_COUNT; s++) {
+        g_retired[s].calls += atomic_load_explicit(&block->calls[s], memory_order_relaxed);
+        g_retired[s].ticks += atomic_load_explicit(&block->ticks[s], memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&g_stats_lock);
+    free(block);
+}
+
+static void create_block_key(void) {
+    pthread_key_create(&g_block_key, retire_block);
+}
+
+static StatsBlock *thread_block(void) {
+    if (t_block != NULL) {
+        return t_block;
+    }
+    StatsBlock *block = calloc(1, sizeof(StatsBlock));
+    if (block == NULL) {
+        return NULL;
+    }
+    pthread_once(&g_key_once, create_block_key);
+    pthread_setspecific(g_block_key, block);
+
+    pthread_mutex_lock(&g_stats_lock);
+    block->next = g_blocks;
+    g_blocks = block;
+    pthread_mutex_unlock(&g_stats_lock);
+    t_block = block;
+    return block;
+}
+
+void lunar_stats_record(LunarStat stat, uint64_t ticks) {
+    StatsBlock *block = thread_block();
+    if (block == NULL || stat < 0 || stat >= LUNAR_STAT_COUNT) {
+        return;
+    }
+    /* Single writer: a plain load and store is enough */
+    atomic_store_explicit(&block->calls[stat],
+                          atomic_load_explicit(&block->calls[stat], memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    if (ticks > 0) {
+        atomic_store_explicit(&block->ticks[stat],
+                              atomic_load_explicit(&block->ticks[stat], memory_order_relaxed) + ticks,
+                              memory_order_relaxed);
+    }
+}
+
+// --- Totals ---
+
+/* Totals since the process started; caller holds g_stats_lock */
+static void sum_blocks(LunarStatValue *totals) {
+    memcpy(totals, g_retired, sizeof(g_retired));
+    for (StatsBlock *block = g_blocks; block != NULL; block = block->next) {
+        for (int s = 0; s < LUNAR_STAT_COUNT; s++) {
+            totals[s].calls += atomic_load_explicit(&block->calls[s], memory_order_relaxed);
+            totals[s].ticks += atomic_load_explicit(&block->ticks[s], memory_order_relaxed);
+        }
+    }
+}
+
+void lunar_stats_snapshot(LunarStats *stats) {
+    LunarStatValue totals[LUNAR_STAT_COUNT];
+
+    pthread_once(&g_calibrate_once, calibrate_ticks);
+    pthread_mutex_lock(&g_stats_lock);
+    sum_blocks(totals);
+    for (int s = 0; s < LUNAR_STAT_COUNT; s++) {
+        stats->values[s].calls = totals[s].calls - g_baseline[s].calls;
+        stats->values[s].ticks = totals[s].ticks - g_baseline[s].ticks;
+    }
+    pthread_mutex_unlock(&g_stats_lock);
+    stats->ns_per_tick = g_ns_per_tick;
+}
+
+void lunar_stats_reset(void) {
+    /* Other threads' blocks are theirs to write, so remember where they were */
+    pthread_mutex_lock(&g_stats_lock);
+    sum_blocks(g_baseline);
+    pthread_mutex_unlock(&g_stats_lock);
+}
+
+size_t lunar_stats_format(const LunarStats *stats, char *buffer, size_t size) {
+    size_t length = 0;
+
+#define STATS_APPEND(...) do { \
+        int written = snprintf(buffer != NULL && length < size ? buffer + length : NULL, \
+                               buffer != NULL && length < size ? size - length : 0, __VA_ARGS__); \
+        if (written > 0) length += (size_t)written; \
+    } while (0)
+
+    STATS_APPEND("%-32s %10s %12s %10s\n", "counter", "calls", "total ms", "ns/call");
+    for (int s = 0; s < LUNAR_STAT_COUNT; s++) {
+        const LunarStatValue *value = &stats->values[s];
+        if (value->ticks == 0) {
+            STATS_APPEND("%-32s %10llu\n", STAT_NAMES[s], (unsigned long long)value->calls);
+            continue;
+        }
+        double ns = (double)value->ticks * stats->ns_per_tick;
+        STATS_APPEND("%-32s %10llu %12.3f %10.1f\n", STAT_NAMES[s], (unsigned long long)value->calls,
+                     ns / 1e6, value->calls > 0 ? ns / (double)value->calls : 0.0);
+    }
+#undef STATS_APPEND
+    return length;
+}
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../include/lunar_trace.h"
+
+// --- Constants ---
+#define TRACE_INITIAL_EVENTS 4096
+
+typedef struct {
+    const char *category;
+    const char *name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    int tid;
+} TraceEvent;
+
+static atomic_bool g_trace_enabled = false;
+static atomic_int g_next_tid = 1;
+static _Thread_local int t_tid = 0;
+
+static pthread_mutex_t g_trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static TraceEvent *g_events = NULL;
+static size_t g_event_count = 0;
+static size_t g_event_capacity = 0;
+static size_t g_dropped = 0;
+
+void lunar_trace_enable(bool enabled) {
+    atomic_store_explicit(&g_trace_enabled, enabled, memory_order_relaxed);
+}
+
+bool lunar_trace_enabled(void) {
+    return atomic_load_explicit(&g_trace_enabled, memory_order_relaxed);
+}
+
+uint64_t lunar_trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec + 1;
+}
+
+// --- Recording ---
+
+/* Make room for one more event; caller holds g_trace_lock */
+static bool reserve_event(void) {
+    if (g_event_count < g_event_capacity) {
+        return true;
+    }
+    if (g_event_capacity >= LUNAR_TRACE_MAX_EVENTS) {
+        return false;
+    }
+    size_t capacity = g_event_capacity > 0 ? g_event_capacity * 2 : TRACE_INITIAL_EVENTS;
+    if (capacity > LUNAR_TRACE_MAX_EVENTS) {
+        capacity = LUNAR_TRACE_MAX_EVENTS;
+    }
+    TraceEvent *events = realloc(g_events, capacity * sizeof(TraceEvent));
+    if (events == NULL) {
+        return false;
+    }
+    g_events = events;
+    g_event_capacity = capacity;
+    return true;
+}
+
+void lunar_trace_record(const char *category, const char *name, uint64_t start_ns, uint64_t end_ns) {
+    if (t_tid == 0) {
+        t_tid = atomic_fetch_add(&g_next_tid, 1);
+    }
+
+    pthread_mutex_lock(&g_trace_lock);
+    if (reserve_event()) {
+        TraceEvent *event = &g_events[g_event_count++];
+        event->category = category;
+        event->name = name;
+        event->start_ns = start_ns;
+        event->end_ns = end_ns >= start_ns ? end_ns : start_ns;
+        event->tid = t_tid;
+    } else {
+        g_dropped++;
+    }
+    pthread_mutex_unlock(&g_trace_lock);
+}
+
+size_t lunar_trace_event_count(void) {
+    pthread_mutex_lock(&g_trace_lock);
+    size_t count = g_event_count;
+    pthread_mutex_unlock(&g_trace_lock);
+    return count;
+}
+
+size_t lunar_trace_dropped(void) {
+    pthread_mutex_lock(&g_trace_lock);
+    size_t dropped = g_dropped;
+    pthread_mutex_unlock(&g_trace_lock);
+    return dropped;
+}
+
+void lunar_trace_clear(void) {
+    pthread_mutex_lock(&g_trace_lock);
+    free(g_events);
+    g_events = NULL;
+    g_event_count = 0;
+    g_event_capacity = 0;
+    g_dropped = 0;
+    pthread_mutex_unlock(&g_trace_lock);
+}
+
+// --- Output ---
+
+static void write_json_string(FILE *file, const char *text) {
+    fputc('"', file);
+    for (const char *p = text; *p != '\0'; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\') {
+            fputc('\\', file);
+            fputc(c, file);
+        } else if (c < 0x20) {
+            fprintf(file, "\\u%04x", c);
+        } else {
+            fputc(c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+/* Complete ("X") events with timestamps in microseconds, as the format wants */
+bool lunar_trace_write(const char *path) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+
+    pthread_mutex_lock(&g_trace_lock);
+    int pid = (int)getpid();
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":%zu},\"traceEvents\":[\n",
+            g_dropped);
+    for (size_t i = 0; i < g_event_count; i++) {
+        const TraceEvent *event = &g_events[i];
+        fputs("{\"name\":", file);
+        write_json_string(file, event->name);
+        fputs(",\"cat\":", file);
+        write_json_string(file, event->category);
+        fprintf(file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d}%s\n",
+                (double)event->start_ns / 1000.0, (double)(event->end_ns - event->start_ns) / 1000.0,
+                pid, event->tid, i + 1 < g_event_count ? "," : "");
+    }
+    fputs("]}\n", file);
+    pthread_mutex_unlock(&g_trace_lock);
+
+    bool ok = !ferror(file);
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+    return ok;
+}
@@ -2,345 +2,794 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 #include "../include/lunar_calendar.h"
 #include "../include/lunar_renderer.h"
+#include "../include/lunar_batch.h"
+#include "../include/lunar_export.h"
+#include "../include/lunar_ics.h"
+#include "../include/lunar_server.h"
+#include "../include/lunar_loadgen.h"
+#include "../include/lunar_stats.h"
 
-/* Function to print the moon phase name */
-const char* get_moon_phase_name(MoonPhase phase) {
-    switch (phase) {
-        case NEW_MOON: return "New Moon";
-        case WAXING_CRESCENT: return "Waxing Crescent";
-        case FIRST_QUARTER: return "First Quarter";
-        case WAXING_GIBBOUS: return "Waxing Gibbous";
-        case FULL_MOON: return "Full Moon";
-        case WANING_GIBBOUS: return "Waning Gibbous";
-        case LAST_QUARTER: return "Last Quarter";
-        case WANING_CRESCENT: return "Waning Crescent";
-        default: return "Unknown";
-    }
-}
-
-/* Function to print the weekday name */
-const char* get_weekday_name(Weekday weekday) {
-    switch (weekday) {
-        case SUNDAY: return "Sunday";
-        case MONDAY: return "Monday";
-        case TUESDAY: return "Tuesday";
-        case WEDNESDAY: return "Wednesday";
-        case THURSDAY: return "Thursday";
-        case FRIDAY: return "Friday";
-        case SATURDAY: return "Saturday";
-        default: return "Unknown";
-    }
-}
-
-/* Display help information */
-void display_help() {
+/* Stream buffer size for batch mode */
+#define BATCH_STREAM_BUFFER (1 << 16)
+
+/* Argument schema of a command */
+typedef enum {
+    ARGS_NONE,          /* no arguments */
+    ARGS_YEAR,          /* YYYY */
+    ARGS_YEAR_MONTH,    /* YYYY MM */
+    ARGS_DATE,          /* YYYY MM DD (or YYYY-MM-DD) */
+    ARGS_YEAR_RANGE     /* YYYY YYYY */
+} ArgSchema;
+
+/* Help sections */
+typedef enum {
+    SECTION_GENERAL,
+    SECTION_RENDERING,
+    SECTION_HIDDEN      /* aliases, not listed */
+} CommandSection;
+
+/* Parsed command arguments; unused fields are zero */
+typedef struct {
+    int year;
+    int month;
+    int day;
+    int end_year;
+} CommandArgs;
+
+typedef void (*CommandHandler)(const CommandArgs *args);
+
+/* One entry of the command table */
+typedef struct {
+    const char *name;
+    ArgSchema schema;
+    CommandSection section;
+    CommandHandler handler;
+    const char *description;
+} CommandDescriptor;
+
+static const char *ARG_SCHEMA_USAGE[] = { "", " YYYY", " YYYY MM", " YYYY MM DD", " YYYY YYYY" };
+static const int ARG_SCHEMA_COUNT[] = { 0, 1, 2, 3, 2 };
+
+static void display_help(void);
+
+// --- Command Handlers ---
+
+static void cmd_help(const CommandArgs *args) {
+    (void)args;
+    display_help();
+}
+
+static void cmd_quit(const CommandArgs *args) {
+    (void)args;
+    exit(0);
+}
+
+static void cmd_today(const CommandArgs *args) {
+    (void)args;
+    LunarDay today = get_today_lunar_date();
+    printf("Today's Gregorian date: %04d-%02d-%02d\n", 
+           today.greg_year, today.greg_month, today.greg_day);
+    printf("Today's Lunar date: Year %d, Month %d, Day %d\n", 
+           today.lunar_year, today.lunar_month, today.lunar_day);
+    printf("Weekday: %s\n", get_weekday_name(today.weekday));
+    printf("Moon phase: %s\n", get_moon_phase_name(today.moon_phase));
+    printf("Germanic Eld year: %d\n", today.eld_year);
+    printf("Position in Metonic cycle: Year %d of Cycle %d\n", 
+           today.metonic_year, today.metonic_cycle);
+}
+
+static void cmd_g2l(const CommandArgs *args) {
+    LunarDay result = gregorian_to_lunar(args->year, args->month, args->day);
+    printf("Gregorian date: %04d-%02d-%02d\n", args->year, args->month, args->day);
+    printf("Lunar date: Year %d, Month %d, Day %d\n", 
+           result.lunar_year, result.lunar_month, result.lunar_day);
+    printf("Weekday: %s\n", get_weekday_name(result.weekday));
+    printf("Moon phase: %s\n", get_moon_phase_name(result.moon_phase));
+    printf("Germanic Eld year: %d\n", result.eld_year);
+    printf("Position in Metonic cycle: Year %d of Cycle %d\n", 
+           result.metonic_year, result.metonic_cycle);
+}
+
+static void cmd_l2g(const CommandArgs *args) {
+    int greg_year, greg_month, greg_day;
+    if (lunar_to_gregorian(args->year, args->month, args->day, &greg_year, &greg_month, &greg_day)) {
+        printf("Lunar date: Year %d, Month %d, Day %d\n", args->year, args->month, args->day);
+        printf("Gregorian date: %04d-%02d-%02d\n", greg_year, greg_month, greg_day);
+        Weekday weekday = calculate_weekday(greg_year, greg_month, greg_day);
+        printf("Weekday: %s\n", get_weekday_name(weekday));
+        printf("Moon phase: %s\n", 
+               get_moon_phase_name(calculate_moon_phase(greg_year, greg_month, greg_day)));
+        printf("Germanic Eld year: %d\n", calculate_eld_year(greg_year));
+        
+        int metonic_year, metonic_cycle;
+        get_metonic_position(args->year, &metonic_year, &metonic_cycle);
+        printf("Position in Metonic cycle: Year %d of Cycle %d\n", 
+               metonic_year, metonic_cycle);
+    } else {
+        printf("Error: Invalid lunar date\n");
+    }
+}
+
+static void cmd_phase(const CommandArgs *args) {
+    MoonPhase phase = calculate_moon_phase(args->year, args->month, args->day);
+    printf("Moon phase on %04d-%02d-%02d: %s\n", 
+           args->year, args->month, args->day, get_moon_phase_name(phase));
+}
+
+static void cmd_eld(const CommandArgs *args) {
+    int eld_year = calculate_eld_year(args->year);
+    printf("Germanic Eld year for %d CE: %d\n", args->year, eld_year);
+}
+
+static void cmd_cycle(const CommandArgs *args) {
+    MetonicCycle cycle = initialize_metonic_cycle(args->year);
+    printf("Metonic Cycle #%d starting from year %d:\n", 
+           cycle.cycle_number, args->year);
+    printf("Year\tPosition\tMonths\tDays\tLeap?\tGermanic New Year\n");
+    
+    for (int i = 0; i < YEARS_PER_METONIC_CYCLE; i++) {
+        LunarYear ly = cycle.years[i];
+        printf("%d\t%d\t\t%d\t%d\t%s\t%02d-%02d\n", 
+               ly.year, ly.metonic_year, ly.months_count, ly.days_count,
+               (ly.months_count == 13) ? "Yes" : "No",
+               ly.germanic_start_greg_month, ly.germanic_start_greg_day);
+    }
+}
+
+static void cmd_weekday(const CommandArgs *args) {
+    Weekday weekday = calculate_weekday(args->year, args->month, args->day);
+    printf("Weekday for %04d-%02d-%02d: %s\n", 
+           args->year, args->month, args->day, get_weekday_name(weekday));
+}
+
+static void cmd_newmoon(const CommandArgs *args) {
+    int new_moon_day;
+    double new_moon_hour;
+    if (calculate_new_moon(args->year, args->month, &new_moon_day, &new_moon_hour)) {
+        int hour = (int)new_moon_hour;
+        int minute = (int)((new_moon_hour - hour) * 60);
+        printf("New moon in %04d-%02d: Day %d at ~%02d:%02d\n", 
+               args->year, args->month, new_moon_day, hour, minute);
+    } else {
+        printf("Error: Could not calculate new moon for %04d-%02d\n", args->year, args->month);
+    }
+}
+
+static void cmd_fullmoon(const CommandArgs *args) {
+    int full_moon_day;
+    double full_moon_hour;
+    if (calculate_full_moon(args->year, args->month, &full_moon_day, &full_moon_hour)) {
+        int hour = (int)full_moon_hour;
+        int minute = (int)((full_moon_hour - hour) * 60);
+        printf("Full moon in %04d-%02d: Day %d at ~%02d:%02d\n", 
+               args->year, args->month, full_moon_day, hour, minute);
+    } else {
+        printf("Error: Could not calculate full moon for %04d-%02d\n", args->year, args->month);
+    }
+}
+
+static void cmd_germanic_new_year(const CommandArgs *args) {
+    int year = args->year;
+    int month, day;
+    if (calculate_germanic_new_year(year, &month, &day)) {
+        printf("Germanic New Year for %d: %04d-%02d-%02d\n", 
+               year, year, month, day);
+        
+        /* Show moon phase at Germanic New Year */
+        MoonPhase phase = calculate_moon_phase(year, month, day);
+        printf("Moon phase: %s\n", get_moon_phase_name(phase));
+        
+        /* Show weekday */
+        Weekday weekday = calculate_weekday(year, month, day);
+        printf("Weekday: %s\n", get_weekday_name(weekday));
+        
+        /* Show Eld year */
+        printf("Germanic Eld year: %d\n", calculate_eld_year(year));
+    } else {
+        printf("Error: Could not calculate Germanic New Year for %d\n", year);
+    }
+}
+
+static void cmd_mpos(const CommandArgs *args) {
+    /* The Metonic position belongs to the lunar year containing the date */
+    LunarDay lunar = gregorian_to_lunar(args->year, args->month, args->day);
+    int metonic_year, metonic_cycle;
+    get_metonic_position(lunar.lunar_year, &metonic_year, &metonic_cycle);
+    printf("Date %04d-%02d-%02d is in:\n", args->year, args->month, args->day);
+    printf("Lunar Year: %d\n", lunar.lunar_year);
+    printf("Metonic Year: %d\n", metonic_year);
+    printf("Metonic Cycle: %d\n", metonic_cycle);
+    printf("Lunar Leap Year: %s\n", is_lunar_leap_year(lunar.lunar_year) ? "Yes" : "No");
+}
+
+static void cmd_month_length(const CommandArgs *args) {
+    int length = calculate_lunar_month_length(args->year, args->month);
+    printf("Lunar month %d in year %d has %d days\n", args->month, args->year, length);
+}
+
+/* Print one season line followed by its weekday */
+static void print_season(const char *label, int year, int month, int day) {
+    printf("%s %04d-%02d-%02d\n", label, year, month, day);
+    Weekday wd = calculate_weekday(year, month, day);
+    printf("                 %s\n", get_weekday_name(wd));
+}
+
+static void cmd_seasons(const CommandArgs *args) {
+    int year = args->year;
+    int month, day;
+    
+    printf("Astronomical seasons for year %d:\n", year);
+    printf("-------------------------------\n");
+    
+    if (calculate_winter_solstice(year, &month, &day)) {
+        print_season("Winter Solstice:", year, month, day);
+    }
+    if (calculate_spring_equinox(year, &month, &day)) {
+        print_season("Spring Equinox: ", year, month, day);
+    }
+    if (calculate_summer_solstice(year, &month, &day)) {
+        print_season("Summer Solstice:", year, month, day);
+    }
+    if (calculate_fall_equinox(year, &month, &day)) {
+        print_season("Fall Equinox:   ", year, month, day);
+    }
+}
+
+/* Render options for stdout: colors only on a terminal */
+static RenderOptions cli_render_options(void) {
+    RenderOptions options = default_render_options();
+    options.use_colors = isatty(STDOUT_FILENO);
+    return options;
+}
+
+/* Renderers write straight to stdout */
+static void cmd_render_month(const CommandArgs *args) {
+    RenderSink sink;
+    render_sink_init_stream(&sink, stdout);
+    if (!render_lunar_month_to(&sink, args->year, args->month, cli_render_options())) {
+        printf("Error: Could not render lunar month\n");
+    }
+}
+
+static void cmd_render_year(const CommandArgs *args) {
+    RenderSink sink;
+    render_sink_init_stream(&sink, stdout);
+    if (!render_lunar_year_to(&sink, args->year, cli_render_options())) {
+        printf("Error: Could not render lunar year\n");
+    }
+}
+
+static void cmd_render_years(const CommandArgs *args) {
+    RenderSink sink;
+    if (args->end_year < args->year) {
+        printf("Error: The last year must not be before the first\n");
+        return;
+    }
+    render_sink_init_stream(&sink, stdout);
+    if (!render_lunar_years_to(&sink, args->year, args->end_year, cli_render_options())) {
+        printf("Error: Could not render lunar years\n");
+    }
+}
+
+static void cmd_render_cycle(const CommandArgs *args) {
+    RenderSink sink;
+    render_sink_init_stream(&sink, stdout);
+    if (!render_metonic_cycle_position_to(&sink, args->year, cli_render_options())) {
+        printf("Error: Could not render Metonic cycle position\n");
+    }
+}
+
+/* Print the hot-path counters since the last 'stats' and start again */
+static void cmd_stats(const CommandArgs *args) {
+    (void)args;
+    if (!lunar_stats_enabled()) {
+        printf("Statistics are not compiled in; rebuild with 'make clean && make STATS=1'\n");
+        return;
+    }
+    LunarStats stats;
+    char table[2048];
+    lunar_stats_snapshot(&stats);
+    lunar_stats_format(&stats, table, sizeof(table));
+    fputs(table, stdout);
+    lunar_stats_reset();
+}
+
+// --- Command Table ---
+
+/* Sorted by name for binary search */
+static const CommandDescriptor COMMANDS[] = {
+    { "cycle",             ARGS_YEAR,       SECTION_GENERAL,   cmd_cycle,             "Display Metonic cycle starting from year YYYY" },
+    { "eld",               ARGS_YEAR,       SECTION_GENERAL,   cmd_eld,               "Calculate Germanic Eld year for Gregorian year" },
+    { "exit",              ARGS_NONE,       SECTION_HIDDEN,    cmd_quit,              NULL },
+    { "fullmoon",          ARGS_YEAR_MONTH, SECTION_GENERAL,   cmd_fullmoon,          "Find full moon in given month" },
+    { "g2l",               ARGS_DATE,       SECTION_GENERAL,   cmd_g2l,               "Convert Gregorian date to lunar date" },
+    { "germanic_new_year", ARGS_YEAR,       SECTION_GENERAL,   cmd_germanic_new_year, "Calculate Germanic New Year for given year" },
+    { "help",              ARGS_NONE,       SECTION_GENERAL,   cmd_help,              "Display this help information" },
+    { "l2g",               ARGS_DATE,       SECTION_GENERAL,   cmd_l2g,               "Convert lunar date to Gregorian date" },
+    { "month_length",      ARGS_YEAR_MONTH, SECTION_GENERAL,   cmd_month_length,      "Calculate lunar month length" },
+    { "mpos",              ARGS_DATE,       SECTION_GENERAL,   cmd_mpos,              "Get Metonic position for given date" },
+    { "newmoon",           ARGS_YEAR_MONTH, SECTION_GENERAL,   cmd_newmoon,           "Find new moon in given month" },
+    { "phase",             ARGS_DATE,       SECTION_GENERAL,   cmd_phase,             "Show moon phase for Gregorian date" },
+    { "quit",              ARGS_NONE,       SECTION_GENERAL,   cmd_quit,              "Exit the program" },
+    { "render_cycle",      ARGS_YEAR,       SECTION_RENDERING, cmd_render_cycle,      "Render the Metonic cycle position" },
+    { "render_month",      ARGS_YEAR_MONTH, SECTION_RENDERING, cmd_render_month,      "Render a lunar month calendar" },
+    { "render_year",       ARGS_YEAR,       SECTION_RENDERING, cmd_render_year,       "Render a full lunar year calendar" },
+    { "render_years",      ARGS_YEAR_RANGE, SECTION_RENDERING, cmd_render_years,      "Render every lunar year in a range" },
+    { "seasons",           ARGS_YEAR,       SECTION_GENERAL,   cmd_seasons,           "Display solstices and equinoxes for given year" },
+    { "stats",             ARGS_NONE,       SECTION_GENERAL,   cmd_stats,             "Show hot-path counters since the last 'stats'" },
+    { "today",             ARGS_NONE,       SECTION_GENERAL,   cmd_today,             "Display lunar date for today" },
+    { "weekday",           ARGS_DATE,       SECTION_GENERAL,   cmd_weekday,           "Calculate weekday for given date" },
+};
+#define COMMAND_COUNT (sizeof(COMMANDS) / sizeof(COMMANDS[0]))
+
+/* Find a command by name (not NUL-terminated); NULL if unknown */
+static const CommandDescriptor *find_command(const char *name, size_t length) {
+    size_t low = 0, high = COMMAND_COUNT;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        int cmp = strncmp(COMMANDS[mid].name, name, length);
+        if (cmp == 0 && COMMANDS[mid].name[length] != '\0') {
+            cmp = 1;  /* Table name is longer than the token */
+        }
+        if (cmp == 0) {
+            return &COMMANDS[mid];
+        }
+        if (cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return NULL;
+}
+
+/* Width of the usage column: the longest usage plus a space */
+static int help_usage_width(void) {
+    int width = 0;
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        int usage = (int)(strlen(COMMANDS[i].name) + strlen(ARG_SCHEMA_USAGE[COMMANDS[i].schema]));
+        if (usage > width) width = usage;
+    }
+    return width + 1;
+}
+
+static void print_help_section(CommandSection section, int width) {
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        const CommandDescriptor *command = &COMMANDS[i];
+        if (command->section != section) {
+            continue;
+        }
+        int usage = printf("  %s%s", command->name, ARG_SCHEMA_USAGE[command->schema]) - 2;
+        printf("%*s- %s\n", width - usage, "", command->description);
+    }
+}
+
+/* Display help information, generated from the command table */
+static void display_help(void) {
     printf("Lunar Calendar - Metonic Cycle Calculator\n");
     printf("------------------------------------------\n");
+    int width = help_usage_width();
     printf("Commands:\n");
-    printf("  today              - Display lunar date for today\n");
-    printf("  g2l YYYY MM DD     - Convert Gregorian date to lunar date\n");
-    printf("  l2g YYYY MM DD     - Convert lunar date to Gregorian date\n");
-    printf("  phase YYYY MM DD   - Show moon phase for Gregorian date\n");
-    printf("  eld YYYY           - Calculate Germanic Eld year for Gregorian year\n");
-    printf("  cycle YYYY         - Display Metonic cycle starting from year YYYY\n");
-    printf("  weekday YYYY MM DD - Calculate weekday for given date\n");
-    printf("  newmoon YYYY MM    - Find new moon in given month\n");
-    printf("  fullmoon YYYY MM   - Find full moon in given month\n");
-    printf("  germanic_new_year YYYY - Calculate Germanic New Year for given year\n");
-    printf("  mpos YYYY MM DD    - Get Metonic position for given date\n");
-    printf("  month_length YYYY MM - Calculate lunar month length\n");
-    printf("  seasons YYYY       - Display solstices and equinoxes for given year\n");
-    printf("  help               - Display this help information\n");
-    printf("  quit               - Exit the program\n");
+    print_help_section(SECTION_GENERAL, width);
     printf("\n");
     printf("Rendering Commands:\n");
-    printf("  render_month YYYY MM - Render a lunar month calendar\n");
-    printf("  render_year YYYY     - Render a full lunar year calendar\n");
-    printf("  render_cycle YYYY    - Render the Metonic cycle position\n");
+    print_help_section(SECTION_RENDERING, width);
+    printf("\n");
+    printf("Batch Mode (command line only):\n");
+    printf("  --batch [FILE] [--format tsv|csv|jsonl] [--l2g] [--no-header]\n");
+    printf("                         - Convert one date per line from FILE or stdin\n");
+    printf("  export --from YYYY-MM-DD --to YYYY-MM-DD [--format csv|jsonl|binary]\n");
+    printf("         [--output FILE] [--threads N] [--no-header]\n");
+    printf("                         - Write one row per day of the range, in parallel\n");
+    printf("  ics --from YYYY --to YYYY [--output FILE] [--no-months] [--no-moons] [--no-seasons]\n");
+    printf("                         - Write lunar months, moon phases and seasons as iCalendar\n");
+    printf("\n");
+    printf("Query Daemon (command line only):\n");
+    printf("  serve [--port N] [--bind ADDR] [--workers N] [--socket PATH]\n");
+    printf("                         - Answer HTTP/JSON (and binary socket) queries until interrupted\n");
+    printf("  loadgen [--host ADDR] [--port N] [--connections N] [--requests N] [--path PATH]\n");
+    printf("          [--socket PATH]\n");
+    printf("                         - Load-test a running daemon and report latency\n");
 }
 
 /* Process a command and its arguments */
 void process_command(const char* command) {
-    int year, month, day;
-    
-    if (strcmp(command, "help") == 0) {
-        display_help();
-    } 
-    else if (strcmp(command, "quit") == 0 || strcmp(command, "exit") == 0) {
-        exit(0);
-    }
-    else if (strcmp(command, "today") == 0) {
-        LunarDay today = get_today_lunar_date();
-        printf("Today's Gregorian date: %04d-%02d-%02d\n", 
-               today.greg_year, today.greg_month, today.greg_day);
-        printf("Today's Lunar date: Year %d, Month %d, Day %d\n", 
-               today.lunar_year, today.lunar_month, today.lunar_day);
-        printf("Weekday: %s\n", get_weekday_name(today.weekday));
-        printf("Moon phase: %s\n", get_moon_phase_name(today.moon_phase));
-        printf("Germanic Eld year: %d\n", today.eld_year);
-        printf("Position in Metonic cycle: Year %d of Cycle %d\n", 
-               today.metonic_year, today.metonic_cycle);
-    }
-    else if (strncmp(command, "g2l ", 4) == 0) {
-        if (sscanf(command + 4, "%d %d %d", &year, &month, &day) == 3) {
-            LunarDay result = gregorian_to_lunar(year, month, day);
-            printf("Gregorian date: %04d-%02d-%02d\n", year, month, day);
-            printf("Lunar date: Year %d, Month %d, Day %d\n", 
-                   result.lunar_year, result.lunar_month, result.lunar_day);
-            printf("Weekday: %s\n", get_weekday_name(result.weekday));
-            printf("Moon phase: %s\n", get_moon_phase_name(result.moon_phase));
-            printf("Germanic Eld year: %d\n", result.eld_year);
-            printf("Position in Metonic cycle: Year %d of Cycle %d\n", 
-                   result.metonic_year, result.metonic_cycle);
-        } else {
-            printf("Error: Invalid format. Use 'g2l YYYY MM DD'\n");
-        }
+    const char *name = command;
+    while (*name == ' ' || *name == '\t') name++;
+
+    size_t length = strcspn(name, " \t\r\n");
+    const CommandDescriptor *descriptor = find_command(name, length);
+    if (descriptor == NULL) {
+        printf("Unknown command. Type 'help' for available commands.\n");
+        return;
     }
-    else if (strncmp(command, "l2g ", 4) == 0) {
-        if (sscanf(command + 4, "%d %d %d", &year, &month, &day) == 3) {
-            int greg_year, greg_month, greg_day;
-            if (lunar_to_gregorian(year, month, day, &greg_year, &greg_month, &greg_day)) {
-                printf("Lunar date: Year %d, Month %d, Day %d\n", year, month, day);
-                printf("Gregorian date: %04d-%02d-%02d\n", greg_year, greg_month, greg_day);
-                Weekday weekday = calculate_weekday(greg_year, greg_month, greg_day);
-                printf("Weekday: %s\n", get_weekday_name(weekday));
-                printf("Moon phase: %s\n", 
-                       get_moon_phase_name(calculate_moon_phase(greg_year, greg_month, greg_day)));
-                printf("Germanic Eld year: %d\n", calculate_eld_year(greg_year));
-                
-                int metonic_year, metonic_cycle;
-                get_metonic_position(greg_year, greg_month, greg_day, &metonic_year, &metonic_cycle);
-                printf("Position in Metonic cycle: Year %d of Cycle %d\n", 
-                       metonic_year, metonic_cycle);
-            } else {
-                printf("Error: Invalid lunar date\n");
-            }
-        } else {
-            printf("Error: Invalid format. Use 'l2g YYYY MM DD'\n");
-        }
+
+    int values[3] = { 0, 0, 0 };
+    int count = ARG_SCHEMA_COUNT[descriptor->schema];
+    const char *arguments = name + length;
+    bool ok;
+    if (count > 0) {
+        ok = parse_int_fields(arguments, values, count);
+    } else {
+        ok = strspn(arguments, " \t\r\n") == strlen(arguments);
     }
-    else if (strncmp(command, "phase ", 6) == 0) {
-        /* Try to parse multiple date formats */
-        int result;
-        /* Try parsing dash-separated format: YYYY-MM-DD */
-        result = sscanf(command + 6, "%d-%d-%d", &year, &month, &day);
-        if (result != 3) {
-            /* Try parsing space-separated format: YYYY MM DD */
-            result = sscanf(command + 6, "%d %d %d", &year, &month, &day);
-        }
-        
-        if (result == 3) {
-            MoonPhase phase = calculate_moon_phase(year, month, day);
-            printf("Moon phase on %04d-%02d-%02d: %s\n", 
-                   year, month, day, get_moon_phase_name(phase));
-        } else {
-            printf("Error: Invalid format. Use 'phase YYYY-MM-DD' or 'phase YYYY MM DD'\n");
-        }
+
+    if (!ok) {
+        printf("Error: Invalid format. Use '%s%s'\n",
+               descriptor->name, ARG_SCHEMA_USAGE[descriptor->schema]);
+        return;
     }
-    else if (strncmp(command, "eld ", 4) == 0) {
-        if (sscanf(command + 4, "%d", &year) == 1) {
-            int eld_year = calculate_eld_year(year);
-            printf("Germanic Eld year for %d CE: %d\n", year, eld_year);
-        } else {
-            printf("Error: Invalid format. Use 'eld YYYY'\n");
-        }
+
+    CommandArgs args = { values[0], values[1], values[2], 0 };
+    if (descriptor->schema == ARGS_YEAR_RANGE) {
+        args.end_year = values[1];
+        args.month = 0;
     }
-    else if (strncmp(command, "cycle ", 6) == 0) {
-        if (sscanf(command + 6, "%d", &year) == 1) {
-            MetonicCycle cycle = initialize_metonic_cycle(year);
-            printf("Metonic Cycle #%d starting from year %d:\n", 
-                   cycle.cycle_number, year);
-            printf("Year\tPosition\tMonths\tDays\tLeap?\tGermanic New Year\n");
-            
-            for (int i = 0; i < YEARS_PER_METONIC_CYCLE; i++) {
-                LunarYear ly = cycle.years[i];
-                printf("%d\t%d\t\t%d\t%d\t%s\t%02d-%02d\n", 
-                       ly.year, ly.metonic_year, ly.months_count, ly.days_count,
-                       (ly.months_count == 13) ? "Yes" : "No",
-                       ly.germanic_start_greg_month, ly.germanic_start_greg_day);
+    descriptor->handler(&args);
+}
+
+/* Run batch mode with the arguments following --batch; returns the exit status */
+static int run_batch_command(int argc, char *argv[]) {
+    BatchOptions options = default_batch_options();
+    const char *input_path = NULL;
+
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            if (!parse_batch_format(argv[++i], &options.format)) {
+                fprintf(stderr, "Error: Unknown batch format '%s' (use tsv, csv or jsonl)\n", argv[i]);
+                return 2;
             }
+        } else if (strcmp(argv[i], "--l2g") == 0) {
+            options.direction = BATCH_LUNAR_TO_GREGORIAN;
+        } else if (strcmp(argv[i], "--g2l") == 0) {
+            options.direction = BATCH_GREGORIAN_TO_LUNAR;
+        } else if (strcmp(argv[i], "--no-header") == 0) {
+            options.header = false;
+        } else if (input_path == NULL && (argv[i][0] != '-' || strcmp(argv[i], "-") == 0)) {
+            input_path = argv[i];
         } else {
-            printf("Error: Invalid format. Use 'cycle YYYY'\n");
+            fprintf(stderr, "Error: Unknown batch option '%s'\n", argv[i]);
+            return 2;
         }
     }
-    else if (strncmp(command, "weekday ", 8) == 0) {
-        if (sscanf(command + 8, "%d %d %d", &year, &month, &day) == 3) {
-            Weekday weekday = calculate_weekday(year, month, day);
-            printf("Weekday for %04d-%02d-%02d: %s\n", 
-                   year, month, day, get_weekday_name(weekday));
-        } else {
-            printf("Error: Invalid format. Use 'weekday YYYY MM DD'\n");
+
+    FILE *in = stdin;
+    if (input_path != NULL && strcmp(input_path, "-") != 0) {
+        in = fopen(input_path, "r");
+        if (in == NULL) {
+            fprintf(stderr, "Error: Could not open '%s'\n", input_path);
+            return 2;
         }
     }
-    else if (strncmp(command, "newmoon ", 8) == 0) {
-        if (sscanf(command + 8, "%d %d", &year, &month) == 2) {
-            int new_moon_day;
-            double new_moon_hour;
-            if (calculate_new_moon(year, month, &new_moon_day, &new_moon_hour)) {
-                int hour = (int)new_moon_hour;
-                int minute = (int)((new_moon_hour - hour) * 60);
-                printf("New moon in %04d-%02d: Day %d at ~%02d:%02d\n", 
-                       year, month, new_moon_day, hour, minute);
-            } else {
-                printf("Error: Could not calculate new moon for %04d-%02d\n", year, month);
+
+    /* Large stream buffers: rows are written with one fwrite each */
+    setvbuf(in, NULL, _IOFBF, BATCH_STREAM_BUFFER);
+    setvbuf(stdout, NULL, _IOFBF, BATCH_STREAM_BUFFER);
+
+    long failures = run_batch(in, stdout, &options);
+
+    if (in != stdin) {
+        fclose(in);
+    }
+
+    if (failures < 0) {
+        fprintf(stderr, "Error: Failed to write batch output\n");
+        return 2;
+    }
+    if (failures > 0) {
+        fprintf(stderr, "%ld line(s) could not be converted\n", failures);
+        return 1;
+    }
+    return 0;
+}
+
+/* Parse a YYYY-MM-DD option value */
+static bool parse_export_date(const char *text, int *year, int *month, int *day) {
+    char extra;
+    return sscanf(text, "%d-%d-%d%c", year, month, day, &extra) == 3 &&
+           is_valid_gregorian_date(*year, *month, *day);
+}
+
+/* Parse a positive integer option value no larger than max */
+static bool parse_count_option(const char *text, long max, long *value) {
+    char *end;
+    long parsed = strtol(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || parsed < 1 || parsed > max) {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+/* Run a range export with the arguments following "export"; returns the exit status */
+static int run_export_command(int argc, char *argv[]) {
+    ExportOptions options = default_export_options();
+    const char *output_path = NULL;
+    bool have_from = false, have_to = false;
+
+    for (int i = 0; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--from") == 0 && has_value) {
+            have_from = parse_export_date(argv[++i], &options.from_year, &options.from_month, &options.from_day);
+            if (!have_from) {
+                fprintf(stderr, "Error: Invalid --from date '%s' (use YYYY-MM-DD)\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--to") == 0 && has_value) {
+            have_to = parse_export_date(argv[++i], &options.to_year, &options.to_month, &options.to_day);
+            if (!have_to) {
+                fprintf(stderr, "Error: Invalid --to date '%s' (use YYYY-MM-DD)\n", argv[i]);
+                return 2;
             }
+        } else if (strcmp(argv[i], "--format") == 0 && has_value) {
+            if (!parse_export_format(argv[++i], &options.format)) {
+                fprintf(stderr, "Error: Unknown export format '%s' (use csv, jsonl or binary)\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--output") == 0 && has_value) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+            long value;
+            if (!parse_count_option(argv[++i], EXPORT_MAX_THREADS, &value)) {
+                fprintf(stderr, "Error: Invalid thread count '%s' (use 1-%d)\n", argv[i], EXPORT_MAX_THREADS);
+                return 2;
+            }
+            options.threads = (int)value;
+        } else if (strcmp(argv[i], "--no-header") == 0) {
+            options.header = false;
         } else {
-            printf("Error: Invalid format. Use 'newmoon YYYY MM'\n");
+            fprintf(stderr, "Error: Unknown export option '%s'\n", argv[i]);
+            return 2;
         }
     }
-    else if (strncmp(command, "fullmoon ", 9) == 0) {
-        if (sscanf(command + 9, "%d %d", &year, &month) == 2) {
-            int full_moon_day;
-            double full_moon_hour;
-            if (calculate_full_moon(year, month, &full_moon_day, &full_moon_hour)) {
-                int hour = (int)full_moon_hour;
-                int minute = (int)((full_moon_hour - hour) * 60);
-                printf("Full moon in %04d-%02d: Day %d at ~%02d:%02d\n", 
-                       year, month, full_moon_day, hour, minute);
-            } else {
-                printf("Error: Could not calculate full moon for %04d-%02d\n", year, month);
-            }
-        } else {
-            printf("Error: Invalid format. Use 'fullmoon YYYY MM'\n");
+
+    if (!have_from || !have_to) {
+        fprintf(stderr, "Error: export needs --from YYYY-MM-DD and --to YYYY-MM-DD\n");
+        return 2;
+    }
+
+    FILE *out = stdout;
+    if (output_path != NULL && strcmp(output_path, "-") != 0) {
+        out = fopen(output_path, "wb");
+        if (out == NULL) {
+            fprintf(stderr, "Error: Could not create '%s'\n", output_path);
+            return 2;
         }
     }
-    else if (strncmp(command, "germanic_new_year ", 18) == 0) {
-        if (sscanf(command + 18, "%d", &year) == 1) {
-            int month, day;
-            if (calculate_germanic_new_year(year, &month, &day)) {
-                printf("Germanic New Year for %d: %04d-%02d-%02d\n", 
-                       year, year, month, day);
-                
-                /* Show moon phase at Germanic New Year */
-                MoonPhase phase = calculate_moon_phase(year, month, day);
-                printf("Moon phase: %s\n", get_moon_phase_name(phase));
-                
-                /* Show weekday */
-                Weekday weekday = calculate_weekday(year, month, day);
-                printf("Weekday: %s\n", get_weekday_name(weekday));
-                
-                /* Show Eld year */
-                printf("Germanic Eld year: %d\n", calculate_eld_year(year));
-            } else {
-                printf("Error: Could not calculate Germanic New Year for %d\n", year);
+    setvbuf(out, NULL, _IOFBF, BATCH_STREAM_BUFFER);
+
+    long long rows = run_export(out, &options);
+
+    if (out != stdout && fclose(out) != 0) {
+        rows = -1;
+    }
+    if (rows < 0) {
+        fprintf(stderr, "Error: Export failed (check the date range and output)\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* Parse a Gregorian year argument of ics (1-9999) */
+static bool parse_ics_year(const char *text, int *year) {
+    int value;
+    if (!parse_int_fields(text, &value, 1) || value < 1 || value > 9999) {
+        return false;
+    }
+    *year = value;
+    return true;
+}
+
+/* Run an iCalendar export with the arguments following "ics"; returns the exit status */
+static int run_ics_command(int argc, char *argv[]) {
+    IcsOptions options = default_ics_options();
+    const char *output_path = NULL;
+    bool have_from = false, have_to = false;
+
+    for (int i = 0; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--from") == 0 && has_value) {
+            have_from = parse_ics_year(argv[++i], &options.from_year);
+            if (!have_from) {
+                fprintf(stderr, "Error: Invalid --from year '%s' (use 1-9999)\n", argv[i]);
+                return 2;
             }
+        } else if (strcmp(argv[i], "--to") == 0 && has_value) {
+            have_to = parse_ics_year(argv[++i], &options.to_year);
+            if (!have_to) {
+                fprintf(stderr, "Error: Invalid --to year '%s' (use 1-9999)\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--output") == 0 && has_value) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--no-months") == 0) {
+            options.month_starts = false;
+        } else if (strcmp(argv[i], "--no-moons") == 0) {
+            options.moon_phases = false;
+        } else if (strcmp(argv[i], "--no-seasons") == 0) {
+            options.seasons = false;
         } else {
-            printf("Error: Invalid format. Use 'germanic_new_year YYYY'\n");
+            fprintf(stderr, "Error: Unknown ics option '%s'\n", argv[i]);
+            return 2;
         }
     }
-    else if (strncmp(command, "mpos ", 5) == 0) {
-        if (sscanf(command + 5, "%d %d %d", &year, &month, &day) == 3) {
-            int metonic_year, metonic_cycle;
-            get_metonic_position(year, month, day, &metonic_year, &metonic_cycle);
-            printf("Date %04d-%02d-%02d is in:\n", year, month, day);
-            printf("Metonic Year: %d\n", metonic_year);
-            printf("Metonic Cycle: %d\n", metonic_cycle);
-            printf("Lunar Leap Year: %s\n", is_lunar_leap_year(year) ? "Yes" : "No");
-        } else {
-            printf("Error: Invalid format. Use 'mpos YYYY MM DD'\n");
+
+    if (!have_from || !have_to || options.to_year < options.from_year) {
+        fprintf(stderr, "Error: ics needs --from YYYY and --to YYYY (from <= to)\n");
+        return 2;
+    }
+
+    FILE *out = stdout;
+    if (output_path != NULL && strcmp(output_path, "-") != 0) {
+        out = fopen(output_path, "wb");
+        if (out == NULL) {
+            fprintf(stderr, "Error: Could not create '%s'\n", output_path);
+            return 2;
         }
     }
-    else if (strncmp(command, "month_length ", 13) == 0) {
-        if (sscanf(command + 13, "%d %d", &year, &month) == 2) {
-            int length = calculate_lunar_month_length(year, month);
-            printf("Lunar month %d in year %d has %d days\n", month, year, length);
+
+    /* The writer buffers internally, so the stream's own buffer is not needed */
+    setvbuf(out, NULL, _IONBF, 0);
+    long events = run_ics_export(out, &options, NULL, NULL);
+
+    if (out != stdout && fclose(out) != 0) {
+        events = -1;
+    }
+    if (events < 0) {
+        fprintf(stderr, "Error: iCalendar export failed\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* Run the query daemon with the arguments following "serve"; returns the exit status */
+static int run_serve_command(int argc, char *argv[]) {
+    ServerOptions options = default_server_options();
+
+    for (int i = 0; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        long value;
+        if (strcmp(argv[i], "--port") == 0 && has_value) {
+            if (!parse_count_option(argv[++i], 65535, &value)) {
+                fprintf(stderr, "Error: Invalid port '%s'\n", argv[i]);
+                return 2;
+            }
+            options.port = (int)value;
+        } else if (strcmp(argv[i], "--bind") == 0 && has_value) {
+            options.bind_address = argv[++i];
+        } else if (strcmp(argv[i], "--socket") == 0 && has_value) {
+            options.socket_path = argv[++i];
+        } else if (strcmp(argv[i], "--workers") == 0 && has_value) {
+            if (!parse_count_option(argv[++i], SERVER_MAX_WORKERS, &value)) {
+                fprintf(stderr, "Error: Invalid worker count '%s' (use 1-%d)\n", argv[i], SERVER_MAX_WORKERS);
+                return 2;
+            }
+            options.workers = (int)value;
         } else {
-            printf("Error: Invalid format. Use 'month_length YYYY MM'\n");
+            fprintf(stderr, "Error: Unknown serve option '%s'\n", argv[i]);
+            return 2;
         }
     }
-    else if (strncmp(command, "seasons ", 8) == 0) {
-        if (sscanf(command + 8, "%d", &year) == 1) {
-            int month, day;
-            
-            printf("Astronomical seasons for year %d:\n", year);
-            printf("-------------------------------\n");
-            
-            /* Winter Solstice */
-            if (calculate_winter_solstice(year, &month, &day)) {
-                printf("Winter Solstice: %04d-%02d-%02d\n", year, month, day);
-                Weekday wd = calculate_weekday(year, month, day);
-                printf("                 %s\n", get_weekday_name(wd));
+
+    return run_server(&options) == 0 ? 0 : 1;
+}
+
+/* Run the load generator with the arguments following "loadgen"; returns the exit status */
+static int run_loadgen_command(int argc, char *argv[]) {
+    LoadgenOptions options = default_loadgen_options();
+
+    for (int i = 0; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        long value;
+        if (strcmp(argv[i], "--host") == 0 && has_value) {
+            options.host = argv[++i];
+        } else if (strcmp(argv[i], "--port") == 0 && has_value) {
+            if (!parse_count_option(argv[++i], 65535, &value)) {
+                fprintf(stderr, "Error: Invalid port '%s'\n", argv[i]);
+                return 2;
             }
-            
-            /* Spring Equinox */
-            if (calculate_spring_equinox(year, &month, &day)) {
-                printf("Spring Equinox:  %04d-%02d-%02d\n", year, month, day);
-                Weekday wd = calculate_weekday(year, month, day);
-                printf("                 %s\n", get_weekday_name(wd));
+            options.port = (int)value;
+        } else if (strcmp(argv[i], "--connections") == 0 && has_value) {
+            if (!parse_count_option(argv[++i], 1024, &value)) {
+                fprintf(stderr, "Error: Invalid connection count '%s' (use 1-1024)\n", argv[i]);
+                return 2;
             }
-            
-            /* Summer Solstice */
-            if (calculate_summer_solstice(year, &month, &day)) {
-                printf("Summer Solstice: %04d-%02d-%02d\n", year, month, day);
-                Weekday wd = calculate_weekday(year, month, day);
-                printf("                 %s\n", get_weekday_name(wd));
+            options.connections = (int)value;
+        } else if (strcmp(argv[i], "--requests") == 0 && has_value) {
+            if (!parse_count_option(argv[++i], 100000000L, &options.requests)) {
+                fprintf(stderr, "Error: Invalid request count '%s'\n", argv[i]);
+                return 2;
             }
-            
-            /* Fall Equinox */
-            if (calculate_fall_equinox(year, &month, &day)) {
-                printf("Fall Equinox:    %04d-%02d-%02d\n", year, month, day);
-                Weekday wd = calculate_weekday(year, month, day);
-                printf("                 %s\n", get_weekday_name(wd));
+        } else if (strcmp(argv[i], "--path") == 0 && has_value) {
+            options.path = argv[++i];
+            if (options.path[0] != '/') {
+                fprintf(stderr, "Error: --path must start with '/'\n");
+                return 2;
             }
+        } else if (strcmp(argv[i], "--socket") == 0 && has_value) {
+            options.socket_path = argv[++i];
         } else {
-            printf("Error: Invalid format. Use 'seasons YYYY'\n");
+            fprintf(stderr, "Error: Unknown loadgen option '%s'\n", argv[i]);
+            return 2;
         }
     }
-    else if (strncmp(command, "render_month ", 13) == 0) {
-        if (sscanf(command + 13, "%d %d", &year, &month) == 2) {
-            RenderOptions options = default_render_options();
-            RenderedMonth rendered = render_lunar_month(year, month, options);
-            if (rendered.buffer) {
-                display_rendered_month(rendered);
-                free_rendered_month(&rendered);
-            } else {
-                printf("Error: Could not render lunar month\n");
-            }
-        } else {
-            printf("Error: Invalid format. Use 'render_month YYYY MM'\n");
-        }
+
+    LoadgenReport report;
+    bool ok = run_loadgen(&options, &report);
+    printf("Requests:  %ld completed, %ld errors in %.2f s\n", report.completed, report.errors, report.seconds);
+    printf("Throughput: %.0f %s/s over %d connections\n", report.qps,
+           options.socket_path != NULL ? "dates" : "requests", options.connections);
+    printf("Latency:   p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+           report.p50_ms, report.p90_ms, report.p99_ms, report.max_ms);
+    return ok && report.errors == 0 ? 0 : 1;
+}
+
+/* Join command line arguments into a single space-separated command string */
+static char *join_arguments(int argc, char *argv[]) {
+    size_t length = 1;
+    for (int i = 0; i < argc; i++) {
+        length += strlen(argv[i]) + 1;
     }
-    else if (strncmp(command, "render_year ", 12) == 0) {
-        if (sscanf(command + 12, "%d", &year) == 1) {
-            RenderOptions options = default_render_options();
-            RenderedYear rendered = render_lunar_year(year, options);
-            if (rendered.buffer) {
-                display_rendered_year(rendered);
-                free_rendered_year(&rendered);
-            } else {
-                printf("Error: Could not render lunar year\n");
-            }
-        } else {
-            printf("Error: Invalid format. Use 'render_year YYYY'\n");
-        }
+
+    char *command = malloc(length);
+    if (command == NULL) {
+        return NULL;
     }
-    else if (strncmp(command, "render_cycle ", 13) == 0) {
-        if (sscanf(command + 13, "%d", &year) == 1) {
-            RenderOptions options = default_render_options();
-            char *position_text = render_metonic_cycle_position(year, options);
-            if (position_text) {
-                display_metonic_cycle_position(position_text);
-                free(position_text);
-            } else {
-                printf("Error: Could not render Metonic cycle position\n");
-            }
-        } else {
-            printf("Error: Invalid format. Use 'render_cycle YYYY'\n");
+
+    char *end = command;
+    for (int i = 0; i < argc; i++) {
+        size_t arg_length = strlen(argv[i]);
+        if (i > 0) {
+            *end++ = ' ';
         }
+        memcpy(end, argv[i], arg_length);
+        end += arg_length;
     }
-    else {
-        printf("Unknown command. Type 'help' for available commands.\n");
-    }
+    *end = '\0';
+    return command;
 }
 
 int main(int argc, char *argv[]) {
     char command[256];
     
+    /* Batch mode, the exports and the daemon write machine-readable output only, so they run before the banner */
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+        return run_batch_command(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "export") == 0) {
+        return run_export_command(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "ics") == 0) {
+        return run_ics_command(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "serve") == 0) {
+        return run_serve_command(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "loadgen") == 0) {
+        return run_loadgen_command(argc - 2, argv + 2);
+    }
+    
     printf("Lunar Calendar - Metonic Cycle Calculator\n");
     printf("Type 'help' for available commands\n\n");
     
+    /* "stats COMMAND ..." runs one command and reports what it cost */
+    if (argc > 2 && strcmp(argv[1], "stats") == 0) {
+        char *joined = join_arguments(argc - 2, argv + 2);
+        if (joined == NULL) {
+            fprintf(stderr, "Error: Out of memory\n");
+            return 1;
+        }
+        lunar_stats_reset();
+        process_command(joined);
+        free(joined);
+        printf("\n");
+        process_command("stats");
+        return 0;
+    }
+
     /* If arguments were provided, process them as a command */
     if (argc > 1) {
         /* First, check for single commands like "today" */
@@ -351,19 +800,14 @@ int main(int argc, char *argv[]) {
         
         /* Handle commands with arguments (g2l, l2g, etc.) */
         if (argc >= 3) {
-            /* Create command string */
-            command[0] = '\0';
-            strcat(command, argv[1]);
-            strcat(command, " ");
-            
-            for (int i = 2; i < argc; i++) {
-                strcat(command, argv[i]);
-                if (i < argc - 1) {
-                    strcat(command, " ");
-                }
+            char *joined = join_arguments(argc - 1, argv + 1);
+            if (joined == NULL) {
+                fprintf(stderr, "Error: Out of memory\n");
+                return 1;
             }
             
-            process_command(command);
+            process_command(joined);
+            free(joined);
             return 0;
         }
     }
@@ -0,0 +1,974 @@
+/* Golden-data regression check.
+ *
+ * The corpus in tests/golden/ records what the reference code path computed
+ * for Gregorian years GOLDEN_FIRST_YEAR..GOLDEN_LAST_YEAR (2000 +/- 3000):
+ *
+ *   - the full LunarDay of every day, from the uncached gregorian_to_lunar;
+ *   - find_next_phase_jd of each phase on a grid of quarter lunations;
+ *   - the lunar new year and month start instants of every lunar year;
+ *   - the solstice and equinox instants of every year.
+ *
+ * `lunar_golden --check` recomputes all of it through the cached and shared
+ * table paths (and the plain path on a sample of days) on all cores, and
+ * fails on any difference beyond the tolerances below. Day fields must match
+ * exactly, since a moved instant only matters once it moves a day, and every
+ * lunar date must convert back (lunar_to_gregorian_cached) to its own day.
+ * Built with GTK (LUNAR_GOLDEN_GUI), it also checks that the GUI events
+ * module (events_gregorian_to_lunar) places every day in the same lunar date.
+ *
+ * `lunar_golden --generate` rewrites the corpus from the current code. Do
+ * that only for a change that is meant to alter results, and say so in the
+ * commit.
+ *
+ * The file is little-endian throughout: a GOLDEN_HEADER_BYTES header of
+ * 32-bit fields, then four sections of varints:
+ *
+ *   days     An event wherever a day is not the previous day's lunar date
+ *            plus one: the gap in days, a GOLDEN_DAY_* mask of the fields
+ *            that changed and their new values.
+ *   phases   find_next_phase_jd(first_day + i * month / 4, i % 4).
+ *   years    Per lunar year: the new year instant, the month count (0 if
+ *            the boundaries could not be computed) and the month starts.
+ *   seasons  Per year: seasons 0-3 of calculate_solstice_equinox_jde.
+ *
+ * Instants are stored as the zigzag varint of their distance from a
+ * prediction (the previous instant of the same series plus its mean period),
+ * in units of GOLDEN_JD_UNIT days. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../include/lunar_calendar.h"
+#ifdef LUNAR_GOLDEN_GUI
+#include <gtk/gtk.h>
+#include "../include/gui/calendar_events.h"
+#endif
+
+// --- Constants ---
+#define GOLDEN_MAGIC 0x444C474Cu      /* "LGLD" */
+#define GOLDEN_VERSION 1
+#define GOLDEN_FIRST_YEAR -1000
+#define GOLDEN_LAST_YEAR 5000
+#define GOLDEN_JD_UNIT 1e-8           /* Resolution of stored instants, in days */
+#define GOLDEN_HEADER_FIELDS 12
+#define GOLDEN_HEADER_BYTES (GOLDEN_HEADER_FIELDS * 4)
+#define GOLDEN_SECTIONS 4
+
+/* Tolerances of the check */
+#define CHECK_JD_TOLERANCE 1e-6       /* Phase, month start and season instants (0.09 s) */
+#define CHECK_PLAIN_STRIDE 61         /* Days between checks of the uncached path */
+#define CHECK_MAX_REPORTED 20         /* Mismatches printed before going quiet */
+
+/* Work units of the threads */
+#define CHUNK_DAYS 8192
+#define CHUNK_PHASES 4096
+#define CHUNK_YEARS 64
+#define MAX_THREADS 64
+
+/* Fields of a day event */
+enum {
+    GOLDEN_DAY_YEAR = 1 << 0,
+    GOLDEN_DAY_MONTH = 1 << 1,
+    GOLDEN_DAY_DAY = 1 << 2,
+    GOLDEN_DAY_PHASE = 1 << 3,
+    GOLDEN_DAY_ELD = 1 << 4,
+    GOLDEN_DAY_METONIC = 1 << 5
+};
+
+enum { SECTION_DAYS, SECTION_PHASES, SECTION_YEARS, SECTION_SEASONS };
+
+/* Header fields, in file order */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int32_t first_year;
+    int32_t last_year;
+    int32_t first_day;                /* Day number of first_year-01-01 */
+    uint32_t day_count;
+    uint32_t phase_count;
+    uint32_t year_count;              /* Lunar years and season years, first_year..last_year */
+    uint32_t section_bytes[GOLDEN_SECTIONS];
+} GoldenHeader;
+
+/* The lunar fields of a day; the Gregorian date and weekday follow from the day number */
+typedef struct {
+    int lunar_year;
+    int lunar_month;
+    int lunar_day;
+    int moon_phase;
+    int eld_year;
+    int metonic_year;
+    int metonic_cycle;
+} GoldenDay;
+
+typedef struct {
+    double new_year;
+    int months_count;
+    double month_start[14];
+} GoldenYear;
+
+// --- Byte Streams ---
+
+typedef struct {
+    unsigned char *data;
+    size_t length;
+    size_t capacity;
+} ByteBuffer;
+
+typedef struct {
+    const unsigned char *data;
+    size_t length;
+    size_t pos;
+    bool failed;                      /* Read past the end */
+} ByteReader;
+
+static void put_byte(ByteBuffer *buffer, unsigned char byte) {
+    if (buffer->length == buffer->capacity) {
+        buffer->capacity = buffer->capacity ? buffer->capacity * 2 : 65536;
+        buffer->data = realloc(buffer->data, buffer->capacity);
+        if (buffer->data == NULL) {
+            fprintf(stderr, "Error: Out of memory\n");
+            exit(2);
+        }
+    }
+    buffer->data[buffer->length++] = byte;
+}
+
+static void put_u32(ByteBuffer *buffer, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        put_byte(buffer, (unsigned char)(value >> (8 * i)));
+    }
+}
+
+static void put_varint(ByteBuffer *buffer, uint64_t value) {
+    while (value >= 0x80) {
+        put_byte(buffer, (unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    put_byte(buffer, (unsigned char)value);
+}
+
+static void put_svarint(ByteBuffer *buffer, int64_t value) {
+    put_varint(buffer, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static unsigned char get_byte(ByteReader *reader) {
+    if (reader->pos >= reader->length) {
+        reader->failed = true;
+        return 0;
+    }
+    return reader->data[reader->pos++];
+}
+
+static uint32_t get_u32(ByteReader *reader) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (uint32_t)get_byte(reader) << (8 * i);
+    }
+    return value;
+}
+
+static uint64_t get_varint(ByteReader *reader) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        unsigned char byte = get_byte(reader);
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    reader->failed = true;
+    return 0;
+}
+
+static int64_t get_svarint(ByteReader *reader) {
+    uint64_t value = get_varint(reader);
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static uint32_t fnv1a(const unsigned char *data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/* A series of instants, each coded against the previous one plus period */
+typedef struct {
+    double previous;
+    double period;
+    bool started;
+} JdSeries;
+
+static double series_prediction(const JdSeries *series) {
+    return series->started ? series->previous + series->period : 0.0;
+}
+
+static void put_jd(ByteBuffer *buffer, JdSeries *series, double jd) {
+    double predicted = series_prediction(series);
+    int64_t residual = llround((jd - predicted) / GOLDEN_JD_UNIT);
+    put_svarint(buffer, residual);
+    /* Continue from the stored value, exactly as the reader will */
+    series->previous = predicted + (double)residual * GOLDEN_JD_UNIT;
+    series->started = true;
+}
+
+static double get_jd(ByteReader *reader, JdSeries *series) {
+    double predicted = series_prediction(series);
+    series->previous = predicted + (double)get_svarint(reader) * GOLDEN_JD_UNIT;
+    series->started = true;
+    return series->previous;
+}
+
+// --- Corpus Layout ---
+
+static int first_day_number(int year) {
+    return (int)floor(gregorian_to_julian_day(year, 1, 1, 12.0));
+}
+
+/* Start of the i-th find_next_phase_jd sample; its phase is i % 4 */
+static double phase_sample_jd(int first_day, uint32_t i) {
+    return first_day + i * (LUNAR_MONTH_AVERAGE_DAYS / 4.0);
+}
+
+static void layout_header(GoldenHeader *header, int first_year, int last_year) {
+    memset(header, 0, sizeof(*header));
+    header->magic = GOLDEN_MAGIC;
+    header->version = GOLDEN_VERSION;
+    header->first_year = first_year;
+    header->last_year = last_year;
+    header->first_day = first_day_number(first_year);
+    header->day_count = (uint32_t)(first_day_number(last_year + 1) - header->first_day);
+    header->phase_count = (uint32_t)floor(header->day_count / (LUNAR_MONTH_AVERAGE_DAYS / 4.0));
+    header->year_count = (uint32_t)(last_year - first_year + 1);
+}
+
+static void golden_day_from(GoldenDay *golden, const LunarDay *day) {
+    golden->lunar_year = day->lunar_year;
+    golden->lunar_month = day->lunar_month;
+    golden->lunar_day = day->lunar_day;
+    golden->moon_phase = day->moon_phase;
+    golden->eld_year = day->eld_year;
+    golden->metonic_year = day->metonic_year;
+    golden->metonic_cycle = day->metonic_cycle;
+}
+
+// --- Generation ---
+
+typedef struct {
+    const GoldenHeader *header;
+    GoldenDay *days;
+    int thread_index;
+    int thread_count;
+    long inconsistent;                /* Days whose Gregorian date or weekday came back wrong */
+} GenerateWorker;
+
+static void *generate_worker(void *arg) {
+    GenerateWorker *worker = arg;
+    const GoldenHeader *header = worker->header;
+
+    for (uint32_t i = (uint32_t)worker->thread_index; i < header->day_count; i += (uint32_t)worker->thread_count) {
+        int day_number = header->first_day + (int)i;
+        int year, month, day;
+        day_number_to_gregorian(day_number, &year, &month, &day);
+
+        /* The reference: no cache, no context */
+        LunarDay lunar = gregorian_to_lunar(year, month, day);
+        if (lunar.greg_year != year || lunar.greg_month != month || lunar.greg_day != day ||
+            (int)lunar.weekday != (day_number + 1) % 7) {
+            worker->inconsistent++;
+        }
+        golden_day_from(&worker->days[i], &lunar);
+    }
+    return NULL;
+}
+
+static void encode_days(ByteBuffer *out, const GoldenHeader *header, const GoldenDay *days) {
+    GoldenDay previous;
+    uint32_t previous_event = 0;
+
+    memset(&previous, 0, sizeof(previous));
+    for (uint32_t i = 0; i < header->day_count; i++) {
+        const GoldenDay *day = &days[i];
+        unsigned mask = 0;
+        if (day->lunar_year != previous.lunar_year) mask |= GOLDEN_DAY_YEAR;
+        if (day->lunar_month != previous.lunar_month) mask |= GOLDEN_DAY_MONTH;
+        if (day->lunar_day != previous.lunar_day + 1) mask |= GOLDEN_DAY_DAY;
+        if (day->moon_phase != previous.moon_phase) mask |= GOLDEN_DAY_PHASE;
+        if (day->eld_year != previous.eld_year) mask |= GOLDEN_DAY_ELD;
+        if (day->metonic_year != previous.metonic_year || day->metonic_cycle != previous.metonic_cycle) {
+            mask |= GOLDEN_DAY_METONIC;
+        }
+        previous = *day;
+        if (mask == 0 && i > 0) {
+            continue;
+        }
+
+        put_varint(out, i - previous_event);
+        put_byte(out, (unsigned char)mask);
+        if (mask & GOLDEN_DAY_YEAR) put_svarint(out, day->lunar_year);
+        if (mask & GOLDEN_DAY_MONTH) put_varint(out, (uint64_t)day->lunar_month);
+        if (mask & GOLDEN_DAY_DAY) put_varint(out, (uint64_t)day->lunar_day);
+        if (mask & GOLDEN_DAY_PHASE) put_varint(out, (uint64_t)day->moon_phase);
+        if (mask & GOLDEN_DAY_ELD) put_svarint(out, day->eld_year);
+        if (mask & GOLDEN_DAY_METONIC) {
+            put_varint(out, (uint64_t)day->metonic_year);
+            put_svarint(out, day->metonic_cycle);
+        }
+        previous_event = i;
+    }
+}
+
+static void encode_phases(ByteBuffer *out, const GoldenHeader *header) {
+    JdSeries series[4];
+    for (int p = 0; p < 4; p++) {
+        series[p] = (JdSeries){ phase_sample_jd(header->first_day, (uint32_t)p) - LUNAR_MONTH_AVERAGE_DAYS,
+                                LUNAR_MONTH_AVERAGE_DAYS, true };
+    }
+    for (uint32_t i = 0; i < header->phase_count; i++) {
+        put_jd(out, &series[i % 4], find_next_phase_jd(phase_sample_jd(header->first_day, i), (int)(i % 4)));
+    }
+}
+
+static void encode_years(ByteBuffer *out, const GoldenHeader *header) {
+    JdSeries new_years = { 0, SOLAR_YEAR_DAYS, false };
+    JdSeries month_starts = { 0, LUNAR_MONTH_AVERAGE_DAYS, false };
+
+    for (uint32_t i = 0; i < header->year_count; i++) {
+        int year = header->first_year + (int)i;
+        LunarYearBoundaries bounds;
+
+        put_jd(out, &new_years, calculate_lunar_new_year_jd(year));
+        if (!calculate_lunar_year_boundaries(year, &bounds)) {
+            put_byte(out, 0);
+            continue;
+        }
+        put_byte(out, (unsigned char)bounds.months_count);
+        for (int m = 0; m <= bounds.months_count; m++) {
+            put_jd(out, &month_starts, bounds.month_start_jd[m]);
+        }
+    }
+}
+
+static void encode_seasons(ByteBuffer *out, const GoldenHeader *header) {
+    JdSeries series[4];
+    for (int s = 0; s < 4; s++) {
+        series[s] = (JdSeries){ 0, SOLAR_YEAR_DAYS, false };
+    }
+    for (uint32_t i = 0; i < header->year_count; i++) {
+        for (int s = 0; s < 4; s++) {
+            put_jd(out, &series[s], calculate_solstice_equinox_jde(header->first_year + (int)i, s));
+        }
+    }
+}
+
+static int generate_corpus(const char *path, int thread_count) {
+    GoldenHeader header;
+    layout_header(&header, GOLDEN_FIRST_YEAR, GOLDEN_LAST_YEAR);
+
+    GoldenDay *days = calloc(header.day_count, sizeof(GoldenDay));
+    if (days == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return 2;
+    }
+    GenerateWorker workers[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    int started = 0;
+    for (int t = 0; t < thread_count; t++) {
+        workers[t] = (GenerateWorker){ &header, days, t, thread_count, 0 };
+        if (pthread_create(&threads[started], NULL, generate_worker, &workers[t]) == 0) {
+            started++;
+        }
+    }
+    long inconsistent = 0;
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+        inconsistent += workers[t].inconsistent;
+    }
+    if (started < thread_count) {
+        /* Stripes whose thread did not start */
+        for (int t = started; t < thread_count; t++) {
+            generate_worker(&workers[t]);
+            inconsistent += workers[t].inconsistent;
+        }
+    }
+    if (inconsistent > 0) {
+        fprintf(stderr, "Error: %ld days did not keep their Gregorian date or weekday; not writing a corpus\n",
+                inconsistent);
+        free(days);
+        return 1;
+    }
+
+    ByteBuffer sections[GOLDEN_SECTIONS];
+    memset(sections, 0, sizeof(sections));
+    encode_days(&sections[SECTION_DAYS], &header, days);
+    encode_phases(&sections[SECTION_PHASES], &header);
+    encode_years(&sections[SECTION_YEARS], &header);
+    encode_seasons(&sections[SECTION_SEASONS], &header);
+    free(days);
+
+    ByteBuffer file;
+    memset(&file, 0, sizeof(file));
+    for (int s = 0; s < GOLDEN_SECTIONS; s++) {
+        header.section_bytes[s] = (uint32_t)sections[s].length;
+    }
+    put_u32(&file, header.magic);
+    put_u32(&file, header.version);
+    put_u32(&file, (uint32_t)header.first_year);
+    put_u32(&file, (uint32_t)header.last_year);
+    put_u32(&file, (uint32_t)header.first_day);
+    put_u32(&file, header.day_count);
+    put_u32(&file, header.phase_count);
+    put_u32(&file, header.year_count);
+    for (int s = 0; s < GOLDEN_SECTIONS; s++) {
+        put_u32(&file, header.section_bytes[s]);
+    }
+    for (int s = 0; s < GOLDEN_SECTIONS; s++) {
+        for (size_t i = 0; i < sections[s].length; i++) {
+            put_byte(&file, sections[s].data[i]);
+        }
+        free(sections[s].data);
+    }
+    put_u32(&file, fnv1a(file.data + GOLDEN_HEADER_BYTES, file.length - GOLDEN_HEADER_BYTES));
+
+    FILE *out = fopen(path, "wb");
+    bool written = out != NULL && fwrite(file.data, 1, file.length, out) == file.length;
+    if (out != NULL && fclose(out) != 0) {
+        written = false;
+    }
+    free(file.data);
+    if (!written) {
+        fprintf(stderr, "Error: Could not write '%s'\n", path);
+        return 2;
+    }
+    printf("Wrote %s: %u days, %u phase instants, %u years (%u + %u + %u + %u bytes)\n", path,
+           header.day_count, header.phase_count, header.year_count, header.section_bytes[0],
+           header.section_bytes[1], header.section_bytes[2], header.section_bytes[3]);
+    return 0;
+}
+
+// --- Loading ---
+
+typedef struct {
+    GoldenHeader header;
+    unsigned char *data;              /* The whole file */
+    ByteReader sections[GOLDEN_SECTIONS];
+    double *phases;                   /* phase_count instants */
+    GoldenYear *years;                /* year_count lunar years */
+    double (*seasons)[4];             /* year_count years of seasons 0-3 */
+} Corpus;
+
+/* Position in the day stream; copies of it resume decoding independently */
+typedef struct {
+    ByteReader in;
+    uint32_t day;                     /* Index of the day in state */
+    uint32_t next_event;              /* Index of the next day with an event */
+    GoldenDay state;
+} DayCursor;
+
+static void day_cursor_start(DayCursor *cursor, const ByteReader *section) {
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->in = *section;
+    cursor->day = UINT32_MAX;         /* Before the first day */
+    cursor->next_event = (uint32_t)get_varint(&cursor->in);
+}
+
+static void day_cursor_next(DayCursor *cursor) {
+    cursor->day++;
+    cursor->state.lunar_day++;
+    if (cursor->day != cursor->next_event) {
+        return;
+    }
+    GoldenDay *state = &cursor->state;
+    unsigned mask = get_byte(&cursor->in);
+    if (mask & GOLDEN_DAY_YEAR) state->lunar_year = (int)get_svarint(&cursor->in);
+    if (mask & GOLDEN_DAY_MONTH) state->lunar_month = (int)get_varint(&cursor->in);
+    if (mask & GOLDEN_DAY_DAY) state->lunar_day = (int)get_varint(&cursor->in);
+    if (mask & GOLDEN_DAY_PHASE) state->moon_phase = (int)get_varint(&cursor->in);
+    if (mask & GOLDEN_DAY_ELD) state->eld_year = (int)get_svarint(&cursor->in);
+    if (mask & GOLDEN_DAY_METONIC) {
+        state->metonic_year = (int)get_varint(&cursor->in);
+        state->metonic_cycle = (int)get_svarint(&cursor->in);
+    }
+    cursor->next_event = cursor->in.pos < cursor->in.length
+                         ? cursor->next_event + (uint32_t)get_varint(&cursor->in) : UINT32_MAX;
+}
+
+static bool load_corpus(const char *path, Corpus *corpus) {
+    memset(corpus, 0, sizeof(*corpus));
+    FILE *in = fopen(path, "rb");
+    if (in == NULL) {
+        fprintf(stderr, "Error: Could not open corpus '%s'\n", path);
+        return false;
+    }
+    fseek(in, 0, SEEK_END);
+    long size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    corpus->data = size > 0 ? malloc((size_t)size) : NULL;
+    bool read = corpus->data != NULL && fread(corpus->data, 1, (size_t)size, in) == (size_t)size;
+    fclose(in);
+    if (!read || size < GOLDEN_HEADER_BYTES + 4) {
+        fprintf(stderr, "Error: Could not read corpus '%s'\n", path);
+        return false;
+    }
+
+    ByteReader reader = { corpus->data, (size_t)size, 0, false };
+    GoldenHeader *header = &corpus->header;
+    header->magic = get_u32(&reader);
+    header->version = get_u32(&reader);
+    header->first_year = (int32_t)get_u32(&reader);
+    header->last_year = (int32_t)get_u32(&reader);
+    header->first_day = (int32_t)get_u32(&reader);
+    header->day_count = get_u32(&reader);
+    header->phase_count = get_u32(&reader);
+    header->year_count = get_u32(&reader);
+    size_t payload = 0;
+    for (int s = 0; s < GOLDEN_SECTIONS; s++) {
+        header->section_bytes[s] = get_u32(&reader);
+        payload += header->section_bytes[s];
+    }
+
+    GoldenHeader expected;
+    layout_header(&expected, header->first_year, header->last_year);
+    if (header->magic != GOLDEN_MAGIC || header->version != GOLDEN_VERSION ||
+        header->day_count != expected.day_count || header->first_day != expected.first_day ||
+        header->phase_count != expected.phase_count || header->year_count != expected.year_count ||
+        payload + GOLDEN_HEADER_BYTES + 4 != (size_t)size) {
+        fprintf(stderr, "Error: '%s' is not a version %d golden corpus\n", path, GOLDEN_VERSION);
+        return false;
+    }
+    ByteReader trailer = { corpus->data + size - 4, 4, 0, false };
+    if (get_u32(&trailer) != fnv1a(corpus->data + GOLDEN_HEADER_BYTES, payload)) {
+        fprintf(stderr, "Error: Corpus '%s' fails its checksum\n", path);
+        return false;
+    }
+    size_t offset = GOLDEN_HEADER_BYTES;
+    for (int s = 0; s < GOLDEN_SECTIONS; s++) {
+        corpus->sections[s] = (ByteReader){ corpus->data + offset, header->section_bytes[s], 0, false };
+        offset += header->section_bytes[s];
+    }
+
+    /* The instant sections are small; decode them up front */
+    corpus->phases = malloc(header->phase_count * sizeof(double));
+    corpus->years = calloc(header->year_count, sizeof(GoldenYear));
+    corpus->seasons = malloc(header->year_count * sizeof(*corpus->seasons));
+    if (corpus->phases == NULL || corpus->years == NULL || corpus->seasons == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return false;
+    }
+
+    ByteReader phases = corpus->sections[SECTION_PHASES];
+    JdSeries phase_series[4];
+    for (int p = 0; p < 4; p++) {
+        phase_series[p] = (JdSeries){ phase_sample_jd(header->first_day, (uint32_t)p) - LUNAR_MONTH_AVERAGE_DAYS,
+                                      LUNAR_MONTH_AVERAGE_DAYS, true };
+    }
+    for (uint32_t i = 0; i < header->phase_count; i++) {
+        corpus->phases[i] = get_jd(&phases, &phase_series[i % 4]);
+    }
+
+    ByteReader years = corpus->sections[SECTION_YEARS];
+    JdSeries new_years = { 0, SOLAR_YEAR_DAYS, false };
+    JdSeries month_starts = { 0, LUNAR_MONTH_AVERAGE_DAYS, false };
+    for (uint32_t i = 0; i < header->year_count; i++) {
+        GoldenYear *year = &corpus->years[i];
+        year->new_year = get_jd(&years, &new_years);
+        year->months_count = get_byte(&years);
+        if (year->months_count > 13) {
+            years.failed = true;
+            break;
+        }
+        for (int m = 0; year->months_count > 0 && m <= year->months_count; m++) {
+            year->month_start[m] = get_jd(&years, &month_starts);
+        }
+    }
+
+    ByteReader seasons = corpus->sections[SECTION_SEASONS];
+    JdSeries season_series[4];
+    for (int s = 0; s < 4; s++) {
+        season_series[s] = (JdSeries){ 0, SOLAR_YEAR_DAYS, false };
+    }
+    for (uint32_t i = 0; i < header->year_count; i++) {
+        for (int s = 0; s < 4; s++) {
+            corpus->seasons[i][s] = get_jd(&seasons, &season_series[s]);
+        }
+    }
+
+    if (phases.failed || phases.pos != phases.length || years.failed || years.pos != years.length ||
+        seasons.failed || seasons.pos != seasons.length) {
+        fprintf(stderr, "Error: Corpus '%s' is truncated or malformed\n", path);
+        return false;
+    }
+    return true;
+}
+
+static void free_corpus(Corpus *corpus) {
+    free(corpus->data);
+    free(corpus->phases);
+    free(corpus->years);
+    free(corpus->seasons);
+}
+
+// --- Checking ---
+
+/* What was compared, by path */
+enum {
+    CHECK_DAYS_CACHED,
+    CHECK_DAYS_SHARED,
+    CHECK_DAYS_PLAIN,
+    CHECK_DAYS_ROUND_TRIP,
+    CHECK_PHASES,
+    CHECK_NEW_YEARS,
+    CHECK_BOUNDARIES,
+    CHECK_SEASONS,
+#ifdef LUNAR_GOLDEN_GUI
+    CHECK_DAYS_EVENTS,
+#endif
+    CHECK_COUNT
+};
+
+static const char *CHECK_NAMES[CHECK_COUNT] = {
+    "days, cached path", "days, shared table", "days, plain path", "days, lunar to gregorian",
+    "phase instants",
+    "lunar new years", "year boundaries", "solstices and equinoxes",
+#ifdef LUNAR_GOLDEN_GUI
+    "days, events module",
+#endif
+};
+
+typedef struct {
+    const Corpus *corpus;
+    DayCursor *checkpoints;           /* Cursor just before each day chunk */
+    uint32_t day_chunks, phase_chunks, year_chunks;
+    LunarContext *shared;             /* LUNAR_CTX_SHARED, used by all threads */
+    pthread_mutex_t lock;             /* Guards next_task and the report */
+    uint32_t next_task;
+    long checked[CHECK_COUNT];
+    long mismatched[CHECK_COUNT];
+    long reported;
+} CheckJob;
+
+static void report(CheckJob *job, int check, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+static void report(CheckJob *job, int check, const char *format, ...) {
+    pthread_mutex_lock(&job->lock);
+    job->mismatched[check]++;
+    if (job->reported++ < CHECK_MAX_REPORTED) {
+        va_list args;
+        va_start(args, format);
+        fprintf(stderr, "MISMATCH (%s): ", CHECK_NAMES[check]);
+        vfprintf(stderr, format, args);
+        fputc('\n', stderr);
+        va_end(args);
+    }
+    pthread_mutex_unlock(&job->lock);
+}
+
+static void compare_day(CheckJob *job, int check, int day_number, const GoldenDay *expected, const LunarDay *actual,
+                        int year, int month, int day) {
+    GoldenDay got;
+    golden_day_from(&got, actual);
+    if (memcmp(&got, expected, sizeof(got)) != 0 || actual->greg_year != year || actual->greg_month != month ||
+        actual->greg_day != day || (int)actual->weekday != (day_number + 1) % 7) {
+        report(job, check, "%04d-%02d-%02d: expected %d/%d/%d phase %d eld %d metonic %d/%d, "
+               "got %d/%d/%d phase %d eld %d metonic %d/%d", year, month, day,
+               expected->lunar_year, expected->lunar_month, expected->lunar_day, expected->moon_phase,
+               expected->eld_year, expected->metonic_year, expected->metonic_cycle,
+               got.lunar_year, got.lunar_month, got.lunar_day, got.moon_phase,
+               got.eld_year, got.metonic_year, got.metonic_cycle);
+    }
+}
+
+static bool jd_matches(double expected, double actual) {
+    return fabs(expected - actual) <= CHECK_JD_TOLERANCE;
+}
+
+static void check_day_chunk(CheckJob *job, uint32_t chunk, long *checked) {
+    const GoldenHeader *header = &job->corpus->header;
+    DayCursor cursor = job->checkpoints[chunk];
+    uint32_t first = chunk * CHUNK_DAYS;
+    uint32_t last = first + CHUNK_DAYS < header->day_count ? first + CHUNK_DAYS : header->day_count;
+    LunarCache cache;
+
+    lunar_cache_init(&cache);
+    for (uint32_t i = first; i < last; i++) {
+        day_cursor_next(&cursor);
+        int day_number = header->first_day + (int)i;
+        int year, month, day;
+        day_number_to_gregorian(day_number, &year, &month, &day);
+
+        LunarDay cached = gregorian_to_lunar_cached(&cache, year, month, day);
+        compare_day(job, CHECK_DAYS_CACHED, day_number, &cursor.state, &cached, year, month, day);
+        LunarDay shared = lunar_ctx_gregorian_to_lunar(job->shared, year, month, day);
+        compare_day(job, CHECK_DAYS_SHARED, day_number, &cursor.state, &shared, year, month, day);
+        checked[CHECK_DAYS_CACHED]++;
+        checked[CHECK_DAYS_SHARED]++;
+
+        const GoldenDay *lunar = &cursor.state;
+        int back_year = 0, back_month = 0, back_day = 0;
+        if (lunar->lunar_month != 0 &&
+            (!lunar_to_gregorian_cached(&cache, lunar->lunar_year, lunar->lunar_month, lunar->lunar_day,
+                                        &back_year, &back_month, &back_day) ||
+             back_year != year || back_month != month || back_day != day)) {
+            report(job, CHECK_DAYS_ROUND_TRIP, "%d/%d/%d: expected %04d-%02d-%02d, got %04d-%02d-%02d",
+                   lunar->lunar_year, lunar->lunar_month, lunar->lunar_day, year, month, day,
+                   back_year, back_month, back_day);
+        }
+        checked[CHECK_DAYS_ROUND_TRIP]++;
+        if (i % CHECK_PLAIN_STRIDE == 0) {
+            LunarDay plain = gregorian_to_lunar(year, month, day);
+            compare_day(job, CHECK_DAYS_PLAIN, day_number, &cursor.state, &plain, year, month, day);
+            checked[CHECK_DAYS_PLAIN]++;
+        }
+    }
+}
+
+static void check_phase_chunk(CheckJob *job, uint32_t chunk, long *checked) {
+    const Corpus *corpus = job->corpus;
+    uint32_t first = chunk * CHUNK_PHASES;
+    uint32_t last = first + CHUNK_PHASES < corpus->header.phase_count ? first + CHUNK_PHASES
+                                                                       : corpus->header.phase_count;
+    for (uint32_t i = first; i < last; i++) {
+        double start = phase_sample_jd(corpus->header.first_day, i);
+        double actual = find_next_phase_jd(start, (int)(i % 4));
+        if (!jd_matches(corpus->phases[i], actual)) {
+            report(job, CHECK_PHASES, "phase %u after JD %.5f: expected %.8f, got %.8f",
+                   i % 4, start, corpus->phases[i], actual);
+        }
+        checked[CHECK_PHASES]++;
+    }
+}
+
+static void compare_boundaries(CheckJob *job, int year, const GoldenYear *expected, bool computed,
+                               const LunarYearBoundaries *bounds) {
+    int months = computed ? bounds->months_count : 0;
+    bool matches = months == expected->months_count;
+    for (int m = 0; matches && m <= months && months > 0; m++) {
+        matches = jd_matches(expected->month_start[m], bounds->month_start_jd[m]);
+    }
+    if (!matches) {
+        report(job, CHECK_BOUNDARIES, "lunar year %d: expected %d months from JD %.8f, got %d months from JD %.8f",
+               year, expected->months_count, expected->month_start[0], months,
+               months > 0 ? bounds->month_start_jd[0] : 0.0);
+    }
+}
+
+static void check_year_chunk(CheckJob *job, uint32_t chunk, long *checked) {
+    const Corpus *corpus = job->corpus;
+    uint32_t first = chunk * CHUNK_YEARS;
+    uint32_t last = first + CHUNK_YEARS < corpus->header.year_count ? first + CHUNK_YEARS
+                                                                     : corpus->header.year_count;
+    for (uint32_t i = first; i < last; i++) {
+        int year = corpus->header.first_year + (int)i;
+        const GoldenYear *expected = &corpus->years[i];
+        LunarYearBoundaries bounds;
+
+        double new_year = calculate_lunar_new_year_jd(year);
+        if (!jd_matches(expected->new_year, new_year)) {
+            report(job, CHECK_NEW_YEARS, "year %d: expected JD %.8f, got %.8f", year, expected->new_year, new_year);
+        }
+        checked[CHECK_NEW_YEARS]++;
+
+        bool computed = calculate_lunar_year_boundaries(year, &bounds);
+        compare_boundaries(job, year, expected, computed, &bounds);
+        computed = lunar_ctx_year_boundaries(job->shared, year, &bounds);
+        compare_boundaries(job, year, expected, computed, &bounds);
+        if (expected->months_count > 0 && get_lunar_months_in_year(year) != expected->months_count) {
+            report(job, CHECK_BOUNDARIES, "lunar year %d: get_lunar_months_in_year is %d, expected %d",
+                   year, get_lunar_months_in_year(year), expected->months_count);
+        }
+        checked[CHECK_BOUNDARIES] += 3;
+
+        for (int s = 0; s < 4; s++) {
+            double actual = calculate_solstice_equinox_jde(year, s);
+            if (!jd_matches(corpus->seasons[i][s], actual)) {
+                report(job, CHECK_SEASONS, "year %d season %d: expected JD %.8f, got %.8f",
+                       year, s, corpus->seasons[i][s], actual);
+            }
+            checked[CHECK_SEASONS]++;
+        }
+    }
+}
+
+static void *check_worker(void *arg) {
+    CheckJob *job = arg;
+    long checked[CHECK_COUNT] = { 0 };
+    uint32_t task_count = job->day_chunks + job->phase_chunks + job->year_chunks;
+
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        uint32_t task = job->next_task < task_count ? job->next_task++ : task_count;
+        pthread_mutex_unlock(&job->lock);
+        if (task == task_count) {
+            break;
+        }
+        if (task < job->day_chunks) {
+            check_day_chunk(job, task, checked);
+        } else if (task < job->day_chunks + job->phase_chunks) {
+            check_phase_chunk(job, task - job->day_chunks, checked);
+        } else {
+            check_year_chunk(job, task - job->day_chunks - job->phase_chunks, checked);
+        }
+    }
+
+    pthread_mutex_lock(&job->lock);
+    for (int c = 0; c < CHECK_COUNT; c++) {
+        job->checked[c] += checked[c];
+    }
+    pthread_mutex_unlock(&job->lock);
+    return NULL;
+}
+
+#ifdef LUNAR_GOLDEN_GUI
+/* The events module keeps its own month boundaries and is not thread-safe, so
+ * it is checked in one pass over the day stream after the workers finish */
+static void check_events_days(CheckJob *job) {
+    const GoldenHeader *header = &job->corpus->header;
+    DayCursor cursor;
+    day_cursor_start(&cursor, &job->corpus->sections[SECTION_DAYS]);
+    events_init(NULL);
+    for (uint32_t i = 0; i < header->day_count; i++) {
+        day_cursor_next(&cursor);
+        const GoldenDay *expected = &cursor.state;
+        if (expected->lunar_month == 0) {
+            continue;
+        }
+        int year, month, day;
+        day_number_to_gregorian(header->first_day + (int)i, &year, &month, &day);
+        int lunar_year = 0, lunar_month = 0, lunar_day = 0;
+        if (!events_gregorian_to_lunar(year, month, day, &lunar_year, &lunar_month, &lunar_day) ||
+            lunar_year != expected->lunar_year || lunar_month != expected->lunar_month ||
+            lunar_day != expected->lunar_day) {
+            report(job, CHECK_DAYS_EVENTS, "%04d-%02d-%02d: expected %d/%d/%d, got %d/%d/%d",
+                   year, month, day, expected->lunar_year, expected->lunar_month, expected->lunar_day,
+                   lunar_year, lunar_month, lunar_day);
+        }
+        job->checked[CHECK_DAYS_EVENTS]++;
+    }
+    events_cleanup();
+}
+#endif
+
+static int check_corpus(const char *path, int thread_count) {
+    Corpus corpus;
+    if (!load_corpus(path, &corpus)) {
+        free_corpus(&corpus);
+        return 2;
+    }
+    const GoldenHeader *header = &corpus.header;
+
+    CheckJob job;
+    memset(&job, 0, sizeof(job));
+    job.corpus = &corpus;
+    job.day_chunks = (header->day_count + CHUNK_DAYS - 1) / CHUNK_DAYS;
+    job.phase_chunks = (header->phase_count + CHUNK_PHASES - 1) / CHUNK_PHASES;
+    job.year_chunks = (header->year_count + CHUNK_YEARS - 1) / CHUNK_YEARS;
+    job.checkpoints = malloc(job.day_chunks * sizeof(DayCursor));
+    job.shared = lunar_ctx_new(LUNAR_CTX_SHARED);
+    if (job.checkpoints == NULL || job.shared == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        free(job.checkpoints);
+        lunar_ctx_free(job.shared);
+        free_corpus(&corpus);
+        return 2;
+    }
+    pthread_mutex_init(&job.lock, NULL);
+
+    /* One pass over the day stream to find where each chunk resumes */
+    DayCursor cursor;
+    day_cursor_start(&cursor, &corpus.sections[SECTION_DAYS]);
+    for (uint32_t i = 0; i < header->day_count; i++) {
+        if (i % CHUNK_DAYS == 0) {
+            job.checkpoints[i / CHUNK_DAYS] = cursor;
+        }
+        day_cursor_next(&cursor);
+    }
+    bool stream_ok = !cursor.in.failed && cursor.in.pos == cursor.in.length;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_t threads[MAX_THREADS];
+    int started = 0;
+    for (int t = 0; stream_ok && t < thread_count; t++) {
+        if (pthread_create(&threads[started], NULL, check_worker, &job) == 0) {
+            started++;
+        }
+    }
+    if (stream_ok && started == 0) {
+        check_worker(&job);
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+#ifdef LUNAR_GOLDEN_GUI
+    if (stream_ok) {
+        check_events_days(&job);
+    }
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    int status = 0;
+    if (!stream_ok) {
+        fprintf(stderr, "Error: Day section of corpus '%s' is malformed\n", path);
+        status = 2;
+    } else {
+        long mismatches = 0;
+        printf("Golden corpus %s: years %d to %d, %d thread%s, %.2f s\n", path, header->first_year,
+               header->last_year, started > 0 ? started : 1, started > 1 ? "s" : "",
+               (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+        for (int c = 0; c < CHECK_COUNT; c++) {
+            printf("  %-26s %9ld checked, %ld mismatched\n", CHECK_NAMES[c], job.checked[c], job.mismatched[c]);
+            mismatches += job.mismatched[c];
+        }
+        printf("%s (instant tolerance %.0e days)\n", mismatches == 0 ? "PASS" : "FAIL", CHECK_JD_TOLERANCE);
+        status = mismatches == 0 ? 0 : 1;
+    }
+
+    pthread_mutex_destroy(&job.lock);
+    lunar_ctx_free(job.shared);
+    free(job.checkpoints);
+    free_corpus(&corpus);
+    return status;
+}
+
+// --- Main ---
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s --check FILE [--threads N]\n"
+                    "       %s --generate FILE [--threads N]\n", program, program);
+}
+
+int main(int argc, char *argv[]) {
+    const char *check_path = NULL;
+    const char *generate_path = NULL;
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    int thread_count = online > 0 ? (int)online : 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check") == 0 && i + 1 < argc) {
+            check_path = argv[++i];
+        } else if (strcmp(argv[i], "--generate") == 0 && i + 1 < argc) {
+            generate_path = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            thread_count = atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if ((check_path == NULL) == (generate_path == NULL) || thread_count < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (thread_count > MAX_THREADS) {
+        thread_count = MAX_THREADS;
+    }
+    return generate_path != NULL ? generate_corpus(generate_path, thread_count)
+                                 : check_corpus(check_path, thread_count);
+}